@@ -20,6 +20,19 @@
 #include "me6eapp_ProxyArp_data.h"
 #include "me6eapp_ProxyNdp_data.h"
 #include "me6eapp_pr_struct.h"
+#include "me6eapp_peer.h"
+#include "me6eapp_mcast.h"
+#include "me6eapp_pmtu.h"
+#include "me6eapp_vnet.h"
+#include "me6eapp_stub_ring.h"
+#include "me6eapp_uring.h"
+#include "me6eapp_fanout.h"
+#include "me6eapp_neigh.h"
+#include "me6eapp_udp.h"
+#include "me6eapp_bufpool.h"
+#include "me6eapp_pipeline.h"
+#include "me6eapp_busypoll.h"
+#include "me6eapp_txq.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // マクロ定義
@@ -36,6 +49,14 @@
 #define MAC_ADDRSTRLEN  18
 //! 受信イベント(ディスクリプタ)の最大登録数
 #define RECV_NEVENT_NUM 4
+//! io_uringの固定ファイル番号(トンネルデバイス)
+#define ME6E_URING_FILE_TAP     0
+//! io_uringの固定ファイル番号(Backbone側ソケット)
+#define ME6E_URING_FILE_BB      1
+//! io_uringの固定ファイル番号(Stub側パケットリング)
+#define ME6E_URING_FILE_RING    2
+//! io_uringの固定ファイル数
+#define ME6E_URING_FILE_NUM     3
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +71,24 @@ struct me6e_handler_t
     me6e_proxy_ndp_t    *proxy_ndp_handler;        ///< Proxy NDP テーブル管理ハンドラー
     me6e_hashtable_t    *mac_manager_static_entry; ///< MAC管理静的エントリ
     me6e_pr_table_t*    pr_handler;                ///< ME6E-PR情報管理
+    me6e_peer_table_t*  peer_handler;              ///< ME6Eピア監視
+    me6e_mcast_table_t* mcast_handler;             ///< マルチキャストグループ管理(未使用時はNULL)
+    me6e_pmtu_table_t*  pmtu_handler;              ///< Path MTU管理(未使用時はNULL)
+    me6e_vnet_gro_t*    gro_handler;               ///< Stub側送信のセグメント結合(未使用時はNULL)
+    me6e_stub_ring_t*   stub_ring;                 ///< Stub側パケットリング(未使用時はNULL)
+    me6e_uring_t*       bb_uring;                  ///< Backbone側受信用io_uring(epoll使用時はNULL)
+    me6e_uring_t*       stub_uring;                ///< Stub側受信/カプセル化送信用io_uring(epoll使用時はNULL)
+    me6e_fanout_t*      bb_fanout;                 ///< Backbone側分散受信(未使用時はNULL)
+    me6e_neigh_table_t* bb_neigh;                  ///< Backbone側L2直接送信(未使用時はNULL)
+    me6e_udp_t*         bb_udp;                    ///< EtherIP over UDP送受信(未使用時はNULL)
+    me6e_bufpool_t*     bufpool;                   ///< パケットバッファプール
+    me6e_pipeline_t*    pipeline;                  ///< 受信スレッド/処理スレッド間パイプライン(未使用時はNULL)
+    me6e_busypoll_t*    bb_busypoll;               ///< Backbone側受信待ちのビジーポーリング(未使用時はNULL)
+    me6e_busypoll_t*    stub_busypoll;             ///< Stub側受信待ちのビジーポーリング(未使用時はNULL)
+    me6e_txq_t*         bb_txq;                    ///< Backbone側送信キュー(未使用時はNULL)
+    me6e_txq_t*         stub_txq;                  ///< Stub側送信キュー(未使用時はNULL)
+    volatile int        backbone_mtu;              ///< Backbone側物理デバイスのMTU(変更時に更新)
+    int                 link_fd;                   ///< Backbone側リンク変更通知受信用ディスクリプタ
     me6e_list           instance_list;             ///< 各機能のインスタンスを登録するリスト
     struct in6_addr     unicast_prefix;            ///< ME6E ユニキャストプレフィックス
     struct in6_addr     multicast_prefix;          ///< ME6E マルチキャストプレフィックス
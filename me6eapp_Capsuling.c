@@ -19,7 +19,9 @@
 #include <arpa/inet.h>
 #include <net/if_arp.h>
 #include <netinet/ether.h>
+#include <netinet/ip.h>
 #include <netinet/ip6.h>
+#include <netinet/tcp.h>
 #include <errno.h>
 
 
@@ -36,8 +38,12 @@
 #include "me6eapp_print_packet.h"
 #include "me6eapp_pr.h"
 #include "me6eapp_pr_struct.h"
+#include "me6eapp_vnet.h"
 
 
+//! 内側フラグメント生成用バッファサイズ
+#define CAPSULING_FRAG_BUF_SIZE 65535
+
 // デバッグ用マクロ
 #ifdef DEBUG
 #define _D_(x) x
@@ -46,12 +52,60 @@
 #endif
 
 
+///////////////////////////////////////////////////////////////////////////////
+//! Capsulingクラスの転送コンテキスト定義
+//!
+//! 初期化時に設定情報から転送処理で必要な値をコピーし、
+//! パケット毎の処理で設定情報を参照しないようにする。
+///////////////////////////////////////////////////////////////////////////////
+struct CapsulingContext{
+        int                 bb_fd;             ///< Backbone側ソケット
+        int                 tunnel_fd;         ///< Stub側トンネルデバイス
+        bool                tunnel_vnet_hdr;   ///< Stub側トンネルデバイスの仮想NICヘッダの有効/無効
+        me6e_vnet_gro_t*    gro_handler;       ///< Stub側送信のセグメント結合(未使用時はNULL)
+        me6e_stub_ring_t*   stub_ring;         ///< Stub側パケットリング(未使用時はNULL)
+        me6e_uring_t*       uring;             ///< カプセル化送信用io_uring(epoll使用時はNULL)
+        me6e_neigh_table_t* neigh;             ///< Backbone側L2直接送信(未使用時はNULL)
+        me6e_udp_t*         udp;               ///< EtherIP over UDP送信(未使用時はNULL)
+        me6e_txq_t*         bb_txq;            ///< Backbone側送信キュー(未使用時はNULL)
+        me6e_txq_t*         stub_txq;          ///< Stub側送信キュー(未使用時はNULL)
+        unsigned int        bb_ifindex;        ///< Backbone側物理デバイスのインデックス
+        struct in6_addr     uni_prefix;        ///< 送信先ME6Eユニキャストプレフィックス
+        struct in6_addr     src_prefix;        ///< 送信元ME6Eユニキャストプレフィックス
+        struct in6_addr     multi_prefix;      ///< 送信先ME6Eマルチキャストアドレス
+        struct in6_addr     own_v6addr;        ///< 自身のME6Eアドレス(L2MC-L3UC用)
+        me6e_list*          host_list;         ///< ME6Eホストアドレスリスト(L2MC-L3UC用)
+        int                 host_num;          ///< ME6Eホスト数(L2MC-L3UC用)
+        struct sockaddr_in6* host_addr;        ///< ME6Eホスト毎の送信先アドレス(L2MC-L3UC用)
+        struct mmsghdr*     host_msg;          ///< ME6Eホスト毎の送信メッセージ(L2MC-L3UC用)
+        int                 send_num;          ///< 送信対象のME6Eホスト数(L2MC-L3UC用)
+        struct mmsghdr*     send_msg;          ///< 送信対象(up)のME6Eホストの送信メッセージ(L2MC-L3UC用)
+        me6e_peer_table_t*  peer_handler;      ///< ME6Eピア監視(死活監視無効時はNULL)
+        me6e_mcast_table_t* mcast_handler;     ///< マルチキャストグループ管理(未使用時はNULL)
+        uint32_t            peer_generation;   ///< 送信対象構築時のピア生存状態の世代番号
+        bool                flow_label;        ///< フローラベル設定有無
+        me6e_pmtu_table_t*  pmtu_handler;      ///< Path MTU管理(未使用時はNULL)
+        char*               frag_buffer;       ///< 内側フラグメント生成用バッファ
+        bool                mss_clamp;         ///< TCP MSSクランプ有無
+        volatile int*       bb_mtu;            ///< Backbone側物理デバイスのMTU(変更時に更新)
+        struct iovec        l2mc_iov[2];       ///< 全ホスト共通の送信データ(L2MC-L3UC用)
+        struct etheriphdr   l2mc_ether_ip_hdr; ///< 全ホスト共通のEtherIPヘッダ(L2MC-L3UC用)
+        char                l2mc_cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))]; ///< 全ホスト共通の送信元情報(L2MC-L3UC用)
+        me6e_pr_table_t*    pr_handler;        ///< ME6E-PR情報管理(PR用)
+        me6e_statistics_t*  stat_info;         ///< 統計情報
+};
+typedef struct CapsulingContext CapsulingContext;
+
+//! StubNWパケット転送関数の型
+typedef bool (*capsuling_forward_func)(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len);
+
 ///////////////////////////////////////////////////////////////////////////////
 //! Capsulingクラスのフィールド定義
 ///////////////////////////////////////////////////////////////////////////////
 struct CapsulingField{
         struct me6e_handler_t *handler;        ///< ME6Eのアプリケーションハンドラー
-        // 以下に必要なメンバを追加する
+        capsuling_forward_func forward_from_stub; ///< モード別のStubNWパケット転送関数
+        CapsulingContext       ctx;            ///< 転送コンテキスト
 };
 typedef struct CapsulingField CapsulingField;
 
@@ -62,11 +116,23 @@ static bool Capsuling_Init(IProcessor* self, struct me6e_handler_t *handler);
 static void Capsuling_Release(IProcessor* proc);
 static bool Capsuling_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t recv_len);
 static bool Capsuling_RecvFromBackbone(IProcessor* self, char* recv_buffer, ssize_t recv_len);
-static inline bool Capsuling_capsule_msg_send(IProcessor* self, struct in6_addr* src,
+static bool Capsuling_forward_fp(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len);
+static bool Capsuling_forward_fp_l2mc_l3uc(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len);
+static bool Capsuling_forward_pr(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len);
+static int Capsuling_pmtu_exceeded(CapsulingContext* ctx, struct in6_addr* src,
+                struct in6_addr* dst, char* recv_buffer, ssize_t recv_len, int mtu);
+static int Capsuling_fragment_ipv4(CapsulingContext* ctx, struct in6_addr* src,
+                struct in6_addr* dst, char* recv_buffer, ssize_t recv_len, int mtu);
+static inline void Capsuling_mss_clamp(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len);
+static inline uint32_t Capsuling_flow_label(CapsulingContext* ctx, uint32_t hash);
+static inline bool Capsuling_capsule_msg_send(CapsulingContext* ctx, struct in6_addr* src,
                 struct in6_addr* dst, char* recv_buffer, ssize_t recv_len);
 // L2MC-L3UC機能 start
-static inline bool Capsuling_capsule_msg_send_l2mc_l3uc( IProcessor* self,
-                struct in6_addr* src, char* recv_buffer, ssize_t recv_len);
+static bool Capsuling_l2mc_l3uc_init(CapsulingContext* ctx);
+static void Capsuling_l2mc_l3uc_release(CapsulingContext* ctx);
+static void Capsuling_l2mc_l3uc_update(CapsulingContext* ctx);
+static inline bool Capsuling_capsule_msg_send_l2mc_l3uc( CapsulingContext* ctx,
+                char* recv_buffer, ssize_t recv_len);
 // L2MC-L3UC機能 end
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -140,6 +206,72 @@ static bool Capsuling_Init(IProcessor* self, struct me6e_handler_t *handler)
     // ハンドラーの設定
     CAPSULING_FIELD(self)->handler = handler;
 
+    // 転送コンテキストの設定
+    CapsulingContext*        ctx  = &(CAPSULING_FIELD(self)->ctx);
+    me6e_config_capsuling_t* conf = handler->conf->capsuling;
+
+    ctx->bb_fd        = conf->bb_fd;
+    ctx->tunnel_fd    = conf->tunnel_device.option.tunnel.fd;
+    ctx->tunnel_vnet_hdr = conf->tunnel_device.option.tunnel.vnet_hdr;
+    ctx->gro_handler     = handler->gro_handler;
+    ctx->stub_ring       = handler->stub_ring;
+    ctx->uring           = handler->stub_uring;
+    ctx->neigh           = handler->bb_neigh;
+    ctx->udp             = handler->bb_udp;
+    ctx->bb_txq          = handler->bb_txq;
+    ctx->stub_txq        = handler->stub_txq;
+    ctx->bb_ifindex   = if_nametoindex(conf->backbone_physical_dev);
+    ctx->uni_prefix   = handler->unicast_prefix;
+    ctx->src_prefix   = handler->unicast_prefix;
+    ctx->multi_prefix = handler->multicast_prefix;
+    ctx->own_v6addr   = handler->me6e_own_v6addr;
+    ctx->host_list    = &(conf->me6e_host_address_list);
+    ctx->pr_handler   = handler->pr_handler;
+    ctx->stat_info    = handler->stat_info;
+    ctx->mcast_handler = handler->mcast_handler;
+    ctx->flow_label   = conf->flow_label;
+    ctx->pmtu_handler = handler->pmtu_handler;
+    ctx->mss_clamp    = conf->tcp_mss_clamp;
+    ctx->bb_mtu       = &handler->backbone_mtu;
+    ctx->peer_handler = NULL;
+    if ((handler->peer_handler != NULL) && (handler->peer_handler->timer_fd >= 0)) {
+        ctx->peer_handler = handler->peer_handler;
+    }
+
+    if (ctx->bb_ifindex == 0) {
+        me6e_logging(LOG_ERR, "fail to get backbone device index : %s.\n", strerror(errno));
+        return false;
+    }
+
+    // 内側フラグメント生成用バッファの確保
+    if (ctx->pmtu_handler != NULL) {
+        ctx->frag_buffer = malloc(CAPSULING_FRAG_BUF_SIZE);
+        if (ctx->frag_buffer == NULL) {
+            me6e_logging(LOG_ERR, "fail to malloc for fragment buffer.\n");
+            return false;
+        }
+    }
+
+    // モード別のStubNWパケット転送関数の選択
+    if (handler->conf->common->tunnel_mode == ME6E_TUNNEL_MODE_PR) {
+        // ME6E-PR ユニキャストアドレスプレフィックスを送信元に設定
+        if (conf->pr_unicast_prefixplaneid == NULL) {
+            me6e_logging(LOG_ERR, "ME6E-PR unicast prefix is not set.\n");
+            return false;
+        }
+        ctx->src_prefix = *(conf->pr_unicast_prefixplaneid);
+        CAPSULING_FIELD(self)->forward_from_stub = Capsuling_forward_pr;
+    } else if (conf->l2multi_l3uni) {
+        // 送信先ME6Eホスト毎の送信メッセージを事前に生成
+        if (!Capsuling_l2mc_l3uc_init(ctx)) {
+            me6e_logging(LOG_ERR, "fail to initialize l2mc_l3uni send message.\n");
+            return false;
+        }
+        CAPSULING_FIELD(self)->forward_from_stub = Capsuling_forward_fp_l2mc_l3uc;
+    } else {
+        CAPSULING_FIELD(self)->forward_from_stub = Capsuling_forward_fp;
+    }
+
     DEBUG_LOG("Capsuling_Init end.");
     return  true;
 }
@@ -163,6 +295,12 @@ static void Capsuling_Release(IProcessor* self)
         return;
     }
 
+    // L2MC-L3UC用送信メッセージの解放
+    Capsuling_l2mc_l3uc_release(&(CAPSULING_FIELD(self)->ctx));
+
+    // 内側フラグメント生成用バッファの解放
+    free(CAPSULING_FIELD(self)->ctx.frag_buffer);
+
     // フィールドの解放
     free(CAPSULING_FIELD(self));
 
@@ -178,6 +316,7 @@ static void Capsuling_Release(IProcessor* self)
 //! @brief StubNWパケット受信処理関数
 //!
 //! StubNWから受信したパケットをカプセル化する。
+//! 実際の処理は初期化時に選択したモード別の転送関数で行う。
 //!
 //! @param [in] self        IProcessor構造体
 //! @param [in] recv_buffer 受信データ
@@ -196,119 +335,165 @@ static bool Capsuling_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t
         return false;
     }
 
-    struct ethhdr*      p_orig_eth_hdr = NULL;
-    struct in6_addr*    uni_prefix = NULL;
-    struct in6_addr     src = in6addr_any;
-    struct in6_addr     dst = in6addr_any;
-    me6e_pr_entry_t*    pr_entry;
+    // TCP SYNのMSSをトンネルの実効MTUに合わせる
+    if (CAPSULING_FIELD(self)->ctx.mss_clamp) {
+        Capsuling_mss_clamp(&(CAPSULING_FIELD(self)->ctx), recv_buffer, recv_len);
+    }
 
-    uni_prefix = &(CAPSULING_FIELD(self)->handler->unicast_prefix);
+    return CAPSULING_FIELD(self)->forward_from_stub(
+                    &(CAPSULING_FIELD(self)->ctx), recv_buffer, recv_len);
+}
 
-    // 受信パケットの先頭を ETHERヘッダへキャスト
-    p_orig_eth_hdr = (struct ethhdr*)recv_buffer;
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNWパケット転送関数(ME6E-FP用)
+//!
+//! StubNWから受信したパケットをカプセル化し、BackboneNWへ送信する。
+//! ブロードキャスト/マルチキャストはME6Eマルチキャストアドレスへ送信する。
+//!
+//! @param [in] ctx         転送コンテキスト
+//! @param [in] recv_buffer 受信データ
+//! @param [in] recv_len    受信データのサイズ
+//!
+//! @retval true  正常終了
+//! @retval false 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static bool Capsuling_forward_fp(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len)
+{
+    struct ethhdr*      p_orig_eth_hdr = (struct ethhdr*)recv_buffer;
+    struct in6_addr     src;
+    struct in6_addr     dst;
+
+    if (me6e_util_is_multicast_mac(&p_orig_eth_hdr->h_dest[0])) {
+        // ブロードキャスト/マルチキャストパケット
+        DEBUG_LOG("recv broadcast/multicast packet.\n");
+
+        if (ctx->mcast_handler != NULL) {
+            // IGMP/MLDのReportを監視し、宛先MAC毎のグループへ送信
+            me6e_mcast_snoop(ctx->mcast_handler, recv_buffer, recv_len);
+            me6e_mcast_group_addr(ctx->mcast_handler, p_orig_eth_hdr->h_dest, &dst);
+        } else {
+            // 送信先ME6Eマルチキャストアドレスの設定
+            dst = ctx->multi_prefix;
+        }
+    } else {
+        // ユニキャストパケット
+        DEBUG_LOG("recv unicast packet.\n");
 
-    if(me6e_util_is_broadcast_mac(&p_orig_eth_hdr->h_dest[0])){
-        // ブロードキャストパケット
-        DEBUG_LOG("recv broadcast packet.\n");
+        // 送信先ME6Eユニキャストキャストアドレスの生成
+        me6e_create_me6eaddr(&ctx->uni_prefix,
+                    (struct ether_addr*)p_orig_eth_hdr->h_dest, &dst);
+    }
 
-        // トンネルモードがME6E_TUNNEL_MODE_PRならば、パケットを破棄
-        if(CAPSULING_FIELD(self)->handler->conf->common->tunnel_mode == ME6E_TUNNEL_MODE_PR){
-            return false;
-        }
+    // 送信元ME6Eアドレスの生成
+    me6e_create_me6eaddr(&ctx->src_prefix,
+                (struct ether_addr*)p_orig_eth_hdr->h_source, &src);
 
-        // L2MC-L3UC機能 start
-        if (CAPSULING_FIELD(self)->handler->conf->capsuling->l2multi_l3uni) {
-            if (!Capsuling_capsule_msg_send_l2mc_l3uc(self,
-                        &(CAPSULING_FIELD(self)->handler->me6e_own_v6addr),
-                        recv_buffer, recv_len)) {
-                me6e_logging(LOG_ERR, "fail to send capsuling packet.\n");
-                return false;
-            }
-            return true;
-        }
-        // L2MC-L3UC機能 end
+    // 受信メッセージをカプセル化し、Backboneへ送信
+    if (!Capsuling_capsule_msg_send(ctx, &src, &dst, recv_buffer, recv_len)) {
+        me6e_logging(LOG_ERR, "fail to send capsuling packet.\n");
+        return false;
+    }
 
-        // 送信先ME6Eマルチキャストアドレスの設定
-        dst = CAPSULING_FIELD(self)->handler->multicast_prefix;
+    return  true;
+}
+
+// L2MC-L3UC機能 start
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNWパケット転送関数(ME6E-FP L2MC-L3UC用)
+//!
+//! StubNWから受信したパケットをカプセル化し、BackboneNWへ送信する。
+//! ブロードキャスト/マルチキャストは登録されているME6Eホスト分、
+//! ユニキャストで送信する。
+//!
+//! @param [in] ctx         転送コンテキスト
+//! @param [in] recv_buffer 受信データ
+//! @param [in] recv_len    受信データのサイズ
+//!
+//! @retval true  正常終了
+//! @retval false 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static bool Capsuling_forward_fp_l2mc_l3uc(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len)
+{
+    struct ethhdr*      p_orig_eth_hdr = (struct ethhdr*)recv_buffer;
+    struct in6_addr     src;
+    struct in6_addr     dst;
 
-    } else if(me6e_util_is_multicast_mac(&p_orig_eth_hdr->h_dest[0])){
-        // マルチキャストパケット
-        DEBUG_LOG("recv multicast packet.\n");
+    if (me6e_util_is_multicast_mac(&p_orig_eth_hdr->h_dest[0])) {
+        // ブロードキャスト/マルチキャストパケット
+        DEBUG_LOG("recv broadcast/multicast packet.\n");
 
-        // トンネルモードがME6E_TUNNEL_MODE_PRならば、パケットを破棄
-        if(CAPSULING_FIELD(self)->handler->conf->common->tunnel_mode == ME6E_TUNNEL_MODE_PR){
+        if (!Capsuling_capsule_msg_send_l2mc_l3uc(ctx,
+                    recv_buffer, recv_len)) {
+            me6e_logging(LOG_ERR, "fail to send capsuling packet.\n");
             return false;
         }
+        return true;
+    }
 
-        // L2MC-L3UC機能 start
-        if (CAPSULING_FIELD(self)->handler->conf->capsuling->l2multi_l3uni) {
-            if (!Capsuling_capsule_msg_send_l2mc_l3uc(self,
-                        &(CAPSULING_FIELD(self)->handler->me6e_own_v6addr),
-                        recv_buffer, recv_len)) {
-                me6e_logging(LOG_ERR, "fail to send capsuling packet.\n");
-                return false;
-            }
-            return true;
-        }
-        // L2MC-L3UC機能 end
-
-        // 送信先ME6Eマルチキャストアドレスの設定
-        dst = CAPSULING_FIELD(self)->handler->multicast_prefix;
+    // ユニキャストパケット
+    DEBUG_LOG("recv unicast packet.\n");
 
-    } else{
-        // ユニキャストパケット
-        DEBUG_LOG("recv unicast packet.\n");
+    // 送信先/送信元ME6Eアドレスの生成
+    me6e_create_me6eaddr(&ctx->uni_prefix,
+                (struct ether_addr*)p_orig_eth_hdr->h_dest, &dst);
+    me6e_create_me6eaddr(&ctx->src_prefix,
+                (struct ether_addr*)p_orig_eth_hdr->h_source, &src);
 
-        // 送信先ME6Eユニキャストキャストアドレスの生成
-        // トンネルモードがME6E_TUNNEL_MODE_PRならば、
-        
-        if(CAPSULING_FIELD(self)->handler->conf->common->tunnel_mode == ME6E_TUNNEL_MODE_PR){
-            // PR Tableより送信先MACアドレスと同一のエントリーを検索する
-            pr_entry = me6e_pr_entry_search_stub(
-                            CAPSULING_FIELD(self)->handler->pr_handler,
-                            (struct ether_addr*)p_orig_eth_hdr->h_dest
-                            );
-            if(pr_entry == NULL){
-                me6e_logging(LOG_ERR,"drop packet so that dest MAC address is NOT in M46E-PR Table.\n");
-                return false;
-            }else{
-                // PRエントリのprefixをuni_prefixに設定
-                uni_prefix = &pr_entry->pr_prefix_planeid;
-                char   addr[INET6_ADDRSTRLEN] = { 0 };
-                DEBUG_LOG("dst prefix: %s\n", inet_ntop(AF_INET6,uni_prefix, addr, INET6_ADDRSTRLEN));
-            }            
-        }
-        
-        if (NULL == me6e_create_me6eaddr(uni_prefix,
-                    (struct ether_addr*)p_orig_eth_hdr->h_dest,
-                    &dst)) {
-            me6e_logging(LOG_ERR, "fail to create dst me6e address.\n");
-            return false;
-        }
+    // 受信メッセージをカプセル化し、Backboneへ送信
+    if (!Capsuling_capsule_msg_send(ctx, &src, &dst, recv_buffer, recv_len)) {
+        me6e_logging(LOG_ERR, "fail to send capsuling packet.\n");
+        return false;
     }
 
-    char   addr[INET6_ADDRSTRLEN] = { 0 };
-    DEBUG_LOG("dst addr : %s\n",inet_ntop(AF_INET6, &dst, addr, INET6_ADDRSTRLEN));
+    return  true;
+}
+// L2MC-L3UC機能 end
 
-    // 送信元ME6Eアドレスの生成
-    // トンネルモードがME6E_TUNNEL_MODE_PRならば、
-    if(CAPSULING_FIELD(self)->handler->conf->common->tunnel_mode == ME6E_TUNNEL_MODE_PR){
-        // ME6E-PR ユニキャストアドレスプレフィックスをprefixをuni_prefixに設定
-        uni_prefix = CAPSULING_FIELD(self)->handler->conf->capsuling->pr_unicast_prefixplaneid;
-        DEBUG_LOG("src prefix: %s\n",inet_ntop(AF_INET6, uni_prefix, addr, INET6_ADDRSTRLEN));
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNWパケット転送関数(ME6E-PR用)
+//!
+//! StubNWから受信したユニキャストパケットをPR Tableに従って
+//! カプセル化し、BackboneNWへ送信する。
+//! ブロードキャスト/マルチキャストは破棄する。
+//!
+//! @param [in] ctx         転送コンテキスト
+//! @param [in] recv_buffer 受信データ
+//! @param [in] recv_len    受信データのサイズ
+//!
+//! @retval true  正常終了
+//! @retval false 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static bool Capsuling_forward_pr(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len)
+{
+    struct ethhdr*      p_orig_eth_hdr = (struct ethhdr*)recv_buffer;
+    struct in6_addr     src;
+    struct in6_addr     dst;
+    me6e_pr_entry_t*    pr_entry;
+
+    // ブロードキャスト/マルチキャストパケットは破棄
+    if (me6e_util_is_multicast_mac(&p_orig_eth_hdr->h_dest[0])) {
+        DEBUG_LOG("drop broadcast/multicast packet.\n");
+        return false;
     }
 
-    if (NULL == me6e_create_me6eaddr(uni_prefix,
-                (struct ether_addr*)p_orig_eth_hdr->h_source,
-                &src)) {
-        me6e_logging(LOG_ERR, "fail to create src me6e address.\n");
+    // PR Tableより送信先MACアドレスと同一のエントリーを検索する
+    pr_entry = me6e_pr_entry_search_stub(ctx->pr_handler,
+                    (struct ether_addr*)p_orig_eth_hdr->h_dest);
+    if (pr_entry == NULL) {
+        me6e_logging(LOG_ERR,"drop packet so that dest MAC address is NOT in M46E-PR Table.\n");
         return false;
     }
 
-    DEBUG_LOG("src addr : %s\n",inet_ntop(AF_INET6, &src, addr, INET6_ADDRSTRLEN));
+    // PRエントリのprefixから送信先ME6Eアドレスを生成
+    me6e_create_me6eaddr(&pr_entry->pr_prefix_planeid,
+                (struct ether_addr*)p_orig_eth_hdr->h_dest, &dst);
+
+    // ME6E-PR ユニキャストアドレスプレフィックスから送信元ME6Eアドレスを生成
+    me6e_create_me6eaddr(&ctx->src_prefix,
+                (struct ether_addr*)p_orig_eth_hdr->h_source, &src);
 
     // 受信メッセージをカプセル化し、Backboneへ送信
-    if (!Capsuling_capsule_msg_send(self, &src, &dst, recv_buffer, recv_len)) {
+    if (!Capsuling_capsule_msg_send(ctx, &src, &dst, recv_buffer, recv_len)) {
         me6e_logging(LOG_ERR, "fail to send capsuling packet.\n");
         return false;
     }
@@ -316,12 +501,284 @@ static bool Capsuling_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t
     return  true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Path MTU超過処理関数
+//!
+//! カプセル化後に送信先のPath MTUを超えるフレームを処理する。
+//! IPv4(DFあり)/IPv6の場合は送信元ホストへICMPを返送してフレームを破棄し、
+//! IPv4(DFなし)の場合は内側でフラグメントして送信する。
+//! いずれも行えないフレーム(VLANタグ付き、IP以外等)は処理せず、
+//! 呼び出し元でそのまま送信する(カーネルで外側をフラグメントする)。
+//!
+//! @param [in] ctx         転送コンテキスト
+//! @param [in] src         送信元IPv6アドレス
+//! @param [in] dst         送信先IPv6アドレス
+//! @param [in] recv_buffer 受信データ
+//! @param [in] recv_len    受信データのサイズ
+//! @param [in] mtu         送信先のPath MTU
+//!
+//! @retval 1   処理済み
+//! @retval 0   未処理(そのまま送信する)
+//! @retval -1  フラグメントの送信失敗(送信失敗は送信時に計上済み)
+///////////////////////////////////////////////////////////////////////////////
+static int Capsuling_pmtu_exceeded(
+        CapsulingContext* ctx,
+        struct in6_addr* src,
+        struct in6_addr* dst,
+        char* recv_buffer,
+        ssize_t recv_len,
+        int mtu)
+{
+    if (me6e_pmtu_send_too_big(ctx->pmtu_handler, recv_buffer, recv_len, mtu)) {
+        me6e_inc_capsuling_too_big_count(ctx->stat_info);
+        DEBUG_LOG("drop %d bytes frame exceeding path mtu %d.\n", recv_len, mtu);
+        return 1;
+    }
+
+    switch (Capsuling_fragment_ipv4(ctx, src, dst, recv_buffer, recv_len, mtu)) {
+    case 1:
+        me6e_inc_capsuling_fragment_count(ctx->stat_info);
+        return 1;
+    case -1:
+        return -1;
+    default:
+        return 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief IPv4内側フラグメント送信関数
+//!
+//! DFビットが設定されていないIPv4パケットを、
+//! カプセル化後に送信先のPath MTUに収まるサイズでフラグメントし、
+//! それぞれカプセル化してBackboneNWへ送信する。
+//! IPオプション付きのパケットは対象外とする。
+//!
+//! @param [in] ctx         転送コンテキスト
+//! @param [in] src         送信元IPv6アドレス
+//! @param [in] dst         送信先IPv6アドレス
+//! @param [in] recv_buffer 受信データ
+//! @param [in] recv_len    受信データのサイズ
+//! @param [in] mtu         送信先のPath MTU
+//!
+//! @retval 1   フラグメントして送信した
+//! @retval 0   対象外
+//! @retval -1  フラグメントの送信失敗(以降のフラグメントは送信しない)
+///////////////////////////////////////////////////////////////////////////////
+static int Capsuling_fragment_ipv4(
+        CapsulingContext* ctx,
+        struct in6_addr* src,
+        struct in6_addr* dst,
+        char* recv_buffer,
+        ssize_t recv_len,
+        int mtu)
+{
+    struct ethhdr*  eth = (struct ethhdr*)recv_buffer;
+    struct ip*      ip  = (struct ip*)(recv_buffer + ETH_HLEN);
+    struct ip*      frag_ip = (struct ip*)(ctx->frag_buffer + ETH_HLEN);
+    uint16_t        orig_off;
+    int             data_len;
+    int             frag_max;
+    int             offset;
+    int             size;
+
+    if ((ntohs(eth->h_proto) != ETH_P_IP) || (recv_len < (ssize_t)(ETH_HLEN + sizeof(struct ip)))) {
+        return false;
+    }
+
+    orig_off = ntohs(ip->ip_off);
+    data_len = ntohs(ip->ip_len) - sizeof(struct ip);
+    if ((orig_off & IP_DF) || (ip->ip_hl != (sizeof(struct ip) >> 2)) ||
+        (data_len <= 0) || ((ssize_t)(ETH_HLEN + sizeof(struct ip) + data_len) > recv_len)) {
+        return 0;
+    }
+
+    // フラグメント毎のデータ長(8の倍数)
+    frag_max = ((int)(mtu - me6e_pmtu_overhead(ctx->udp != NULL) - ETH_HLEN - sizeof(struct ip))) & ~7;
+    if (frag_max <= 0) {
+        return 0;
+    }
+
+    memcpy(ctx->frag_buffer, recv_buffer, ETH_HLEN + sizeof(struct ip));
+
+    for (offset = 0; offset < data_len; offset += size) {
+        size = data_len - offset;
+        if (size > frag_max) {
+            size = frag_max;
+        }
+
+        // 元パケットがフラグメントの場合は、そのオフセットとMFを引き継ぐ
+        frag_ip->ip_off = htons(((orig_off & IP_OFFMASK) + (offset >> 3)) |
+                    (((offset + size) < data_len) ? IP_MF : (orig_off & IP_MF)));
+        frag_ip->ip_len = htons(sizeof(struct ip) + size);
+        frag_ip->ip_sum = 0;
+        frag_ip->ip_sum = me6e_util_checksum((unsigned short*)frag_ip, sizeof(struct ip));
+        memcpy(ctx->frag_buffer + ETH_HLEN + sizeof(struct ip),
+                recv_buffer + ETH_HLEN + sizeof(struct ip) + offset, size);
+
+        if (!Capsuling_capsule_msg_send(ctx, src, dst, ctx->frag_buffer,
+                    ETH_HLEN + sizeof(struct ip) + size)) {
+            return -1;
+        }
+    }
+
+    DEBUG_LOG("fragment %d bytes packet to path mtu %d.\n", data_len, mtu);
+
+    return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief TCP MSSクランプ関数
+//!
+//! 内側フレームがTCPのSYN(SYN/ACK含む)の場合、MSSオプションの値が
+//! トンネルの実効MTUに収まる値を超えていれば書き換え、
+//! TCPチェックサムを差分更新する(RFC1624)。
+//! トンネルの実効MTUは、Path MTU学習時は全送信先で最小のPath MTU、
+//! それ以外はBackbone側物理デバイスのMTUからカプセル化のオーバーヘッドを
+//! 差し引いた値とする。
+//!
+//! @param [in]     ctx         転送コンテキスト
+//! @param [in,out] recv_buffer 内側フレーム
+//! @param [in]     recv_len    内側フレームのサイズ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void Capsuling_mss_clamp(CapsulingContext* ctx, char* recv_buffer, ssize_t recv_len)
+{
+    uint8_t*        l3 = (uint8_t*)recv_buffer + ETH_HLEN;
+    ssize_t         l3_len = recv_len - ETH_HLEN;
+    uint16_t        type;
+    struct tcphdr*  tcp;
+    uint8_t*        opt;
+    int             tcp_len;
+    int             mtu;
+    int             mss;
+    int             i;
+
+    if (recv_len < ETH_HLEN) {
+        return;
+    }
+
+    // VLANタグの読み飛ばし
+    type = ntohs(((struct ethhdr*)recv_buffer)->h_proto);
+    while (((type == ETH_P_8021Q) || (type == ETH_P_8021AD)) && (l3_len >= 4)) {
+        type    = (l3[2] << 8) | l3[3];
+        l3     += 4;
+        l3_len -= 4;
+    }
+
+    mtu = (ctx->pmtu_handler != NULL) ? ctx->pmtu_handler->min_mtu : *ctx->bb_mtu;
+    mtu -= me6e_pmtu_overhead(ctx->udp != NULL) + ETH_HLEN;
+
+    if ((type == ETH_P_IP) && (l3_len >= (ssize_t)sizeof(struct ip))) {
+        struct ip* ip = (struct ip*)l3;
+        // 先頭フラグメント以外は対象外
+        if ((ip->ip_p != IPPROTO_TCP) || (ntohs(ip->ip_off) & IP_OFFMASK)) {
+            return;
+        }
+        tcp = (struct tcphdr*)(l3 + ip->ip_hl * 4);
+        l3_len -= ip->ip_hl * 4;
+        mss = mtu - sizeof(struct ip) - sizeof(struct tcphdr);
+    }
+    else if ((type == ETH_P_IPV6) && (l3_len >= (ssize_t)sizeof(struct ip6_hdr))) {
+        struct ip6_hdr* ip6 = (struct ip6_hdr*)l3;
+        // 拡張ヘッダ付きは対象外
+        if (ip6->ip6_nxt != IPPROTO_TCP) {
+            return;
+        }
+        tcp = (struct tcphdr*)(l3 + sizeof(struct ip6_hdr));
+        l3_len -= sizeof(struct ip6_hdr);
+        mss = mtu - sizeof(struct ip6_hdr) - sizeof(struct tcphdr);
+    }
+    else {
+        return;
+    }
+
+    if ((l3_len < (ssize_t)sizeof(struct tcphdr)) || !tcp->syn) {
+        return;
+    }
+    tcp_len = tcp->doff * 4;
+    if ((tcp_len > l3_len) || (mss <= 0)) {
+        return;
+    }
+
+    // MSSオプションの検索
+    opt = (uint8_t*)tcp;
+    for (i = sizeof(struct tcphdr); i < tcp_len; ) {
+        if (opt[i] == TCPOPT_EOL) {
+            break;
+        }
+        if (opt[i] == TCPOPT_NOP) {
+            i++;
+            continue;
+        }
+        if ((i + 1 >= tcp_len) || (opt[i + 1] < 2) || (i + opt[i + 1] > tcp_len)) {
+            break;
+        }
+        if ((opt[i] == TCPOPT_MAXSEG) && (opt[i + 1] == TCPOLEN_MAXSEG)) {
+            uint16_t old_mss;
+            uint16_t new_mss = htons(mss);
+            uint32_t sum;
+
+            memcpy(&old_mss, &opt[i + 2], sizeof(old_mss));
+            if (ntohs(old_mss) <= mss) {
+                return;
+            }
+
+            // チェックサムの差分更新 HC' = ~(~HC + ~m + m')
+            sum  = (uint16_t)~tcp->check;
+            sum += (uint16_t)~old_mss;
+            sum += new_mss;
+            sum  = (sum & 0xffff) + (sum >> 16);
+            sum  = (sum & 0xffff) + (sum >> 16);
+            tcp->check = ~sum;
+
+            memcpy(&opt[i + 2], &new_mss, sizeof(new_mss));
+            DEBUG_LOG("clamp tcp mss %d to %d.\n", ntohs(old_mss), mss);
+            return;
+        }
+        i += opt[i + 1];
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フローラベル計算関数
+//!
+//! 内側フレームのフローハッシュからカプセル化パケットに設定する
+//! IPv6フローラベル(sin6_flowinfo形式)を計算する。
+//! 同じフローのパケットは常に同じフローラベルとなる。
+//! フローラベル設定無効時は0を返す。
+//!
+//! @param [in] ctx         転送コンテキスト
+//! @param [in] hash        内側フレームのフローハッシュ(me6e_util_flow_hash)
+//!
+//! @return フローラベル(ネットワークバイトオーダ)
+///////////////////////////////////////////////////////////////////////////////
+static inline uint32_t Capsuling_flow_label(
+        CapsulingContext* ctx,
+        uint32_t hash)
+{
+    if (!ctx->flow_label) {
+        return 0;
+    }
+
+    // 20bitに畳み込み、0(フローラベル未設定)は避ける
+    hash = (hash ^ (hash >> 20)) & 0x000FFFFF;
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    return htonl(hash);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //! @brief カプセリング処理関数
 //!
 //! StubNWから受信したパケットをカプセル化し、BackboneNWへ送信する。
 //!
-//! @param [in] self        IProcessor構造体へのポインター
+//! @param [in] ctx         転送コンテキスト
 //! @param [in] src         送信元IPv6アドレス
 //! @param [in] dst         送信先IPv6アドレス
 //! @param [in] recv_buffer 受信データ
@@ -331,7 +788,7 @@ static bool Capsuling_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t
 //! @retval false 異常終了
 ///////////////////////////////////////////////////////////////////////////////
 static inline bool Capsuling_capsule_msg_send(
-        IProcessor* self,
+        CapsulingContext* ctx,
         struct in6_addr* src,
         struct in6_addr* dst,
         char* recv_buffer,
@@ -339,7 +796,7 @@ static inline bool Capsuling_capsule_msg_send(
 {
 
     // 引数チェック
-    if ((self == NULL) || (recv_buffer == NULL) || (src == NULL) || (dst == NULL) ) {
+    if ((ctx == NULL) || (recv_buffer == NULL) || (src == NULL) || (dst == NULL) ) {
         me6e_logging(LOG_ERR, "Parameter Check NG(Capsuling_capsule_msg_send).\n");
         return false;
     }
@@ -353,8 +810,25 @@ static inline bool Capsuling_capsule_msg_send(
     struct etheriphdr   ether_ip_hdr;
     int                 fd = -1;
     int                 ret = -1;
+    int                 mtu;
+    uint32_t            hash = 0;
+
+    // カプセル化後に送信先のPath MTUを超える場合
+    if ((ctx->pmtu_handler != NULL) && !me6e_pmtu_fit(ctx->pmtu_handler, recv_len)) {
+        mtu = me6e_pmtu_get(ctx->pmtu_handler, dst);
+        if ((recv_len + me6e_pmtu_overhead(ctx->udp != NULL)) > mtu) {
+            switch (Capsuling_pmtu_exceeded(ctx, src, dst, recv_buffer, recv_len, mtu)) {
+            case 1:
+                return true;
+            case -1:
+                return false;
+            default:
+                break;
+            }
+        }
+    }
 
-    fd = CAPSULING_FIELD(self)->handler->conf->capsuling->bb_fd;
+    fd = ctx->bb_fd;
 
     // EtherIPヘッダの設定
     ether_ip_hdr.version = ETHERIP_VERSION;
@@ -365,7 +839,11 @@ static inline bool Capsuling_capsule_msg_send(
     daddr.sin6_family = AF_INET6;
     daddr.sin6_port = htons(ME6E_IPPROTO_ETHERIP);
     daddr.sin6_addr = *dst;
-    daddr.sin6_flowinfo = 0;
+    // フローハッシュはフローラベルとUDP送信元ポートで共用する
+    if (ctx->flow_label || (ctx->udp != NULL)) {
+        hash = me6e_util_flow_hash(recv_buffer, recv_len);
+    }
+    daddr.sin6_flowinfo = Capsuling_flow_label(ctx, hash);
     daddr.sin6_scope_id = 0;
 
     // Scatter/Gather設定
@@ -395,22 +873,57 @@ static inline bool Capsuling_capsule_msg_send(
 
     if (IN6_IS_ADDR_MULTICAST(dst)) {
         // マルチキャスト送信
-        info->ipi6_ifindex = if_nametoindex(
-            CAPSULING_FIELD(self)->handler->conf->capsuling->backbone_physical_dev);
+        info->ipi6_ifindex = ctx->bb_ifindex;
     } else {
         // ユニキャスト送信
         info->ipi6_ifindex = 0;
     }
 
+    // EtherIP over UDPの場合はユニキャストのみUDPで送信
+    // (送信待ちのセグメントはStub側の受信待ちの前にまとめて送信する。
+    //  送信先がUDP非対応の場合はEtherIPで送信する)
+    if ((ctx->udp != NULL) && !IN6_IS_ADDR_MULTICAST(dst) &&
+        (me6e_udp_send(ctx->udp, src, dst, daddr.sin6_flowinfo, hash, iov, 2) == 0)) {
+        DEBUG_LOG("forward %d bytes to encap(udp).\n", recv_len + sizeof(ether_ip_hdr));
+        return true;
+    }
+
+    // 送信先のMACアドレスを解決できた場合はL2で直接送信
+    if ((ctx->neigh != NULL) &&
+        (me6e_neigh_send(ctx->neigh, src, dst, daddr.sin6_flowinfo, iov, 2) == 0)) {
+        me6e_inc_capsuling_success_count(ctx->stat_info);
+        DEBUG_LOG("forward %d bytes to encap(l2).\n", recv_len + sizeof(ether_ip_hdr));
+        return true;
+    }
+
     // カプセル化したデータを送信
-    ret = sendmsg(fd, &msg, 0);
+    // (io_uring使用時は送信要求のみ行い、受信待ちの際にまとめて投入する。
+    //  送信結果の統計は送信完了時に計上する)
+    if ((ctx->uring != NULL) && (me6e_uring_sendmsg(ctx->uring, ME6E_URING_FILE_BB, &msg) >= 0)) {
+        DEBUG_LOG("queue %d bytes to encap.\n", recv_len + sizeof(ether_ip_hdr));
+        return true;
+    }
+
+    // 送信キュー使用時は、一時的に送信できない場合にキューに積んで再送する
+    // (満杯で破棄した数は送信キューの統計に計上する)
+    if (ctx->bb_txq != NULL) {
+        ret = me6e_txq_send(ctx->bb_txq, &msg, me6e_txq_classify(recv_buffer, recv_len));
+    }
+    else {
+        ret = sendmsg(fd, &msg, 0);
+    }
     if (ret < 0) {
-        me6e_inc_capsuling_failure_count(CAPSULING_FIELD(self)->handler->stat_info);
-        me6e_logging(LOG_ERR, "fail to sendmsg capsuling packet. %s\n", strerror(errno));
+        me6e_inc_capsuling_failure_count(ctx->stat_info);
+        if ((ctx->bb_txq != NULL) && (errno == ENOBUFS)) {
+            DEBUG_LOG("drop capsuling packet by tx queue.\n");
+        }
+        else {
+            me6e_logging(LOG_ERR, "fail to sendmsg capsuling packet. %s\n", strerror(errno));
+        }
         return false;
     }
 
-    me6e_inc_capsuling_success_count(CAPSULING_FIELD(self)->handler->stat_info);
+    me6e_inc_capsuling_success_count(ctx->stat_info);
     DEBUG_LOG("forward %d bytes to encap.\n", recv_len + sizeof(ether_ip_hdr));
 
     return true;
@@ -418,106 +931,268 @@ static inline bool Capsuling_capsule_msg_send(
 
 // L2MC-L3UC機能 start
 ///////////////////////////////////////////////////////////////////////////////
-//! @brief カプセリング処理関数(L2multicast-L3unicast用)
+//! @brief L2MC-L3UC送信メッセージ生成関数
 //!
-//! StubNWから受信したパケットをカプセル化し、
-//! 設定情報に登録されているME6Eホスト分、BackboneNWへ送信する。
+//! 設定情報に登録されているME6Eホスト分の送信先アドレスと
+//! 送信メッセージを事前に生成する。
+//! EtherIPヘッダ、送信元情報、Scatter/Gather配列は全ホストで共有する。
 //!
-//! @param [in] self        IProcessor構造体へのポインター
-//! @param [in] src         送信元IPv6アドレス
-//! @param [in] recv_buffer 受信データ
-//! @param [in] recv_len    受信データのサイズ
+//! @param [in,out] ctx 転送コンテキスト
 //!
 //! @retval true  正常終了
 //! @retval false 異常終了
 ///////////////////////////////////////////////////////////////////////////////
-static inline bool Capsuling_capsule_msg_send_l2mc_l3uc(
-        IProcessor* self,
-        struct in6_addr* src,
-        char* recv_buffer,
-        ssize_t recv_len)
+static bool Capsuling_l2mc_l3uc_init(CapsulingContext* ctx)
 {
-
     // 引数チェック
-    if ((self == NULL) || (recv_buffer == NULL) || (src == NULL) ) {
-        me6e_logging(LOG_ERR, "Parameter Check NG(Capsuling_capsule_msg_send_l2mc_l3uc).\n");
+    if ((ctx == NULL) || (ctx->host_list == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(Capsuling_l2mc_l3uc_init).\n");
         return false;
     }
 
-    // EtherIPヘッダの設定
-    struct sockaddr_in6 daddr;
     struct in6_pktinfo* info;
-    struct msghdr       msg = {0};
     struct cmsghdr*     cmsg;
-    char                cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))] = {0};
-    struct  iovec       iov[2];
-    struct etheriphdr   ether_ip_hdr;
-    int                 fd = -1;
-    int                 ret = -1;
+    struct msghdr       msg = {0};
+    me6e_list*          iter;
+    int                 num = 0;
+    int                 i;
+
+    // ME6Eホスト数の算出
+    me6e_list_for_each(iter, ctx->host_list) {
+        if (iter->data != NULL) {
+            num++;
+        }
+    }
 
-    fd = CAPSULING_FIELD(self)->handler->conf->capsuling->bb_fd;
+    ctx->host_num  = 0;
+    ctx->host_addr = NULL;
+    ctx->host_msg  = NULL;
+    if (num == 0) {
+        return true;
+    }
 
-    // EtherIPヘッダの設定
-    ether_ip_hdr.version = ETHERIP_VERSION;
-    ether_ip_hdr.reserved = 0;
-    ether_ip_hdr.reserved2 = 0;
+    ctx->host_addr = calloc(num, sizeof(struct sockaddr_in6));
+    ctx->host_msg  = calloc(num, sizeof(struct mmsghdr));
+    ctx->send_msg  = calloc(num, sizeof(struct mmsghdr));
+    if ((ctx->host_addr == NULL) || (ctx->host_msg == NULL) || (ctx->send_msg == NULL)) {
+        me6e_logging(LOG_ERR, "fail to allocate l2mc_l3uni send message.\n");
+        Capsuling_l2mc_l3uc_release(ctx);
+        return false;
+    }
 
-    // IPv6ヘッダの設定
-    daddr.sin6_family = AF_INET6;
-    daddr.sin6_port = htons(ME6E_IPPROTO_ETHERIP);
-    daddr.sin6_flowinfo = 0;
-    daddr.sin6_scope_id = 0;
+    // EtherIPヘッダの設定
+    ctx->l2mc_ether_ip_hdr.version = ETHERIP_VERSION;
+    ctx->l2mc_ether_ip_hdr.reserved = 0;
+    ctx->l2mc_ether_ip_hdr.reserved2 = 0;
 
     // Scatter/Gather設定
     // 配列0に、EtherIPヘッダを格納
-    iov[0].iov_base = &ether_ip_hdr;
-    iov[0].iov_len  = sizeof(ether_ip_hdr);
-
-    // 配列1に、EtherIPヘッダ以降のデータを格納(デカプセル化データ)
-    iov[1].iov_base = recv_buffer;
-    iov[1].iov_len  = recv_len;
-
-    msg.msg_name = &daddr;
-    msg.msg_namelen = sizeof(daddr);
-    msg.msg_iov = iov;
-    msg.msg_iovlen = 2;
-    msg.msg_control = &cmsgbuf[0];
-    msg.msg_controllen = sizeof(cmsgbuf);
+    // 配列1は、送信時にEtherIPヘッダ以降のデータを格納
+    ctx->l2mc_iov[0].iov_base = &ctx->l2mc_ether_ip_hdr;
+    ctx->l2mc_iov[0].iov_len  = sizeof(ctx->l2mc_ether_ip_hdr);
+    ctx->l2mc_iov[1].iov_base = NULL;
+    ctx->l2mc_iov[1].iov_len  = 0;
 
+    // 送信元情報(in6_pktinfo)をcmsgへ設定
+    memset(ctx->l2mc_cmsgbuf, 0, sizeof(ctx->l2mc_cmsgbuf));
+    msg.msg_control = ctx->l2mc_cmsgbuf;
+    msg.msg_controllen = sizeof(ctx->l2mc_cmsgbuf);
     cmsg = CMSG_FIRSTHDR(&msg);
     cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
     cmsg->cmsg_level = IPPROTO_IPV6;
     cmsg->cmsg_type = IPV6_PKTINFO;
 
-    // 送信元情報(in6_pktinfo)をcmsgへ設定
     info = (struct in6_pktinfo*)CMSG_DATA(cmsg);
-    info->ipi6_addr = *src;
+    info->ipi6_addr = ctx->own_v6addr;
     info->ipi6_ifindex = 0;
 
-    // 登録されているリスト分、カプセル化したデータを送信
-    me6e_list* host_list = &(CAPSULING_FIELD(self)->handler->conf->capsuling->me6e_host_address_list);
-    me6e_list* iter;
-    me6e_list_for_each(iter, host_list) {
-    struct in6_addr* dst = iter->data;
-    char   addr[INET6_ADDRSTRLEN] = { 0 };
-
-        if(dst != NULL){
-            // パケット送信
-            daddr.sin6_addr = *(dst);
-            ret = sendmsg(fd, &msg, 0);
-            if (ret < 0) {
-                me6e_inc_capsuling_failure_count(CAPSULING_FIELD(self)->handler->stat_info);
-                me6e_logging(LOG_ERR, "fail to send address %s (l2mc_l3uni) : %s.",
-                                inet_ntop(AF_INET6, dst, addr, INET6_ADDRSTRLEN), strerror(errno));
-            }
-            else {
-                me6e_inc_capsuling_success_count(CAPSULING_FIELD(self)->handler->stat_info);
-                DEBUG_LOG("forward %d bytes to encap %s (l2mc_l3uni).\n",
-                        recv_len + sizeof(ether_ip_hdr), inet_ntop(AF_INET6, dst, addr, INET6_ADDRSTRLEN));
+    // ME6Eホスト毎の送信メッセージ設定
+    i = 0;
+    me6e_list_for_each(iter, ctx->host_list) {
+        struct in6_addr* dst = iter->data;
+        if (dst == NULL) {
+            continue;
+        }
+
+        ctx->host_addr[i].sin6_family = AF_INET6;
+        ctx->host_addr[i].sin6_port = htons(ME6E_IPPROTO_ETHERIP);
+        ctx->host_addr[i].sin6_flowinfo = 0;
+        ctx->host_addr[i].sin6_scope_id = 0;
+        ctx->host_addr[i].sin6_addr = *dst;
+
+        ctx->host_msg[i].msg_hdr.msg_name = &ctx->host_addr[i];
+        ctx->host_msg[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in6);
+        ctx->host_msg[i].msg_hdr.msg_iov = ctx->l2mc_iov;
+        ctx->host_msg[i].msg_hdr.msg_iovlen = 2;
+        ctx->host_msg[i].msg_hdr.msg_control = ctx->l2mc_cmsgbuf;
+        ctx->host_msg[i].msg_hdr.msg_controllen = sizeof(ctx->l2mc_cmsgbuf);
+        i++;
+    }
+    ctx->host_num = num;
+
+    // ピア監視テーブルはme6e_host_addressの設定順に生成されるため、
+    // 監視が有効な場合はホスト番号がそのままピア番号となる
+    if ((ctx->peer_handler != NULL) && (ctx->peer_handler->num != num)) {
+        ctx->peer_handler = NULL;
+    }
+
+    // 送信対象の構築
+    Capsuling_l2mc_l3uc_update(ctx);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief L2MC-L3UC送信対象更新関数
+//!
+//! ピア監視でupと判定されているME6Eホストの送信メッセージのみを
+//! 送信対象として詰めて格納する。
+//! ピア監視が無効の場合は全ホストを送信対象とする。
+//!
+//! @param [in,out] ctx 転送コンテキスト
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void Capsuling_l2mc_l3uc_update(CapsulingContext* ctx)
+{
+    int i;
+
+    if (ctx->peer_handler != NULL) {
+        ctx->peer_generation = ctx->peer_handler->generation;
+    }
+
+    ctx->send_num = 0;
+    for (i = 0; i < ctx->host_num; i++) {
+        if ((ctx->peer_handler == NULL) || me6e_peer_is_alive(ctx->peer_handler, i)) {
+            ctx->send_msg[ctx->send_num++] = ctx->host_msg[i];
+        }
+    }
+
+    DEBUG_LOG("l2mc_l3uni send target %d/%d hosts.\n", ctx->send_num, ctx->host_num);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief L2MC-L3UC送信メッセージ解放関数
+//!
+//! Capsuling_l2mc_l3uc_initで生成した送信メッセージを解放する。
+//!
+//! @param [in,out] ctx 転送コンテキスト
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void Capsuling_l2mc_l3uc_release(CapsulingContext* ctx)
+{
+    // 引数チェック
+    if (ctx == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(Capsuling_l2mc_l3uc_release).\n");
+        return;
+    }
+
+    free(ctx->host_addr);
+    free(ctx->host_msg);
+    free(ctx->send_msg);
+    ctx->host_addr = NULL;
+    ctx->host_msg  = NULL;
+    ctx->send_msg  = NULL;
+    ctx->host_num  = 0;
+    ctx->send_num  = 0;
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief カプセリング処理関数(L2multicast-L3unicast用)
+//!
+//! StubNWから受信したパケットをカプセル化し、
+//! 設定情報に登録されているME6Eホスト分(ピア監視でdownのホストを除く)、
+//! BackboneNWへ送信する。
+//! 送信は事前に生成した送信メッセージを使用し、sendmmsgで一括して行う。
+//! 送信に失敗したホストはスキップし、残りのホストへの送信を継続する。
+//!
+//! @param [in] ctx         転送コンテキスト
+//! @param [in] recv_buffer 受信データ
+//! @param [in] recv_len    受信データのサイズ
+//!
+//! @retval true  正常終了
+//! @retval false 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static inline bool Capsuling_capsule_msg_send_l2mc_l3uc(
+        CapsulingContext* ctx,
+        char* recv_buffer,
+        ssize_t recv_len)
+{
+
+    // 引数チェック
+    if ((ctx == NULL) || (recv_buffer == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(Capsuling_capsule_msg_send_l2mc_l3uc).\n");
+        return false;
+    }
+
+    int  fd;
+    int  num;
+    int  i;
+    uint32_t flowinfo;
+    int  sent = 0;
+    int  success = 0;
+    int  failure = 0;
+    int  ret = -1;
+
+    // ピアの生存状態が変化していれば送信対象を更新
+    if ((ctx->peer_handler != NULL) &&
+        (ctx->peer_generation != ctx->peer_handler->generation)) {
+        Capsuling_l2mc_l3uc_update(ctx);
+    }
+
+    // カプセル化後にPath MTUを超える場合は、送信元ホストへICMPを返送
+    // (全ホスト共通の送信データのため、全送信先で最小のPath MTUで判定する)
+    if ((ctx->pmtu_handler != NULL) && !me6e_pmtu_fit(ctx->pmtu_handler, recv_len)) {
+        if (me6e_pmtu_send_too_big(ctx->pmtu_handler, recv_buffer, recv_len,
+                    ctx->pmtu_handler->min_mtu)) {
+            me6e_inc_capsuling_too_big_count(ctx->stat_info);
+            return true;
+        }
+    }
+
+    fd  = ctx->bb_fd;
+    num = ctx->send_num;
+
+    // 配列1に、EtherIPヘッダ以降のデータを格納(デカプセル化データ)
+    ctx->l2mc_iov[1].iov_base = recv_buffer;
+    ctx->l2mc_iov[1].iov_len  = recv_len;
+
+    // 送信対象のホスト分、フローラベルを設定
+    if (ctx->flow_label) {
+        flowinfo = Capsuling_flow_label(ctx, me6e_util_flow_hash(recv_buffer, recv_len));
+        for (i = 0; i < num; i++) {
+            ((struct sockaddr_in6*)ctx->send_msg[i].msg_hdr.msg_name)->sin6_flowinfo = flowinfo;
+        }
+    }
+
+    // 送信対象のホスト分、カプセル化したデータを一括送信
+    while (sent < num) {
+        ret = sendmmsg(fd, &ctx->send_msg[sent], num - sent, 0);
+        if (ret <= 0) {
+            if ((ret < 0) && (errno == EINTR)) {
+                continue;
             }
+            // 先頭のホストへの送信失敗はスキップして継続
+            DEBUG_LOG("fail to send l2mc_l3uni packet : %s.\n", strerror(errno));
+            failure++;
+            sent++;
+        }
+        else {
+            success += ret;
+            sent    += ret;
         }
     }
 
+    me6e_add_capsuling_success_count(ctx->stat_info, success);
+    me6e_add_capsuling_failure_count(ctx->stat_info, failure);
+    DEBUG_LOG("forward %d bytes to encap %d hosts (l2mc_l3uni).\n",
+            recv_len + sizeof(ctx->l2mc_ether_ip_hdr), success);
+
     return true;
 }
 // L2MC-L3UC機能 end
@@ -557,21 +1232,49 @@ static bool Capsuling_RecvFromBackbone(IProcessor* self, char* recv_buffer, ssiz
     _D_(me6e_print_packet(recv_buffer);)
 
 
+    // TCP SYNのMSSをトンネルの実効MTUに合わせる
+    if (CAPSULING_FIELD(self)->ctx.mss_clamp) {
+        Capsuling_mss_clamp(&(CAPSULING_FIELD(self)->ctx), recv_buffer, recv_len);
+    }
+
     // 既にデカプセル化されているので、そのままStubNWへ送信
-    ssize_t         send_len    = recv_len;
-    char*           send_buffer = recv_buffer;
+    ssize_t         send_len;
+    struct iovec    iov;
 
-    me6e_device_t* send_dev    =
-                    &(CAPSULING_FIELD(self)->handler->conf->capsuling->tunnel_device);
+    iov.iov_base = recv_buffer;
+    iov.iov_len  = recv_len;
 
     // デカプセル化したデータを送信
-    if((send_len = write(send_dev->option.tunnel.fd, send_buffer, send_len)) < 0){
-        me6e_inc_decapsuling_failure_count(CAPSULING_FIELD(self)->handler->stat_info);
-        me6e_logging(LOG_ERR, "fail to send decapsuling packet : %s\n", strerror(errno));
+    // (セグメント結合有効時は、バースト受信の終了時にまとめて送信される)
+    // (パケットリング使用時は、宛先MACアドレスで物理デバイスとトンネルデバイスに振り分ける)
+    // (送信キュー使用時は、一時的に送信できない場合にキューに積んで再送する)
+    if(CAPSULING_FIELD(self)->ctx.stub_ring != NULL){
+        send_len = me6e_stub_ring_output(CAPSULING_FIELD(self)->ctx.stub_ring, &iov, 1);
+    }
+    else if(CAPSULING_FIELD(self)->ctx.gro_handler != NULL){
+        send_len = me6e_vnet_gro_write(CAPSULING_FIELD(self)->ctx.gro_handler, recv_buffer, recv_len);
+    }
+    else if(CAPSULING_FIELD(self)->ctx.stub_txq != NULL){
+        struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1 };
+        send_len = me6e_txq_send(CAPSULING_FIELD(self)->ctx.stub_txq, &msg,
+                    me6e_txq_classify(recv_buffer, recv_len));
+    }
+    else{
+        send_len = me6e_vnet_writev(CAPSULING_FIELD(self)->ctx.tunnel_fd,
+                    CAPSULING_FIELD(self)->ctx.tunnel_vnet_hdr, &iov, 1);
+    }
+    if(send_len < 0){
+        me6e_inc_decapsuling_failure_count(CAPSULING_FIELD(self)->ctx.stat_info);
+        if((CAPSULING_FIELD(self)->ctx.stub_txq != NULL) && (errno == ENOBUFS)){
+            DEBUG_LOG("drop decapsuling packet by tx queue.\n");
+        }
+        else{
+            me6e_logging(LOG_ERR, "fail to send decapsuling packet : %s\n", strerror(errno));
+        }
         return false;
     }
     else{
-        me6e_inc_decapsuling_success_count(CAPSULING_FIELD(self)->handler->stat_info);
+        me6e_inc_decapsuling_success_count(CAPSULING_FIELD(self)->ctx.stat_info);
         DEBUG_LOG("forward %d bytes to decap\n", send_len);
     }
 
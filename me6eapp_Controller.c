@@ -31,6 +31,8 @@
 #include <arpa/inet.h>
 #include <net/if.h>
 #include <sys/epoll.h>
+#include <poll.h>
+#include <sched.h>
 
 
 #include "me6eapp.h"
@@ -45,6 +47,9 @@
 #include "me6eapp_Capsuling.h"
 #include "me6eapp_print_packet.h"
 #include "me6eapp_EtherIP.h"
+#include "me6eapp_vnet.h"
+#include "me6eapp_fanout.h"
+#include "me6eapp_affinity.h"
 
 // デバッグ用マクロ
 #ifdef DEBUG
@@ -55,6 +60,70 @@
 
 //! 受信バッファのサイズ
 #define TUNNEL_RECV_BUF_SIZE 65535
+//! GSOフレーム受信バッファのサイズ(IPペイロード最大長 + L2/L3ヘッダ)
+#define TUNNEL_GSO_RECV_BUF_SIZE (TUNNEL_RECV_BUF_SIZE + 256)
+//! Backbone側で1回の受信通知毎にまとめて受信するパケットの最大数
+#define TUNNEL_BACKBONE_BURST_NUM 64
+//! トンネルスレッド毎に起動する処理スレッドの最大数
+#define TUNNEL_WORKER_MAX (ME6E_UDP_RECV_MAX + ME6E_PIPELINE_WORKER_MAX + 1)
+//! 送信キュー処理スレッドの番号(Backbone側送信キュー)
+#define TUNNEL_TXQ_BACKBONE 0
+//! 送信キュー処理スレッドの番号(Stub側送信キュー)
+#define TUNNEL_TXQ_STUB 1
+
+//! io_uring完了通知の識別子(トンネルデバイスの読み込み、下位はバッファ番号)
+#define TUNNEL_URING_UD_READ    (1ULL << ME6E_URING_UD_SHIFT)
+//! io_uring完了通知の識別子(Stub側パケットリングの受信監視)
+#define TUNNEL_URING_UD_RING    (2ULL << ME6E_URING_UD_SHIFT)
+//! io_uring完了通知の識別子(Backbone側ソケットのマルチショット受信)
+#define TUNNEL_URING_UD_RECV    (3ULL << ME6E_URING_UD_SHIFT)
+//! io_uring完了通知の識別子から要求種別を取り出すマスク
+#define TUNNEL_URING_UD_MASK    (0xFFULL << ME6E_URING_UD_SHIFT)
+
+///////////////////////////////////////////////////////////////////////////////
+//! Stub側パケットリング受信時の転送コンテキスト
+///////////////////////////////////////////////////////////////////////////////
+struct tunnel_ring_arg
+{
+    struct me6e_handler_t*  handler;        ///< ME6Eハンドラ
+    char*                   seg_buffer;     ///< セグメント組み立て用バッファ
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! Backbone側分散受信のデカプセル化スレッド情報
+///////////////////////////////////////////////////////////////////////////////
+struct tunnel_fanout_arg
+{
+    struct me6e_handler_t*  handler;        ///< ME6Eハンドラ
+    int                     index;          ///< 受信するパケットソケットの番号
+    pthread_t               tid[ME6E_FANOUT_MAX]; ///< デカプセル化スレッド(番号0は呼び出し元スレッド)
+    int                     tid_num;        ///< 起動したデカプセル化スレッドの数(番号0を含む)
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! トンネルスレッドが起動する処理スレッドの情報
+//! (EtherIP over UDPの受信スレッド、パイプラインの処理スレッド)
+///////////////////////////////////////////////////////////////////////////////
+struct tunnel_worker_arg
+{
+    struct me6e_handler_t*  handler;        ///< ME6Eハンドラ
+    int                     index;          ///< 受信するUDPソケット/受け渡しリングの番号
+    pthread_t               tid;            ///< デカプセル化スレッド
+    bool                    started;        ///< スレッドの起動有無
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! io_uring使用時の受信処理コンテキスト
+///////////////////////////////////////////////////////////////////////////////
+struct tunnel_uring_arg
+{
+    struct me6e_handler_t*  handler;        ///< ME6Eハンドラ
+    me6e_uring_t*           uring;          ///< io_uring
+    bool                    vnet_hdr;       ///< トンネルデバイスの仮想NICヘッダの有効/無効
+    char*                   scratch;        ///< Stub側パケットリングのフレーム加工用バッファ
+    struct tunnel_ring_arg  ring_arg;       ///< Stub側パケットリング受信時の転送コンテキスト
+    struct msghdr           recv_msg;       ///< Backbone側マルチショット受信のひな型
+};
 
 // ME6Eユニキャストアドレスのプレフィックス判定
 #define IS_EQUAL_ME6E_UNI_PREFIX(a, b) \
@@ -69,6 +138,13 @@
          && ((__const uint32_t *) (a))[2] == ((__const uint32_t *) (b))[2]  \
          && ((__const uint32_t *) (a))[3] == ((__const uint32_t *) (b))[3])
 
+// ME6Eマルチキャストアドレスのプレフィックス判定(グループ番号を除く)
+#define IS_EQUAL_ME6E_MULTI_GROUP_PREFIX(a, b) \
+        (((__const uint32_t *) (a))[0] == ((__const uint32_t *) (b))[0]     \
+         && ((__const uint32_t *) (a))[1] == ((__const uint32_t *) (b))[1]  \
+         && ((__const uint16_t *) (a))[4] == ((__const uint16_t *) (b))[4]  \
+         && ((__const uint32_t *) (a))[3] == ((__const uint32_t *) (b))[3])
+
 // ME6E-PR PlaneID判定
 #define IS_EQUAL_ME6E_PR_PLANE_ID(a, b) \
         (((__const uint16_t *) (a))[3] == ((__const uint16_t *) (b))[3] \
@@ -80,11 +156,43 @@
 static inline int me6e_construct_proxyndp(me6e_config_proxy_ndp_t* conf, me6e_list* list);
 static inline int me6e_construct_macmanager(me6e_config_mng_macaddr_t* conf, me6e_list* list);
 static inline int me6e_construct_Capsuling(me6e_config_capsuling_t* conf, me6e_list* list);
+static inline char* tunnel_buffer_alloc(struct me6e_handler_t* handler, me6e_buf_t** list, size_t size);
 static inline void tunnel_buffer_cleanup(void* buffer);
 static inline void tunnel_backbone_main_loop(struct me6e_handler_t* handler);
 static inline void tunnel_stub_main_loop(struct me6e_handler_t* handler);
+static inline void tunnel_backbone_uring_loop(struct me6e_handler_t* handler);
+static inline void tunnel_backbone_fanout_loop(struct me6e_handler_t* handler);
+static void* tunnel_fanout_thread(void* arg);
+static void tunnel_fanout_cleanup(void* arg);
+static inline void tunnel_fanout_main_loop(struct me6e_handler_t* handler, int index);
+static int tunnel_worker_start(struct tunnel_worker_arg* worker_arg, struct me6e_handler_t* handler,
+                int index, void* (*routine)(void*));
+static void tunnel_worker_cleanup(void* arg);
+static void* tunnel_udp_thread(void* arg);
+static inline void tunnel_udp_main_loop(struct me6e_handler_t* handler, int index);
+static inline void tunnel_backbone_pipeline_loop(struct me6e_handler_t* handler);
+static inline void tunnel_stub_pipeline_loop(struct me6e_handler_t* handler);
+static void* tunnel_decap_thread(void* arg);
+static inline void tunnel_decap_main_loop(struct me6e_handler_t* handler, int index);
+static void* tunnel_encap_thread(void* arg);
+static inline void tunnel_encap_main_loop(struct me6e_handler_t* handler);
+static inline me6e_buf_t* tunnel_pipeline_buffer(struct me6e_handler_t* handler, size_t size);
+static void* tunnel_txq_thread(void* arg);
+static inline void tunnel_txq_main_loop(me6e_txq_t* txq);
+static inline void tunnel_stub_uring_loop(struct me6e_handler_t* handler);
+static void tunnel_backbone_uring_complete(void* arg, uint64_t user_data, int res, uint32_t flags);
+static void tunnel_stub_uring_complete(void* arg, uint64_t user_data, int res, uint32_t flags);
+static inline int tunnel_uring_wait(me6e_uring_t* uring);
+static inline void tunnel_uring_drain(int fd, char* buffer, size_t size);
 static inline void tunnel_forward_from_stub(struct me6e_handler_t* handler, char* recv_buffer, ssize_t recv_len);
+static inline void tunnel_forward_from_stub_vnet(struct me6e_handler_t* handler, struct virtio_net_hdr* vnet,
+                char* recv_buffer, ssize_t recv_len, char* seg_buffer);
+static void tunnel_forward_segment(void* arg, char* frame, ssize_t len);
+static inline void tunnel_forward_from_host(struct me6e_handler_t* handler, char* recv_buffer, ssize_t recv_len);
+static void tunnel_forward_from_ring(void* arg, char* frame, ssize_t len);
+static void tunnel_forward_ring_segment(void* arg, char* frame, ssize_t len);
 static inline void tunnel_forward_from_backbone(struct me6e_handler_t* handler, struct msghdr* msg, ssize_t recv_len);
+static inline void tunnel_backbone_recv_error(struct me6e_handler_t* handler, int err);
 static inline bool me6e_prefix_check( struct me6e_handler_t* handler, struct in6_addr* ipi6_addr);
 static inline bool me6e_pr_planeid_check(struct me6e_handler_t* handler, struct in6_addr* ipi6_addr);
 
@@ -448,9 +556,10 @@ static inline void tunnel_backbone_main_loop(struct me6e_handler_t* handler)
 {
     // ローカル変数宣言
     char*               recv_buffer;
+    me6e_buf_t*         recv_list;
     ssize_t             recv_len;
     int                 epfd, bb_fd;
-    int                 loop, num;
+    int                 loop, num, burst;
     struct msghdr       msg = {0};
     char                cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))] = {0};
     struct sockaddr_in6 daddr;
@@ -465,14 +574,15 @@ static inline void tunnel_backbone_main_loop(struct me6e_handler_t* handler)
     }
 
     // 受信バッファ領域を確保
-    recv_buffer = (char*)malloc(TUNNEL_RECV_BUF_SIZE);
+    recv_list   = NULL;
+    recv_buffer = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_RECV_BUF_SIZE);
     if(recv_buffer == NULL){
         me6e_logging(LOG_ERR, "receive buffer allocation failed.");
         return;
     }
 
     // 後始末ハンドラ登録
-    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_buffer);
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_list);
 
     // ファイルディスクリプタ
     bb_fd  = handler->conf->capsuling->bb_fd;
@@ -534,7 +644,7 @@ static inline void tunnel_backbone_main_loop(struct me6e_handler_t* handler)
     me6e_logging(LOG_INFO, "Backbone tunnel thread main loop start.");
     while(1){
         // 受信待ち
-        num = epoll_wait(epfd, ev_ret, RECV_NEVENT_NUM, -1);
+        num = me6e_busypoll_wait(handler->bb_busypoll, epfd, ev_ret, RECV_NEVENT_NUM);
 
         if(num < 0){
             if(errno == EINTR){
@@ -551,15 +661,39 @@ static inline void tunnel_backbone_main_loop(struct me6e_handler_t* handler)
         // Backbone用ソケットでデータ受信
         for (loop = 0; loop < num; loop++) {
             if (ev_ret[loop].data.fd == bb_fd) {
-                if((recv_len = recvmsg(bb_fd, &msg, 0)) > 0){
-                    DEBUG_LOG("\n");
-                    DEBUG_LOG("\n");
-                    DEBUG_LOG("---------- backbone massage receive. ----------\n");
-                    tunnel_forward_from_backbone(handler, &msg, recv_len);
+                // エラーキューにPacket Too Big等が通知された場合はPath MTUを学習
+                if ((ev_ret[loop].events & EPOLLERR) && (handler->pmtu_handler != NULL)) {
+                    me6e_pmtu_recv_error(handler->pmtu_handler);
+                    if (!(ev_ret[loop].events & EPOLLIN)) {
+                        continue;
+                    }
                 }
-                else{
-                    me6e_logging(LOG_ERR, "backbone recvmsg error : %s.", strerror(errno));
+                // 受信済みのパケットをまとめて処理する
+                // (Stub側送信のセグメント結合はバースト単位で行う)
+                for (burst = 0; burst < TUNNEL_BACKBONE_BURST_NUM; burst++) {
+                    msg.msg_namelen    = sizeof(daddr);
+                    msg.msg_controllen = sizeof(cmsgbuf);
+                    if((recv_len = recvmsg(bb_fd, &msg, (burst == 0) ? 0 : MSG_DONTWAIT)) > 0){
+                        DEBUG_LOG("\n");
+                        DEBUG_LOG("\n");
+                        DEBUG_LOG("---------- backbone massage receive. ----------\n");
+                        tunnel_forward_from_backbone(handler, &msg, recv_len);
+                    }
+                    else{
+                        if((burst == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK))){
+                            tunnel_backbone_recv_error(handler, errno);
+                        }
+                        break;
+                    }
+                }
+
+                // 結合中のフレームをStub側へ送信
+                if((handler->gro_handler != NULL) && !me6e_vnet_gro_flush(handler->gro_handler)){
+                    me6e_inc_decapsuling_failure_count(handler->stat_info);
+                    me6e_logging(LOG_ERR, "fail to send decapsuling packet : %s\n", strerror(errno));
                 }
+                // 送信リングに積んだフレームの送信をカーネルへ通知
+                me6e_stub_ring_flush(handler->stub_ring);
             } else {
                 me6e_logging(LOG_ERR, "unknown fd = %d.", ev_ret[loop].data.fd);
                 me6e_logging(LOG_ERR, "bb_fd = %d.", bb_fd);
@@ -579,6 +713,9 @@ static inline void tunnel_backbone_main_loop(struct me6e_handler_t* handler)
 //! @brief BackboneNW デカプセル化スレッドメイン関数
 //!
 //! Backboneネットワークのデカプセル化処理のメインループを起動する。
+//! EtherIP over UDP使用時は、UDPソケット毎のデカプセル化スレッドも起動する。
+//! パイプライン使用時は、デカプセル化処理スレッドを起動し、
+//! 自スレッドは受信と処理スレッドへの受け渡しのみ行う。
 //!
 //! @param [in] arg ME6Eハンドラ
 //!
@@ -587,7 +724,9 @@ static inline void tunnel_backbone_main_loop(struct me6e_handler_t* handler)
 void* me6e_tunnel_backbone_thread(void* arg)
 {
     // ローカル変数宣言
-    struct me6e_handler_t* handler = NULL;
+    struct me6e_handler_t*   handler = NULL;
+    struct tunnel_worker_arg worker_arg[TUNNEL_WORKER_MAX];
+    int                      i, num;
 
     // 引数チェック
     if(arg == NULL){
@@ -597,9 +736,66 @@ void* me6e_tunnel_backbone_thread(void* arg)
 
     // ローカル変数初期化
     handler = (struct me6e_handler_t*)arg;
+    memset(worker_arg, 0, sizeof(worker_arg));
+    num = 0;
+
+    // CPU割り当て/スケジューリングポリシーの適用
+    me6e_affinity_apply(ME6E_THREAD_BACKBONE);
+
+    // 後始末ハンドラ登録(EtherIP over UDPのデカプセル化スレッド、処理スレッド、送信キュー再送スレッドの停止)
+    pthread_cleanup_push(tunnel_worker_cleanup, (void*)worker_arg);
+
+    // EtherIP over UDPのデカプセル化スレッド起動
+    // (UDP非対応の送信先からのEtherIPは、以降のメインループで受信する)
+    if(handler->bb_udp != NULL){
+        for(i = 0; i < handler->bb_udp->recv_num; i++){
+            if(tunnel_worker_start(&worker_arg[num], handler, i, tunnel_udp_thread) != 0){
+                me6e_logging(LOG_ERR, "fail to create backbone udp thread : %s.", strerror(errno));
+                break;
+            }
+            num++;
+        }
+        me6e_logging(LOG_INFO, "Backbone tunnel udp %d threads start.", i);
+    }
+
+    // パイプラインのデカプセル化処理スレッド起動
+    if(handler->pipeline != NULL){
+        for(i = 0; i < handler->pipeline->decap_num; i++){
+            if(tunnel_worker_start(&worker_arg[num], handler, i, tunnel_decap_thread) != 0){
+                me6e_logging(LOG_ERR, "fail to create backbone pipeline thread : %s.", strerror(errno));
+                break;
+            }
+            num++;
+        }
+        me6e_logging(LOG_INFO, "Backbone tunnel pipeline %d threads start.", i);
+    }
+
+    // Stub側送信キューの再送スレッド起動(デカプセル化したフレームの送信先)
+    if(handler->stub_txq != NULL){
+        if(tunnel_worker_start(&worker_arg[num], handler, TUNNEL_TXQ_STUB, tunnel_txq_thread) != 0){
+            me6e_logging(LOG_ERR, "fail to create stub tx queue thread : %s.", strerror(errno));
+        }
+        else{
+            num++;
+        }
+    }
 
     // メインループ開始
-    tunnel_backbone_main_loop(handler);
+    if(handler->bb_fanout != NULL){
+        tunnel_backbone_fanout_loop(handler);
+    }
+    else if(handler->bb_uring != NULL){
+        tunnel_backbone_uring_loop(handler);
+    }
+    else if(handler->pipeline != NULL){
+        tunnel_backbone_pipeline_loop(handler);
+    }
+    else{
+        tunnel_backbone_main_loop(handler);
+    }
+
+    // 後始末
+    pthread_cleanup_pop(1);
 
     pthread_exit(NULL);
 
@@ -607,84 +803,174 @@ void* me6e_tunnel_backbone_thread(void* arg)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-//! @brief StubNW カプセル化メインループ関数
+//! @brief BackboneNW デカプセル化メインループ関数(分散受信)
 //!
-//! Stubネットワークのカプセル化処理のメインループ。
-//! トンネルデバイスからのパケット受信を待ち受け、
-//! 受信したパケットをカプセル化する処理を起動する。
+//! 分散受信のパケットソケット毎にデカプセル化スレッドを起動する。
+//! 番号0のパケットソケットは呼び出し元スレッドで処理し、
+//! 呼び出し元スレッドのキャンセル時に他のスレッドも停止する。
 //!
 //! @param [in] handler   ME6Eハンドラ
 //!
 //! @return なし
 ///////////////////////////////////////////////////////////////////////////////
-static inline void tunnel_stub_main_loop(struct me6e_handler_t* handler)
+static inline void tunnel_backbone_fanout_loop(struct me6e_handler_t* handler)
 {
     // ローカル変数宣言
-    int                 epfd, stub_fd;
-    char*               recv_buffer;
-    ssize_t             recv_len;
-    int                 loop, num;
-    struct epoll_event  ev, ev_ret[RECV_NEVENT_NUM];
-
+    struct tunnel_fanout_arg  arg[ME6E_FANOUT_MAX];
+    int                       i;
 
     // 引数チェック
-    if(handler == NULL){
-        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_stub_main_loop).");
+    if((handler == NULL) || (handler->bb_fanout == NULL)){
+        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_backbone_fanout_loop).");
         return;
     }
 
+    memset(arg, 0, sizeof(arg));
+    arg[0].handler = handler;
+    arg[0].index   = 0;
+    arg[0].tid_num = 1;
+
+    // 後始末ハンドラ登録(起動したスレッドの停止)
+    pthread_cleanup_push(tunnel_fanout_cleanup, (void*)&arg[0]);
+
+    for(i = 1; i < handler->bb_fanout->num; i++){
+        arg[i].handler = handler;
+        arg[i].index   = i;
+        if(pthread_create(&arg[0].tid[i], NULL, tunnel_fanout_thread, &arg[i]) != 0){
+            me6e_logging(LOG_ERR, "fail to create backbone fanout thread : %s.", strerror(errno));
+            break;
+        }
+        arg[0].tid_num++;
+    }
+
+    me6e_logging(LOG_INFO, "Backbone tunnel fanout %d threads start.", arg[0].tid_num);
+
+    // 番号0のパケットソケットを処理
+    tunnel_fanout_main_loop(handler, 0);
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief BackboneNW 分散受信デカプセル化スレッドメイン関数
+//!
+//! @param [in] arg デカプセル化スレッド情報
+//!
+//! @return NULL固定
+///////////////////////////////////////////////////////////////////////////////
+static void* tunnel_fanout_thread(void* arg)
+{
+    // ローカル変数宣言
+    struct tunnel_fanout_arg* fanout_arg = (struct tunnel_fanout_arg*)arg;
+
+    me6e_affinity_apply(ME6E_THREAD_WORKER);
+
+    tunnel_fanout_main_loop(fanout_arg->handler, fanout_arg->index);
+
+    pthread_exit(NULL);
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief BackboneNW 分散受信デカプセル化スレッド停止関数
+//!
+//! 起動したデカプセル化スレッド(番号0以外)をキャンセルし、終了を待ち合わせる。
+//!
+//! @param [in] arg デカプセル化スレッド情報(番号0)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void tunnel_fanout_cleanup(void* arg)
+{
+    // ローカル変数宣言
+    struct tunnel_fanout_arg* fanout_arg = (struct tunnel_fanout_arg*)arg;
+    int                       i;
+
+    DEBUG_LOG("tunnel_fanout_cleanup\n");
+
+    for(i = 1; i < fanout_arg->tid_num; i++){
+        pthread_cancel(fanout_arg->tid[i]);
+    }
+    for(i = 1; i < fanout_arg->tid_num; i++){
+        pthread_join(fanout_arg->tid[i], NULL);
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief BackboneNW 分散受信デカプセル化メインループ関数
+//!
+//! 分散受信のパケットソケットからのパケット受信を待ち受け、
+//! 受信したパケットをデカプセル化する処理を起動する。
+//! 番号0のスレッドはBackbone側IPv6ソケットのエラーキュー(Path MTU)も監視する。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//! @param [in] index     受信するパケットソケットの番号
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_fanout_main_loop(struct me6e_handler_t* handler, int index)
+{
+    // ローカル変数宣言
+    char*               recv_buffer;
+    me6e_buf_t*         recv_list;
+    ssize_t             recv_len;
+    int                 epfd, fd, bb_fd;
+    int                 loop, num, burst;
+    me6e_fanout_msg_t   fmsg;
+    struct epoll_event  ev, ev_ret[RECV_NEVENT_NUM];
+
     // 受信バッファ領域を確保
-    recv_buffer = (char*)malloc(TUNNEL_RECV_BUF_SIZE);
+    recv_list   = NULL;
+    recv_buffer = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_RECV_BUF_SIZE);
     if(recv_buffer == NULL){
         me6e_logging(LOG_ERR, "receive buffer allocation failed.");
         return;
     }
 
     // 後始末ハンドラ登録
-    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_buffer);
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_list);
 
-    // ファイルディクリプタの取得
-    stub_fd =  handler->conf->capsuling->tunnel_device.option.tunnel.fd;
+    // ファイルディスクリプタ
+    fd    = handler->bb_fanout->fd[index];
+    bb_fd = handler->conf->capsuling->bb_fd;
 
     // epollの生成
     epfd = epoll_create(RECV_NEVENT_NUM);
     if (epfd < 0) {
-        me6e_logging(LOG_ERR, "fail to create epoll stub : %s.", strerror(errno));
+        me6e_logging(LOG_ERR, "fail to create epoll backbone fanout : %s.", strerror(errno));
         return;
     }
 
-    // 受信用ソケットをepollへ登録
+    // 受信ソケットをepollへ登録
     memset(&ev, 0, sizeof(ev));
     ev.events = EPOLLIN;
-    ev.data.fd = stub_fd;
-    if (epoll_ctl(epfd, EPOLL_CTL_ADD, stub_fd, &ev) != 0) {
-        me6e_logging(LOG_ERR, "fail to control epoll stub : %s.", strerror(errno));
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        me6e_logging(LOG_ERR, "fail to control epoll backbone fanout : %s.", strerror(errno));
         return;
     }
 
-
-    // メインループ前に溜まっているデータを全て吐き出す
-    while(1){
-        // 受信待ち
-        num = epoll_wait(epfd, ev_ret, RECV_NEVENT_NUM, 0);
-
-        if (num > 0 ) {
-            for (loop = 0; loop < num; loop++) {
-                if (ev_ret[loop].data.fd == stub_fd) {
-                    recv_len = read(stub_fd, recv_buffer, TUNNEL_RECV_BUF_SIZE);
-                } else {
-                    me6e_logging(LOG_ERR, "unknown fd = %d.", ev_ret[loop].data.fd);
-                    me6e_logging(LOG_ERR, "stub_fd = %d.", stub_fd);
-                }
-            }
-        } else{
-            // 即時に受信できるデータが無くなったのでループを抜ける
-            break;
+    // エラーキューの通知(EPOLLERR)のみ監視する(受信はフィルタで止めている)
+    if ((index == 0) && (handler->pmtu_handler != NULL)) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = 0;
+        ev.data.fd = bb_fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, bb_fd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll backbone : %s.", strerror(errno));
+            return;
         }
     }
 
+    // 受信メッセージの設定
+    me6e_fanout_msg_init(&fmsg, recv_buffer, TUNNEL_RECV_BUF_SIZE);
 
-    me6e_logging(LOG_INFO, "Stub tunnel thread main loop start.");
+    me6e_logging(LOG_INFO, "Backbone tunnel fanout[%d] main loop start.", index);
     while(1){
         // 受信待ち
         num = epoll_wait(epfd, ev_ret, RECV_NEVENT_NUM, -1);
@@ -692,72 +978,69 @@ static inline void tunnel_stub_main_loop(struct me6e_handler_t* handler)
         if(num < 0){
             if(errno == EINTR){
                 // シグナル割込みの場合は処理継続
-                me6e_logging(LOG_INFO, "Stub tunnel main loop receive signal : %s.", strerror(errno));
+                me6e_logging(LOG_INFO, "Backbone tunnel fanout loop receive signal : %s.", strerror(errno));
                 continue;
             }
             else{
-                me6e_logging(LOG_ERR, "Stub tunnel main loop receive error : %s.", strerror(errno));
-                break;;
+                me6e_logging(LOG_ERR, "Backbone tunnel fanout loop receive error : %s.", strerror(errno));
+                break;
             }
         }
 
-        // Stub用TAPデバイスでデータ受信
         for (loop = 0; loop < num; loop++) {
-            if (ev_ret[loop].data.fd == stub_fd) {
-                if((recv_len=read(stub_fd, recv_buffer, TUNNEL_RECV_BUF_SIZE)) > 0){
-                    DEBUG_LOG("\n");
-                    DEBUG_LOG("\n");
-                    DEBUG_LOG("---------- stub massage receive. ----------\n");
-                    _D_(me6eapp_hex_dump(recv_buffer, recv_len);)
-                    _D_(me6e_print_packet(recv_buffer);)
-                    tunnel_forward_from_stub(handler, recv_buffer, recv_len);
-                }
-                else{
-                    me6e_logging(LOG_ERR, "stub read error : %s.", strerror(errno));
+            if (ev_ret[loop].data.fd == bb_fd) {
+                // エラーキューにPacket Too Big等が通知された場合はPath MTUを学習
+                me6e_pmtu_recv_error(handler->pmtu_handler);
+            }
+            else if (ev_ret[loop].data.fd == fd) {
+                // 受信済みのパケットをまとめて処理する
+                for (burst = 0; burst < TUNNEL_BACKBONE_BURST_NUM; burst++) {
+                    recv_len = me6e_fanout_recv(handler->bb_fanout, fd, &fmsg, (burst == 0) ? 0 : MSG_DONTWAIT);
+                    if (recv_len > 0) {
+                        DEBUG_LOG("---------- backbone fanout[%d] massage receive. ----------\n", index);
+                        tunnel_forward_from_backbone(handler, &fmsg.msg, recv_len);
+                    }
+                    else if (recv_len < 0) {
+                        if((burst == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK))){
+                            me6e_logging(LOG_ERR, "backbone fanout recvmsg error : %s.", strerror(errno));
+                        }
+                        break;
+                    }
                 }
-            } else {
+
+                // 送信リングに積んだフレームの送信をカーネルへ通知
+                me6e_stub_ring_flush(handler->stub_ring);
+            }
+            else {
                 me6e_logging(LOG_ERR, "unknown fd = %d.", ev_ret[loop].data.fd);
-                me6e_logging(LOG_ERR, "stub_fd = %d.", stub_fd);
             }
         }
     }
 
-    me6e_logging(LOG_INFO, "Stub tunnel thread main loop end.");
+    me6e_logging(LOG_INFO, "Backbone tunnel fanout[%d] main loop end.", index);
 
     // 後始末
+    close(epfd);
     pthread_cleanup_pop(1);
 
     return;
-
 }
 
-
-
 ///////////////////////////////////////////////////////////////////////////////
-//! @brief StubNW カプセル化スレッドメイン関数
-//!
-//! Stubネットワークのカプセル化処理のメインループを起動する。
+//! @brief BackboneNW EtherIP over UDPデカプセル化スレッドメイン関数
 //!
-//! @param [in] arg ME6Eハンドラ
+//! @param [in] arg デカプセル化スレッド情報
 //!
-//! @return NULL
+//! @return NULL固定
 ///////////////////////////////////////////////////////////////////////////////
-void* me6e_tunnel_stub_thread(void* arg)
+static void* tunnel_udp_thread(void* arg)
 {
     // ローカル変数宣言
-    struct me6e_handler_t* handler = NULL;
+    struct tunnel_worker_arg* worker_arg = (struct tunnel_worker_arg*)arg;
 
-    // 引数チェック
-    if(arg == NULL){
-        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_tunnel_stub_thread).");
-        pthread_exit(NULL);
-    }
-
-    // ローカル変数初期化
-    handler = (struct me6e_handler_t*)arg;
+    me6e_affinity_apply(ME6E_THREAD_WORKER);
 
-    // メインループ開始
-    tunnel_stub_main_loop(handler);
+    tunnel_udp_main_loop(worker_arg->handler, worker_arg->index);
 
     pthread_exit(NULL);
 
@@ -765,97 +1048,1736 @@ void* me6e_tunnel_stub_thread(void* arg)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-//! @brief 受信バッファ解放関数
+//! @brief 処理スレッド起動関数
 //!
-//! 引数で指定されたバッファを解放する。
-//! スレッドの終了時に呼ばれる。
+//! トンネルスレッドが使用する処理スレッドを起動し、起動結果を記録する。
 //!
-//! @param [in] buffer    受信バッファ
+//! @param [out] worker_arg 処理スレッド情報
+//! @param [in]  handler    ME6Eハンドラ
+//! @param [in]  index      受信するUDPソケット/受け渡しリングの番号
+//! @param [in]  routine    スレッドメイン関数
 //!
-//! @return なし
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
 ///////////////////////////////////////////////////////////////////////////////
-static inline void tunnel_buffer_cleanup(void* buffer)
+static int tunnel_worker_start(
+                struct tunnel_worker_arg* worker_arg, struct me6e_handler_t* handler,
+                int index, void* (*routine)(void*))
 {
-    DEBUG_LOG("tunnel_buffer_cleanup\n");
-
-    // 確保したメモリを解放
-    free(buffer);
+    worker_arg->handler = handler;
+    worker_arg->index   = index;
+    if(pthread_create(&worker_arg->tid, NULL, routine, worker_arg) != 0){
+        return -1;
+    }
+    worker_arg->started = true;
 
-    return;
+    return 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-//! @brief StubNWパケット処理関数
-//!
-//! Stub側から受信したパケットに対して起動されている各機能の
-//! インスタンスの処理を起動する。
-//!
-//! インスタンスからの戻り値がtrueの場合、
-//! 次のインスタンスの処理を起動する。
+//! @brief 処理スレッド停止関数
 //!
-//! インスタンスからの戻り値がfalseの場合、
-//! 次のインスタンスの処理は起動せず、処理を終了する。
+//! 起動した処理スレッドをキャンセルし、終了を待ち合わせる。
 //!
-//! @param [in,out] handler     ME6Eハンドラ
-//! @param [in]     recv_buffer 受信パケットデータ
-//! @param [in]     recv_len    受信パケット長
+//! @param [in] arg 処理スレッド情報の配列(TUNNEL_WORKER_MAX個)
 //!
 //! @return なし
 ///////////////////////////////////////////////////////////////////////////////
-static inline void tunnel_forward_from_stub(
-                struct me6e_handler_t* handler,
-                char* recv_buffer, ssize_t recv_len)
+static void tunnel_worker_cleanup(void* arg)
 {
-    // 引数チェック
-    if ((handler == NULL) || (recv_buffer == NULL)){
-        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_forward_from_stub).");
-        pthread_exit(NULL);
-    }
-
-    // 各機能のインスタンス リストを取得
-    me6e_list* list = &(handler->instance_list);
+    // ローカル変数宣言
+    struct tunnel_worker_arg* worker_arg = (struct tunnel_worker_arg*)arg;
+    int                       i;
 
-    bool isContinue = true;
-    struct me6e_list* iter;
-    me6e_list_for_each(iter, list){
-        // 各機能のインスタンスへ処理を依頼
-        IProcessor* proc = iter->data;
-        isContinue = IProcessor_RecvFromStub(proc, recv_buffer, recv_len);
+    DEBUG_LOG("tunnel_worker_cleanup\n");
 
-        if(!isContinue) {
-            break;
+    for(i = 0; i < TUNNEL_WORKER_MAX; i++){
+        if(worker_arg[i].started){
+            pthread_cancel(worker_arg[i].tid);
+        }
+    }
+    for(i = 0; i < TUNNEL_WORKER_MAX; i++){
+        if(worker_arg[i].started){
+            pthread_join(worker_arg[i].tid, NULL);
         }
     }
+
     return;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-//! @brief Backbone側パケット転送関数
-//!
-//! Backbone側から受信したパケットをデカプセル化し、
-//! 各機能のインスタンスへ処理を依頼する。
+//! @brief BackboneNW EtherIP over UDPデカプセル化メインループ関数
 //!
-//! インスタンスからの戻り値がtrueの場合、
-//! 次のインスタンスの処理を起動する。
-//!
-//! インスタンスからの戻り値がfalseの場合、
-//! 次のインスタンスの処理は起動せず、処理を終了する。
+//! UDPソケットからのパケット受信を待ち受け、UDP_GROで結合された
+//! セグメント毎にデカプセル化する処理を起動する。
 //!
-//! @param [in,out] handler     ME6Eハンドラ
-//! @param [in]     msg         受信メッセージ
-//! @param [in]     recv_len    受信パケット長
+//! @param [in] handler   ME6Eハンドラ
+//! @param [in] index     受信するUDPソケットの番号
 //!
 //! @return なし
 ///////////////////////////////////////////////////////////////////////////////
-static inline void tunnel_forward_from_backbone(
-                struct me6e_handler_t* handler,
-                struct msghdr* msg, ssize_t recv_len)
+static inline void tunnel_udp_main_loop(struct me6e_handler_t* handler, int index)
 {
-    struct cmsghdr*     cmsg = NULL;
-    struct etheriphdr*  ether_ip_hdr = NULL;
-    char*               recv_buffer = NULL;
-    ssize_t             packet_len = 0;
-    me6e_list*         list = NULL;
+    // ローカル変数宣言
+    char*               recv_buffer;
+    me6e_buf_t*         recv_list;
+    ssize_t             recv_len, seg_len, offset;
+    int                 fd, seg_size;
+    struct msghdr       msg = {0};
+    struct msghdr       seg_msg;
+    char                cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))] = {0};
+    struct sockaddr_in6 saddr;
+    struct iovec        iov, seg_iov[2];
+
+    // 受信バッファ領域を確保
+    recv_list   = NULL;
+    recv_buffer = tunnel_buffer_alloc(handler, &recv_list, ME6E_UDP_RECV_BUF_SIZE);
+    if(recv_buffer == NULL){
+        me6e_logging(LOG_ERR, "receive buffer allocation failed.");
+        return;
+    }
+
+    // 後始末ハンドラ登録
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_list);
+
+    // ファイルディスクリプタ
+    fd = handler->bb_udp->recv_fd[index];
+
+    // 受信メッセージの設定(EtherIPヘッダから受信する)
+    iov.iov_base = recv_buffer;
+    iov.iov_len  = ME6E_UDP_RECV_BUF_SIZE;
+    msg.msg_name    = &saddr;
+    msg.msg_iov     = &iov;
+    msg.msg_iovlen  = 1;
+    msg.msg_control = &cmsgbuf[0];
+
+    me6e_logging(LOG_INFO, "Backbone tunnel udp[%d] main loop start.", index);
+    while(1){
+        msg.msg_namelen    = sizeof(saddr);
+        msg.msg_controllen = sizeof(cmsgbuf);
+        recv_len = me6e_udp_recv(handler->bb_udp, fd, &msg, &seg_size);
+        if(recv_len < 0){
+            if(errno == EINTR){
+                // シグナル割込みの場合は処理継続
+                continue;
+            }
+            me6e_logging(LOG_ERR, "backbone udp recvmsg error : %s.", strerror(errno));
+            break;
+        }
+        if(seg_size <= 0){
+            seg_size = recv_len;
+        }
+
+        DEBUG_LOG("---------- backbone udp[%d] massage receive(%d bytes, segment %d). ----------\n",
+                index, recv_len, seg_size);
+
+        // セグメント毎に、配列0にEtherIPヘッダ、配列1にEtherIPヘッダ以降を設定
+        // (送信元アドレスと送信先情報は結合前の全セグメントで共通)
+        seg_msg = msg;
+        seg_msg.msg_iov    = seg_iov;
+        seg_msg.msg_iovlen = 2;
+        for(offset = 0; offset < recv_len; offset += seg_size){
+            seg_len = ((recv_len - offset) < seg_size) ? (recv_len - offset) : seg_size;
+            if(seg_len <= (ssize_t)sizeof(struct etheriphdr)){
+                me6e_inc_decapsuling_unmatch_header_count(handler->stat_info);
+                continue;
+            }
+            seg_iov[0].iov_base = recv_buffer + offset;
+            seg_iov[0].iov_len  = sizeof(struct etheriphdr);
+            seg_iov[1].iov_base = recv_buffer + offset + sizeof(struct etheriphdr);
+            seg_iov[1].iov_len  = seg_len - sizeof(struct etheriphdr);
+            tunnel_forward_from_backbone(handler, &seg_msg, seg_len);
+        }
+
+        // 送信リングに積んだフレームの送信をカーネルへ通知
+        me6e_stub_ring_flush(handler->stub_ring);
+    }
+
+    me6e_logging(LOG_INFO, "Backbone tunnel udp[%d] main loop end.", index);
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief BackboneNW 受信メインループ関数(パイプライン)
+//!
+//! Backboneからのパケット受信を待ち受け、受信したパケットを
+//! パケットバッファへ格納してデカプセル化処理スレッドへ受け渡す。
+//! 内側フレームのフローのバケット毎に同じ処理スレッドへ振り分け、フロー内の順序を保つ。
+//! 送信元/送信先アドレスはパケットバッファの利用者領域で受け渡す。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_backbone_pipeline_loop(struct me6e_handler_t* handler)
+{
+    // ローカル変数宣言
+    me6e_pipeline_t*    pipeline;
+    char*               recv_buffer;
+    me6e_buf_t*         recv_list;
+    me6e_buf_t*         buf;
+    ssize_t             recv_len;
+    int                 epfd, bb_fd;
+    int                 loop, num, burst, i;
+    struct msghdr       msg = {0};
+    char                cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))] = {0};
+    struct sockaddr_in6 saddr;
+    struct iovec        iov;
+    struct cmsghdr*     cmsg;
+    struct in6_pktinfo* info;
+    bool                kick[ME6E_PIPELINE_WORKER_MAX];
+    struct epoll_event  ev, ev_ret[RECV_NEVENT_NUM];
+
+    // 引数チェック
+    if((handler == NULL) || (handler->pipeline == NULL)){
+        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_backbone_pipeline_loop).");
+        return;
+    }
+
+    pipeline = handler->pipeline;
+
+    // 受信バッファ領域を確保
+    recv_list   = NULL;
+    recv_buffer = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_RECV_BUF_SIZE);
+    if(recv_buffer == NULL){
+        me6e_logging(LOG_ERR, "receive buffer allocation failed.");
+        return;
+    }
+
+    // 後始末ハンドラ登録
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_list);
+
+    // ファイルディスクリプタ
+    bb_fd  = handler->conf->capsuling->bb_fd;
+
+    // epollの生成
+    epfd = epoll_create(RECV_NEVENT_NUM);
+    if (epfd < 0) {
+        me6e_logging(LOG_ERR, "fail to create epoll backbone : %s.", strerror(errno));
+        return;
+    }
+
+    // 受信ソケットをepollへ登録
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = bb_fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, bb_fd, &ev) != 0) {
+        me6e_logging(LOG_ERR, "fail to control epoll backbone : %s.", strerror(errno));
+        return;
+    }
+
+    // 受信メッセージの設定(EtherIPヘッダから受信する)
+    iov.iov_base = recv_buffer;
+    iov.iov_len  = TUNNEL_RECV_BUF_SIZE;
+    msg.msg_name    = &saddr;
+    msg.msg_iov     = &iov;
+    msg.msg_iovlen  = 1;
+    msg.msg_control = &cmsgbuf[0];
+
+    me6e_logging(LOG_INFO, "Backbone tunnel thread pipeline loop start.");
+    while(1){
+        // 受信待ち
+        num = me6e_busypoll_wait(handler->bb_busypoll, epfd, ev_ret, RECV_NEVENT_NUM);
+
+        if(num < 0){
+            if(errno == EINTR){
+                // シグナル割込みの場合は処理継続
+                me6e_logging(LOG_INFO, "Backbone tunnel pipeline loop receive signal : %s.", strerror(errno));
+                continue;
+            }
+            else{
+                me6e_logging(LOG_ERR, "Backbone tunnel pipeline loop receive error : %s.", strerror(errno));
+                break;
+            }
+        }
+
+        for (loop = 0; loop < num; loop++) {
+            if (ev_ret[loop].data.fd != bb_fd) {
+                me6e_logging(LOG_ERR, "unknown fd = %d.", ev_ret[loop].data.fd);
+                me6e_logging(LOG_ERR, "bb_fd = %d.", bb_fd);
+                continue;
+            }
+
+            // エラーキューにPacket Too Big等が通知された場合はPath MTUを学習
+            if ((ev_ret[loop].events & EPOLLERR) && (handler->pmtu_handler != NULL)) {
+                me6e_pmtu_recv_error(handler->pmtu_handler);
+                if (!(ev_ret[loop].events & EPOLLIN)) {
+                    continue;
+                }
+            }
+
+            // 受信済みのパケットをまとめて受け渡し、処理スレッドの起床はまとめて行う
+            memset(kick, 0, sizeof(kick));
+            for (burst = 0; burst < TUNNEL_BACKBONE_BURST_NUM; burst++) {
+                msg.msg_namelen    = sizeof(saddr);
+                msg.msg_controllen = sizeof(cmsgbuf);
+                if((recv_len = recvmsg(bb_fd, &msg, (burst == 0) ? 0 : MSG_DONTWAIT)) <= 0){
+                    if((burst == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK))){
+                        tunnel_backbone_recv_error(handler, errno);
+                    }
+                    break;
+                }
+                if(recv_len <= (ssize_t)sizeof(struct etheriphdr)){
+                    me6e_inc_decapsuling_unmatch_header_count(handler->stat_info);
+                    continue;
+                }
+
+                // 送信先情報の取得
+                info = NULL;
+                for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)){
+                    if(cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_PKTINFO){
+                        info = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+                        break;
+                    }
+                }
+                if(info == NULL){
+                    me6e_logging(LOG_ERR, "packet info not exists.");
+                    continue;
+                }
+
+                // 受信長に合ったパケットバッファへ格納
+                buf = tunnel_pipeline_buffer(handler, recv_len);
+                memcpy(me6e_buf_data(buf), recv_buffer, recv_len);
+                buf->len = recv_len;
+                memcpy(&buf->priv[0], &saddr.sin6_addr, sizeof(struct in6_addr));
+                memcpy(&buf->priv[sizeof(struct in6_addr)], &info->ipi6_addr, sizeof(struct in6_addr));
+
+                // 内側フレームのフロー(5-tuple、非IPはMACアドレスの組)毎に処理スレッドを選択
+                buf->hash = me6e_util_flow_hash(recv_buffer + sizeof(struct etheriphdr),
+                                recv_len - sizeof(struct etheriphdr));
+                i = me6e_pipeline_dispatch(pipeline, buf);
+                kick[i] = true;
+            }
+
+            for (i = 0; i < pipeline->decap_num; i++) {
+                if (kick[i]) {
+                    me6e_pipeline_kick(&pipeline->decap[i]);
+                }
+            }
+        }
+    }
+
+    me6e_logging(LOG_INFO, "Backbone tunnel thread pipeline loop end.");
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief BackboneNW デカプセル化処理スレッドメイン関数(パイプライン)
+//!
+//! @param [in] arg 処理スレッド情報
+//!
+//! @return NULL固定
+///////////////////////////////////////////////////////////////////////////////
+static void* tunnel_decap_thread(void* arg)
+{
+    // ローカル変数宣言
+    struct tunnel_worker_arg* worker_arg = (struct tunnel_worker_arg*)arg;
+
+    me6e_affinity_apply(ME6E_THREAD_WORKER);
+
+    tunnel_decap_main_loop(worker_arg->handler, worker_arg->index);
+
+    pthread_exit(NULL);
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief BackboneNW デカプセル化処理メインループ関数(パイプライン)
+//!
+//! 受け渡しリングからパケットバッファを取り出し、受信時の送信元/送信先
+//! アドレスで受信メッセージを組み立ててデカプセル化する処理を起動する。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//! @param [in] index     受け渡しリングの番号
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_decap_main_loop(struct me6e_handler_t* handler, int index)
+{
+    // ローカル変数宣言
+    me6e_pipeline_worker_t* worker;
+    me6e_buf_t*             buf;
+    char*                   data;
+    struct msghdr           msg = {0};
+    char                    cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))] = {0};
+    struct sockaddr_in6     saddr;
+    struct iovec            iov[2];
+    struct cmsghdr*         cmsg;
+    struct in6_pktinfo*     info;
+
+    worker = &handler->pipeline->decap[index];
+
+    // 受信メッセージのひな型(送信元アドレスと送信先情報のみ設定する)
+    memset(&saddr, 0, sizeof(saddr));
+    saddr.sin6_family  = AF_INET6;
+    msg.msg_name       = &saddr;
+    msg.msg_namelen    = sizeof(saddr);
+    msg.msg_iov        = iov;
+    msg.msg_iovlen     = 2;
+    msg.msg_control    = &cmsgbuf[0];
+    msg.msg_controllen = sizeof(cmsgbuf);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = IPPROTO_IPV6;
+    cmsg->cmsg_type  = IPV6_PKTINFO;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(struct in6_pktinfo));
+    info = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+
+    me6e_logging(LOG_INFO, "Backbone tunnel pipeline[%d] main loop start.", index);
+    while(1){
+        buf = me6e_pipeline_dequeue(worker);
+        if(buf == NULL){
+            // 受け渡しリングが空の場合は受け渡しを待つ
+            me6e_pipeline_wait(worker);
+            continue;
+        }
+
+        DEBUG_LOG("---------- backbone pipeline[%d] massage receive. ----------\n", index);
+
+        // 配列0にEtherIPヘッダ、配列1にEtherIPヘッダ以降を設定
+        data = me6e_buf_data(buf);
+        memcpy(&saddr.sin6_addr, &buf->priv[0], sizeof(struct in6_addr));
+        memcpy(&info->ipi6_addr, &buf->priv[sizeof(struct in6_addr)], sizeof(struct in6_addr));
+        iov[0].iov_base = data;
+        iov[0].iov_len  = sizeof(struct etheriphdr);
+        iov[1].iov_base = data + sizeof(struct etheriphdr);
+        iov[1].iov_len  = buf->len - sizeof(struct etheriphdr);
+        tunnel_forward_from_backbone(handler, &msg, buf->len);
+
+        me6e_buf_free(buf);
+
+        // 処理完了を通知(バケット移動の判定に使用)
+        me6e_pipeline_done(worker);
+    }
+
+    me6e_logging(LOG_INFO, "Backbone tunnel pipeline[%d] main loop end.", index);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNW 受信メインループ関数(パイプライン)
+//!
+//! トンネルデバイスからのパケット受信を待ち受け、受信したパケットを
+//! パケットバッファへ格納してカプセル化処理スレッドへ受け渡す。
+//! 仮想NICヘッダはパケットバッファの利用者領域で受け渡す。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_stub_pipeline_loop(struct me6e_handler_t* handler)
+{
+    // ローカル変数宣言
+    me6e_pipeline_worker_t* worker;
+    int                     epfd, stub_fd;
+    char*                   recv_buffer;
+    me6e_buf_t*             recv_list;
+    me6e_buf_t*             buf;
+    ssize_t                 recv_len;
+    int                     loop, num;
+    bool                    vnet_hdr;
+    struct virtio_net_hdr   vnet;
+    struct iovec            iov[2];
+    struct epoll_event      ev, ev_ret[RECV_NEVENT_NUM];
+
+    // 引数チェック
+    if((handler == NULL) || (handler->pipeline == NULL)){
+        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_stub_pipeline_loop).");
+        return;
+    }
+
+    worker   = &handler->pipeline->encap;
+    vnet_hdr = handler->conf->capsuling->tunnel_device.option.tunnel.vnet_hdr;
+
+    // 受信バッファ領域を確保(GSOフレームを受信できる長さ)
+    recv_list   = NULL;
+    recv_buffer = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_GSO_RECV_BUF_SIZE);
+    if(recv_buffer == NULL){
+        me6e_logging(LOG_ERR, "receive buffer allocation failed.");
+        return;
+    }
+
+    // 仮想NICヘッダとフレームを分けて受信
+    iov[0].iov_base = &vnet;
+    iov[0].iov_len  = sizeof(vnet);
+    iov[1].iov_base = recv_buffer;
+    iov[1].iov_len  = TUNNEL_GSO_RECV_BUF_SIZE;
+
+    // 後始末ハンドラ登録
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_list);
+
+    // ファイルディクリプタの取得
+    stub_fd =  handler->conf->capsuling->tunnel_device.option.tunnel.fd;
+
+    // epollの生成
+    epfd = epoll_create(RECV_NEVENT_NUM);
+    if (epfd < 0) {
+        me6e_logging(LOG_ERR, "fail to create epoll stub : %s.", strerror(errno));
+        return;
+    }
+
+    // 受信用ソケットをepollへ登録
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = stub_fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, stub_fd, &ev) != 0) {
+        me6e_logging(LOG_ERR, "fail to control epoll stub : %s.", strerror(errno));
+        return;
+    }
+
+    me6e_logging(LOG_INFO, "Stub tunnel thread pipeline loop start.");
+    while(1){
+        // 受信待ち
+        num = me6e_busypoll_wait(handler->stub_busypoll, epfd, ev_ret, RECV_NEVENT_NUM);
+
+        if(num < 0){
+            if(errno == EINTR){
+                // シグナル割込みの場合は処理継続
+                me6e_logging(LOG_INFO, "Stub tunnel pipeline loop receive signal : %s.", strerror(errno));
+                continue;
+            }
+            else{
+                me6e_logging(LOG_ERR, "Stub tunnel pipeline loop receive error : %s.", strerror(errno));
+                break;
+            }
+        }
+
+        // Stub用TAPデバイスでデータ受信
+        for (loop = 0; loop < num; loop++) {
+            if (ev_ret[loop].data.fd != stub_fd) {
+                me6e_logging(LOG_ERR, "unknown fd = %d.", ev_ret[loop].data.fd);
+                me6e_logging(LOG_ERR, "stub_fd = %d.", stub_fd);
+                continue;
+            }
+
+            if(vnet_hdr){
+                if((recv_len = readv(stub_fd, iov, 2)) <= (ssize_t)sizeof(vnet)){
+                    me6e_logging(LOG_ERR, "stub read error : %s.", strerror(errno));
+                    continue;
+                }
+                recv_len -= sizeof(vnet);
+            }
+            else if((recv_len = read(stub_fd, recv_buffer, TUNNEL_RECV_BUF_SIZE)) <= 0){
+                me6e_logging(LOG_ERR, "stub read error : %s.", strerror(errno));
+                continue;
+            }
+
+            DEBUG_LOG("---------- stub pipeline massage receive. ----------\n");
+
+            // 受信長に合ったパケットバッファへ格納して受け渡す
+            buf = tunnel_pipeline_buffer(handler, recv_len);
+            memcpy(me6e_buf_data(buf), recv_buffer, recv_len);
+            buf->len = recv_len;
+            if(vnet_hdr){
+                memcpy(&buf->priv[0], &vnet, sizeof(vnet));
+            }
+            me6e_pipeline_enqueue(worker, buf);
+        }
+
+        // 処理スレッドの起床は受信通知毎にまとめて行う
+        me6e_pipeline_kick(worker);
+    }
+
+    me6e_logging(LOG_INFO, "Stub tunnel thread pipeline loop end.");
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNW カプセル化処理スレッドメイン関数(パイプライン)
+//!
+//! @param [in] arg 処理スレッド情報
+//!
+//! @return NULL固定
+///////////////////////////////////////////////////////////////////////////////
+static void* tunnel_encap_thread(void* arg)
+{
+    // ローカル変数宣言
+    struct tunnel_worker_arg* worker_arg = (struct tunnel_worker_arg*)arg;
+
+    me6e_affinity_apply(ME6E_THREAD_WORKER);
+
+    tunnel_encap_main_loop(worker_arg->handler);
+
+    pthread_exit(NULL);
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNW カプセル化処理メインループ関数(パイプライン)
+//!
+//! 受け渡しリングからパケットバッファを取り出し、カプセル化する処理を起動する。
+//! 受け渡しリングが空になった時点で、EtherIP over UDPの送信待ちセグメントを送信する。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_encap_main_loop(struct me6e_handler_t* handler)
+{
+    // ローカル変数宣言
+    me6e_pipeline_worker_t* worker;
+    me6e_buf_t*             buf;
+    char*                   seg_buffer;
+    me6e_buf_t*             seg_list;
+    bool                    vnet_hdr;
+    struct virtio_net_hdr   vnet;
+
+    worker   = &handler->pipeline->encap;
+    vnet_hdr = handler->conf->capsuling->tunnel_device.option.tunnel.vnet_hdr;
+
+    // 仮想NICヘッダ有効時はセグメント組み立て用バッファを確保
+    seg_list   = NULL;
+    seg_buffer = NULL;
+    if(vnet_hdr){
+        seg_buffer = tunnel_buffer_alloc(handler, &seg_list, TUNNEL_RECV_BUF_SIZE);
+        if(seg_buffer == NULL){
+            me6e_logging(LOG_ERR, "segment buffer allocation failed.");
+            return;
+        }
+    }
+
+    // 後始末ハンドラ登録
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)seg_list);
+
+    me6e_logging(LOG_INFO, "Stub tunnel pipeline main loop start.");
+    while(1){
+        buf = me6e_pipeline_dequeue(worker);
+        if(buf == NULL){
+            // EtherIP over UDPの送信待ちセグメントを送信してから受け渡しを待つ
+            me6e_udp_flush(handler->bb_udp);
+            me6e_pipeline_wait(worker);
+            continue;
+        }
+
+        if(vnet_hdr){
+            memcpy(&vnet, &buf->priv[0], sizeof(vnet));
+            tunnel_forward_from_stub_vnet(handler, &vnet, me6e_buf_data(buf), buf->len, seg_buffer);
+        }
+        else{
+            _D_(me6eapp_hex_dump(me6e_buf_data(buf), buf->len);)
+            _D_(me6e_print_packet(me6e_buf_data(buf));)
+            tunnel_forward_from_host(handler, me6e_buf_data(buf), buf->len);
+        }
+
+        me6e_buf_free(buf);
+    }
+
+    me6e_logging(LOG_INFO, "Stub tunnel pipeline main loop end.");
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パイプライン受け渡し用バッファ確保関数
+//!
+//! パケットバッファプールから指定長のバッファを確保する。
+//! 空きがない場合は、処理スレッドが返却するまで受信を止めて待ち合わせる。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//! @param [in] size      必要なデータ長
+//!
+//! @return 確保したパケットバッファ
+///////////////////////////////////////////////////////////////////////////////
+static inline me6e_buf_t* tunnel_pipeline_buffer(struct me6e_handler_t* handler, size_t size)
+{
+    // ローカル変数宣言
+    me6e_pipeline_t*    pipeline = handler->pipeline;
+    me6e_buf_t*         buf;
+    int                 i;
+
+    while((buf = me6e_buf_alloc(handler->bufpool, size)) == NULL){
+        // 処理スレッドに滞留分の処理を促す
+        for(i = 0; i < pipeline->decap_num; i++){
+            me6e_pipeline_kick(&pipeline->decap[i]);
+        }
+        me6e_pipeline_kick(&pipeline->encap);
+        pthread_testcancel();
+        sched_yield();
+    }
+
+    return buf;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信キュー再送スレッドメイン関数
+//!
+//! @param [in] arg 処理スレッド情報(indexは送信キューの種別)
+//!
+//! @return NULL固定
+///////////////////////////////////////////////////////////////////////////////
+static void* tunnel_txq_thread(void* arg)
+{
+    // ローカル変数宣言
+    struct tunnel_worker_arg* worker_arg = (struct tunnel_worker_arg*)arg;
+
+    // 再送の待ち合わせが主のため処理スレッドのCPUは割り当てない
+    me6e_affinity_apply(ME6E_THREAD_CONTROL);
+
+    if(worker_arg->index == TUNNEL_TXQ_BACKBONE){
+        tunnel_txq_main_loop(worker_arg->handler->bb_txq);
+    }
+    else{
+        tunnel_txq_main_loop(worker_arg->handler->stub_txq);
+    }
+
+    pthread_exit(NULL);
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信キュー再送メインループ関数
+//!
+//! 送信キューにフレームが積まれると、送信先のEPOLLOUT(ENOBUFSの場合は
+//! 一定間隔)毎に、送信できなくなるまでまとめて再送する。
+//!
+//! @param [in] txq   送信キュー
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_txq_main_loop(me6e_txq_t* txq)
+{
+    me6e_logging(LOG_INFO, "%s tx queue thread loop start.", txq->name);
+    while(1){
+        me6e_txq_drain(txq);
+        me6e_txq_wait(txq);
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNW カプセル化メインループ関数
+//!
+//! Stubネットワークのカプセル化処理のメインループ。
+//! トンネルデバイスからのパケット受信を待ち受け、
+//! 受信したパケットをカプセル化する処理を起動する。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_stub_main_loop(struct me6e_handler_t* handler)
+{
+    // ローカル変数宣言
+    int                 epfd, stub_fd, ring_fd;
+    char*               recv_buffer;
+    char*               seg_buffer;
+    me6e_buf_t*         recv_list;
+    struct tunnel_ring_arg ring_arg;
+    ssize_t             recv_len;
+    int                 loop, num;
+    bool                vnet_hdr;
+    struct virtio_net_hdr vnet;
+    struct iovec        iov[2];
+    struct epoll_event  ev, ev_ret[RECV_NEVENT_NUM];
+
+
+    // 引数チェック
+    if(handler == NULL){
+        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_stub_main_loop).");
+        return;
+    }
+
+    vnet_hdr = handler->conf->capsuling->tunnel_device.option.tunnel.vnet_hdr;
+
+    // 受信バッファ領域を確保
+    // 仮想NICヘッダ有効時はGSOフレーム受信用とセグメント組み立て用を確保
+    // (パケットリング使用時も、受信フレームの加工用とセグメント組み立て用に同様に確保)
+    recv_list = NULL;
+    if(vnet_hdr || (handler->stub_ring != NULL)){
+        recv_buffer = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_GSO_RECV_BUF_SIZE);
+        seg_buffer  = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_RECV_BUF_SIZE);
+    }
+    else{
+        recv_buffer = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_RECV_BUF_SIZE);
+        seg_buffer  = NULL;
+    }
+    if((recv_buffer == NULL) || ((seg_buffer == NULL) && (vnet_hdr || (handler->stub_ring != NULL)))){
+        me6e_logging(LOG_ERR, "receive buffer allocation failed.");
+        me6e_buf_free_list(recv_list);
+        return;
+    }
+
+    // 仮想NICヘッダとフレームを分けて受信
+    iov[0].iov_base = &vnet;
+    iov[0].iov_len  = sizeof(vnet);
+    iov[1].iov_base = recv_buffer;
+    iov[1].iov_len  = TUNNEL_GSO_RECV_BUF_SIZE;
+
+    // 後始末ハンドラ登録
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_list);
+
+    // ファイルディクリプタの取得
+    stub_fd =  handler->conf->capsuling->tunnel_device.option.tunnel.fd;
+
+    // epollの生成
+    epfd = epoll_create(RECV_NEVENT_NUM);
+    if (epfd < 0) {
+        me6e_logging(LOG_ERR, "fail to create epoll stub : %s.", strerror(errno));
+        return;
+    }
+
+    // 受信用ソケットをepollへ登録
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = stub_fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, stub_fd, &ev) != 0) {
+        me6e_logging(LOG_ERR, "fail to control epoll stub : %s.", strerror(errno));
+        return;
+    }
+
+    // メインループ前に溜まっているデータを全て吐き出す
+    while(1){
+        // 受信待ち
+        num = epoll_wait(epfd, ev_ret, RECV_NEVENT_NUM, 0);
+
+        if (num > 0 ) {
+            for (loop = 0; loop < num; loop++) {
+                if (ev_ret[loop].data.fd == stub_fd) {
+                    recv_len = read(stub_fd, recv_buffer, TUNNEL_RECV_BUF_SIZE);
+                } else {
+                    me6e_logging(LOG_ERR, "unknown fd = %d.", ev_ret[loop].data.fd);
+                    me6e_logging(LOG_ERR, "stub_fd = %d.", stub_fd);
+                }
+            }
+        } else{
+            // 即時に受信できるデータが無くなったのでループを抜ける
+            break;
+        }
+    }
+
+    // Stub側パケットリングをepollへ登録
+    // (リングのブロックは処理して返却するまで通知され続けるため、吐き出し後に登録する)
+    ring_fd = -1;
+    if (handler->stub_ring != NULL) {
+        ring_fd = handler->stub_ring->poll_fd;
+        ring_arg.handler    = handler;
+        ring_arg.seg_buffer = seg_buffer;
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = ring_fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, ring_fd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll stub ring : %s.", strerror(errno));
+            return;
+        }
+    }
+
+
+    me6e_logging(LOG_INFO, "Stub tunnel thread main loop start.");
+    while(1){
+        // 受信待ち
+        num = me6e_busypoll_wait(handler->stub_busypoll, epfd, ev_ret, RECV_NEVENT_NUM);
+
+        if(num < 0){
+            if(errno == EINTR){
+                // シグナル割込みの場合は処理継続
+                me6e_logging(LOG_INFO, "Stub tunnel main loop receive signal : %s.", strerror(errno));
+                continue;
+            }
+            else{
+                me6e_logging(LOG_ERR, "Stub tunnel main loop receive error : %s.", strerror(errno));
+                break;;
+            }
+        }
+
+        // Stub用TAPデバイスでデータ受信
+        for (loop = 0; loop < num; loop++) {
+            if (ev_ret[loop].data.fd == stub_fd) {
+                if(vnet_hdr){
+                    if((recv_len = readv(stub_fd, iov, 2)) > (ssize_t)sizeof(vnet)){
+                        recv_len -= sizeof(vnet);
+                        DEBUG_LOG("\n");
+                        DEBUG_LOG("\n");
+                        DEBUG_LOG("---------- stub massage receive(gso type %d). ----------\n", vnet.gso_type);
+                        tunnel_forward_from_stub_vnet(handler, &vnet, recv_buffer, recv_len, seg_buffer);
+                    }
+                    else{
+                        me6e_logging(LOG_ERR, "stub read error : %s.", strerror(errno));
+                    }
+                }
+                else if((recv_len=read(stub_fd, recv_buffer, TUNNEL_RECV_BUF_SIZE)) > 0){
+                    DEBUG_LOG("\n");
+                    DEBUG_LOG("\n");
+                    DEBUG_LOG("---------- stub massage receive. ----------\n");
+                    _D_(me6eapp_hex_dump(recv_buffer, recv_len);)
+                    _D_(me6e_print_packet(recv_buffer);)
+                    tunnel_forward_from_host(handler, recv_buffer, recv_len);
+                }
+                else{
+                    me6e_logging(LOG_ERR, "stub read error : %s.", strerror(errno));
+                }
+            } else if (ev_ret[loop].data.fd == ring_fd) {
+                // 受信リングのブロックをまとめて処理する
+                // (受信バッファを加工用に使用する)
+                DEBUG_LOG("---------- stub ring receive. ----------\n");
+                me6e_stub_ring_recv(handler->stub_ring, recv_buffer, tunnel_forward_from_ring, &ring_arg);
+            } else {
+                me6e_logging(LOG_ERR, "unknown fd = %d.", ev_ret[loop].data.fd);
+                me6e_logging(LOG_ERR, "stub_fd = %d.", stub_fd);
+            }
+        }
+
+        // EtherIP over UDPの送信待ちセグメントを送信
+        me6e_udp_flush(handler->bb_udp);
+
+        // 送信リングに積んだフレームの送信をカーネルへ通知
+        me6e_stub_ring_flush(handler->stub_ring);
+    }
+
+    me6e_logging(LOG_INFO, "Stub tunnel thread main loop end.");
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    return;
+
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNW カプセル化スレッドメイン関数
+//!
+//! Stubネットワークのカプセル化処理のメインループを起動する。
+//! パイプライン使用時は、カプセル化処理スレッドを起動し、
+//! 自スレッドは受信と処理スレッドへの受け渡しのみ行う。
+//!
+//! @param [in] arg ME6Eハンドラ
+//!
+//! @return NULL
+///////////////////////////////////////////////////////////////////////////////
+void* me6e_tunnel_stub_thread(void* arg)
+{
+    // ローカル変数宣言
+    struct me6e_handler_t*   handler = NULL;
+    struct tunnel_worker_arg worker_arg[TUNNEL_WORKER_MAX];
+
+    // 引数チェック
+    if(arg == NULL){
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_tunnel_stub_thread).");
+        pthread_exit(NULL);
+    }
+
+    // ローカル変数初期化
+    handler = (struct me6e_handler_t*)arg;
+    memset(worker_arg, 0, sizeof(worker_arg));
+
+    // CPU割り当て/スケジューリングポリシーの適用
+    me6e_affinity_apply(ME6E_THREAD_STUB);
+
+    // 後始末ハンドラ登録(カプセル化処理スレッド、送信キュー再送スレッドの停止)
+    pthread_cleanup_push(tunnel_worker_cleanup, (void*)worker_arg);
+
+    // Backbone側送信キューの再送スレッド起動(カプセル化したフレームの送信先)
+    if(handler->bb_txq != NULL){
+        if(tunnel_worker_start(&worker_arg[1], handler, TUNNEL_TXQ_BACKBONE, tunnel_txq_thread) != 0){
+            me6e_logging(LOG_ERR, "fail to create backbone tx queue thread : %s.", strerror(errno));
+        }
+    }
+
+    // メインループ開始
+    if(handler->stub_uring != NULL){
+        tunnel_stub_uring_loop(handler);
+    }
+    else if(handler->pipeline != NULL){
+        // パイプラインのカプセル化処理スレッド起動
+        if(tunnel_worker_start(&worker_arg[0], handler, 0, tunnel_encap_thread) != 0){
+            me6e_logging(LOG_ERR, "fail to create stub pipeline thread : %s.", strerror(errno));
+        }
+        else{
+            tunnel_stub_pipeline_loop(handler);
+        }
+    }
+    else{
+        tunnel_stub_main_loop(handler);
+    }
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    pthread_exit(NULL);
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief トンネル送受信用io_uring生成関数
+//!
+//! Backbone側受信用とStub側受信/カプセル化送信用のio_uringを生成する。
+//! トンネルデバイス、Backbone側ソケット、Stub側パケットリングを
+//! 固定ファイルとして登録し、各用途のバッファを確保する。
+//!
+//! @param [in,out] handler ME6Eハンドラ
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_create_tunnel_uring(struct me6e_handler_t* handler)
+{
+    // ローカル変数宣言
+    int     fds[ME6E_URING_FILE_NUM];
+    size_t  send_size;
+
+    // 引数チェック
+    if(handler == NULL){
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_create_tunnel_uring).");
+        return -1;
+    }
+
+    fds[ME6E_URING_FILE_TAP]  = handler->conf->capsuling->tunnel_device.option.tunnel.fd;
+    fds[ME6E_URING_FILE_BB]   = handler->conf->capsuling->bb_fd;
+    fds[ME6E_URING_FILE_RING] = (handler->stub_ring != NULL) ? handler->stub_ring->poll_fd : -1;
+
+    // Backbone側(マルチショット受信)
+    // (分散受信時はパケットソケット毎のスレッドで受信するため生成しない)
+    if(handler->bb_fanout == NULL){
+        handler->bb_uring = me6e_uring_create(fds, ME6E_URING_FILE_NUM, handler->stat_info);
+        if((handler->bb_uring == NULL) ||
+           (me6e_uring_setup_recv(handler->bb_uring, ME6E_URING_RECV_NUM, ME6E_URING_BUF_SIZE) != 0)){
+            goto error;
+        }
+    }
+
+    // Stub側(トンネルデバイスの読み込み、カプセル化したパケットの送信)
+    // 送信用バッファはトンネルデバイスのMTU分のフレームを格納できるサイズとする
+    send_size = handler->conf->capsuling->tunnel_device.mtu + ETH_HLEN + 4 + sizeof(struct etheriphdr);
+    if(send_size < ME6E_URING_SEND_SIZE){
+        send_size = ME6E_URING_SEND_SIZE;
+    }
+    handler->stub_uring = me6e_uring_create(fds, ME6E_URING_FILE_NUM, handler->stat_info);
+    if((handler->stub_uring == NULL) ||
+       (me6e_uring_setup_read(handler->stub_uring, ME6E_URING_READ_NUM, ME6E_URING_BUF_SIZE) != 0) ||
+       (me6e_uring_setup_send(handler->stub_uring, ME6E_URING_SEND_NUM, send_size) != 0)){
+        goto error;
+    }
+
+    return 0;
+
+error:
+    me6e_destroy_tunnel_uring(handler);
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief トンネル送受信用io_uring解放関数
+//!
+//! @param [in,out] handler ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_destroy_tunnel_uring(struct me6e_handler_t* handler)
+{
+    // 引数チェック
+    if(handler == NULL){
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_destroy_tunnel_uring).");
+        return;
+    }
+
+    me6e_uring_destroy(handler->bb_uring);
+    handler->bb_uring = NULL;
+    me6e_uring_destroy(handler->stub_uring);
+    handler->stub_uring = NULL;
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief BackboneNW デカプセル化メインループ関数(io_uring)
+//!
+//! Backbone側ソケットのマルチショット受信を要求し、
+//! 完了通知毎に受信したパケットをデカプセル化する処理を起動する。
+//! 1回の待ち合わせで届いた完了通知をまとめて処理し、
+//! Stub側送信のセグメント結合/送信リングの通知はその単位で行う。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_backbone_uring_loop(struct me6e_handler_t* handler)
+{
+    // ローカル変数宣言
+    char*                   recv_buffer;
+    me6e_buf_t*             recv_list;
+    struct tunnel_uring_arg arg;
+
+    // 引数チェック
+    if(handler == NULL){
+        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_backbone_uring_loop).");
+        return;
+    }
+
+    // 受信バッファ領域を確保(起動前の受信データの破棄用)
+    recv_list   = NULL;
+    recv_buffer = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_RECV_BUF_SIZE);
+    if(recv_buffer == NULL){
+        me6e_logging(LOG_ERR, "receive buffer allocation failed.");
+        return;
+    }
+
+    // 後始末ハンドラ登録
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_list);
+
+    memset(&arg, 0, sizeof(arg));
+    arg.handler = handler;
+    arg.uring   = handler->bb_uring;
+    arg.recv_msg.msg_namelen    = sizeof(struct sockaddr_in6);
+    arg.recv_msg.msg_controllen = CMSG_SPACE(sizeof(struct in6_pktinfo));
+
+    // ループ前に今溜まっているデータを全て吐き出す
+    tunnel_uring_drain(handler->conf->capsuling->bb_fd, recv_buffer, TUNNEL_RECV_BUF_SIZE);
+
+    // マルチショット受信を要求
+    me6e_uring_recvmsg(arg.uring, ME6E_URING_FILE_BB, &arg.recv_msg, TUNNEL_URING_UD_RECV);
+
+    me6e_logging(LOG_INFO, "Backbone tunnel thread main loop start(io_uring).");
+    while(1){
+        // 受信待ち
+        if(tunnel_uring_wait(arg.uring) != 0){
+            if(errno == EINTR){
+                // シグナル割込みの場合は処理継続
+                me6e_logging(LOG_INFO, "Backbone tunnel main loop receive signal : %s.", strerror(errno));
+                continue;
+            }
+            else{
+                me6e_logging(LOG_ERR, "Backbone tunnel main loop receive error : %s.", strerror(errno));
+                break;
+            }
+        }
+
+        // 届いた完了通知をまとめて処理する
+        me6e_uring_reap(arg.uring, tunnel_backbone_uring_complete, &arg);
+
+        // 結合中のフレームをStub側へ送信
+        if((handler->gro_handler != NULL) && !me6e_vnet_gro_flush(handler->gro_handler)){
+            me6e_inc_decapsuling_failure_count(handler->stat_info);
+            me6e_logging(LOG_ERR, "fail to send decapsuling packet : %s\n", strerror(errno));
+        }
+        // 送信リングに積んだフレームの送信をカーネルへ通知
+        me6e_stub_ring_flush(handler->stub_ring);
+    }
+
+    me6e_logging(LOG_INFO, "Backbone tunnel thread main loop end.");
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNW カプセル化メインループ関数(io_uring)
+//!
+//! トンネルデバイスの読み込みを複数同時に要求し、完了通知毎に
+//! 受信したパケットをカプセル化する処理を起動する。
+//! カプセル化したパケットの送信要求は、次の待ち合わせの際にまとめて投入する。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_stub_uring_loop(struct me6e_handler_t* handler)
+{
+    // ローカル変数宣言
+    char*                   recv_buffer;
+    char*                   seg_buffer;
+    me6e_buf_t*             recv_list;
+    struct tunnel_uring_arg arg;
+    int                     i;
+
+    // 引数チェック
+    if(handler == NULL){
+        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_stub_uring_loop).");
+        return;
+    }
+
+    // フレーム加工用とセグメント組み立て用のバッファを確保
+    recv_list   = NULL;
+    recv_buffer = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_GSO_RECV_BUF_SIZE);
+    seg_buffer  = tunnel_buffer_alloc(handler, &recv_list, TUNNEL_RECV_BUF_SIZE);
+    if((recv_buffer == NULL) || (seg_buffer == NULL)){
+        me6e_logging(LOG_ERR, "receive buffer allocation failed.");
+        me6e_buf_free_list(recv_list);
+        return;
+    }
+
+    // 後始末ハンドラ登録
+    pthread_cleanup_push(tunnel_buffer_cleanup, (void*)recv_list);
+
+    memset(&arg, 0, sizeof(arg));
+    arg.handler             = handler;
+    arg.uring               = handler->stub_uring;
+    arg.vnet_hdr            = handler->conf->capsuling->tunnel_device.option.tunnel.vnet_hdr;
+    arg.scratch             = recv_buffer;
+    arg.ring_arg.handler    = handler;
+    arg.ring_arg.seg_buffer = seg_buffer;
+
+    // メインループ前に溜まっているデータを全て吐き出す
+    tunnel_uring_drain(handler->conf->capsuling->tunnel_device.option.tunnel.fd,
+            recv_buffer, TUNNEL_GSO_RECV_BUF_SIZE);
+
+    // トンネルデバイスの読み込みを要求
+    for(i = 0; i < ME6E_URING_READ_NUM; i++){
+        me6e_uring_read(arg.uring, ME6E_URING_FILE_TAP, i, TUNNEL_URING_UD_READ | i);
+    }
+
+    // Stub側パケットリングの受信監視を要求
+    if(handler->stub_ring != NULL){
+        me6e_uring_poll(arg.uring, ME6E_URING_FILE_RING, POLLIN, TUNNEL_URING_UD_RING);
+    }
+
+    me6e_logging(LOG_INFO, "Stub tunnel thread main loop start(io_uring).");
+    while(1){
+        // 送信要求の投入と受信待ち
+        if(tunnel_uring_wait(arg.uring) != 0){
+            if(errno == EINTR){
+                // シグナル割込みの場合は処理継続
+                me6e_logging(LOG_INFO, "Stub tunnel main loop receive signal : %s.", strerror(errno));
+                continue;
+            }
+            else{
+                me6e_logging(LOG_ERR, "Stub tunnel main loop receive error : %s.", strerror(errno));
+                break;
+            }
+        }
+
+        // 届いた完了通知をまとめて処理する
+        me6e_uring_reap(arg.uring, tunnel_stub_uring_complete, &arg);
+
+        // EtherIP over UDPの送信待ちセグメントを送信
+        me6e_udp_flush(handler->bb_udp);
+
+        // 送信リングに積んだフレームの送信をカーネルへ通知
+        me6e_stub_ring_flush(handler->stub_ring);
+    }
+
+    me6e_logging(LOG_INFO, "Stub tunnel thread main loop end.");
+
+    // 後始末
+    pthread_cleanup_pop(1);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone側io_uring完了通知処理関数
+//!
+//! マルチショット受信で受信したパケットをデカプセル化する処理を起動し、
+//! バッファを返却する。受信が終了した場合は再度要求する。
+//! 受信エラー(Packet Too Big等の通知)の場合はPath MTUを学習する。
+//!
+//! @param [in] arg         受信処理コンテキスト
+//! @param [in] user_data   完了通知の識別子
+//! @param [in] res         完了通知の結果
+//! @param [in] flags       完了通知のフラグ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void tunnel_backbone_uring_complete(void* arg, uint64_t user_data, int res, uint32_t flags)
+{
+    // ローカル変数宣言
+    struct tunnel_uring_arg*    uring_arg = (struct tunnel_uring_arg*)arg;
+    struct me6e_handler_t*      handler   = uring_arg->handler;
+    struct msghdr               msg;
+    struct iovec                iov[2];
+    char*                       data;
+    ssize_t                     recv_len;
+
+    if((user_data & TUNNEL_URING_UD_MASK) != TUNNEL_URING_UD_RECV){
+        me6e_logging(LOG_ERR, "unknown io_uring completion = %llx.", (unsigned long long)user_data);
+        return;
+    }
+
+    if(res < 0){
+        // 提供バッファ不足の場合は返却後に再度要求する
+        if(res != -ENOBUFS){
+            if(handler->pmtu_handler != NULL){
+                me6e_pmtu_recv_error(handler->pmtu_handler);
+            }
+            else{
+                me6e_logging(LOG_ERR, "backbone recvmsg error : %s.", strerror(-res));
+            }
+        }
+    }
+    else{
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_namelen    = uring_arg->recv_msg.msg_namelen;
+        msg.msg_controllen = uring_arg->recv_msg.msg_controllen;
+        data = me6e_uring_recvmsg_out(uring_arg->uring, flags, res, &msg, &recv_len);
+        if((data != NULL) && (recv_len >= (ssize_t)sizeof(struct etheriphdr))){
+            // 配列0にEtherIPヘッダ、配列1にデカプセル化データ
+            iov[0].iov_base = data;
+            iov[0].iov_len  = sizeof(struct etheriphdr);
+            iov[1].iov_base = data + sizeof(struct etheriphdr);
+            iov[1].iov_len  = recv_len - sizeof(struct etheriphdr);
+            msg.msg_iov     = iov;
+            msg.msg_iovlen  = 2;
+
+            DEBUG_LOG("\n");
+            DEBUG_LOG("\n");
+            DEBUG_LOG("---------- backbone massage receive. ----------\n");
+            tunnel_forward_from_backbone(handler, &msg, recv_len);
+        }
+    }
+
+    me6e_uring_recv_recycle(uring_arg->uring, flags);
+
+    if(!(flags & ME6E_URING_CQE_F_MORE)){
+        me6e_uring_recvmsg(uring_arg->uring, ME6E_URING_FILE_BB, &uring_arg->recv_msg, TUNNEL_URING_UD_RECV);
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stub側io_uring完了通知処理関数
+//!
+//! トンネルデバイスから読み込んだパケットをカプセル化する処理を起動し、
+//! 同じバッファで次の読み込みを要求する。
+//! Stub側パケットリングの受信通知の場合は受信リングを処理する。
+//!
+//! @param [in] arg         受信処理コンテキスト
+//! @param [in] user_data   完了通知の識別子
+//! @param [in] res         完了通知の結果
+//! @param [in] flags       完了通知のフラグ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void tunnel_stub_uring_complete(void* arg, uint64_t user_data, int res, uint32_t flags)
+{
+    // ローカル変数宣言
+    struct tunnel_uring_arg*    uring_arg = (struct tunnel_uring_arg*)arg;
+    struct me6e_handler_t*      handler   = uring_arg->handler;
+    char*                       buffer;
+    int                         index;
+
+    switch(user_data & TUNNEL_URING_UD_MASK){
+    case TUNNEL_URING_UD_READ:
+        index  = (int)(user_data & ~TUNNEL_URING_UD_MASK);
+        buffer = me6e_uring_read_buffer(uring_arg->uring, index);
+
+        if(uring_arg->vnet_hdr){
+            // 先頭の仮想NICヘッダとフレームに分けて処理
+            if(res > (int)sizeof(struct virtio_net_hdr)){
+                DEBUG_LOG("\n");
+                DEBUG_LOG("\n");
+                DEBUG_LOG("---------- stub massage receive(gso type %d). ----------\n",
+                        ((struct virtio_net_hdr*)buffer)->gso_type);
+                tunnel_forward_from_stub_vnet(handler, (struct virtio_net_hdr*)buffer,
+                        buffer + sizeof(struct virtio_net_hdr), res - sizeof(struct virtio_net_hdr),
+                        uring_arg->ring_arg.seg_buffer);
+            }
+            else{
+                me6e_logging(LOG_ERR, "stub read error : %s.", strerror((res < 0) ? -res : EINVAL));
+            }
+        }
+        else if(res > 0){
+            DEBUG_LOG("\n");
+            DEBUG_LOG("\n");
+            DEBUG_LOG("---------- stub massage receive. ----------\n");
+            _D_(me6eapp_hex_dump(buffer, res);)
+            _D_(me6e_print_packet(buffer);)
+            tunnel_forward_from_host(handler, buffer, res);
+        }
+        else{
+            me6e_logging(LOG_ERR, "stub read error : %s.", strerror((res < 0) ? -res : EINVAL));
+        }
+
+        // 同じバッファで次の読み込みを要求
+        me6e_uring_read(uring_arg->uring, ME6E_URING_FILE_TAP, index, user_data);
+        break;
+
+    case TUNNEL_URING_UD_RING:
+        // 受信リングのブロックをまとめて処理する
+        DEBUG_LOG("---------- stub ring receive. ----------\n");
+        me6e_stub_ring_recv(handler->stub_ring, uring_arg->scratch, tunnel_forward_from_ring, &uring_arg->ring_arg);
+
+        if(!(flags & ME6E_URING_CQE_F_MORE)){
+            me6e_uring_poll(uring_arg->uring, ME6E_URING_FILE_RING, POLLIN, TUNNEL_URING_UD_RING);
+        }
+        break;
+
+    default:
+        me6e_logging(LOG_ERR, "unknown io_uring completion = %llx.", (unsigned long long)user_data);
+        break;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief io_uring待ち合わせ関数
+//!
+//! 未投入の要求を投入し、完了通知を待ち合わせる。
+//! io_uring_enterはスレッドの取り消しポイントではないため、
+//! 待ち合わせ中は非同期に取り消せるようにする。
+//!
+//! @param [in] uring   io_uring
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+static inline int tunnel_uring_wait(me6e_uring_t* uring)
+{
+    // ローカル変数宣言
+    int ret;
+    int oldtype;
+
+    pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, &oldtype);
+    ret = me6e_uring_submit(uring, true);
+    pthread_setcanceltype(oldtype, NULL);
+
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受信済みデータ破棄関数
+//!
+//! メインループ開始前に溜まっている受信データを全て読み捨てる。
+//!
+//! @param [in] fd      ファイルディスクリプタ
+//! @param [in] buffer  読み捨て用バッファ
+//! @param [in] size    読み捨て用バッファのサイズ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_uring_drain(int fd, char* buffer, size_t size)
+{
+    // ローカル変数宣言
+    struct pollfd pfd;
+
+    pfd.fd     = fd;
+    pfd.events = POLLIN;
+    while((poll(&pfd, 1, 0) > 0) && (pfd.revents & POLLIN)){
+        if(read(fd, buffer, size) <= 0){
+            break;
+        }
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受信バッファ確保関数
+//!
+//! パケットバッファプールから指定長のバッファを確保し、
+//! 確保済みバッファのリスト(スレッド終了時に一括で解放する)へ連結する。
+//!
+//! @param [in]     handler   ME6Eハンドラ
+//! @param [in,out] list      確保済みバッファのリスト
+//! @param [in]     size      必要なデータ長
+//!
+//! @return 確保したバッファのデータ先頭(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static inline char* tunnel_buffer_alloc(struct me6e_handler_t* handler, me6e_buf_t** list, size_t size)
+{
+    // ローカル変数宣言
+    me6e_buf_t* buf;
+
+    buf = me6e_buf_alloc(handler->bufpool, size);
+    if(buf == NULL){
+        return NULL;
+    }
+    buf->next = *list;
+    *list = buf;
+
+    return me6e_buf_data(buf);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受信バッファ解放関数
+//!
+//! 引数で指定されたバッファのリストをパケットバッファプールへ返却する。
+//! スレッドの終了時に呼ばれる。
+//!
+//! @param [in] buffer    確保済みバッファのリスト
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_buffer_cleanup(void* buffer)
+{
+    DEBUG_LOG("tunnel_buffer_cleanup\n");
+
+    // 確保したバッファを返却
+    me6e_buf_free_list(buffer);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNWパケット処理関数
+//!
+//! Stub側から受信したパケットに対して起動されている各機能の
+//! インスタンスの処理を起動する。
+//!
+//! インスタンスからの戻り値がtrueの場合、
+//! 次のインスタンスの処理を起動する。
+//!
+//! インスタンスからの戻り値がfalseの場合、
+//! 次のインスタンスの処理は起動せず、処理を終了する。
+//!
+//! @param [in,out] handler     ME6Eハンドラ
+//! @param [in]     recv_buffer 受信パケットデータ
+//! @param [in]     recv_len    受信パケット長
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_forward_from_stub(
+                struct me6e_handler_t* handler,
+                char* recv_buffer, ssize_t recv_len)
+{
+    // 引数チェック
+    if ((handler == NULL) || (recv_buffer == NULL)){
+        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_forward_from_stub).");
+        pthread_exit(NULL);
+    }
+
+    // 各機能のインスタンス リストを取得
+    me6e_list* list = &(handler->instance_list);
+
+    bool isContinue = true;
+    struct me6e_list* iter;
+    me6e_list_for_each(iter, list){
+        // 各機能のインスタンスへ処理を依頼
+        IProcessor* proc = iter->data;
+        isContinue = IProcessor_RecvFromStub(proc, recv_buffer, recv_len);
+
+        if(!isContinue) {
+            break;
+        }
+    }
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief StubNWパケット処理関数(仮想NICヘッダ付き)
+//!
+//! Stub側から仮想NICヘッダ付きで受信したフレームを処理する。
+//! GSOフレームの場合はセグメント分割し、セグメント毎に
+//! 各機能のインスタンスの処理を起動する。
+//! チェックサム未計算のフレームの場合はチェックサムを補完してから
+//! 各機能のインスタンスの処理を起動する。
+//!
+//! @param [in,out] handler     ME6Eハンドラ
+//! @param [in]     vnet        仮想NICヘッダ
+//! @param [in]     recv_buffer 受信パケットデータ
+//! @param [in]     recv_len    受信パケット長
+//! @param [out]    seg_buffer  セグメント組み立て用バッファ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_forward_from_stub_vnet(
+                struct me6e_handler_t* handler, struct virtio_net_hdr* vnet,
+                char* recv_buffer, ssize_t recv_len, char* seg_buffer)
+{
+    // 引数チェック
+    if ((handler == NULL) || (vnet == NULL) || (recv_buffer == NULL) || (seg_buffer == NULL)){
+        me6e_logging(LOG_ERR, "Parameter Check NG(tunnel_forward_from_stub_vnet).");
+        return;
+    }
+
+    if (vnet->gso_type != VIRTIO_NET_HDR_GSO_NONE) {
+        // GSOフレームはセグメント分割して転送
+        if (me6e_vnet_segment(vnet, recv_buffer, recv_len, seg_buffer, tunnel_forward_segment, handler) < 0) {
+            me6e_inc_capsuling_failure_count(handler->stat_info);
+            DEBUG_LOG("fail to segment gso frame.\n");
+        }
+        else {
+            me6e_inc_capsuling_gso_count(handler->stat_info);
+        }
+        return;
+    }
+
+    // チェックサムの補完
+    if (!me6e_vnet_complete_csum(vnet, recv_buffer, recv_len)) {
+        me6e_inc_capsuling_failure_count(handler->stat_info);
+        return;
+    }
+
+    _D_(me6eapp_hex_dump(recv_buffer, recv_len);)
+    _D_(me6e_print_packet(recv_buffer);)
+    tunnel_forward_from_host(handler, recv_buffer, recv_len);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GSOセグメント転送関数
+//!
+//! GSOフレームを分割したセグメントを、各機能のインスタンスへ渡す。
+//!
+//! @param [in]     arg         ME6Eハンドラ
+//! @param [in]     frame       セグメント
+//! @param [in]     len         セグメント長
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void tunnel_forward_segment(void* arg, char* frame, ssize_t len)
+{
+    _D_(me6eapp_hex_dump(frame, len);)
+    _D_(me6e_print_packet(frame);)
+    tunnel_forward_from_host((struct me6e_handler_t*)arg, frame, len);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief トンネルデバイス受信フレーム転送関数
+//!
+//! トンネルデバイスから受信したフレーム(ホスト自身が送信したフレーム)を
+//! 各機能のインスタンスへ渡す。
+//! Stub側パケットリング使用時は、物理デバイス側宛てのフレームを
+//! 送信リングへ送信し、カプセル化が不要なフレームはここで終了する。
+//!
+//! @param [in,out] handler     ME6Eハンドラ
+//! @param [in]     recv_buffer 受信パケットデータ
+//! @param [in]     recv_len    受信パケット長
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_forward_from_host(
+                struct me6e_handler_t* handler,
+                char* recv_buffer, ssize_t recv_len)
+{
+    if ((handler->stub_ring != NULL) &&
+        me6e_stub_ring_from_host(handler->stub_ring, recv_buffer, recv_len)) {
+        return;
+    }
+
+    tunnel_forward_from_stub(handler, recv_buffer, recv_len);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stub側パケットリング受信フレーム転送関数
+//!
+//! 受信リングから受信したカプセル化対象のフレームを各機能のインスタンスへ渡す。
+//! 物理デバイスのGRO/LROでMTUを超えて結合されたTCPフレームは、
+//! 物理デバイスのMTU以下にセグメント分割してから渡す。
+//!
+//! @param [in]     arg         転送コンテキスト
+//! @param [in]     frame       Ethernetフレーム
+//! @param [in]     len         Ethernetフレーム長
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void tunnel_forward_from_ring(void* arg, char* frame, ssize_t len)
+{
+    struct tunnel_ring_arg* ring_arg = (struct tunnel_ring_arg*)arg;
+    struct me6e_handler_t*  handler  = ring_arg->handler;
+    struct virtio_net_hdr   vnet;
+
+    if ((len > handler->stub_ring->mtu + ETH_HLEN + 4) &&
+        me6e_vnet_build_gso(frame, len, handler->stub_ring->mtu, &vnet)) {
+        if (me6e_vnet_segment(&vnet, frame, len, ring_arg->seg_buffer, tunnel_forward_ring_segment, handler) < 0) {
+            me6e_inc_capsuling_failure_count(handler->stat_info);
+            DEBUG_LOG("fail to segment stub ring frame.\n");
+        }
+        else {
+            me6e_inc_capsuling_gso_count(handler->stat_info);
+        }
+        return;
+    }
+
+    _D_(me6eapp_hex_dump(frame, len);)
+    _D_(me6e_print_packet(frame);)
+    tunnel_forward_from_stub(handler, frame, len);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stub側パケットリング受信セグメント転送関数
+//!
+//! 受信リングのフレームを分割したセグメントを、各機能のインスタンスへ渡す。
+//!
+//! @param [in]     arg         ME6Eハンドラ
+//! @param [in]     frame       セグメント
+//! @param [in]     len         セグメント長
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void tunnel_forward_ring_segment(void* arg, char* frame, ssize_t len)
+{
+    _D_(me6eapp_hex_dump(frame, len);)
+    _D_(me6e_print_packet(frame);)
+    tunnel_forward_from_stub((struct me6e_handler_t*)arg, frame, len);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone側受信エラー処理関数
+//!
+//! Path MTU学習時はBackbone側ソケットでIPV6_RECVERRが有効なため、
+//! ICMPv6エラーの通知でもデータ受信(recvmsg)が失敗する。
+//! その場合はエラーキューを読み出してPath MTUを学習し、
+//! 受信の異常としては扱わない(デバッグログのみ出力する)。
+//!
+//! @param [in] handler   ME6Eハンドラ
+//! @param [in] err       受信時のerrno
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_backbone_recv_error(struct me6e_handler_t* handler, int err)
+{
+    if(handler->pmtu_handler != NULL){
+        me6e_pmtu_recv_error(handler->pmtu_handler);
+        DEBUG_LOG("backbone recvmsg error : %s.\n", strerror(err));
+    }
+    else{
+        me6e_logging(LOG_ERR, "backbone recvmsg error : %s.", strerror(err));
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone側パケット転送関数
+//!
+//! Backbone側から受信したパケットをデカプセル化し、
+//! 各機能のインスタンスへ処理を依頼する。
+//!
+//! インスタンスからの戻り値がtrueの場合、
+//! 次のインスタンスの処理を起動する。
+//!
+//! インスタンスからの戻り値がfalseの場合、
+//! 次のインスタンスの処理は起動せず、処理を終了する。
+//!
+//! @param [in,out] handler     ME6Eハンドラ
+//! @param [in]     msg         受信メッセージ
+//! @param [in]     recv_len    受信パケット長
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void tunnel_forward_from_backbone(
+                struct me6e_handler_t* handler,
+                struct msghdr* msg, ssize_t recv_len)
+{
+    struct cmsghdr*     cmsg = NULL;
+    struct etheriphdr*  ether_ip_hdr = NULL;
+    char*               recv_buffer = NULL;
+    ssize_t             packet_len = 0;
+    me6e_list*         list = NULL;
 
 
     // 引数チェック
@@ -935,6 +2857,13 @@ static inline void tunnel_forward_from_backbone(
         return;
     }
 
+    // ME6Eピア監視パケットの場合は監視処理のみ行う
+    if (me6e_peer_recv(handler->peer_handler, &s_srcaddr->sin6_addr,
+                &info->ipi6_addr, recv_buffer, packet_len)) {
+        DEBUG_LOG("peer probe packet receive.\n");
+        return;
+    }
+
 
     // 各機能のインスタンスへ処理を依頼
     list = &(handler->instance_list);
@@ -988,7 +2917,12 @@ static inline bool me6e_prefix_check(
     if (IN6_IS_ADDR_MULTICAST(ipi6_addr)) {
         // マルチキャストの場合
         DEBUG_LOG("IPv6 multicast packet.\n");
-        ret = IS_EQUAL_ME6E_MULTI_PREFIX(ipi6_addr, &handler->multicast_prefix);
+        if (handler->mcast_handler != NULL) {
+            // マルチキャストグループ対応付け時はグループ番号を除いて比較
+            ret = IS_EQUAL_ME6E_MULTI_GROUP_PREFIX(ipi6_addr, &handler->multicast_prefix);
+        } else {
+            ret = IS_EQUAL_ME6E_MULTI_PREFIX(ipi6_addr, &handler->multicast_prefix);
+        }
 
     } else {
         // ユニキャストの場合
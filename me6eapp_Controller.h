@@ -19,6 +19,8 @@ void me6e_release_instances(struct me6e_handler_t* handler);
 void me6e_destroy_instances(struct me6e_handler_t* handler);
 void* me6e_tunnel_backbone_thread(void* arg);
 void* me6e_tunnel_stub_thread(void* arg);
+int me6e_create_tunnel_uring(struct me6e_handler_t* handler);
+void me6e_destroy_tunnel_uring(struct me6e_handler_t* handler);
 
 #endif // __ME6EAPP_CONTROLLER_H__
 
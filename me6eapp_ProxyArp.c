@@ -32,6 +32,8 @@
 #include "me6eapp_ProxyArp.h"
 #include "me6eapp_ProxyArp_data.h"
 #include "me6eapp_network.h"		// MACフィルタ対応 2016/09/08 add
+#include "me6eapp_holdoff.h"
+#include "me6eapp_vnet.h"
 
 
 // デバッグ用マクロ
@@ -46,6 +48,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 struct ProxyArpField{
         struct me6e_handler_t  *handler;               ///< ME6Eのアプリケーションハンドラー
+        me6e_holdoff_t         *holdoff;               ///< ARP Requestフラッディング抑止テーブル
 };
 typedef struct ProxyArpField ProxyArpField;
 
@@ -101,7 +104,8 @@ static bool ProxyArp_RecvFromBackbone(IProcessor* self, char* recv_buffer, ssize
 static inline void ProxyArp_arp_analyze_dump(me6eapp_arp_analyze* arp);
 static inline bool ProxyArp_arp_parse_packet(const char* packet, me6eapp_arp_analyze* arp);
 static inline bool ProxyArp_arp_send_reply( me6eapp_arp_analyze* arp,
-                const struct ether_addr* target_mac, const struct ether_addr* physical_mac, int send_fd);
+                const struct ether_addr* target_mac, const struct ether_addr* physical_mac, int send_fd, bool vnet_hdr,
+                me6e_stub_ring_t* stub_ring);
 static inline me6e_proxy_arp_t*  ProxyArp_init_arp_table(me6e_config_proxy_arp_t* conf);
 static inline void ProxyArp_add_static_entry(const char* key, const void* value, void* userdata);
 static inline void ProxyArp_end_arp_table(me6e_proxy_arp_t* handler);
@@ -111,6 +115,7 @@ static inline enum arp_table_set_result ProxyArp_arp_entry_set(me6e_proxy_arp_t*
 static inline int ProxyArp_arp_entry_get(me6e_proxy_arp_t* handler,
                 const struct in_addr*   v4daddr, struct ether_addr* macaddr);
 static inline void ProxyArp_timeout_cb(const timer_t timerid, void* data);
+static inline bool ProxyArp_flood_check(IProcessor* self, const struct in_addr* target);
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -189,6 +194,15 @@ static bool ProxyArp_Init(IProcessor* self, struct me6e_handler_t *handler)
         return false;
     }
 
+    // ARP Requestフラッディング抑止テーブルの初期化
+    if (handler->conf->arp->arp_suppress) {
+        PROXYARP_FIELD(self)->holdoff = me6e_holdoff_create(handler->conf->arp->arp_suppress_holdoff);
+        if (PROXYARP_FIELD(self)->holdoff == NULL) {
+            me6e_logging(LOG_ERR, "fail to create proxy arp holdoff table.");
+            return false;
+        }
+    }
+
     DEBUG_LOG("ProxyArp_Init end.\n");
     return  true;
 }
@@ -220,6 +234,9 @@ static void ProxyArp_Release(IProcessor* self)
         }
     }
 
+    // ARP Requestフラッディング抑止テーブルの解放
+    me6e_holdoff_destroy(PROXYARP_FIELD(self)->holdoff);
+
     // フィールドの解放
     free(PROXYARP_FIELD(self));
 
@@ -321,7 +338,9 @@ static bool ProxyArp_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t r
             fd = PROXYARP_FIELD(self)->handler->conf->capsuling->tunnel_device.option.tunnel.fd;
             // MACフィルタ対応 2016/09/08 chg start
             //if(ProxyArp_arp_send_reply(&arp, &macaddr, &macaddr_bridge, fd)) {
-            if(ProxyArp_arp_send_reply(&arp, &macaddr, PROXYARP_FIELD(self)->handler->conf->capsuling->bridge_hwaddr, fd)) {
+            if(ProxyArp_arp_send_reply(&arp, &macaddr, PROXYARP_FIELD(self)->handler->conf->capsuling->bridge_hwaddr, fd,
+                        PROXYARP_FIELD(self)->handler->conf->capsuling->tunnel_device.option.tunnel.vnet_hdr,
+                        PROXYARP_FIELD(self)->handler->stub_ring)) {
             // MACフィルタ対応 2016/09/08 chg end
                 me6e_inc_arp_reply_send_count(PROXYARP_FIELD(self)->handler->stat_info);
             } else {
@@ -331,7 +350,8 @@ static bool ProxyArp_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t r
             // 動的エントリー機能動作有無判定
             if ((PROXYARP_FIELD(self)->handler->conf->arp->arp_entry_update)) {
                 // 処理を継続(ProxyARPの動的ARPエントリ更新が有効であれば、ARP Requestは転送する)
-                isContinue = true;
+                // フラッディング抑止が有効な場合は抑止時間内の転送は1回のみ
+                isContinue = ProxyArp_flood_check(self, &(arp.target_proto_addr));
             } else {
                 // 処理を継続しない。
                 isContinue = false;
@@ -339,14 +359,50 @@ static bool ProxyArp_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t r
 
         } else {
             DEBUG_LOG("ARP REQUEST NO Match.\n");
-            // 次のクラスの処理を継続
-            isContinue = true;
+            // 次のクラスの処理を継続(フラッディング抑止が有効な場合は抑止時間内の転送は1回のみ)
+            isContinue = ProxyArp_flood_check(self, &(arp.target_proto_addr));
         }
     }
 
     return  isContinue;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ARP Requestフラッディング可否判定関数
+//!
+//! ARP RequestをBackboneへ転送してよいか判定する。
+//! フラッディング抑止が有効な場合、同一ターゲットへのARP Requestは
+//! 抑止時間内に1回のみ転送する。
+//!
+//! @param [in] self    IProcessor構造体
+//! @param [in] target  ARP Requestのターゲットアドレス
+//!
+//! @retval true  転送する
+//! @retval false 転送しない(抑止時間内)
+///////////////////////////////////////////////////////////////////////////////
+static inline bool ProxyArp_flood_check(IProcessor* self, const struct in_addr* target)
+{
+    struct in6_addr key;
+
+    // フラッディング抑止が無効な場合は常に転送
+    if (PROXYARP_FIELD(self)->holdoff == NULL) {
+        return true;
+    }
+
+    // IPv4射影アドレスをキーとする
+    memset(&key, 0, sizeof(key));
+    key.s6_addr16[5] = 0xffff;
+    key.s6_addr32[3] = target->s_addr;
+
+    if (!me6e_holdoff_check(PROXYARP_FIELD(self)->holdoff, &key)) {
+        DEBUG_LOG("ARP REQUEST suppressed.\n");
+        me6e_inc_arp_request_suppress_count(PROXYARP_FIELD(self)->handler->stat_info);
+        return false;
+    }
+
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //! @brief BackBoneパケット受信処理関
 //!
@@ -503,6 +559,8 @@ static inline bool ProxyArp_arp_parse_packet(
 //! @param [in]     arp         ARP解析データ
 //! @param [in]     target_mac  ターゲットMACアドレス
 //! @param [in]     send_fd     送信用ファイルディスクリプタ
+//! @param [in]     vnet_hdr    送信先トンネルデバイスの仮想NICヘッダの有効/無効
+//! @param [in]     stub_ring   Stub側パケットリング(未使用時はNULL)
 //!
 //! @retval true  正常終了
 //! @retval false 異常終了
@@ -511,7 +569,9 @@ static inline bool ProxyArp_arp_send_reply(
     me6eapp_arp_analyze*       arp,
     const struct ether_addr*    target_mac,
     const struct ether_addr*    physical_mac,
-    int                         send_fd
+    int                         send_fd,
+    bool                        vnet_hdr,
+    me6e_stub_ring_t*           stub_ring
 )
 {
     // ローカル変数宣言
@@ -557,7 +617,15 @@ static inline bool ProxyArp_arp_send_reply(
     iov[2].iov_len  = sizeof(arp_eth_ip);
 
     // パケット送信
-    if(writev(send_fd, iov, 3) < 0){
+    // (パケットリング使用時は、要求元が物理デバイス側かホスト自身かで振り分ける)
+    ssize_t ret;
+    if(stub_ring != NULL){
+        ret = me6e_stub_ring_output(stub_ring, iov, 3);
+    }
+    else{
+        ret = me6e_vnet_writev(send_fd, vnet_hdr, iov, 3);
+    }
+    if(ret < 0){
         me6e_logging(LOG_ERR, "fail to send ARP Reply packet %s.", strerror(errno));
         return false;
     }
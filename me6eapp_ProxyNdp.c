@@ -37,6 +37,8 @@
 #include "me6eapp_IProcessor.h"
 #include "me6eapp_ProxyNdp.h"
 #include "me6eapp_ProxyNdp_data.h"
+#include "me6eapp_holdoff.h"
+#include "me6eapp_vnet.h"
 
 
 // デバッグ用マクロ
@@ -54,6 +56,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 struct ProxyNdpField{
         struct me6e_handler_t  *handler;               ///< ME6Eのアプリケーションハンドラー
+        me6e_holdoff_t         *holdoff;               ///< NSフラッディング抑止テーブル
 };
 typedef struct ProxyNdpField ProxyNdpField;
 
@@ -116,7 +119,7 @@ static inline void ProxyNdp_Leave_Group(const char* key, const void* value, void
 static inline void ProxyNdp_Join_Group(const char* key, const void* value, void* userdata);
 static inline int ProxyNdp_create_soli_multi_addr( struct in6_addr* prefix,
         struct in6_addr* addr, struct in6_addr* soli_multi_addr);
-static inline int ProxyNdp_na_send( int fd, struct ether_addr* srcmacaddr,
+static inline int ProxyNdp_na_send( int fd, bool vnet_hdr, me6e_stub_ring_t* stub_ring, struct ether_addr* srcmacaddr,
             struct ether_addr* dstmacaddr, struct in6_addr* srcv6addr,
             struct in6_addr* targetaddr, struct ether_addr* target_mac);
 static inline me6e_proxy_ndp_t*  ProxyNdp_init_ndp_table(me6e_config_proxy_ndp_t* conf);
@@ -128,6 +131,7 @@ static inline enum ndp_table_set_result ProxyNdp_ndp_entry_set(me6e_proxy_ndp_t*
 static inline int ProxyNdp_ndp_entry_get( me6e_proxy_ndp_t* handler,
                 const struct in6_addr*  v6daddr, struct ether_addr* macaddr);
 static inline void ProxyNdp_timeout_cb(const timer_t timerid, void* data);
+static inline bool ProxyNdp_flood_check(IProcessor* self, me6eapp_ns_na_analyze* ns);
 
 
 
@@ -232,6 +236,15 @@ static bool ProxyNdp_Init(IProcessor* self, struct me6e_handler_t *handler)
     data.solmulti_preifx = (PROXYNDP_FIELD(self)->handler->proxy_ndp_handler->solmulti_preifx);
     me6e_hashtable_foreach(handler->conf->ndp->ndp_static_entry, ProxyNdp_Join_Group, &data);
 
+    // NSフラッディング抑止テーブルの初期化
+    if (handler->conf->ndp->ndp_suppress) {
+        PROXYNDP_FIELD(self)->holdoff = me6e_holdoff_create(handler->conf->ndp->ndp_suppress_holdoff);
+        if (PROXYNDP_FIELD(self)->holdoff == NULL) {
+            me6e_logging(LOG_ERR, "fail to create proxy ndp holdoff table.");
+            return false;
+        }
+    }
+
     DEBUG_LOG("ProxyNdp_Init end.\n");
     return  true;
 }
@@ -276,6 +289,9 @@ static void ProxyNdp_Release(IProcessor* self)
         }
     }
 
+    // NSフラッディング抑止テーブルの解放
+    me6e_holdoff_destroy(PROXYNDP_FIELD(self)->holdoff);
+
     // フィールドの解放
     free(PROXYNDP_FIELD(self));
 
@@ -376,7 +392,9 @@ static bool ProxyNdp_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t r
         // NS返信
         // MACフィルタ対応 2016/09/08 chg start
         //if (ProxyNdp_na_send(fd, &target_mac,
-        if (ProxyNdp_na_send(fd, PROXYNDP_FIELD(self)->handler->conf->capsuling->bridge_hwaddr,
+        if (ProxyNdp_na_send(fd, PROXYNDP_FIELD(self)->handler->conf->capsuling->tunnel_device.option.tunnel.vnet_hdr,
+                    PROXYNDP_FIELD(self)->handler->stub_ring,
+                    PROXYNDP_FIELD(self)->handler->conf->capsuling->bridge_hwaddr,
         // MACフィルタ対応 2016/09/08 chg end
                     (struct ether_addr*)p_orig_eth_hdr->h_source,
                     &(ns.target_addr), &(ns.src_proto_addr), &target_mac) < 0) {
@@ -388,15 +406,16 @@ static bool ProxyNdp_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t r
         // 動的エントリー機能動作有無判定
         if ((PROXYNDP_FIELD(self)->handler->conf->ndp->ndp_entry_update)) {
             // 処理を継続(ProxyNDPの動的NDPエントリ更新が有効であれば、NSは転送する)
-            isContinue = true;
+            // フラッディング抑止が有効な場合は抑止時間内の転送は1回のみ
+            isContinue = ProxyNdp_flood_check(self, &ns);
         } else {
             // 処理を継続しない。
             isContinue = false;
         }
     } else {
         DEBUG_LOG("NS REQUEST No Match.\n");
-        // 次のクラスの処理を継続
-        isContinue = true;
+        // 次のクラスの処理を継続(フラッディング抑止が有効な場合は抑止時間内の転送は1回のみ)
+        isContinue = ProxyNdp_flood_check(self, &ns);
     }
 
     return  isContinue;
@@ -408,6 +427,8 @@ static bool ProxyNdp_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t r
 //! NA を送信する
 //!
 //! @param [in]     fd          ソケットディスクリプタ
+//! @param [in]     vnet_hdr    送信先トンネルデバイスの仮想NICヘッダの有効/無効
+//! @param [in]     stub_ring   Stub側パケットリング(未使用時はNULL)
 //! @param [in]     srcmacaddr  送信元MACアドレス
 //! @param [in]     dstmacaddr  送信先MACアドレス
 //! @param [in]     targetaddr  送信元IPv6アドレス
@@ -419,6 +440,8 @@ static bool ProxyNdp_RecvFromStub(IProcessor* self, char* recv_buffer, ssize_t r
 ///////////////////////////////////////////////////////////////////////////////
 static inline int ProxyNdp_na_send(
             int fd,
+            bool vnet_hdr,
+            me6e_stub_ring_t* stub_ring,
             struct ether_addr* srcmacaddr,
             struct ether_addr* dstmacaddr,
             struct in6_addr* targetaddr,
@@ -486,7 +509,15 @@ static inline int ProxyNdp_na_send(
     na.nd_na_cksum = me6e_util_pseudo_checksumv(AF_INET6, &iov[1], 4);
 
     // パケット送信
-    if(writev(fd, iov, 5) < 0){
+    // (パケットリング使用時は、要求元が物理デバイス側かホスト自身かで振り分ける)
+    ssize_t ret;
+    if(stub_ring != NULL){
+        ret = me6e_stub_ring_output(stub_ring, iov, 5);
+    }
+    else{
+        ret = me6e_vnet_writev(fd, vnet_hdr, iov, 5);
+    }
+    if(ret < 0){
         me6e_logging(LOG_ERR, "fail to send NA packet %s.", strerror(errno));
         return errno;
     }
@@ -495,6 +526,40 @@ static inline int ProxyNdp_na_send(
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+//! @brief NSフラッディング可否判定関数
+//!
+//! NSをBackboneへ転送してよいか判定する。
+//! フラッディング抑止が有効な場合、同一ターゲットへのマルチキャストNSは
+//! 抑止時間内に1回のみ転送する。ユニキャストNS(到達性確認)は常に転送する。
+//!
+//! @param [in] self    IProcessor構造体
+//! @param [in] ns      NS解析データ
+//!
+//! @retval true  転送する
+//! @retval false 転送しない(抑止時間内)
+///////////////////////////////////////////////////////////////////////////////
+static inline bool ProxyNdp_flood_check(IProcessor* self, me6eapp_ns_na_analyze* ns)
+{
+    // フラッディング抑止が無効な場合は常に転送
+    if (PROXYNDP_FIELD(self)->holdoff == NULL) {
+        return true;
+    }
+
+    // ユニキャストNSは抑止対象外
+    if (!IN6_IS_ADDR_MULTICAST(&(ns->dst_proto_addr))) {
+        return true;
+    }
+
+    if (!me6e_holdoff_check(PROXYNDP_FIELD(self)->holdoff, &(ns->target_addr))) {
+        DEBUG_LOG("NS REQUEST suppressed.\n");
+        me6e_inc_ns_suppress_count(PROXYNDP_FIELD(self)->handler->stat_info);
+        return false;
+    }
+
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //! @brief BackBoneパケット受信処理関
 //!
@@ -0,0 +1,408 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_affinity.c                                            */
+/* 機能概要   : スレッド配置/スケジューリング管理 ソースファイル              */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <ctype.h>
+#include <sys/syscall.h>
+
+#include "me6eapp_affinity.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 物理デバイスのNUMAノード番号のパス
+#define AFFINITY_NUMA_NODE_PATH     "/sys/class/net/%s/device/numa_node"
+//! メモリ配置ポリシー(指定ノードを優先、不足時は他ノードから確保)
+#define AFFINITY_MPOL_PREFERRED     1
+//! メモリ配置ポリシーのノードマスクのビット数
+#define AFFINITY_NODEMASK_BITS      (sizeof(unsigned long) * 8)
+
+///////////////////////////////////////////////////////////////////////////////
+//! スレッド配置管理情報
+///////////////////////////////////////////////////////////////////////////////
+struct affinity_info_t
+{
+    me6e_config_capsuling_t*    conf;           ///< カプセリング固有の設定
+    pthread_attr_t              control_attr;   ///< 制御スレッド生成時の属性
+    bool                        control_valid;  ///< 制御スレッド生成時の属性の有効/無効
+    int                         numa_node;      ///< Backbone側物理デバイスのNUMAノード番号(不明時は-1)
+    int                         worker_seq;     ///< 処理スレッドへCPUを割り当てた数
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部変数
+////////////////////////////////////////////////////////////////////////////////
+static struct affinity_info_t affinity_info = {
+    .conf          = NULL,
+    .control_valid = false,
+    .numa_node     = -1,
+    .worker_seq    = 0,
+};
+
+//! スレッドの種別名
+static const char* affinity_class_name[] = { "backbone", "stub", "worker", "control" };
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int affinity_read_numa_node(const char* dev);
+static void affinity_set_numa_policy(int node);
+static cpu_set_t* affinity_class_cpus(me6e_thread_class cls);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief スレッド配置初期化関数
+//!
+//! 設定を保持し、制御スレッド(タイマのコールバック)生成時の属性を作成する。
+//! NUMA配置の指定時は、Backbone側物理デバイスのNUMAノードを呼び出し元スレッドの
+//! メモリ配置の優先ノードとする(以降に確保するパケットバッファや各種テーブル、
+//! 以降に生成するスレッドへ引き継がれる)。
+//! 設定を適用できない場合は警告を出力して処理を継続する。
+//!
+//! @param [in] conf    カプセリング固有の設定
+//!
+//! @retval 0   正常終了
+//! @retval -1  異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_affinity_init(me6e_config_capsuling_t* conf)
+{
+    // ローカル変数宣言
+    char cpus[ME6E_AFFINITY_CPUS_STR_MAX];
+
+    // 引数チェック
+    if (conf == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_affinity_init).");
+        return -1;
+    }
+
+    affinity_info.conf       = conf;
+    affinity_info.worker_seq = 0;
+
+    // 制御スレッド生成時の属性
+    if (conf->control_cpus != NULL) {
+        pthread_attr_init(&affinity_info.control_attr);
+        if (pthread_attr_setaffinity_np(&affinity_info.control_attr, sizeof(cpu_set_t), conf->control_cpus) != 0) {
+            me6e_logging(LOG_WARNING, "fail to set control thread attribute. continue without control cpus.");
+            pthread_attr_destroy(&affinity_info.control_attr);
+        }
+        else {
+            affinity_info.control_valid = true;
+            me6e_logging(LOG_INFO, "control thread cpus : %s.",
+                    me6e_affinity_format_cpus(conf->control_cpus, cpus, sizeof(cpus)));
+        }
+    }
+
+    // NUMAノードの取得とメモリ配置
+    affinity_info.numa_node = affinity_read_numa_node(conf->backbone_physical_dev);
+    if (conf->numa_placement) {
+        if (affinity_info.numa_node < 0) {
+            me6e_logging(LOG_WARNING, "numa node of %s is unknown. continue without numa placement.",
+                    conf->backbone_physical_dev);
+        }
+        else {
+            affinity_set_numa_policy(affinity_info.numa_node);
+        }
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief スレッド配置解放関数
+//!
+//! @param なし
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_affinity_release(void)
+{
+    if (affinity_info.control_valid) {
+        pthread_attr_destroy(&affinity_info.control_attr);
+        affinity_info.control_valid = false;
+    }
+    affinity_info.conf = NULL;
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief スレッド配置適用関数
+//!
+//! 呼び出し元スレッドへ種別毎のCPU割り当てとスケジューリングポリシーを適用する。
+//! 処理スレッドは、指定されたCPUを起動順に1つずつ割り当てる。
+//! スケジューリングポリシーは制御スレッド以外に適用する。
+//! CPUの指定がない種別は生成元スレッドの設定を引き継ぐ。
+//!
+//! @param [in] cls     スレッドの種別
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_affinity_apply(me6e_thread_class cls)
+{
+    // ローカル変数宣言
+    me6e_config_capsuling_t*    conf = affinity_info.conf;
+    cpu_set_t*                  cpus;
+    cpu_set_t                   set;
+    struct sched_param          param;
+    char                        str[ME6E_AFFINITY_CPUS_STR_MAX];
+    int                         num, seq, cpu;
+    int                         ret;
+
+    if (conf == NULL) {
+        return;
+    }
+
+    // CPU割り当て
+    cpus = affinity_class_cpus(cls);
+    if (cpus != NULL) {
+        set = *cpus;
+        num = CPU_COUNT(cpus);
+        if ((cls == ME6E_THREAD_WORKER) && (num > 1)) {
+            // 処理スレッドは指定CPUのうち1つへ順に割り当てる
+            seq = __atomic_fetch_add(&affinity_info.worker_seq, 1, __ATOMIC_RELAXED) % num;
+            CPU_ZERO(&set);
+            for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, cpus) && (seq-- == 0)) {
+                    CPU_SET(cpu, &set);
+                    break;
+                }
+            }
+        }
+        ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+        if (ret != 0) {
+            me6e_logging(LOG_WARNING, "fail to set %s thread cpus : %s.",
+                    affinity_class_name[cls], strerror(ret));
+        }
+        else {
+            me6e_logging(LOG_INFO, "%s thread cpus : %s.",
+                    affinity_class_name[cls], me6e_affinity_format_cpus(&set, str, sizeof(str)));
+        }
+    }
+
+    // スケジューリングポリシー(データパスのスレッドのみ)
+    if ((cls != ME6E_THREAD_CONTROL) && (conf->datapath_sched == ME6E_SCHED_FIFO)) {
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = conf->datapath_priority;
+        ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (ret != 0) {
+            me6e_logging(LOG_WARNING, "fail to set %s thread SCHED_FIFO(%d) : %s.",
+                    affinity_class_name[cls], conf->datapath_priority, strerror(ret));
+        }
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 制御スレッド生成時属性取得関数
+//!
+//! タイマのコールバック等、制御スレッドを生成する際の属性を返す。
+//!
+//! @param なし
+//!
+//! @return 制御スレッド生成時の属性(CPUの指定がない場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+pthread_attr_t* me6e_affinity_control_attr(void)
+{
+    return affinity_info.control_valid ? &affinity_info.control_attr : NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief CPU番号リスト解析関数
+//!
+//! "0-3,8,10-11"形式のCPU番号リストを解析する。
+//!
+//! @param [in]  str    CPU番号リストの文字列
+//! @param [out] set    CPUセット
+//!
+//! @retval true    正常終了
+//! @retval false   異常終了(書式不正、範囲外、CPU指定なし)
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_affinity_parse_cpus(const char* str, cpu_set_t* set)
+{
+    // ローカル変数宣言
+    const char* p = str;
+    char*       end;
+    long        first, last, cpu;
+
+    // 引数チェック
+    if ((str == NULL) || (set == NULL)) {
+        return false;
+    }
+
+    CPU_ZERO(set);
+    while (*p != '\0') {
+        if (!isdigit((unsigned char)*p)) {
+            return false;
+        }
+        first = strtol(p, &end, 10);
+        last  = first;
+        p = end;
+        if (*p == '-') {
+            p++;
+            if (!isdigit((unsigned char)*p)) {
+                return false;
+            }
+            last = strtol(p, &end, 10);
+            p = end;
+        }
+        if ((first > last) || (last >= CPU_SETSIZE)) {
+            return false;
+        }
+        for (cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, set);
+        }
+        if (*p == ',') {
+            p++;
+            if (*p == '\0') {
+                return false;
+            }
+        }
+        else if (*p != '\0') {
+            return false;
+        }
+    }
+
+    return (CPU_COUNT(set) > 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief CPU番号リスト文字列変換関数
+//!
+//! CPUセットを"0-3,8"形式の文字列に変換する。
+//! 格納しきれない場合は末尾を切り詰める。
+//!
+//! @param [in]  set    CPUセット
+//! @param [out] buf    出力先
+//! @param [in]  len    出力先の長さ
+//!
+//! @return 出力先(buf)
+///////////////////////////////////////////////////////////////////////////////
+char* me6e_affinity_format_cpus(const cpu_set_t* set, char* buf, size_t len)
+{
+    // ローカル変数宣言
+    size_t  pos = 0;
+    int     cpu, last;
+    int     ret;
+
+    if (len == 0) {
+        return buf;
+    }
+    buf[0] = '\0';
+
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, set)) {
+            continue;
+        }
+        for (last = cpu; (last + 1 < CPU_SETSIZE) && CPU_ISSET(last + 1, set); last++) {
+            ;
+        }
+        if (last == cpu) {
+            ret = snprintf(buf + pos, len - pos, "%s%d", (pos > 0) ? "," : "", cpu);
+        }
+        else {
+            ret = snprintf(buf + pos, len - pos, "%s%d-%d", (pos > 0) ? "," : "", cpu, last);
+        }
+        if ((ret < 0) || ((size_t)ret >= len - pos)) {
+            break;
+        }
+        pos += ret;
+        cpu = last;
+    }
+
+    return buf;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief NUMAノード読み込み関数
+//!
+//! @param [in] dev     物理デバイス名
+//!
+//! @return NUMAノード番号(NUMA構成でない場合、取得できない場合は-1)
+///////////////////////////////////////////////////////////////////////////////
+static int affinity_read_numa_node(const char* dev)
+{
+    // ローカル変数宣言
+    char    path[128];
+    FILE*   fp;
+    int     node = -1;
+
+    if (dev == NULL) {
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), AFFINITY_NUMA_NODE_PATH, dev);
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+    if (fscanf(fp, "%d", &node) != 1) {
+        node = -1;
+    }
+    fclose(fp);
+
+    return node;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief メモリ配置ポリシー設定関数
+//!
+//! 呼び出し元スレッドのメモリ配置を指定ノード優先とする。
+//!
+//! @param [in] node    NUMAノード番号
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void affinity_set_numa_policy(int node)
+{
+    // ローカル変数宣言
+    unsigned long mask[(CPU_SETSIZE + AFFINITY_NODEMASK_BITS - 1) / AFFINITY_NODEMASK_BITS];
+
+    if ((node < 0) || (node >= CPU_SETSIZE)) {
+        return;
+    }
+
+    memset(mask, 0, sizeof(mask));
+    mask[node / AFFINITY_NODEMASK_BITS] |= 1UL << (node % AFFINITY_NODEMASK_BITS);
+
+    if (syscall(SYS_set_mempolicy, AFFINITY_MPOL_PREFERRED, mask, sizeof(mask) * 8) != 0) {
+        me6e_logging(LOG_WARNING, "fail to set memory policy to numa node %d : %s.", node, strerror(errno));
+        return;
+    }
+
+    me6e_logging(LOG_INFO, "memory is placed on numa node %d.", node);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 種別毎CPUセット取得関数
+//!
+//! @param [in] cls     スレッドの種別
+//!
+//! @return CPUセット(指定がない場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static cpu_set_t* affinity_class_cpus(me6e_thread_class cls)
+{
+    switch (cls) {
+    case ME6E_THREAD_BACKBONE:
+        return affinity_info.conf->backbone_cpus;
+    case ME6E_THREAD_STUB:
+        return affinity_info.conf->stub_cpus;
+    case ME6E_THREAD_WORKER:
+        return affinity_info.conf->worker_cpus;
+    case ME6E_THREAD_CONTROL:
+        return affinity_info.conf->control_cpus;
+    default:
+        return NULL;
+    }
+}
@@ -0,0 +1,46 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_affinity.h                                            */
+/* 機能概要   : スレッド配置/スケジューリング管理 ヘッダファイル              */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_AFFINITY_H__
+#define __ME6EAPP_AFFINITY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "me6eapp_config.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! CPU番号リストの文字列の最大長
+#define ME6E_AFFINITY_CPUS_STR_MAX  256
+
+///////////////////////////////////////////////////////////////////////////////
+//! スレッドの種別
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_thread_class
+{
+    ME6E_THREAD_BACKBONE = 0,   ///< Backbone側トンネルスレッド
+    ME6E_THREAD_STUB     = 1,   ///< Stub側トンネルスレッド
+    ME6E_THREAD_WORKER   = 2,   ///< 処理スレッド(分散受信/UDP受信/パイプライン)
+    ME6E_THREAD_CONTROL  = 3,   ///< 制御スレッド(メインループ/タイマ/送信キュー再送)
+};
+typedef enum me6e_thread_class me6e_thread_class;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+int me6e_affinity_init(me6e_config_capsuling_t* conf);
+void me6e_affinity_release(void);
+void me6e_affinity_apply(me6e_thread_class cls);
+pthread_attr_t* me6e_affinity_control_attr(void);
+bool me6e_affinity_parse_cpus(const char* str, cpu_set_t* set);
+char* me6e_affinity_format_cpus(const cpu_set_t* set, char* buf, size_t len);
+
+#endif // __ME6EAPP_AFFINITY_H__
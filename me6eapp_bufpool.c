@@ -0,0 +1,504 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_bufpool.c                                             */
+/* 機能概要   : パケットバッファプール ソースファイル                         */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <net/ethernet.h>
+
+#include "me6eapp_bufpool.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! ヒュージページのサイズ
+#define BUFPOOL_HUGEPAGE_SIZE   (2 * 1024 * 1024)
+//! バッファの配置境界(キャッシュライン)
+#define BUFPOOL_ALIGN           64
+//! 境界への切り上げ
+#define BUFPOOL_ROUNDUP(x, a)   ((((x) + (a) - 1) / (a)) * (a))
+
+///////////////////////////////////////////////////////////////////////////////
+//! スレッド毎のキャッシュ
+///////////////////////////////////////////////////////////////////////////////
+struct bufpool_cache_t
+{
+    me6e_bufpool_t*     pool;           ///< キャッシュ元のプール
+    int                 num;            ///< キャッシュしているバッファ数
+    me6e_buf_t*         list;           ///< キャッシュしているバッファ
+};
+
+//! スレッド毎のキャッシュ(MTUサイズのみ)
+static __thread struct bufpool_cache_t bufpool_cache;
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int bufpool_class_init(me6e_bufpool_class_t* cls, int cls_id, me6e_bufpool_t* pool,
+        uint32_t size, int num, int cache_max, bool hugepage);
+static void bufpool_class_release(me6e_bufpool_class_t* cls);
+static me6e_buf_t* bufpool_get(me6e_bufpool_class_t* cls, int num, int* got);
+static void bufpool_put(me6e_bufpool_class_t* cls, me6e_buf_t* head, me6e_buf_t* tail, int num);
+static void bufpool_cache_flush(void* arg);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パケットバッファプール生成関数
+//!
+//! MTUサイズとジャンボサイズのバッファを指定数ずつ確保する。
+//! MTUサイズのデータ長は、Backbone側MTUのフレーム(Ethernet/VLANヘッダ込み)を
+//! 格納できる長さとし、ME6E_BUFPOOL_MTU_SIZE_MINを下限とする。
+//!
+//! @param [in] mtu         Backbone側物理デバイスのMTU
+//! @param [in] mtu_num     MTUサイズのバッファ数
+//! @param [in] jumbo_num   ジャンボサイズのバッファ数
+//! @param [in] hugepage    ヒュージページを使用するかどうか
+//!
+//! @return 生成したプール(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_bufpool_t* me6e_bufpool_create(int mtu, int mtu_num, int jumbo_num, bool hugepage)
+{
+    // ローカル変数宣言
+    me6e_bufpool_t* pool;
+    uint32_t        mtu_size;
+
+    // 引数チェック
+    if ((mtu <= 0) || (mtu_num <= 0) || (jumbo_num <= 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_bufpool_create).");
+        return NULL;
+    }
+
+    pool = malloc(sizeof(me6e_bufpool_t));
+    if (pool == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for buffer pool.");
+        return NULL;
+    }
+    memset(pool, 0, sizeof(me6e_bufpool_t));
+
+    if (pthread_key_create(&pool->key, bufpool_cache_flush) != 0) {
+        me6e_logging(LOG_ERR, "fail to create buffer pool key.");
+        free(pool);
+        return NULL;
+    }
+
+    mtu_size = BUFPOOL_ROUNDUP(mtu + ETH_HLEN + 4, BUFPOOL_ALIGN);
+    if (mtu_size < ME6E_BUFPOOL_MTU_SIZE_MIN) {
+        mtu_size = ME6E_BUFPOOL_MTU_SIZE_MIN;
+    }
+
+    if (bufpool_class_init(&pool->cls[ME6E_BUFPOOL_CLASS_MTU], ME6E_BUFPOOL_CLASS_MTU, pool,
+                mtu_size, mtu_num, ME6E_BUFPOOL_CACHE_MAX, hugepage) != 0) {
+        pthread_key_delete(pool->key);
+        free(pool);
+        return NULL;
+    }
+
+    // ジャンボサイズはスレッドの起動時/終了時のみ確保/解放するためキャッシュしない
+    if (bufpool_class_init(&pool->cls[ME6E_BUFPOOL_CLASS_JUMBO], ME6E_BUFPOOL_CLASS_JUMBO, pool,
+                ME6E_BUFPOOL_JUMBO_SIZE, jumbo_num, 0, hugepage) != 0) {
+        bufpool_class_release(&pool->cls[ME6E_BUFPOOL_CLASS_MTU]);
+        pthread_key_delete(pool->key);
+        free(pool);
+        return NULL;
+    }
+
+    me6e_logging(LOG_INFO, "buffer pool : %d x %u bytes, %d x %u bytes (%s).",
+            mtu_num, mtu_size, jumbo_num, ME6E_BUFPOOL_JUMBO_SIZE,
+            (pool->cls[ME6E_BUFPOOL_CLASS_MTU].hugepage && pool->cls[ME6E_BUFPOOL_CLASS_JUMBO].hugepage) ?
+                "hugepage" : "normal page");
+
+    return pool;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パケットバッファプール解放関数
+//!
+//! バッファを使用するスレッドが全て終了した後に呼び出すこと。
+//!
+//! @param [in] pool    パケットバッファプール(NULLの場合は何もしない)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_bufpool_destroy(me6e_bufpool_t* pool)
+{
+    // ローカル変数宣言
+    int i;
+
+    if (pool == NULL) {
+        return;
+    }
+
+    // 呼び出し元スレッドのキャッシュを破棄
+    if (bufpool_cache.pool == pool) {
+        memset(&bufpool_cache, 0, sizeof(bufpool_cache));
+    }
+
+    for (i = 0; i < ME6E_BUFPOOL_CLASS_NUM; i++) {
+        bufpool_class_release(&pool->cls[i]);
+    }
+    pthread_key_delete(pool->key);
+    free(pool);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パケットバッファ確保関数
+//!
+//! 指定長のデータを格納できるサイズクラスからバッファを確保する。
+//! データ先頭はヘッドルームの後ろ、データ長は0で返す。
+//!
+//! @param [in] pool    パケットバッファプール
+//! @param [in] len     格納するデータ長
+//!
+//! @return 確保したバッファ(空きが無い場合、格納できない長さの場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_buf_t* me6e_buf_alloc(me6e_bufpool_t* pool, size_t len)
+{
+    // ローカル変数宣言
+    me6e_bufpool_class_t*   cls;
+    me6e_buf_t*             buf;
+    int                     got;
+
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    if (len <= pool->cls[ME6E_BUFPOOL_CLASS_MTU].size) {
+        cls = &pool->cls[ME6E_BUFPOOL_CLASS_MTU];
+
+        // スレッド毎のキャッシュから確保(空の場合は共有プールからまとめて補充)
+        if (bufpool_cache.pool != pool) {
+            bufpool_cache_flush(bufpool_cache.pool);
+            bufpool_cache.pool = pool;
+            pthread_setspecific(pool->key, pool);
+        }
+        if (bufpool_cache.num == 0) {
+            bufpool_cache.list = bufpool_get(cls, ME6E_BUFPOOL_CACHE_BATCH, &got);
+            bufpool_cache.num  = got;
+        }
+        buf = bufpool_cache.list;
+        if (buf != NULL) {
+            bufpool_cache.list = buf->next;
+            bufpool_cache.num--;
+        }
+    }
+    else if (len <= ME6E_BUFPOOL_JUMBO_SIZE) {
+        cls = &pool->cls[ME6E_BUFPOOL_CLASS_JUMBO];
+        buf = bufpool_get(cls, 1, &got);
+    }
+    else {
+        return NULL;
+    }
+
+    if (buf == NULL) {
+        __sync_fetch_and_add(&cls->fail_count, 1);
+        return NULL;
+    }
+
+    buf->next = NULL;
+    buf->head = ME6E_BUFPOOL_HEADROOM;
+    buf->len  = 0;
+    buf->hash = 0;
+
+    return buf;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パケットバッファ解放関数
+//!
+//! バッファをプールへ返却する。確保したスレッド以外から解放してもよい。
+//!
+//! @param [in] buf     パケットバッファ(NULLの場合は何もしない)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_buf_free(me6e_buf_t* buf)
+{
+    // ローカル変数宣言
+    me6e_bufpool_t*         pool;
+    me6e_bufpool_class_t*   cls;
+    me6e_buf_t*             tail;
+    int                     i;
+
+    if (buf == NULL) {
+        return;
+    }
+
+    pool = buf->pool;
+    cls  = &pool->cls[buf->cls];
+
+    if ((cls->cache_max == 0) || (bufpool_cache.pool != pool)) {
+        buf->next = NULL;
+        bufpool_put(cls, buf, buf, 1);
+        return;
+    }
+
+    // スレッド毎のキャッシュへ返却(満杯の場合は半分を共有プールへ返却)
+    buf->next = bufpool_cache.list;
+    bufpool_cache.list = buf;
+    bufpool_cache.num++;
+    if (bufpool_cache.num > cls->cache_max) {
+        buf  = bufpool_cache.list;
+        tail = buf;
+        for (i = 1; i < ME6E_BUFPOOL_CACHE_BATCH; i++) {
+            tail = tail->next;
+        }
+        bufpool_cache.list = tail->next;
+        bufpool_cache.num -= ME6E_BUFPOOL_CACHE_BATCH;
+        tail->next = NULL;
+        bufpool_put(cls, buf, tail, ME6E_BUFPOOL_CACHE_BATCH);
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パケットバッファ連結解放関数
+//!
+//! nextで連結されたバッファを全て解放する。
+//! スレッドの後始末ハンドラとして登録できるようにvoid*で受け取る。
+//!
+//! @param [in] buf     先頭のパケットバッファ(NULLの場合は何もしない)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_buf_free_list(void* buf)
+{
+    // ローカル変数宣言
+    me6e_buf_t* cur = (me6e_buf_t*)buf;
+    me6e_buf_t* next;
+
+    while (cur != NULL) {
+        next = cur->next;
+        me6e_buf_free(cur);
+        cur = next;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パケットバッファプール表示関数
+//!
+//! サイズクラス毎のバッファ数、共有プールの空き数、確保失敗数を出力する。
+//! (スレッド毎のキャッシュにあるバッファは使用中として数える)
+//!
+//! @param [in] pool    パケットバッファプール(NULLの場合は何もしない)
+//! @param [in] fd      出力先のファイルディスクリプタ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_bufpool_print(me6e_bufpool_t* pool, int fd)
+{
+    // ローカル変数宣言
+    static const char*      name[ME6E_BUFPOOL_CLASS_NUM] = { "MTU  ", "Jumbo" };
+    me6e_bufpool_class_t*   cls;
+    int                     i;
+
+    if (pool == NULL) {
+        return;
+    }
+
+    dprintf(fd, "【Buffer Pool】\n");
+    for (i = 0; i < ME6E_BUFPOOL_CLASS_NUM; i++) {
+        cls = &pool->cls[i];
+        dprintf(fd, "   %s(%5u bytes) total/free/fail  : %d / %d / %u %s\n",
+                name[i], cls->size, cls->num, cls->free_num, cls->fail_count,
+                cls->hugepage ? "(hugepage)" : "");
+    }
+    dprintf(fd, "\n");
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief サイズクラス初期化関数
+//!
+//! バッファ領域をヒュージページで確保し、確保できない場合は通常ページで
+//! 確保して透過的ヒュージページを要求する。確保した領域はmlockする。
+//!
+//! @param [out] cls        サイズクラス
+//! @param [in]  cls_id     サイズクラスの番号
+//! @param [in]  pool       所属するプール
+//! @param [in]  size       データ長(ヘッドルームを含まない)
+//! @param [in]  num        バッファ数
+//! @param [in]  cache_max  スレッド毎のキャッシュの最大数
+//! @param [in]  hugepage   ヒュージページを使用するかどうか
+//!
+//! @retval 0   正常終了
+//! @retval -1  異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int bufpool_class_init(me6e_bufpool_class_t* cls, int cls_id, me6e_bufpool_t* pool,
+        uint32_t size, int num, int cache_max, bool hugepage)
+{
+    // ローカル変数宣言
+    me6e_buf_t* buf;
+    int         i;
+
+    pthread_mutex_init(&cls->mutex, NULL);
+    cls->size      = size;
+    cls->num       = num;
+    cls->cache_max = cache_max;
+    cls->stride    = BUFPOOL_ROUNDUP(sizeof(me6e_buf_t) + ME6E_BUFPOOL_HEADROOM + size, BUFPOOL_ALIGN);
+    cls->area_len  = BUFPOOL_ROUNDUP(cls->stride * num, BUFPOOL_HUGEPAGE_SIZE);
+    cls->area      = MAP_FAILED;
+
+    if (hugepage) {
+        cls->area = mmap(NULL, cls->area_len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (cls->area == MAP_FAILED) {
+            me6e_logging(LOG_INFO, "hugepage is not available for buffer pool : %s.", strerror(errno));
+        }
+    }
+    cls->hugepage = (cls->area != MAP_FAILED);
+    if (cls->area == MAP_FAILED) {
+        cls->area = mmap(NULL, cls->area_len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (cls->area == MAP_FAILED) {
+            me6e_logging(LOG_ERR, "fail to allocate buffer pool : %s.", strerror(errno));
+            pthread_mutex_destroy(&cls->mutex);
+            return -1;
+        }
+        if (hugepage) {
+            madvise(cls->area, cls->area_len, MADV_HUGEPAGE);
+        }
+    }
+
+    // ページアウトによる遅延を防ぐ(上限を超える場合は警告のみ)
+    if (mlock(cls->area, cls->area_len) != 0) {
+        me6e_logging(LOG_WARNING, "fail to lock buffer pool : %s.", strerror(errno));
+    }
+
+    // 空きリストの作成
+    cls->free_list = NULL;
+    for (i = num - 1; i >= 0; i--) {
+        buf = (me6e_buf_t*)(cls->area + cls->stride * i);
+        buf->pool = pool;
+        buf->cls  = cls_id;
+        buf->size = ME6E_BUFPOOL_HEADROOM + size;
+        buf->next = cls->free_list;
+        cls->free_list = buf;
+    }
+    cls->free_num = num;
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief サイズクラス解放関数
+//!
+//! @param [in] cls     サイズクラス
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void bufpool_class_release(me6e_bufpool_class_t* cls)
+{
+    if ((cls->area != NULL) && (cls->area != MAP_FAILED)) {
+        munlock(cls->area, cls->area_len);
+        munmap(cls->area, cls->area_len);
+    }
+    cls->area = NULL;
+    pthread_mutex_destroy(&cls->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 共有プール取得関数
+//!
+//! 共有プールの空きリストから最大num個のバッファを取り出す。
+//!
+//! @param [in]  cls    サイズクラス
+//! @param [in]  num    取り出す最大数
+//! @param [out] got    取り出した数
+//!
+//! @return 取り出したバッファのリスト(空きが無い場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static me6e_buf_t* bufpool_get(me6e_bufpool_class_t* cls, int num, int* got)
+{
+    // ローカル変数宣言
+    me6e_buf_t* head;
+    me6e_buf_t* tail;
+    int         i;
+
+    pthread_mutex_lock(&cls->mutex);
+    head = cls->free_list;
+    if (head == NULL) {
+        pthread_mutex_unlock(&cls->mutex);
+        *got = 0;
+        return NULL;
+    }
+    tail = head;
+    for (i = 1; (i < num) && (tail->next != NULL); i++) {
+        tail = tail->next;
+    }
+    cls->free_list = tail->next;
+    cls->free_num -= i;
+    pthread_mutex_unlock(&cls->mutex);
+
+    tail->next = NULL;
+    *got = i;
+
+    return head;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 共有プール返却関数
+//!
+//! @param [in] cls     サイズクラス
+//! @param [in] head    返却するバッファのリストの先頭
+//! @param [in] tail    返却するバッファのリストの末尾
+//! @param [in] num     返却するバッファ数
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void bufpool_put(me6e_bufpool_class_t* cls, me6e_buf_t* head, me6e_buf_t* tail, int num)
+{
+    pthread_mutex_lock(&cls->mutex);
+    tail->next = cls->free_list;
+    cls->free_list = head;
+    cls->free_num += num;
+    pthread_mutex_unlock(&cls->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief スレッド毎のキャッシュ返却関数
+//!
+//! 呼び出し元スレッドのキャッシュを全て共有プールへ返却する。
+//! スレッド終了時にpthread_keyのデストラクタとして呼ばれる。
+//!
+//! @param [in] arg     キャッシュ元のプール(NULLの場合は何もしない)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void bufpool_cache_flush(void* arg)
+{
+    // ローカル変数宣言
+    me6e_bufpool_t* pool = (me6e_bufpool_t*)arg;
+    me6e_buf_t*     tail;
+
+    if ((pool == NULL) || (bufpool_cache.pool != pool)) {
+        return;
+    }
+
+    if (bufpool_cache.list != NULL) {
+        tail = bufpool_cache.list;
+        while (tail->next != NULL) {
+            tail = tail->next;
+        }
+        bufpool_put(&pool->cls[ME6E_BUFPOOL_CLASS_MTU], bufpool_cache.list, tail, bufpool_cache.num);
+    }
+    memset(&bufpool_cache, 0, sizeof(bufpool_cache));
+
+    return;
+}
@@ -0,0 +1,153 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_bufpool.h                                             */
+/* 機能概要   : パケットバッファプール ヘッダファイル                         */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_BUFPOOL_H__
+#define __ME6EAPP_BUFPOOL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! データ先頭の前に確保するヘッドルーム
+//! (Ethernet + 仮想NICヘッダ + IPv6 + UDP + EtherIPヘッダを前置できる長さ)
+#define ME6E_BUFPOOL_HEADROOM       128
+//! MTUサイズのバッファの最小データ長
+#define ME6E_BUFPOOL_MTU_SIZE_MIN   2048
+//! ジャンボサイズのバッファのデータ長(GSOフレームを格納できる長さ)
+#define ME6E_BUFPOOL_JUMBO_SIZE     (65536 + 256)
+//! スレッド毎のキャッシュに保持する最大数(MTUサイズのみ)
+#define ME6E_BUFPOOL_CACHE_MAX      64
+//! スレッド毎のキャッシュと共有プール間で一度に移動する数
+#define ME6E_BUFPOOL_CACHE_BATCH    32
+
+///////////////////////////////////////////////////////////////////////////////
+//! バッファのサイズクラス
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_bufpool_class
+{
+    ME6E_BUFPOOL_CLASS_MTU   = 0,   ///< MTUサイズ
+    ME6E_BUFPOOL_CLASS_JUMBO = 1,   ///< ジャンボサイズ
+    ME6E_BUFPOOL_CLASS_NUM
+};
+typedef enum me6e_bufpool_class me6e_bufpool_class;
+
+struct me6e_bufpool_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! パケットバッファ
+//!
+//! バッファ領域の先頭に置く管理情報。データはbuffer + headの位置から格納し、
+//! headを減らすことでヘッダをコピーせずに前置できる。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_buf_t
+{
+    struct me6e_buf_t*      next;       ///< 空きリスト/キューの次のバッファ
+    struct me6e_bufpool_t*  pool;       ///< 所属するプール
+    uint16_t                cls;        ///< サイズクラス
+    uint16_t                head;       ///< bufferの先頭からデータ先頭までの長さ
+    uint32_t                len;        ///< データ長
+    uint32_t                size;       ///< bufferの長さ(ヘッドルームを含む)
+    uint32_t                hash;       ///< フローのハッシュ値(利用者が設定)
+    char                    priv[32];   ///< 利用者領域(受け渡し時の付加情報)
+    char                    buffer[] __attribute__((aligned(64))); ///< バッファ領域
+};
+typedef struct me6e_buf_t me6e_buf_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! サイズクラス毎の共有プール
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_bufpool_class_t
+{
+    pthread_mutex_t     mutex;          ///< 排他用mutex(空きリスト)
+    char*               area;           ///< バッファ領域
+    size_t              area_len;       ///< バッファ領域の長さ
+    bool                hugepage;       ///< ヒュージページで確保したかどうか
+    size_t              stride;         ///< 1バッファあたりの長さ(管理情報を含む)
+    uint32_t            size;           ///< データ長(ヘッドルームを含まない)
+    int                 num;            ///< バッファ数
+    int                 free_num;       ///< 空きリストのバッファ数
+    me6e_buf_t*         free_list;      ///< 空きリスト
+    int                 cache_max;      ///< スレッド毎のキャッシュの最大数
+    volatile uint32_t   fail_count;     ///< 確保失敗数
+};
+typedef struct me6e_bufpool_class_t me6e_bufpool_class_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! パケットバッファプール
+//!
+//! 固定長のバッファをヒュージページ(確保できない場合は通常ページ)に
+//! 起動時に一括で確保してmlockし、MTUサイズとジャンボサイズの2つの
+//! サイズクラスで貸し出す。MTUサイズはスレッド毎のキャッシュから
+//! 排他なしで確保/解放し、キャッシュが空/満杯の時のみ共有プールと
+//! まとめて受け渡す。解放はどのスレッドから行ってもよい。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_bufpool_t
+{
+    me6e_bufpool_class_t    cls[ME6E_BUFPOOL_CLASS_NUM];    ///< サイズクラス毎の共有プール
+    pthread_key_t           key;        ///< スレッド終了時のキャッシュ返却用
+};
+typedef struct me6e_bufpool_t me6e_bufpool_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_bufpool_t* me6e_bufpool_create(int mtu, int mtu_num, int jumbo_num, bool hugepage);
+void me6e_bufpool_destroy(me6e_bufpool_t* pool);
+me6e_buf_t* me6e_buf_alloc(me6e_bufpool_t* pool, size_t len);
+void me6e_buf_free(me6e_buf_t* buf);
+void me6e_buf_free_list(void* buf);
+void me6e_bufpool_print(me6e_bufpool_t* pool, int fd);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief データ先頭取得関数
+//!
+//! @param [in] buf     パケットバッファ
+//!
+//! @return データ先頭
+///////////////////////////////////////////////////////////////////////////////
+static inline char* me6e_buf_data(me6e_buf_t* buf)
+{
+    return buf->buffer + buf->head;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief データ格納可能長取得関数
+//!
+//! @param [in] buf     パケットバッファ
+//!
+//! @return データ先頭から格納できる長さ
+///////////////////////////////////////////////////////////////////////////////
+static inline size_t me6e_buf_room(me6e_buf_t* buf)
+{
+    return buf->size - buf->head;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ヘッダ前置関数
+//!
+//! データ先頭をヘッドルーム側へ移動し、前置するヘッダの格納位置を返す。
+//!
+//! @param [in,out] buf     パケットバッファ
+//! @param [in]     len     前置するヘッダの長さ
+//!
+//! @return ヘッダの格納位置(ヘッドルームが不足する場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static inline char* me6e_buf_push(me6e_buf_t* buf, size_t len)
+{
+    if (buf->head < len) {
+        return NULL;
+    }
+    buf->head -= len;
+    buf->len  += len;
+    return buf->buffer + buf->head;
+}
+
+#endif // __ME6EAPP_BUFPOOL_H__
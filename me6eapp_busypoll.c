@@ -0,0 +1,244 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_busypoll.c                                            */
+/* 機能概要   : 適応型ビジーポーリング ソースファイル                         */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+
+#include "me6eapp_busypoll.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL            46
+#endif
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL     69
+#endif
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET     70
+#endif
+
+//! ソケットのビジーポーリング1回あたりの最大受信数
+#define BUSYPOLL_SOCK_BUDGET    64
+
+//! 受信可否の確認を繰り返す間のCPU休止
+#if defined(__x86_64__) || defined(__i386__)
+#define BUSYPOLL_CPU_RELAX()    __builtin_ia32_pause()
+#else
+#define BUSYPOLL_CPU_RELAX()    __asm__ __volatile__("" ::: "memory")
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static inline uint64_t busypoll_now_usec(void);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 適応型ビジーポーリング生成関数
+//!
+//! @param [in] name    表示名
+//! @param [in] budget  予算の上限(マイクロ秒)
+//!
+//! @return 生成した適応型ビジーポーリング(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_busypoll_t* me6e_busypoll_create(const char* name, int budget)
+{
+    // ローカル変数宣言
+    me6e_busypoll_t* busypoll;
+
+    // 引数チェック
+    if ((name == NULL) || (budget <= 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_busypoll_create).");
+        return NULL;
+    }
+
+    busypoll = malloc(sizeof(me6e_busypoll_t));
+    if (busypoll == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for busy poll.");
+        return NULL;
+    }
+    memset(busypoll, 0, sizeof(me6e_busypoll_t));
+    busypoll->name       = name;
+    busypoll->budget_max = budget;
+    busypoll->budget     = budget;
+
+    return busypoll;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 適応型ビジーポーリング解放関数
+//!
+//! @param [in] busypoll    適応型ビジーポーリング(NULLの場合は何もしない)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_busypoll_destroy(me6e_busypoll_t* busypoll)
+{
+    free(busypoll);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ソケットビジーポーリング設定関数
+//!
+//! ソケットにSO_BUSY_POLL/SO_PREFER_BUSY_POLL/SO_BUSY_POLL_BUDGETを設定し、
+//! 受信時(epollでの確認時を含む)にデバイスのキューを直接ポーリングさせる。
+//! SO_PREFER_BUSY_POLL/SO_BUSY_POLL_BUDGETはカーネルが非対応の場合は設定しない。
+//!
+//! @param [in] fd      ソケット
+//! @param [in] usec    ソケットのビジーポーリング時間(マイクロ秒)
+//!
+//! @retval 0   正常終了
+//! @retval -1  異常終了(SO_BUSY_POLLを設定できない)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_busypoll_setsockopt(int fd, int usec)
+{
+    // ローカル変数宣言
+    int value;
+
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) != 0) {
+        me6e_logging(LOG_WARNING, "fail to set SO_BUSY_POLL : %s.", strerror(errno));
+        return -1;
+    }
+
+    value = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &value, sizeof(value)) != 0) {
+        DEBUG_LOG("SO_PREFER_BUSY_POLL not supported : %s.\n", strerror(errno));
+    }
+
+    value = BUSYPOLL_SOCK_BUDGET;
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &value, sizeof(value)) != 0) {
+        DEBUG_LOG("SO_BUSY_POLL_BUDGET not supported : %s.\n", strerror(errno));
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 適応型ビジーポーリング受信待ち関数
+//!
+//! 予算の間epoll_waitをタイムアウト0で繰り返し、受信がない場合は
+//! epoll_waitで休止する。予算は以下のように調整する。
+//!  - ビジーポーリング中に受信した場合は上限まで倍増
+//!  - 受信がないまま予算を使い切ることがME6E_BUSYPOLL_IDLE_NUM回続いた場合は半減
+//!  - 休止から予算の上限以内に起床した場合は倍増(0の場合は最小値から再開)
+//!
+//! @param [in]  busypoll   適応型ビジーポーリング(NULLの場合は休止のみ)
+//! @param [in]  epfd       epollのファイルディスクリプタ
+//! @param [out] events     発生したイベント
+//! @param [in]  maxevents  イベントの最大数
+//!
+//! @return epoll_waitの戻り値
+///////////////////////////////////////////////////////////////////////////////
+int me6e_busypoll_wait(me6e_busypoll_t* busypoll, int epfd, struct epoll_event* events, int maxevents)
+{
+    // ローカル変数宣言
+    uint64_t    start, now;
+    int         num;
+
+    if (busypoll == NULL) {
+        return epoll_wait(epfd, events, maxevents, -1);
+    }
+
+    if (busypoll->budget > 0) {
+        start = busypoll_now_usec();
+        do {
+            num = epoll_wait(epfd, events, maxevents, 0);
+            now = busypoll_now_usec();
+            if (num != 0) {
+                busypoll->spin_usec += now - start;
+                if (num > 0) {
+                    busypoll->spin_count++;
+                    busypoll->idle_num = 0;
+                    busypoll->budget   = (busypoll->budget * 2 < busypoll->budget_max) ?
+                                            busypoll->budget * 2 : busypoll->budget_max;
+                }
+                return num;
+            }
+            BUSYPOLL_CPU_RELAX();
+        } while ((now - start) < (uint64_t)busypoll->budget);
+
+        // 受信がないまま予算を使い切った
+        busypoll->spin_usec += now - start;
+        if (++busypoll->idle_num >= ME6E_BUSYPOLL_IDLE_NUM) {
+            busypoll->budget  /= 2;
+            busypoll->idle_num = 0;
+        }
+    }
+
+    // 休止
+    busypoll->sleep_count++;
+    start = busypoll_now_usec();
+    num   = epoll_wait(epfd, events, maxevents, -1);
+    if ((num > 0) && ((busypoll_now_usec() - start) <= (uint64_t)busypoll->budget_max)) {
+        // ビジーポーリングしていれば受信できた間隔のため予算を戻す
+        busypoll->budget = (busypoll->budget == 0) ? ME6E_BUSYPOLL_BUDGET_MIN : busypoll->budget * 2;
+        if (busypoll->budget > busypoll->budget_max) {
+            busypoll->budget = busypoll->budget_max;
+        }
+    }
+
+    return num;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 適応型ビジーポーリング表示関数
+//!
+//! ビジーポーリング中の受信回数と休止回数、その比率、
+//! ビジーポーリングに費やした時間と現在の予算を出力する。
+//!
+//! @param [in] busypoll    適応型ビジーポーリング(NULLの場合は何もしない)
+//! @param [in] fd          出力先のファイルディスクリプタ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_busypoll_print(me6e_busypoll_t* busypoll, int fd)
+{
+    // ローカル変数宣言
+    uint64_t total;
+
+    if (busypoll == NULL) {
+        return;
+    }
+
+    total = busypoll->spin_count + busypoll->sleep_count;
+    dprintf(fd, "【Busy Poll(%s)】\n", busypoll->name);
+    dprintf(fd, "   spin/sleep           : %llu / %llu (spin %.1f%%)\n",
+            (unsigned long long)busypoll->spin_count,
+            (unsigned long long)busypoll->sleep_count,
+            (total > 0) ? ((double)busypoll->spin_count * 100 / total) : 0.0);
+    dprintf(fd, "   spin time            : %llu usec\n", (unsigned long long)busypoll->spin_usec);
+    dprintf(fd, "   budget(current/max)  : %d / %d usec\n", busypoll->budget, busypoll->budget_max);
+    dprintf(fd, "\n");
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 現在時刻取得関数
+//!
+//! @param なし
+//!
+//! @return 単調増加時刻(マイクロ秒)
+///////////////////////////////////////////////////////////////////////////////
+static inline uint64_t busypoll_now_usec(void)
+{
+    // ローカル変数宣言
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
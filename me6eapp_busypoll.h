@@ -0,0 +1,52 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_busypoll.h                                            */
+/* 機能概要   : 適応型ビジーポーリング ヘッダファイル                         */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_BUSYPOLL_H__
+#define __ME6EAPP_BUSYPOLL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 受信がないまま連続で予算を使い切った場合に予算を半減する回数
+#define ME6E_BUSYPOLL_IDLE_NUM      8
+//! 休止後に予算を再開する際の最小値(マイクロ秒)
+#define ME6E_BUSYPOLL_BUDGET_MIN    4
+
+///////////////////////////////////////////////////////////////////////////////
+//! 適応型ビジーポーリング
+//!
+//! 受信待ちの前に、予算(マイクロ秒)の間ノンブロッキングで受信可否を確認し続け、
+//! 受信がない場合のみepollで休止する。受信のない状態が続くと予算を半減して
+//! 最終的には休止のみとし、休止から短時間で起床した場合は予算を倍増して
+//! ビジーポーリングへ戻す。ループ毎に1つ生成し、そのループのスレッドのみが使用する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_busypoll_t
+{
+    const char*     name;           ///< 表示名
+    int             budget_max;     ///< 予算の上限(マイクロ秒)
+    int             budget;         ///< 現在の予算(マイクロ秒、0は休止のみ)
+    int             idle_num;       ///< 受信がないまま連続で予算を使い切った回数
+    uint64_t        spin_count;     ///< ビジーポーリング中に受信した回数
+    uint64_t        sleep_count;    ///< 休止した回数
+    uint64_t        spin_usec;      ///< ビジーポーリングに費やした時間(マイクロ秒)
+};
+typedef struct me6e_busypoll_t me6e_busypoll_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_busypoll_t* me6e_busypoll_create(const char* name, int budget);
+void me6e_busypoll_destroy(me6e_busypoll_t* busypoll);
+int me6e_busypoll_setsockopt(int fd, int usec);
+int me6e_busypoll_wait(me6e_busypoll_t* busypoll, int epfd, struct epoll_event* events, int maxevents);
+void me6e_busypoll_print(me6e_busypoll_t* busypoll, int fd);
+
+#endif // __ME6EAPP_BUSYPOLL_H__
@@ -39,6 +39,7 @@ enum me6e_command_code
     ME6E_SHOW_PR,              ///< PRテーブルエントリの表示
     ME6E_LOAD_PR,              ///< PR-Commandファイル読み込み
     ME6E_SHUTDOWN,             ///< シャットダウン指示
+    ME6E_SHOW_PEER,            ///< ME6Eピア監視状態表示
     ME6E_COMMAND_MAX
 };
 
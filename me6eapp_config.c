@@ -24,6 +24,7 @@
 #include "me6eapp_config.h"
 #include "me6eapp_log.h"
 #include "me6eapp_pr.h"
+#include "me6eapp_affinity.h"
 
 
 //! 設定ファイルを読込む場合の１行あたりの最大文字数
@@ -57,8 +58,52 @@
 
 #define CONFIG_MTU_MIN 1280
 #define CONFIG_MTU_MAX 65521
+#define CONFIG_TUN_MTU_AUTO "auto"
 #define CONFIG_MTU_DEFAULT 1500
 
+#define CONFIG_STUB_BACKEND_BRIDGE "bridge"
+#define CONFIG_STUB_BACKEND_PACKET "packet"
+#define CONFIG_STUB_BACKEND_XDP    "xdp"
+#define CONFIG_IO_ENGINE_EPOLL     "epoll"
+#define CONFIG_IO_ENGINE_URING     "io_uring"
+#define CONFIG_TRANSPORT_ETHERIP   "etherip"
+#define CONFIG_TRANSPORT_UDP       "udp"
+#define CONFIG_SCHED_OTHER         "other"
+#define CONFIG_SCHED_FIFO          "fifo"
+#define CONFIG_TXQ_POLICY_TAIL     "tail"
+#define CONFIG_TXQ_POLICY_PRIORITY "priority"
+
+#define CONFIG_BB_FANOUT_MIN 0
+#define CONFIG_BB_FANOUT_MAX 16
+#define CONFIG_UDP_PORT_MIN 1
+#define CONFIG_UDP_PORT_MAX 65535
+#define CONFIG_UDP_PORT_DEFAULT 9797
+#define CONFIG_UDP_WORKERS_MIN 1
+#define CONFIG_UDP_WORKERS_MAX 16
+#define CONFIG_BUFFER_POOL_NUM_MIN 256
+#define CONFIG_BUFFER_POOL_NUM_MAX 1048576
+#define CONFIG_BUFFER_POOL_NUM_DEFAULT 8192
+#define CONFIG_BUFFER_POOL_JUMBO_NUM_MIN 16
+#define CONFIG_BUFFER_POOL_JUMBO_NUM_MAX 4096
+#define CONFIG_BUFFER_POOL_JUMBO_NUM_DEFAULT 64
+#define CONFIG_PIPELINE_WORKERS_MIN 0
+#define CONFIG_PIPELINE_WORKERS_MAX 16
+#define CONFIG_PIPELINE_RING_SIZE_MIN 64
+#define CONFIG_PIPELINE_RING_SIZE_MAX 65536
+#define CONFIG_PIPELINE_RING_SIZE_DEFAULT 1024
+#define CONFIG_DATAPATH_PRIORITY_MIN 1
+#define CONFIG_DATAPATH_PRIORITY_MAX 99
+#define CONFIG_DATAPATH_PRIORITY_DEFAULT 10
+#define CONFIG_BUSY_POLL_USEC_MIN 0
+#define CONFIG_BUSY_POLL_USEC_MAX 1000
+#define CONFIG_BUSY_POLL_USEC_DEFAULT 50
+#define CONFIG_BUSY_POLL_BUDGET_MIN 1
+#define CONFIG_BUSY_POLL_BUDGET_MAX 10000
+#define CONFIG_BUSY_POLL_BUDGET_DEFAULT 100
+#define CONFIG_TX_QUEUE_LEN_MIN 0
+#define CONFIG_TX_QUEUE_LEN_MAX 65536
+#define CONFIG_TX_QUEUE_LEN_DEFAULT 0
+
 #define CONFIG_DEVICE_MTU_MIN 548
 #define CONFIG_DEVICE_MTU_MAX 65521
 
@@ -95,6 +140,26 @@
 #define CONFIG_NDP_ENTRY_MIN 1
 #define CONFIG_NDP_ENTRY_MAX 65535
 
+#define CONFIG_SUPPRESS_HOLDOFF_MIN 1
+#define CONFIG_SUPPRESS_HOLDOFF_MAX 3600
+#define CONFIG_SUPPRESS_HOLDOFF_DEFAULT 5
+
+#define CONFIG_PEER_PROBE_INTERVAL_MIN 1
+#define CONFIG_PEER_PROBE_INTERVAL_MAX 60
+#define CONFIG_PEER_PROBE_INTERVAL_DEFAULT 1
+
+#define CONFIG_PEER_PROBE_DEAD_COUNT_MIN 1
+#define CONFIG_PEER_PROBE_DEAD_COUNT_MAX 100
+#define CONFIG_PEER_PROBE_DEAD_COUNT_DEFAULT 3
+
+#define CONFIG_MCAST_MEMBER_TIMEOUT_MIN 1
+#define CONFIG_MCAST_MEMBER_TIMEOUT_MAX 3600
+#define CONFIG_MCAST_MEMBER_TIMEOUT_DEFAULT 260
+
+#define CONFIG_PMTU_EXPIRE_MIN 60
+#define CONFIG_PMTU_EXPIRE_MAX 3600
+#define CONFIG_PMTU_EXPIRE_DEFAULT 600
+
 #define CONFIG_MAC_ENTRY_MIN 1
 #define CONFIG_MAC_ENTRY_MAX 65535
 
@@ -118,13 +183,48 @@
 #define SECTION_CAPSULING_HOP_LIMIT         "hop_limit"
 #define SECTION_CAPSULING_BB_PHY_DEV        "backbone_physical_dev"
 #define SECTION_CAPSULING_SB_PHY_DEV        "stub_physical_dev"
+#define SECTION_CAPSULING_SB_BACKEND        "stub_backend"
 #define SECTION_CAPSULING_TUN_NAME          "tunnel_name"
 #define SECTION_CAPSULING_TUN_MTU           "tunnel_mtu"
+#define SECTION_CAPSULING_TUN_OFFLOAD       "tunnel_offload"
+#define SECTION_CAPSULING_TUN_GRO           "tunnel_gro"
+#define SECTION_CAPSULING_IO_ENGINE         "io_engine"
+#define SECTION_CAPSULING_BB_FANOUT         "backbone_fanout"
+#define SECTION_CAPSULING_BB_L2_FASTPATH    "backbone_l2_fastpath"
+#define SECTION_CAPSULING_TRANSPORT         "transport"
+#define SECTION_CAPSULING_UDP_PORT          "udp_port"
+#define SECTION_CAPSULING_UDP_WORKERS       "udp_workers"
+#define SECTION_CAPSULING_BUFFER_POOL_NUM   "buffer_pool_num"
+#define SECTION_CAPSULING_BUFFER_POOL_JUMBO "buffer_pool_jumbo_num"
+#define SECTION_CAPSULING_BUFFER_POOL_HUGE  "buffer_pool_hugepage"
+#define SECTION_CAPSULING_PIPELINE_WORKERS  "pipeline_workers"
+#define SECTION_CAPSULING_PIPELINE_RING     "pipeline_ring_size"
+#define SECTION_CAPSULING_BACKBONE_CPUS     "backbone_cpus"
+#define SECTION_CAPSULING_STUB_CPUS         "stub_cpus"
+#define SECTION_CAPSULING_WORKER_CPUS       "worker_cpus"
+#define SECTION_CAPSULING_CONTROL_CPUS      "control_cpus"
+#define SECTION_CAPSULING_DATAPATH_SCHED    "datapath_sched"
+#define SECTION_CAPSULING_DATAPATH_PRIORITY "datapath_priority"
+#define SECTION_CAPSULING_NUMA_PLACEMENT    "numa_placement"
+#define SECTION_CAPSULING_BUSY_POLL         "busy_poll"
+#define SECTION_CAPSULING_BUSY_POLL_USEC    "busy_poll_usec"
+#define SECTION_CAPSULING_BUSY_POLL_BUDGET  "busy_poll_budget"
+#define SECTION_CAPSULING_TX_QUEUE_LEN     "tx_queue_len"
+#define SECTION_CAPSULING_TX_QUEUE_POLICY  "tx_queue_policy"
 #define SECTION_CAPSULING_TUN_HWADDR        "tunnel_hwaddr"
 #define SECTION_CAPSULING_BRG_NAME          "bridge_name"
 #define SECTION_CAPSULING_BRG_HWADDR        "bridge_hwaddr"		// MACフィルタ対応 2016/09/12 add
 #define SECTION_CAPSULING_L2MULTI_L3UNI     "l2multi_l3uni"
 #define SECTION_CAPSULING_HOST_ADDRESS      "me6e_host_address"
+#define SECTION_CAPSULING_PEER_PROBE        "peer_probe"
+#define SECTION_CAPSULING_PEER_PROBE_INTERVAL "peer_probe_interval"
+#define SECTION_CAPSULING_PEER_PROBE_DEAD_COUNT "peer_probe_dead_count"
+#define SECTION_CAPSULING_MCAST_GROUP_MAP   "multicast_group_map"
+#define SECTION_CAPSULING_MCAST_MEMBER_TIMEOUT "multicast_member_timeout"
+#define SECTION_CAPSULING_FLOW_LABEL        "flow_label"
+#define SECTION_CAPSULING_PMTU_DISCOVERY    "path_mtu_discovery"
+#define SECTION_CAPSULING_PMTU_EXPIRE       "path_mtu_expire"
+#define SECTION_CAPSULING_TCP_MSS_CLAMP     "tcp_mss_clamp"
 #define SECTION_CAPSULING_PR_UNICAST_PREFIX "me6e_pr_unicast_prefix"
 
 
@@ -134,6 +234,8 @@
 #define SECTION_PROXY_ARP_ENTRY_UPDATE      "arp_entry_update"
 #define SECTION_PROXY_ARP_AGING_TIME        "arp_aging_time"
 #define SECTION_PROXY_ARP_ENTRY_MAX         "arp_entry_max"
+#define SECTION_PROXY_ARP_SUPPRESS          "arp_suppress"
+#define SECTION_PROXY_ARP_SUPPRESS_HOLDOFF  "arp_suppress_holdoff"
 
 // 代理NDP固有の設定
 #define SECTION_PROXY_NDP                   "proxy_ndp"
@@ -141,6 +243,8 @@
 #define SECTION_PROXY_NDP_ENTRY_UPDATE      "ndp_entry_update"
 #define SECTION_PROXY_NDP_AGING_TIME        "ndp_aging_time"
 #define SECTION_PROXY_NDP_ENTRY_MAX         "ndp_entry_max"
+#define SECTION_PROXY_NDP_SUPPRESS          "ndp_suppress"
+#define SECTION_PROXY_NDP_SUPPRESS_HOLDOFF  "ndp_suppress_holdoff"
 
 // MAC管理固有の設定
 #define SECTION_MNG_MACADDR                 "mng_macaddr"
@@ -223,6 +327,7 @@ static bool config_is_section(const char* str, config_section* section);
 static bool config_is_keyvalue(const char* line_str, config_keyvalue_t* kv);
 static bool parse_bool(const char* str, bool* output);
 static bool parse_int(const char* str, int* output, const int min, const int max);
+static bool parse_cpus(const char* str, cpu_set_t** output);
 
 ///////////////////////////////////////////////////////////////////////////////
 //! 設定ファイル解析用テーブル
@@ -482,6 +587,7 @@ void me6e_config_dump(const me6e_config_t* config, int fd)
     // ローカル変数宣言
     char address[INET6_ADDRSTRLEN] = { 0 };
     char macaddrstr[MAC_ADDRSTRLEN] = { 0 };
+    char cpus[ME6E_AFFINITY_CPUS_STR_MAX] = { 0 };
     char* strbool[] = { CONFIG_BOOL_FALSE, CONFIG_BOOL_TRUE };
 
     // 引数チェック
@@ -534,8 +640,61 @@ void me6e_config_dump(const me6e_config_t* config, int fd)
         dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_HOP_LIMIT, config->capsuling->hop_limit);
         dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_BB_PHY_DEV, config->capsuling->backbone_physical_dev);
         dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_SB_PHY_DEV, config->capsuling->stub_physical_dev);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_SB_BACKEND,
+                (config->capsuling->stub_backend == ME6E_STUB_BACKEND_XDP) ? CONFIG_STUB_BACKEND_XDP :
+                (config->capsuling->stub_backend == ME6E_STUB_BACKEND_PACKET) ?
+                    CONFIG_STUB_BACKEND_PACKET : CONFIG_STUB_BACKEND_BRIDGE);
         dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_TUN_NAME, config->capsuling->tunnel_device.name);
-        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_TUN_MTU, config->capsuling->tunnel_device.mtu);
+        if(config->capsuling->tunnel_mtu_auto){
+            dprintf(fd, "    %s = %s(%d)\n", SECTION_CAPSULING_TUN_MTU, CONFIG_TUN_MTU_AUTO,
+                                                config->capsuling->tunnel_device.mtu);
+        }
+        else{
+            dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_TUN_MTU, config->capsuling->tunnel_device.mtu);
+        }
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_TUN_OFFLOAD, strbool[config->capsuling->tunnel_offload]);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_TUN_GRO, strbool[config->capsuling->tunnel_gro]);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_IO_ENGINE,
+                (config->capsuling->io_engine == ME6E_IO_ENGINE_URING) ?
+                    CONFIG_IO_ENGINE_URING : CONFIG_IO_ENGINE_EPOLL);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_BB_FANOUT, config->capsuling->backbone_fanout);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_BB_L2_FASTPATH, strbool[config->capsuling->backbone_l2_fastpath]);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_TRANSPORT,
+                (config->capsuling->transport == ME6E_TRANSPORT_UDP) ?
+                    CONFIG_TRANSPORT_UDP : CONFIG_TRANSPORT_ETHERIP);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_UDP_PORT, config->capsuling->udp_port);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_UDP_WORKERS, config->capsuling->udp_workers);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_BUFFER_POOL_NUM, config->capsuling->buffer_pool_num);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_BUFFER_POOL_JUMBO, config->capsuling->buffer_pool_jumbo_num);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_BUFFER_POOL_HUGE, strbool[config->capsuling->buffer_pool_hugepage]);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_PIPELINE_WORKERS, config->capsuling->pipeline_workers);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_PIPELINE_RING, config->capsuling->pipeline_ring_size);
+        if(config->capsuling->backbone_cpus != NULL){
+            dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_BACKBONE_CPUS,
+                    me6e_affinity_format_cpus(config->capsuling->backbone_cpus, cpus, sizeof(cpus)));
+        }
+        if(config->capsuling->stub_cpus != NULL){
+            dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_STUB_CPUS,
+                    me6e_affinity_format_cpus(config->capsuling->stub_cpus, cpus, sizeof(cpus)));
+        }
+        if(config->capsuling->worker_cpus != NULL){
+            dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_WORKER_CPUS,
+                    me6e_affinity_format_cpus(config->capsuling->worker_cpus, cpus, sizeof(cpus)));
+        }
+        if(config->capsuling->control_cpus != NULL){
+            dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_CONTROL_CPUS,
+                    me6e_affinity_format_cpus(config->capsuling->control_cpus, cpus, sizeof(cpus)));
+        }
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_DATAPATH_SCHED,
+                (config->capsuling->datapath_sched == ME6E_SCHED_FIFO) ? CONFIG_SCHED_FIFO : CONFIG_SCHED_OTHER);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_DATAPATH_PRIORITY, config->capsuling->datapath_priority);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_NUMA_PLACEMENT, strbool[config->capsuling->numa_placement]);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_BUSY_POLL, strbool[config->capsuling->busy_poll]);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_BUSY_POLL_USEC, config->capsuling->busy_poll_usec);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_BUSY_POLL_BUDGET, config->capsuling->busy_poll_budget);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_TX_QUEUE_LEN, config->capsuling->tx_queue_len);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_TX_QUEUE_POLICY,
+                (config->capsuling->tx_queue_policy == ME6E_TXQ_POLICY_PRIORITY) ? CONFIG_TXQ_POLICY_PRIORITY : CONFIG_TXQ_POLICY_TAIL);
         if(config->capsuling->tunnel_device.hwaddr != NULL){
             dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_TUN_HWADDR, ether_ntoa_r(
                                     config->capsuling->tunnel_device.hwaddr, macaddrstr));
@@ -557,6 +716,15 @@ void me6e_config_dump(const me6e_config_t* config, int fd)
                 inet_ntop(AF_INET6, host, address, sizeof(address)));
             }
         }
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_PEER_PROBE, strbool[config->capsuling->peer_probe]);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_PEER_PROBE_INTERVAL, config->capsuling->peer_probe_interval);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_PEER_PROBE_DEAD_COUNT, config->capsuling->peer_probe_dead_count);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_MCAST_GROUP_MAP, strbool[config->capsuling->mcast_group_map]);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_MCAST_MEMBER_TIMEOUT, config->capsuling->mcast_member_timeout);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_FLOW_LABEL, strbool[config->capsuling->flow_label]);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_PMTU_DISCOVERY, strbool[config->capsuling->pmtu_discovery]);
+        dprintf(fd, "    %s = %d\n", SECTION_CAPSULING_PMTU_EXPIRE, config->capsuling->pmtu_expire);
+        dprintf(fd, "    %s = %s\n", SECTION_CAPSULING_TCP_MSS_CLAMP, strbool[config->capsuling->tcp_mss_clamp]);
         if(config->common->tunnel_mode == ME6E_TUNNEL_MODE_PR){
             dprintf(fd, "    %s = %s/%d\n",
                 SECTION_CAPSULING_PR_UNICAST_PREFIX,
@@ -574,6 +742,8 @@ void me6e_config_dump(const me6e_config_t* config, int fd)
         dprintf(fd, "    %s = %s\n", SECTION_PROXY_NDP_ENTRY_UPDATE, strbool[config->arp->arp_entry_update]);
         dprintf(fd, "    %s = %d\n", SECTION_PROXY_ARP_AGING_TIME, config->arp->arp_aging_time);
         dprintf(fd, "    %s = %d\n", SECTION_PROXY_ARP_ENTRY_MAX, config->arp->arp_entry_max);
+        dprintf(fd, "    %s = %s\n", SECTION_PROXY_ARP_SUPPRESS, strbool[config->arp->arp_suppress]);
+        dprintf(fd, "    %s = %d\n", SECTION_PROXY_ARP_SUPPRESS_HOLDOFF, config->arp->arp_suppress_holdoff);
         dprintf(fd, "                IPv4 Address                |     MAC Addr         \n");
         dprintf(fd, "    ----------------------------------------+----------------------\n");
         me6e_hashtable_foreach(config->arp->arp_static_entry, conf_print_hash_table, &fd);
@@ -588,6 +758,8 @@ void me6e_config_dump(const me6e_config_t* config, int fd)
         dprintf(fd, "    %s = %s\n", SECTION_PROXY_NDP_ENTRY_UPDATE, strbool[config->ndp->ndp_entry_update]);
         dprintf(fd, "    %s = %d\n", SECTION_PROXY_NDP_AGING_TIME, config->ndp->ndp_aging_time);
         dprintf(fd, "    %s = %d\n", SECTION_PROXY_NDP_ENTRY_MAX, config->ndp->ndp_entry_max);
+        dprintf(fd, "    %s = %s\n", SECTION_PROXY_NDP_SUPPRESS, strbool[config->ndp->ndp_suppress]);
+        dprintf(fd, "    %s = %d\n", SECTION_PROXY_NDP_SUPPRESS_HOLDOFF, config->ndp->ndp_suppress_holdoff);
         dprintf(fd, "                IPv6 Address                |     MAC Addr         \n");
         dprintf(fd, "    ----------------------------------------+----------------------\n");
         me6e_hashtable_foreach(config->ndp->ndp_static_entry, conf_print_hash_table, &fd);
@@ -993,15 +1165,52 @@ static bool config_init_capsuling(me6e_config_t* config)
     config->capsuling->tunnel_device.ipv6_address       = NULL; // 未使用
     config->capsuling->tunnel_device.ipv6_prefixlen     = -1;   // 未使用
     config->capsuling->tunnel_device.mtu                = -1;
+    config->capsuling->tunnel_mtu_auto                  = true;
     config->capsuling->tunnel_device.hwaddr             = NULL;
     config->capsuling->tunnel_device.ifindex            = -1;
     config->capsuling->tunnel_device.option.tunnel.mode = IFF_TAP;
     config->capsuling->tunnel_device.option.tunnel.fd   = -1;
+    config->capsuling->tunnel_device.option.tunnel.vnet_hdr = false;
+    config->capsuling->tunnel_offload                   = true;
+    config->capsuling->tunnel_gro                       = true;
+    config->capsuling->io_engine                        = ME6E_IO_ENGINE_EPOLL;
+    config->capsuling->backbone_fanout                  = 0;
+    config->capsuling->backbone_l2_fastpath             = false;
+    config->capsuling->transport                        = ME6E_TRANSPORT_ETHERIP;
+    config->capsuling->udp_port                         = CONFIG_UDP_PORT_DEFAULT;
+    config->capsuling->udp_workers                      = 1;
+    config->capsuling->buffer_pool_num                  = CONFIG_BUFFER_POOL_NUM_DEFAULT;
+    config->capsuling->buffer_pool_jumbo_num            = CONFIG_BUFFER_POOL_JUMBO_NUM_DEFAULT;
+    config->capsuling->buffer_pool_hugepage             = true;
+    config->capsuling->pipeline_workers                 = 0;
+    config->capsuling->pipeline_ring_size               = CONFIG_PIPELINE_RING_SIZE_DEFAULT;
+    config->capsuling->backbone_cpus                    = NULL;
+    config->capsuling->stub_cpus                        = NULL;
+    config->capsuling->worker_cpus                      = NULL;
+    config->capsuling->control_cpus                     = NULL;
+    config->capsuling->datapath_sched                   = ME6E_SCHED_OTHER;
+    config->capsuling->datapath_priority                = CONFIG_DATAPATH_PRIORITY_DEFAULT;
+    config->capsuling->numa_placement                   = false;
+    config->capsuling->busy_poll                        = false;
+    config->capsuling->busy_poll_usec                   = CONFIG_BUSY_POLL_USEC_DEFAULT;
+    config->capsuling->busy_poll_budget                 = CONFIG_BUSY_POLL_BUDGET_DEFAULT;
+    config->capsuling->tx_queue_len                     = CONFIG_TX_QUEUE_LEN_DEFAULT;
+    config->capsuling->tx_queue_policy                  = ME6E_TXQ_POLICY_TAIL;
+    config->capsuling->stub_backend                     = ME6E_STUB_BACKEND_BRIDGE;
 
     config->capsuling->bridge_name                      = NULL;
     config->capsuling->bridge_hwaddr                    = NULL;  // MACフィルタ対応　2016/09/12 add
     config->capsuling->l2multi_l3uni                    = false;
     me6e_list_init(&(config->capsuling->me6e_host_address_list));
+    config->capsuling->peer_probe                       = false;
+    config->capsuling->peer_probe_interval              = CONFIG_PEER_PROBE_INTERVAL_DEFAULT;
+    config->capsuling->peer_probe_dead_count            = CONFIG_PEER_PROBE_DEAD_COUNT_DEFAULT;
+    config->capsuling->mcast_group_map                  = false;
+    config->capsuling->mcast_member_timeout             = CONFIG_MCAST_MEMBER_TIMEOUT_DEFAULT;
+    config->capsuling->flow_label                       = true;
+    config->capsuling->pmtu_discovery                   = true;
+    config->capsuling->pmtu_expire                      = CONFIG_PMTU_EXPIRE_DEFAULT;
+    config->capsuling->tcp_mss_clamp                    = false;
 
     return true;
 }
@@ -1035,6 +1244,10 @@ static void config_destruct_capsuling(me6e_config_capsuling_t* capsuling)
     free(capsuling->bridge_hwaddr);			// MACフィルタ対応　2016/09/12 add
     free(capsuling->me6e_pr_unicast_prefix);
     free(capsuling->pr_unicast_prefixplaneid);
+    free(capsuling->backbone_cpus);
+    free(capsuling->stub_cpus);
+    free(capsuling->worker_cpus);
+    free(capsuling->control_cpus);
 
     while(!me6e_list_empty(&capsuling->me6e_host_address_list)){
         me6e_list* node = capsuling->me6e_host_address_list.next;
@@ -1187,7 +1400,171 @@ static bool config_parse_capsuling(
     }
     else if(!strcasecmp(SECTION_CAPSULING_TUN_MTU, kv->key)){
         DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_TUN_MTU);
-        result = parse_int(kv->value, &config->capsuling->tunnel_device.mtu, CONFIG_MTU_MIN, CONFIG_MTU_MAX);
+        if(!strcasecmp(CONFIG_TUN_MTU_AUTO, kv->value)){
+            config->capsuling->tunnel_mtu_auto = true;
+        }
+        else{
+            config->capsuling->tunnel_mtu_auto = false;
+            result = parse_int(kv->value, &config->capsuling->tunnel_device.mtu, CONFIG_MTU_MIN, CONFIG_MTU_MAX);
+        }
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_SB_BACKEND, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_SB_BACKEND);
+        if(!strcasecmp(CONFIG_STUB_BACKEND_BRIDGE, kv->value)){
+            config->capsuling->stub_backend = ME6E_STUB_BACKEND_BRIDGE;
+        }
+        else if(!strcasecmp(CONFIG_STUB_BACKEND_PACKET, kv->value)){
+            config->capsuling->stub_backend = ME6E_STUB_BACKEND_PACKET;
+        }
+        else if(!strcasecmp(CONFIG_STUB_BACKEND_XDP, kv->value)){
+            config->capsuling->stub_backend = ME6E_STUB_BACKEND_XDP;
+        }
+        else{
+            result = false;
+        }
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_TUN_OFFLOAD, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_TUN_OFFLOAD);
+        result = parse_bool(kv->value, &config->capsuling->tunnel_offload);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_TUN_GRO, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_TUN_GRO);
+        result = parse_bool(kv->value, &config->capsuling->tunnel_gro);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_IO_ENGINE, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_IO_ENGINE);
+        if(!strcasecmp(CONFIG_IO_ENGINE_EPOLL, kv->value)){
+            config->capsuling->io_engine = ME6E_IO_ENGINE_EPOLL;
+        }
+        else if(!strcasecmp(CONFIG_IO_ENGINE_URING, kv->value)){
+            config->capsuling->io_engine = ME6E_IO_ENGINE_URING;
+        }
+        else{
+            result = false;
+        }
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BB_FANOUT, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BB_FANOUT);
+        result = parse_int(kv->value, &config->capsuling->backbone_fanout,
+                                CONFIG_BB_FANOUT_MIN, CONFIG_BB_FANOUT_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BB_L2_FASTPATH, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BB_L2_FASTPATH);
+        result = parse_bool(kv->value, &config->capsuling->backbone_l2_fastpath);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_TRANSPORT, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_TRANSPORT);
+        if(!strcasecmp(CONFIG_TRANSPORT_ETHERIP, kv->value)){
+            config->capsuling->transport = ME6E_TRANSPORT_ETHERIP;
+        }
+        else if(!strcasecmp(CONFIG_TRANSPORT_UDP, kv->value)){
+            config->capsuling->transport = ME6E_TRANSPORT_UDP;
+        }
+        else{
+            result = false;
+        }
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_UDP_PORT, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_UDP_PORT);
+        result = parse_int(kv->value, &config->capsuling->udp_port,
+                                CONFIG_UDP_PORT_MIN, CONFIG_UDP_PORT_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_UDP_WORKERS, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_UDP_WORKERS);
+        result = parse_int(kv->value, &config->capsuling->udp_workers,
+                                CONFIG_UDP_WORKERS_MIN, CONFIG_UDP_WORKERS_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BUFFER_POOL_NUM, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BUFFER_POOL_NUM);
+        result = parse_int(kv->value, &config->capsuling->buffer_pool_num,
+                                CONFIG_BUFFER_POOL_NUM_MIN, CONFIG_BUFFER_POOL_NUM_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BUFFER_POOL_JUMBO, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BUFFER_POOL_JUMBO);
+        result = parse_int(kv->value, &config->capsuling->buffer_pool_jumbo_num,
+                                CONFIG_BUFFER_POOL_JUMBO_NUM_MIN, CONFIG_BUFFER_POOL_JUMBO_NUM_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BUFFER_POOL_HUGE, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BUFFER_POOL_HUGE);
+        result = parse_bool(kv->value, &config->capsuling->buffer_pool_hugepage);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_PIPELINE_WORKERS, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_PIPELINE_WORKERS);
+        result = parse_int(kv->value, &config->capsuling->pipeline_workers,
+                                CONFIG_PIPELINE_WORKERS_MIN, CONFIG_PIPELINE_WORKERS_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_PIPELINE_RING, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_PIPELINE_RING);
+        result = parse_int(kv->value, &config->capsuling->pipeline_ring_size,
+                                CONFIG_PIPELINE_RING_SIZE_MIN, CONFIG_PIPELINE_RING_SIZE_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BACKBONE_CPUS, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BACKBONE_CPUS);
+        result = parse_cpus(kv->value, &config->capsuling->backbone_cpus);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_STUB_CPUS, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_STUB_CPUS);
+        result = parse_cpus(kv->value, &config->capsuling->stub_cpus);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_WORKER_CPUS, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_WORKER_CPUS);
+        result = parse_cpus(kv->value, &config->capsuling->worker_cpus);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_CONTROL_CPUS, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_CONTROL_CPUS);
+        result = parse_cpus(kv->value, &config->capsuling->control_cpus);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_DATAPATH_SCHED, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_DATAPATH_SCHED);
+        if(!strcasecmp(CONFIG_SCHED_OTHER, kv->value)){
+            config->capsuling->datapath_sched = ME6E_SCHED_OTHER;
+        }
+        else if(!strcasecmp(CONFIG_SCHED_FIFO, kv->value)){
+            config->capsuling->datapath_sched = ME6E_SCHED_FIFO;
+        }
+        else{
+            result = false;
+        }
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_DATAPATH_PRIORITY, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_DATAPATH_PRIORITY);
+        result = parse_int(kv->value, &config->capsuling->datapath_priority,
+                                CONFIG_DATAPATH_PRIORITY_MIN, CONFIG_DATAPATH_PRIORITY_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_NUMA_PLACEMENT, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_NUMA_PLACEMENT);
+        result = parse_bool(kv->value, &config->capsuling->numa_placement);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BUSY_POLL, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BUSY_POLL);
+        result = parse_bool(kv->value, &config->capsuling->busy_poll);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BUSY_POLL_USEC, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BUSY_POLL_USEC);
+        result = parse_int(kv->value, &config->capsuling->busy_poll_usec,
+                                CONFIG_BUSY_POLL_USEC_MIN, CONFIG_BUSY_POLL_USEC_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_BUSY_POLL_BUDGET, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_BUSY_POLL_BUDGET);
+        result = parse_int(kv->value, &config->capsuling->busy_poll_budget,
+                                CONFIG_BUSY_POLL_BUDGET_MIN, CONFIG_BUSY_POLL_BUDGET_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_TX_QUEUE_LEN, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_TX_QUEUE_LEN);
+        result = parse_int(kv->value, &config->capsuling->tx_queue_len,
+                                CONFIG_TX_QUEUE_LEN_MIN, CONFIG_TX_QUEUE_LEN_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_TX_QUEUE_POLICY, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_TX_QUEUE_POLICY);
+        if(!strcasecmp(CONFIG_TXQ_POLICY_TAIL, kv->value)){
+            config->capsuling->tx_queue_policy = ME6E_TXQ_POLICY_TAIL;
+        }
+        else if(!strcasecmp(CONFIG_TXQ_POLICY_PRIORITY, kv->value)){
+            config->capsuling->tx_queue_policy = ME6E_TXQ_POLICY_PRIORITY;
+        }
+        else{
+            result = false;
+        }
     }
     else if(!strcasecmp(SECTION_CAPSULING_TUN_HWADDR, kv->key)){
         DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_TUN_HWADDR);
@@ -1264,6 +1641,46 @@ static bool config_parse_capsuling(
             result = !IN6_IS_ADDR_MULTICAST(host);
         }
     }
+    else if(!strcasecmp(SECTION_CAPSULING_PEER_PROBE, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_PEER_PROBE);
+        result = parse_bool(kv->value, &config->capsuling->peer_probe);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_PEER_PROBE_INTERVAL, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_PEER_PROBE_INTERVAL);
+        result = parse_int(kv->value, &config->capsuling->peer_probe_interval,
+                    CONFIG_PEER_PROBE_INTERVAL_MIN, CONFIG_PEER_PROBE_INTERVAL_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_PEER_PROBE_DEAD_COUNT, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_PEER_PROBE_DEAD_COUNT);
+        result = parse_int(kv->value, &config->capsuling->peer_probe_dead_count,
+                    CONFIG_PEER_PROBE_DEAD_COUNT_MIN, CONFIG_PEER_PROBE_DEAD_COUNT_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_MCAST_GROUP_MAP, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_MCAST_GROUP_MAP);
+        result = parse_bool(kv->value, &config->capsuling->mcast_group_map);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_MCAST_MEMBER_TIMEOUT, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_MCAST_MEMBER_TIMEOUT);
+        result = parse_int(kv->value, &config->capsuling->mcast_member_timeout,
+                    CONFIG_MCAST_MEMBER_TIMEOUT_MIN, CONFIG_MCAST_MEMBER_TIMEOUT_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_FLOW_LABEL, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_FLOW_LABEL);
+        result = parse_bool(kv->value, &config->capsuling->flow_label);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_PMTU_DISCOVERY, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_PMTU_DISCOVERY);
+        result = parse_bool(kv->value, &config->capsuling->pmtu_discovery);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_PMTU_EXPIRE, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_PMTU_EXPIRE);
+        result = parse_int(kv->value, &config->capsuling->pmtu_expire,
+                    CONFIG_PMTU_EXPIRE_MIN, CONFIG_PMTU_EXPIRE_MAX);
+    }
+    else if(!strcasecmp(SECTION_CAPSULING_TCP_MSS_CLAMP, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_CAPSULING_TCP_MSS_CLAMP);
+        result = parse_bool(kv->value, &config->capsuling->tcp_mss_clamp);
+    }
     // PRモードの場合、SECTION_CAPSULING_PR_UNICAST_PREFIXをチェック
     else if(config->common->tunnel_mode == ME6E_TUNNEL_MODE_PR){
         if(!strcasecmp(SECTION_CAPSULING_PR_UNICAST_PREFIX, kv->key)){
@@ -1358,6 +1775,14 @@ static bool config_validate_capsuling(me6e_config_t* config)
         return false;
     }
 
+    // マルチキャストグループ対応付け時は、11-12オクテット目をグループ番号に使用する
+    if(config->capsuling->mcast_group_map &&
+       (config->capsuling->me6e_multicast_prefix->s6_addr16[5] != 0)){
+        me6e_logging(LOG_ERR, "[%s] 11-12th octet must be zero when %s is enabled.",
+                SECTION_CAPSULING_MULTICAST_PREFIX, SECTION_CAPSULING_MCAST_GROUP_MAP);
+        return false;
+    }
+
     if(config->capsuling->backbone_physical_dev == NULL){
         me6e_logging(LOG_ERR, "[%s] is not found", SECTION_CAPSULING_BB_PHY_DEV);
         return false;
@@ -1470,6 +1895,8 @@ static bool config_init_proxy_arp(me6e_config_t* config)
     config->arp->arp_aging_time     = CONFIG_ARP_EXPIRE_TIME_DEFAULT;
     config->arp->arp_entry_max      = -1;
     config->arp->arp_static_entry   = NULL;
+    config->arp->arp_suppress       = false;
+    config->arp->arp_suppress_holdoff = CONFIG_SUPPRESS_HOLDOFF_DEFAULT;
     return true;
 }
 
@@ -1555,6 +1982,15 @@ static bool config_parse_proxy_arp(
             result = false;
         }
     }
+    else if(!strcasecmp(SECTION_PROXY_ARP_SUPPRESS, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_PROXY_ARP_SUPPRESS);
+        result = parse_bool(kv->value, &config->arp->arp_suppress);
+    }
+    else if(!strcasecmp(SECTION_PROXY_ARP_SUPPRESS_HOLDOFF, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_PROXY_ARP_SUPPRESS_HOLDOFF);
+        result = parse_int(kv->value, &config->arp->arp_suppress_holdoff,
+            CONFIG_SUPPRESS_HOLDOFF_MIN, CONFIG_SUPPRESS_HOLDOFF_MAX);
+    }
     else{
         struct in_addr    v4_addr;
         struct ether_addr eth_addr;
@@ -1608,6 +2044,13 @@ static bool config_validate_proxy_arp(me6e_config_t* config)
         return false;
     }
 
+    // フラッディング抑止は代理ARPテーブルの学習が前提
+    // (学習しない場合は抑止したRequestに誰も応答しない)
+    if(config->arp->arp_suppress && !config->arp->arp_entry_update){
+        me6e_logging(LOG_ERR, "[%s] requires [%s] = yes", SECTION_PROXY_ARP_SUPPRESS, SECTION_PROXY_ARP_ENTRY_UPDATE);
+        return false;
+    }
+
     return true;
 }
 
@@ -1648,6 +2091,8 @@ static bool config_init_proxy_ndp(me6e_config_t* config)
     config->ndp->ndp_aging_time     = CONFIG_NDP_EXPIRE_TIME_DEFAULT;
     config->ndp->ndp_entry_max      = -1;
     config->ndp->ndp_static_entry   = NULL;
+    config->ndp->ndp_suppress       = false;
+    config->ndp->ndp_suppress_holdoff = CONFIG_SUPPRESS_HOLDOFF_DEFAULT;
 
     return true;
 }
@@ -1731,6 +2176,15 @@ static bool config_parse_proxy_ndp(
             result = false;
         }
     }
+    else if(!strcasecmp(SECTION_PROXY_NDP_SUPPRESS, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_PROXY_NDP_SUPPRESS);
+        result = parse_bool(kv->value, &config->ndp->ndp_suppress);
+    }
+    else if(!strcasecmp(SECTION_PROXY_NDP_SUPPRESS_HOLDOFF, kv->key)){
+        DEBUG_LOG("Match %s.\n", SECTION_PROXY_NDP_SUPPRESS_HOLDOFF);
+        result = parse_int(kv->value, &config->ndp->ndp_suppress_holdoff,
+            CONFIG_SUPPRESS_HOLDOFF_MIN, CONFIG_SUPPRESS_HOLDOFF_MAX);
+    }
     else{
         struct in6_addr    v6_addr;
         struct ether_addr eth_addr;
@@ -1783,6 +2237,13 @@ static bool config_validate_proxy_ndp(me6e_config_t* config)
         return false;
     }
 
+    // フラッディング抑止は代理NDPテーブルの学習が前提
+    // (学習しない場合は抑止したNSに誰も応答しない)
+    if(config->ndp->ndp_suppress && !config->ndp->ndp_entry_update){
+        me6e_logging(LOG_ERR, "[%s] requires [%s] = yes", SECTION_PROXY_NDP_SUPPRESS, SECTION_PROXY_NDP_ENTRY_UPDATE);
+        return false;
+    }
+
     return true;
 }
 
@@ -2385,6 +2846,48 @@ static bool parse_int(const char* str, int* output, const int min, const int max
     return result;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 文字列をCPUセットに変換する
+//!
+//! 引数で指定された文字列が"0-3,8"形式のCPU番号リストの場合に、
+//! CPUセットを確保して出力パラメータに格納する。
+//!
+//! @param [in]  str     変換対象の文字列
+//! @param [out] output  変換結果の出力先ポインタ
+//!
+//! @retval true  変換成功
+//! @retval false 変換失敗 (書式不正、または設定済み)
+///////////////////////////////////////////////////////////////////////////////
+static bool parse_cpus(const char* str, cpu_set_t** output)
+{
+    // ローカル変数定義
+    cpu_set_t* set;
+
+    // 引数チェック
+    if((str == NULL) || (output == NULL)){
+        me6e_logging(LOG_ERR, "Parameter Check NG(parse_cpus).");
+        return false;
+    }
+
+    // 設定済みの場合はエラー
+    if(*output != NULL){
+        return false;
+    }
+
+    set = malloc(sizeof(cpu_set_t));
+    if(set == NULL){
+        return false;
+    }
+
+    if(!me6e_affinity_parse_cpus(str, set)){
+        free(set);
+        return false;
+    }
+    *output = set;
+
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //! @brief 文字列をIPv4アドレス型に変換する
 //!
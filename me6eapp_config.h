@@ -11,6 +11,7 @@
 #define __ME6EAPP_CONFIG_H__
 
 #include <stdbool.h>
+#include <sched.h>
 #include <netinet/in.h>
 
 #include "me6eapp_list.h"
@@ -57,6 +58,7 @@ struct me6e_device_t
         struct {
             int mode;                    ///< トンネル方式(TUN/TAP)
             int fd;                      ///< トンネルデバイスファイルディスクリプタ
+            bool vnet_hdr;               ///< 仮想NICヘッダ(GSO/チェックサムオフロード)の有効/無効
         } tunnel;                        ///< トンネルデバイス固有の設定
     } option;                            ///< オプション設定
 };
@@ -73,6 +75,57 @@ enum me6e_tunnel_mode
 };
 typedef enum me6e_tunnel_mode me6e_tunnel_mode;
 
+///////////////////////////////////////////////////////////////////////////////
+//! Stub側物理デバイスの送受信方式
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_stub_backend
+{
+    ME6E_STUB_BACKEND_BRIDGE = 0,   ///< Bridgeデバイス経由
+    ME6E_STUB_BACKEND_PACKET = 1,   ///< パケットリング(TPACKET_V3)で直接送受信
+    ME6E_STUB_BACKEND_XDP    = 2,   ///< AF_XDPソケットで直接送受信
+};
+typedef enum me6e_stub_backend me6e_stub_backend;
+
+///////////////////////////////////////////////////////////////////////////////
+//! トンネル送受信のI/O方式
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_io_engine
+{
+    ME6E_IO_ENGINE_EPOLL = 0,   ///< epollで受信待ち合わせ
+    ME6E_IO_ENGINE_URING = 1,   ///< io_uringで送受信
+};
+typedef enum me6e_io_engine me6e_io_engine;
+
+///////////////////////////////////////////////////////////////////////////////
+//! Backbone側のトンネル転送方式
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_transport
+{
+    ME6E_TRANSPORT_ETHERIP = 0, ///< EtherIP(IPv6 RAW)で転送
+    ME6E_TRANSPORT_UDP     = 1, ///< EtherIP over UDPで転送
+};
+typedef enum me6e_transport me6e_transport;
+
+///////////////////////////////////////////////////////////////////////////////
+//! データパスのスレッドのスケジューリングポリシー
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_sched_policy
+{
+    ME6E_SCHED_OTHER = 0,       ///< SCHED_OTHER(通常)
+    ME6E_SCHED_FIFO  = 1,       ///< SCHED_FIFO(リアルタイム)
+};
+typedef enum me6e_sched_policy me6e_sched_policy;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 送信キューの満杯時の破棄ポリシー
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_txq_policy
+{
+    ME6E_TXQ_POLICY_TAIL     = 0,   ///< 新しいフレームを破棄
+    ME6E_TXQ_POLICY_PRIORITY = 1,   ///< 高優先のフレームのために通常のフレームを破棄
+};
+typedef enum me6e_txq_policy me6e_txq_policy;
+
 ///////////////////////////////////////////////////////////////////////////////
 //! 共通設定
 ///////////////////////////////////////////////////////////////////////////////
@@ -99,11 +152,47 @@ struct me6e_config_capsuling_t
     char*                backbone_physical_dev;   ///< Backboneネットワーク網に接続される物理デバイス名
     int                  bb_fd;                   ///< Backboneネットワーク網の送受信用IPv6ソケット
     char*                stub_physical_dev;       ///< Stubネットワーク網に接続される物理デバイス名
+    me6e_stub_backend    stub_backend;            ///< Stub側物理デバイスの送受信方式
     me6e_device_t        tunnel_device;           ///< トンネルデバイス情報
+    bool                 tunnel_mtu_auto;         ///< トンネルデバイスのMTUを自動設定するかどうか
+    bool                 tunnel_offload;          ///< トンネルデバイスのオフロード(GSO受信)の動作有無
+    bool                 tunnel_gro;              ///< トンネルデバイスへの送信時のセグメント結合の動作有無
+    me6e_io_engine       io_engine;               ///< トンネル送受信のI/O方式
+    int                  backbone_fanout;         ///< Backbone側分散受信のソケット数(0は分散しない)
+    bool                 backbone_l2_fastpath;    ///< Backbone側へのL2直接送信の動作有無
+    me6e_transport       transport;               ///< Backbone側のトンネル転送方式
+    int                  udp_port;                ///< EtherIP over UDPのポート番号
+    int                  udp_workers;             ///< EtherIP over UDPの受信スレッド数
+    int                  buffer_pool_num;         ///< パケットバッファプールのMTUサイズのバッファ数
+    int                  buffer_pool_jumbo_num;   ///< パケットバッファプールのジャンボサイズのバッファ数
+    bool                 buffer_pool_hugepage;    ///< パケットバッファプールのヒュージページ使用有無
+    int                  pipeline_workers;        ///< パイプラインのデカプセル化処理スレッド数(0は使用しない)
+    int                  pipeline_ring_size;      ///< パイプラインの受け渡しリングのスロット数
+    cpu_set_t*           backbone_cpus;           ///< Backbone側トンネルスレッドのCPU(未指定時はNULL)
+    cpu_set_t*           stub_cpus;               ///< Stub側トンネルスレッドのCPU(未指定時はNULL)
+    cpu_set_t*           worker_cpus;             ///< 処理スレッドのCPU(未指定時はNULL)
+    cpu_set_t*           control_cpus;            ///< 制御スレッドのCPU(未指定時はNULL)
+    me6e_sched_policy    datapath_sched;          ///< データパスのスレッドのスケジューリングポリシー
+    int                  datapath_priority;       ///< データパスのスレッドの優先度(SCHED_FIFO時)
+    bool                 numa_placement;          ///< Backbone側物理デバイスのNUMAノードへのメモリ配置有無
+    bool                 busy_poll;               ///< トンネルスレッドのビジーポーリング有無
+    int                  busy_poll_usec;          ///< Backbone側ソケットのビジーポーリング時間(SO_BUSY_POLL、マイクロ秒)
+    int                  busy_poll_budget;        ///< 休止前にビジーポーリングする時間の上限(マイクロ秒)
+    int                  tx_queue_len;            ///< 送信キューに保持するフレーム数の上限(0は送信キューなし)
+    me6e_txq_policy      tx_queue_policy;         ///< 送信キューの満杯時の破棄ポリシー
     char*                bridge_name;             ///< Bridgeデバイス名
     struct ether_addr*   bridge_hwaddr;           ///< BridgeデバイスのMAC  // MACフィルタ対応 2016/09/09 add
     bool                 l2multi_l3uni;           ///< L2マルチ-L3ユニキャスト機能の動作有無
     me6e_list            me6e_host_address_list;  ///< ME6Eサーバアドレスのリスト
+    bool                 peer_probe;              ///< ME6Eサーバの死活監視の動作有無
+    int                  peer_probe_interval;     ///< 死活監視の周期(秒)
+    int                  peer_probe_dead_count;   ///< down判定する連続無応答回数
+    bool                 mcast_group_map;         ///< マルチキャストグループ対応付けの動作有無
+    int                  mcast_member_timeout;    ///< マルチキャストメンバーシップの保持時間(秒)
+    bool                 flow_label;              ///< カプセル化パケットへのフローラベル設定有無
+    bool                 pmtu_discovery;          ///< Path MTU学習の動作有無
+    int                  pmtu_expire;             ///< 学習したPath MTUの保持時間(秒)
+    bool                 tcp_mss_clamp;           ///< TCP MSSクランプの動作有無
     struct in6_addr*     me6e_pr_unicast_prefix;  ///< ME6E-PR ユニキャストアドレスプレフィックス
     int                  pr_unicat_prefixlen;     ///< ME6E-PR unicast prefix長
     struct in6_addr*     pr_unicast_prefixplaneid;///< ME6E-PR unicast prefix + plane ID
@@ -120,6 +209,8 @@ struct me6e_config_proxy_arp_t
     int                    arp_aging_time;          ///< 動的エントリのエージングタイマ
     int                    arp_entry_max;           ///< 登録できるエントリの最大数
     me6e_hashtable_t*      arp_static_entry;        ///< 静的ARPエントリ
+    bool                   arp_suppress;            ///< ARP Requestのフラッディング抑止の動作有無
+    int                    arp_suppress_holdoff;    ///< 同一ターゲットへのフラッディング抑止時間(秒)
 };
 typedef struct me6e_config_proxy_arp_t me6e_config_proxy_arp_t;
 
@@ -133,6 +224,8 @@ struct me6e_config_proxy_ndp_t
     int                    ndp_aging_time;          ///< 動的エントリのエージングタイマ
     int                    ndp_entry_max;           ///< 登録できるエントリの最大数
     me6e_hashtable_t*      ndp_static_entry;        ///< 静的NDPエントリ
+    bool                   ndp_suppress;            ///< NSのフラッディング抑止の動作有無
+    int                    ndp_suppress_holdoff;    ///< 同一ターゲットへのフラッディング抑止時間(秒)
 };
 typedef struct me6e_config_proxy_ndp_t me6e_config_proxy_ndp_t;
 
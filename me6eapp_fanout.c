@@ -0,0 +1,480 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_fanout.c                                              */
+/* 機能概要   : Backbone側分散受信(PACKET_FANOUT) ソースファイル              */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/filter.h>
+
+#include "me6eapp.h"
+#include "me6eapp_fanout.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+#ifndef PACKET_IGNORE_OUTGOING
+//! 自ソケットからの送信フレームを受信しない(Linux 4.20以降)
+#define PACKET_IGNORE_OUTGOING  23
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int fanout_open(const char* ifname, int ifindex, int group);
+static ssize_t fanout_reasm(me6e_fanout_t* fanout, me6e_fanout_msg_t* fmsg, ssize_t plen);
+static me6e_fanout_reasm_t* fanout_reasm_find(me6e_fanout_t* fanout,
+        const struct ip6_hdr* ip6, uint32_t id, time_t now);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone側分散受信生成関数
+//!
+//! Backbone側物理デバイスにパケットソケットをnum個生成し、
+//! PACKET_FANOUT_HASHのグループ(プロセスID毎)に登録する。
+//! パケットソケットはme6e_filter_setup_backboneでフィルタを設定するまで受信しない。
+//! (IPv6 RAWソケットの受信停止もme6e_filter_setup_backboneで行う)
+//!
+//! @param [in] ifname  Backbone側物理デバイス名
+//! @param [in] num     パケットソケット数(1～ME6E_FANOUT_MAX)
+//!
+//! @return 生成したBackbone側分散受信(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_fanout_t* me6e_fanout_create(const char* ifname, int num)
+{
+    // ローカル変数宣言
+    me6e_fanout_t*      fanout;
+    int                 ifindex;
+    int                 group;
+    int                 i;
+
+    // 引数チェック
+    if ((ifname == NULL) || (num <= 0) || (num > ME6E_FANOUT_MAX)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_fanout_create).");
+        return NULL;
+    }
+
+    ifindex = if_nametoindex(ifname);
+    if (ifindex == 0) {
+        me6e_logging(LOG_ERR, "fail to get index of %s : %s.", ifname, strerror(errno));
+        return NULL;
+    }
+
+    fanout = malloc(sizeof(me6e_fanout_t));
+    if (fanout == NULL) {
+        me6e_logging(LOG_ERR, "fail to allocate fanout.");
+        return NULL;
+    }
+    memset(fanout, 0, sizeof(me6e_fanout_t));
+    pthread_mutex_init(&fanout->mutex, NULL);
+    for (i = 0; i < ME6E_FANOUT_MAX; i++) {
+        fanout->fd[i] = -1;
+    }
+
+    // グループ番号はプロセス毎に分ける(同一ホストで複数プレーンを動作させるため)
+    group = getpid() & 0xFFFF;
+
+    for (i = 0; i < num; i++) {
+        fanout->fd[i] = fanout_open(ifname, ifindex, group);
+        if (fanout->fd[i] < 0) {
+            goto error;
+        }
+        fanout->num++;
+    }
+
+    me6e_logging(LOG_INFO, "backbone fanout %s : %d sockets (group %d).", ifname, num, group);
+
+    return fanout;
+
+error:
+    me6e_fanout_destroy(fanout);
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone側分散受信解放関数
+//!
+//! パケットソケットをクローズし、再構築テーブルを解放する。
+//! (IPv6 RAWソケットの受信はme6e_filter_setup_backboneで再開する)
+//!
+//! @param [in] fanout  Backbone側分散受信
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_fanout_destroy(me6e_fanout_t* fanout)
+{
+    // ローカル変数宣言
+    int i;
+
+    if (fanout == NULL) {
+        return;
+    }
+
+    for (i = 0; i < fanout->num; i++) {
+        close(fanout->fd[i]);
+    }
+    for (i = 0; i < ME6E_FANOUT_REASM_MAX; i++) {
+        free(fanout->reasm[i].data);
+    }
+    pthread_mutex_destroy(&fanout->mutex);
+    free(fanout);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 分散受信メッセージ初期化関数
+//!
+//! 受信メッセージの各要素を分散受信メッセージ内の領域に対応付ける。
+//!
+//! @param [out] fmsg   分散受信メッセージ
+//! @param [in]  buffer デカプセル化データの受信バッファ
+//! @param [in]  size   デカプセル化データの受信バッファのサイズ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_fanout_msg_init(me6e_fanout_msg_t* fmsg, char* buffer, size_t size)
+{
+    // ローカル変数宣言
+    struct cmsghdr* cmsg;
+
+    memset(fmsg, 0, sizeof(me6e_fanout_msg_t));
+    fmsg->buffer = buffer;
+    fmsg->size   = size;
+
+    // 配列0に、EtherIPヘッダを格納
+    fmsg->iov[0].iov_base = &fmsg->etherip;
+    fmsg->iov[0].iov_len  = sizeof(fmsg->etherip);
+
+    // 配列1に、EtherIPヘッダ以降のデータを格納(デカプセル化データ)
+    fmsg->iov[1].iov_base = buffer;
+    fmsg->iov[1].iov_len  = size;
+
+    fmsg->src.sin6_family   = AF_INET6;
+    fmsg->msg.msg_name      = &fmsg->src;
+    fmsg->msg.msg_namelen   = sizeof(fmsg->src);
+    fmsg->msg.msg_iov       = fmsg->iov;
+    fmsg->msg.msg_iovlen    = 2;
+    fmsg->msg.msg_control   = fmsg->cmsgbuf;
+    fmsg->msg.msg_controllen = sizeof(fmsg->cmsgbuf);
+
+    cmsg = CMSG_FIRSTHDR(&fmsg->msg);
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(struct in6_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IPV6;
+    cmsg->cmsg_type  = IPV6_PKTINFO;
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 分散受信関数
+//!
+//! パケットソケットからIPv6パケットを受信し、送信元アドレスと
+//! 送信先情報(IPV6_PKTINFO)を受信メッセージ(fmsg->msg)に設定する。
+//! 自ホスト宛て(ユニキャスト/マルチキャスト)以外のパケットは無視する。
+//! フラグメントは再構築テーブルに格納し、全て揃った時点で再構築したパケットを返す。
+//!
+//! @param [in]     fanout  Backbone側分散受信
+//! @param [in]     fd      パケットソケット
+//! @param [in,out] fmsg    分散受信メッセージ
+//! @param [in]     flags   recvmsgのフラグ
+//!
+//! @retval 0より大きい EtherIPヘッダ以降のデータ長(IPv6 RAWソケットの受信長と同じ)
+//! @retval 0           無視したパケット(再構築中のフラグメントを含む)
+//! @retval -1          異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_fanout_recv(me6e_fanout_t* fanout, int fd, me6e_fanout_msg_t* fmsg, int flags)
+{
+    // ローカル変数宣言
+    struct sockaddr_ll  sll;
+    struct iovec        iov[3];
+    struct msghdr       msg;
+    struct in6_pktinfo* info;
+    ssize_t             len;
+    ssize_t             plen;
+
+    // IPv6ヘッダ/EtherIPヘッダ/データに分けて受信
+    iov[0].iov_base = &fmsg->ip6;
+    iov[0].iov_len  = sizeof(fmsg->ip6);
+    iov[1].iov_base = &fmsg->etherip;
+    iov[1].iov_len  = sizeof(fmsg->etherip);
+    iov[2].iov_base = fmsg->buffer;
+    iov[2].iov_len  = fmsg->size;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name    = &sll;
+    msg.msg_namelen = sizeof(sll);
+    msg.msg_iov     = iov;
+    msg.msg_iovlen  = 3;
+
+    len = recvmsg(fd, &msg, flags);
+    if (len < 0) {
+        return -1;
+    }
+
+    // 自ホスト宛て以外(他ホスト宛て、自ホストからの送信)は無視
+    if ((sll.sll_pkttype != PACKET_HOST) && (sll.sll_pkttype != PACKET_MULTICAST)) {
+        return 0;
+    }
+
+    // ペイロード長で切り詰める(Ethernetの最小長に満たない場合のパディングを除く)
+    plen = ntohs(fmsg->ip6.ip6_plen);
+    if ((len < (ssize_t)(sizeof(fmsg->ip6) + sizeof(fmsg->etherip))) ||
+        ((fmsg->ip6.ip6_nxt != ME6E_IPPROTO_ETHERIP) && (fmsg->ip6.ip6_nxt != IPPROTO_FRAGMENT)) ||
+        (plen < (ssize_t)sizeof(fmsg->etherip)) || (plen > (len - (ssize_t)sizeof(fmsg->ip6)))) {
+        DEBUG_LOG("drop fanout packet(len %zd, plen %zd).\n", len, plen);
+        return 0;
+    }
+
+    // フラグメントの場合は再構築(揃っていなければ無視したパケットとして扱う)
+    if (fmsg->ip6.ip6_nxt == IPPROTO_FRAGMENT) {
+        plen = fanout_reasm(fanout, fmsg, plen);
+        if (plen <= 0) {
+            return 0;
+        }
+    }
+
+    fmsg->src.sin6_addr     = fmsg->ip6.ip6_src;
+    fmsg->src.sin6_scope_id = IN6_IS_ADDR_LINKLOCAL(&fmsg->ip6.ip6_src) ? sll.sll_ifindex : 0;
+
+    info = (struct in6_pktinfo*)CMSG_DATA(CMSG_FIRSTHDR(&fmsg->msg));
+    info->ipi6_addr    = fmsg->ip6.ip6_dst;
+    info->ipi6_ifindex = sll.sll_ifindex;
+
+    // recvmsgで書き換えられないため受信毎に戻す
+    fmsg->msg.msg_controllen = sizeof(fmsg->cmsgbuf);
+
+    return plen;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パケットソケット生成関数
+//!
+//! IPv6パケットを受信するパケットソケットを生成し、
+//! デバイスにバインドしてPACKET_FANOUT_HASHのグループに登録する。
+//! 受信するパケットを選択するフィルタが設定されるまでは全て破棄する。
+//!
+//! @param [in] ifname  デバイス名
+//! @param [in] ifindex デバイスのインデックス
+//! @param [in] group   PACKET_FANOUTのグループ番号
+//!
+//! @return 生成したパケットソケット(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+static int fanout_open(const char* ifname, int ifindex, int group)
+{
+    // ローカル変数宣言
+    int                 fd;
+    int                 ignore = 1;
+    int                 arg;
+    struct sockaddr_ll  sll;
+    struct sock_filter  filter[] = {
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct sock_fprog   prog;
+
+    fd = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IPV6));
+    if (fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create fanout socket : %s.", strerror(errno));
+        return -1;
+    }
+
+    // バインド前にフィルタを設定(フィルタ設定前のパケットを受信キューに溜めない)
+    prog.len    = sizeof(filter) / sizeof(filter[0]);
+    prog.filter = filter;
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0) {
+        me6e_logging(LOG_ERR, "fail to attach fanout filter : %s.", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // 自ホストからの送信パケットを受信しない
+    // (未対応のカーネルではパケット種別で無視するため処理継続)
+    if (setsockopt(fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignore, sizeof(ignore)) < 0) {
+        DEBUG_LOG("fail to set PACKET_IGNORE_OUTGOING : %s.\n", strerror(errno));
+    }
+
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family   = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_IPV6);
+    sll.sll_ifindex  = ifindex;
+    if (bind(fd, (struct sockaddr*)&sll, sizeof(sll)) < 0) {
+        me6e_logging(LOG_ERR, "fail to bind fanout socket %s : %s.", ifname, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // フロー毎のハッシュで受信ソケットを選択する
+    arg = group | (PACKET_FANOUT_HASH << 16);
+    if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) < 0) {
+        me6e_logging(LOG_ERR, "fail to join fanout group %d : %s.", group, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フラグメント再構築関数
+//!
+//! 受信したEtherIPのフラグメントを再構築テーブルに格納し、
+//! 全てのフラグメントが揃った場合は再構築したEtherIPヘッダとデータを
+//! 分散受信メッセージ(fmsg->etherip/fmsg->buffer)に格納する。
+//! フラグメントヘッダはIPv6ヘッダの直後にあるもののみ扱う。
+//! 重複したフラグメントは受信済みの範囲を数えないことで無視する。
+//!
+//! @param [in]     fanout  Backbone側分散受信
+//! @param [in,out] fmsg    分散受信メッセージ(フラグメントを受信済み)
+//! @param [in]     plen    フラグメントのIPv6ペイロード長
+//!
+//! @retval 0より大きい 再構築したEtherIPヘッダ以降のデータ長
+//! @retval 0           再構築中(または破棄したフラグメント)
+///////////////////////////////////////////////////////////////////////////////
+static ssize_t fanout_reasm(me6e_fanout_t* fanout, me6e_fanout_msg_t* fmsg, ssize_t plen)
+{
+    // ローカル変数宣言
+    struct ip6_frag         frag;
+    struct timespec         now;
+    me6e_fanout_reasm_t*    reasm;
+    const uint8_t*          data;
+    int                     offset, flen, end, block;
+    bool                    more;
+    ssize_t                 ret = 0;
+
+    if (plen < (ssize_t)sizeof(frag)) {
+        return 0;
+    }
+
+    // フラグメントヘッダはEtherIPヘッダ領域と受信バッファにまたがって受信している
+    memcpy(&frag, &fmsg->etherip, sizeof(fmsg->etherip));
+    memcpy((char*)&frag + sizeof(fmsg->etherip), fmsg->buffer, sizeof(frag) - sizeof(fmsg->etherip));
+    data   = (const uint8_t*)fmsg->buffer + sizeof(frag) - sizeof(fmsg->etherip);
+    flen   = plen - sizeof(frag);
+    offset = ntohs(frag.ip6f_offlg & IP6F_OFF_MASK);
+    more   = ((frag.ip6f_offlg & IP6F_MORE_FRAG) != 0);
+    end    = offset + flen;
+
+    // 最終以外のフラグメント長は8の倍数
+    if ((frag.ip6f_nxt != ME6E_IPPROTO_ETHERIP) || (flen <= 0) ||
+        (more && (flen & 7)) || (end > ME6E_FANOUT_REASM_SIZE)) {
+        DEBUG_LOG("drop fanout fragment(offset %d, len %d).\n", offset, flen);
+        return 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&fanout->mutex);
+
+    reasm = fanout_reasm_find(fanout, &fmsg->ip6, frag.ip6f_ident, now.tv_sec);
+    if (reasm == NULL) {
+        goto finish;
+    }
+
+    // 最終フラグメントでペイロード長が確定する(矛盾する場合は破棄)
+    if ((!more && (reasm->total >= 0) && (reasm->total != end)) ||
+        ((reasm->total >= 0) && (end > reasm->total))) {
+        DEBUG_LOG("drop inconsistent fanout fragment(offset %d, len %d).\n", offset, flen);
+        reasm->used = false;
+        goto finish;
+    }
+    if (!more) {
+        reasm->total = end;
+    }
+
+    memcpy(reasm->data + offset, data, flen);
+    for (block = offset / 8; (block * 8) < end; block++) {
+        if ((reasm->map[block / 8] & (1 << (block % 8))) == 0) {
+            reasm->map[block / 8] |= (1 << (block % 8));
+            reasm->received += ((end - block * 8) < 8) ? (end - block * 8) : 8;
+        }
+    }
+
+    if ((reasm->total < 0) || (reasm->received < reasm->total)) {
+        goto finish;
+    }
+
+    // 全て揃った場合は再構築したデータを受信メッセージへ格納
+    reasm->used = false;
+    if ((reasm->total < (int)sizeof(fmsg->etherip)) ||
+        ((size_t)(reasm->total - sizeof(fmsg->etherip)) > fmsg->size)) {
+        DEBUG_LOG("drop reassembled fanout packet(len %d).\n", reasm->total);
+        goto finish;
+    }
+    memcpy(&fmsg->etherip, reasm->data, sizeof(fmsg->etherip));
+    memcpy(fmsg->buffer, reasm->data + sizeof(fmsg->etherip), reasm->total - sizeof(fmsg->etherip));
+    ret = reasm->total;
+
+finish:
+    pthread_mutex_unlock(&fanout->mutex);
+
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 再構築中パケット検索関数
+//!
+//! 送信元/送信先/フラグメントIDが一致する再構築中のパケットを検索する。
+//! 未登録の場合は空きエントリ、空きが無い場合は満了時刻が最も近いエントリを
+//! 初期化して返す。満了したエントリは検索時に解放する。
+//! (mutexを取得した状態で呼び出すこと)
+//!
+//! @param [in] fanout  Backbone側分散受信
+//! @param [in] ip6     フラグメントのIPv6ヘッダ
+//! @param [in] id      フラグメントID
+//! @param [in] now     現在時刻(単調増加時刻)
+//!
+//! @return 再構築中のパケット(再構築領域を確保できない場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static me6e_fanout_reasm_t* fanout_reasm_find(me6e_fanout_t* fanout,
+        const struct ip6_hdr* ip6, uint32_t id, time_t now)
+{
+    // ローカル変数宣言
+    me6e_fanout_reasm_t*    target = NULL;
+    me6e_fanout_reasm_t*    reasm;
+    int                     i;
+
+    for (i = 0; i < ME6E_FANOUT_REASM_MAX; i++) {
+        reasm = &fanout->reasm[i];
+        if (reasm->used && (reasm->expire <= now)) {
+            DEBUG_LOG("fanout reassembly timeout(id %u).\n", ntohl(reasm->id));
+            reasm->used = false;
+        }
+        if (reasm->used && (reasm->id == id) &&
+            IN6_ARE_ADDR_EQUAL(&reasm->src, &ip6->ip6_src) &&
+            IN6_ARE_ADDR_EQUAL(&reasm->dst, &ip6->ip6_dst)) {
+            return reasm;
+        }
+        if ((target == NULL) || (target->used && (!reasm->used || (reasm->expire < target->expire)))) {
+            target = reasm;
+        }
+    }
+
+    if (target->data == NULL) {
+        target->data = malloc(ME6E_FANOUT_REASM_SIZE);
+        if (target->data == NULL) {
+            me6e_logging(LOG_ERR, "fail to allocate fanout reassembly buffer.");
+            return NULL;
+        }
+    }
+
+    target->used     = true;
+    target->src      = ip6->ip6_src;
+    target->dst      = ip6->ip6_dst;
+    target->id       = id;
+    target->expire   = now + ME6E_FANOUT_REASM_TIMEOUT;
+    target->total    = -1;
+    target->received = 0;
+    memset(target->map, 0, sizeof(target->map));
+
+    return target;
+}
@@ -0,0 +1,100 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_fanout.h                                              */
+/* 機能概要   : Backbone側分散受信(PACKET_FANOUT) ヘッダファイル              */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_FANOUT_H__
+#define __ME6EAPP_FANOUT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/ip6.h>
+
+#include "me6eapp_EtherIP.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 分散受信するソケット(デカプセル化スレッド)の最大数
+#define ME6E_FANOUT_MAX     16
+//! 再構築中のEtherIPパケットを管理できる最大数
+#define ME6E_FANOUT_REASM_MAX       64
+//! フラグメント再構築のタイムアウト(秒)
+#define ME6E_FANOUT_REASM_TIMEOUT   60
+//! 再構築できるIPv6ペイロードの最大長
+#define ME6E_FANOUT_REASM_SIZE      65535
+
+///////////////////////////////////////////////////////////////////////////////
+//! 再構築中のEtherIPパケット
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_fanout_reasm_t
+{
+    bool                used;                   ///< 使用中かどうか
+    struct in6_addr     src;                    ///< 送信元アドレス
+    struct in6_addr     dst;                    ///< 送信先アドレス
+    uint32_t            id;                     ///< フラグメントID
+    time_t              expire;                 ///< 満了時刻(単調増加時刻)
+    int                 total;                  ///< ペイロード長(最終フラグメント受信前は-1)
+    int                 received;               ///< 受信済みのデータ長
+    uint8_t             map[(ME6E_FANOUT_REASM_SIZE + 63) / 64];   ///< 8バイト単位の受信済みビットマップ
+    uint8_t*            data;                   ///< 再構築領域(ME6E_FANOUT_REASM_SIZE)
+};
+typedef struct me6e_fanout_reasm_t me6e_fanout_reasm_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! Backbone側分散受信
+//!
+//! Backbone側物理デバイスにEtherIPのみを受信するパケットソケットを複数生成し、
+//! PACKET_FANOUT_HASHのグループに登録する。カーネルがフロー毎のハッシュで
+//! 受信ソケットを選択するため、フロー内の順序を保ったまま
+//! ソケット毎のスレッドでデカプセル化を分散できる。
+//! Backbone側のIPv6 RAWソケットは送信専用とし、受信しないようにする。
+//! (フィルタはme6e_filter_setup_backboneで設定する)
+//! パケットソケットにはカーネルで再構築される前のフラグメントが届くため、
+//! EtherIPのフラグメントは全ソケットで共有する再構築テーブルで再構築する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_fanout_t
+{
+    int                 num;                    ///< パケットソケット数
+    int                 fd[ME6E_FANOUT_MAX];    ///< パケットソケット
+    pthread_mutex_t     mutex;                  ///< 排他用mutex(再構築テーブル)
+    me6e_fanout_reasm_t reasm[ME6E_FANOUT_REASM_MAX];  ///< 再構築テーブル
+};
+typedef struct me6e_fanout_t me6e_fanout_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 分散受信メッセージ
+//!
+//! パケットソケットで受信したIPv6パケットを、IPv6 RAWソケットの
+//! recvmsgと同じ形式(送信元アドレス/IPV6_PKTINFO/EtherIPヘッダとデータ)に変換する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_fanout_msg_t
+{
+    struct ip6_hdr      ip6;                    ///< 受信したIPv6ヘッダ
+    struct etheriphdr   etherip;                ///< 受信したEtherIPヘッダ
+    char*               buffer;                 ///< デカプセル化データの受信バッファ
+    size_t              size;                   ///< デカプセル化データの受信バッファのサイズ
+    struct sockaddr_in6 src;                    ///< 送信元アドレス
+    char                cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))]; ///< 送信先情報
+    struct iovec        iov[2];                 ///< EtherIPヘッダとデカプセル化データ
+    struct msghdr       msg;                    ///< 受信メッセージ
+};
+typedef struct me6e_fanout_msg_t me6e_fanout_msg_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_fanout_t* me6e_fanout_create(const char* ifname, int num);
+void me6e_fanout_destroy(me6e_fanout_t* fanout);
+void me6e_fanout_msg_init(me6e_fanout_msg_t* fmsg, char* buffer, size_t size);
+ssize_t me6e_fanout_recv(me6e_fanout_t* fanout, int fd, me6e_fanout_msg_t* fmsg, int flags);
+
+#endif // __ME6EAPP_FANOUT_H__
@@ -0,0 +1,466 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_filter.c                                              */
+/* 機能概要   : カーネルパケットフィルタ設定 ソースファイル                   */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/ethernet.h>
+#include <sys/ioctl.h>
+#include <linux/filter.h>
+#include <linux/if_tun.h>
+
+#include "me6eapp.h"
+#include "me6eapp_config.h"
+#include "me6eapp_log.h"
+#include "me6eapp_filter.h"
+#include "me6eapp_EtherIP.h"
+
+//! フィルタ命令数の最大値
+#define FILTER_INSN_MAX         64
+
+//! ジャンプ先の仮値(破棄)
+#define FILTER_JUMP_DROP        0xfe
+//! ジャンプ先の仮値(受信)
+#define FILTER_JUMP_ACCEPT      0xfd
+
+//! IPv6ヘッダ内の送信元アドレスのオフセット(ネットワークヘッダ基準)
+#define FILTER_IP6_SRC_OFF      (SKF_NET_OFF + 8)
+//! IPv6ヘッダ内の送信先アドレスのオフセット(ネットワークヘッダ基準)
+#define FILTER_IP6_DST_OFF      (SKF_NET_OFF + 24)
+//! IPv6ヘッダ内の次ヘッダのオフセット(ネットワークヘッダ基準)
+#define FILTER_IP6_NXT_OFF      (SKF_NET_OFF + 6)
+//! IPv6ヘッダ直後のオフセット(ネットワークヘッダ基準)
+#define FILTER_IP6_PAYLOAD_OFF  (SKF_NET_OFF + 40)
+
+///////////////////////////////////////////////////////////////////////////////
+//! フィルタプログラム生成用の構造体
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_filter_prog{
+    struct sock_filter  insn[FILTER_INSN_MAX];  ///< 命令列
+    int                 len;                    ///< 命令数
+};
+typedef struct me6e_filter_prog me6e_filter_prog;
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static inline void filter_add(me6e_filter_prog* prog,
+                uint16_t code, uint8_t jt, uint8_t jf, uint32_t k);
+static void filter_add_address_check(me6e_filter_prog* prog, struct me6e_handler_t* handler);
+static int filter_attach_drop(int fd);
+static void filter_add_uni_prefix_check(me6e_filter_prog* prog,
+                int offset, const struct in6_addr* prefix);
+static void filter_add_multi_prefix_check(me6e_filter_prog* prog,
+                int offset, const struct in6_addr* prefix, bool group_map);
+static int filter_resolve(me6e_filter_prog* prog, struct sock_fprog* fprog);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backboneソケット用フィルタ設定関数
+//!
+//! ME6Eのユニキャスト/マルチキャストプレフィックスからBPFフィルタを生成し、
+//! Backboneソケットへ設定する。以下のパケットをカーネル内で破棄する。
+//!
+//!   - EtherIPのバージョンが不正なパケット
+//!   - 送信元がマルチキャストアドレスのパケット
+//!   - 送信元のプレフィックスが自planeと異なるパケット(ME6E-PRモード以外)
+//!   - 送信先のプレフィックスが自planeと異なるパケット
+//!
+//! 分散受信の動作時は、同じチェックに次ヘッダのチェックを加えたフィルタを
+//! 分散受信のパケットソケットへ設定し、IPv6 RAWソケットの受信は止める。
+//! (フラグメントは分散受信側で再構築するため、パケットソケットで受信する)
+//!
+//! 既にフィルタが設定されている場合は置き換えるため、プレフィックスを変更した場合と
+//! 分散受信を生成/解放した場合は本関数を再度呼び出すこと。
+//!
+//! @param [in]     handler      ME6Eハンドラ
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_filter_setup_backbone(struct me6e_handler_t* handler)
+{
+    me6e_filter_prog  prog;
+    struct sock_fprog fprog;
+
+    // 引数チェック
+    if (handler == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_filter_setup_backbone).");
+        return -1;
+    }
+
+    if (handler->bb_fanout != NULL) {
+        return me6e_filter_setup_fanout(handler);
+    }
+
+    memset(&prog, 0, sizeof(prog));
+
+    // EtherIPバージョンチェック(先頭オクテットの上位4bit)
+    filter_add(&prog, BPF_LD  | BPF_B   | BPF_ABS, 0, 0, 0);
+    filter_add(&prog, BPF_ALU | BPF_AND | BPF_K,   0, 0, 0xf0);
+    filter_add(&prog, BPF_JMP | BPF_JEQ | BPF_K,   0, FILTER_JUMP_DROP, ETHERIP_VERSION << 4);
+
+    // 送信元/送信先アドレスチェック
+    filter_add_address_check(&prog, handler);
+
+    if (filter_resolve(&prog, &fprog) != 0) {
+        return -1;
+    }
+
+    if (setsockopt(handler->conf->capsuling->bb_fd,
+                SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) < 0) {
+        me6e_logging(LOG_ERR, "fail to set sockopt SO_ATTACH_FILTER : %s.", strerror(errno));
+        return errno;
+    }
+
+    DEBUG_LOG("attach backbone filter len = %d\n", fprog.len);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 分散受信パケットソケット用フィルタ設定関数
+//!
+//! Backboneソケット用フィルタと同じチェックを、パケットソケットで受信する
+//! IPv6パケットに対して行うフィルタを生成し、分散受信の全パケットソケットへ設定する。
+//! 次ヘッダがEtherIPのパケットと、EtherIPのフラグメントのみ受信する。
+//! (EtherIPバージョンのチェックはフラグメントでないパケットのみ)
+//! 設定後はIPv6 RAWソケットに全て破棄するフィルタを設定し、受信を止める。
+//! (送信、およびエラーキューへのICMPエラー通知は従来通り使用できる)
+//!
+//! @param [in]     handler      ME6Eハンドラ
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_filter_setup_fanout(struct me6e_handler_t* handler)
+{
+    me6e_filter_prog  prog;
+    struct sock_fprog fprog;
+    int               i;
+
+    // 引数チェック
+    if ((handler == NULL) || (handler->bb_fanout == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_filter_setup_fanout).");
+        return -1;
+    }
+
+    memset(&prog, 0, sizeof(prog));
+
+    // 次ヘッダがEtherIPならバージョンチェックへ、フラグメントなら次ヘッダをチェック
+    filter_add(&prog, BPF_LD  | BPF_B   | BPF_ABS, 0, 0, FILTER_IP6_NXT_OFF);
+    filter_add(&prog, BPF_JMP | BPF_JEQ | BPF_K,   3, 0, ME6E_IPPROTO_ETHERIP);
+    filter_add(&prog, BPF_JMP | BPF_JEQ | BPF_K,   0, FILTER_JUMP_DROP, IPPROTO_FRAGMENT);
+
+    // フラグメントヘッダの次ヘッダがEtherIPならアドレスチェックへ
+    filter_add(&prog, BPF_LD  | BPF_B   | BPF_ABS, 0, 0, FILTER_IP6_PAYLOAD_OFF);
+    filter_add(&prog, BPF_JMP | BPF_JEQ | BPF_K,   3, FILTER_JUMP_DROP, ME6E_IPPROTO_ETHERIP);
+
+    // EtherIPバージョンチェック(先頭オクテットの上位4bit)
+    filter_add(&prog, BPF_LD  | BPF_B   | BPF_ABS, 0, 0, FILTER_IP6_PAYLOAD_OFF);
+    filter_add(&prog, BPF_ALU | BPF_AND | BPF_K,   0, 0, 0xf0);
+    filter_add(&prog, BPF_JMP | BPF_JEQ | BPF_K,   0, FILTER_JUMP_DROP, ETHERIP_VERSION << 4);
+
+    // 送信元/送信先アドレスチェック
+    filter_add_address_check(&prog, handler);
+
+    if (filter_resolve(&prog, &fprog) != 0) {
+        return -1;
+    }
+
+    for (i = 0; i < handler->bb_fanout->num; i++) {
+        if (setsockopt(handler->bb_fanout->fd[i], SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) < 0) {
+            me6e_logging(LOG_ERR, "fail to attach fanout filter : %s.", strerror(errno));
+            return errno;
+        }
+    }
+
+    // IPv6 RAWソケットの受信を止める
+    if (filter_attach_drop(handler->conf->capsuling->bb_fd) != 0) {
+        me6e_logging(LOG_ERR, "fail to attach drop filter to backbone socket : %s.", strerror(errno));
+        return errno;
+    }
+
+    DEBUG_LOG("attach fanout filter len = %d\n", fprog.len);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stub側トンネルデバイス用フィルタ設定関数
+//!
+//! 動作モードと各機能の設定からBPFフィルタを生成し、
+//! トンネルデバイスへ設定する。以下のフレームをカーネル内で破棄する。
+//!
+//!   - Etherヘッダ長に満たないフレーム
+//!   - ME6E-PRモードで転送しないブロードキャスト/マルチキャストフレーム
+//!     (代理ARP/代理NDP/MACアドレス管理で使用するフレームは除く)
+//!
+//! @param [in]     handler      ME6Eハンドラ
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_filter_setup_stub(struct me6e_handler_t* handler)
+{
+    me6e_filter_prog  prog;
+    struct sock_fprog fprog;
+    me6e_config_t*    conf;
+
+    // 引数チェック
+    if (handler == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_filter_setup_stub).");
+        return -1;
+    }
+
+    conf = handler->conf;
+    memset(&prog, 0, sizeof(prog));
+
+    // Etherヘッダ長チェック
+    filter_add(&prog, BPF_LD  | BPF_W   | BPF_LEN, 0, 0, 0);
+    filter_add(&prog, BPF_JMP | BPF_JGE | BPF_K,   0, FILTER_JUMP_DROP, ETH_HLEN);
+
+    // ME6E-PRモードの場合、ブロードキャスト/マルチキャストは転送しない
+    // MACアドレス管理の動的エントリは全フレームの送信元から学習するため除外
+    if ((conf->common->tunnel_mode == ME6E_TUNNEL_MODE_PR) && !conf->mac->mac_entry_update) {
+        // 送信先がユニキャストなら受信
+        filter_add(&prog, BPF_LD  | BPF_B    | BPF_ABS, 0, 0, 0);
+        filter_add(&prog, BPF_JMP | BPF_JSET | BPF_K,   0, FILTER_JUMP_ACCEPT, 0x01);
+
+        // 代理ARP/代理NDPが処理するフレームは受信
+        filter_add(&prog, BPF_LD  | BPF_H    | BPF_ABS, 0, 0, offsetof(struct ether_header, ether_type));
+        if (conf->arp->arp_enable) {
+            filter_add(&prog, BPF_JMP | BPF_JEQ | BPF_K, FILTER_JUMP_ACCEPT, 0, ETHERTYPE_ARP);
+        }
+        if (conf->ndp->ndp_enable) {
+            filter_add(&prog, BPF_JMP | BPF_JEQ | BPF_K, FILTER_JUMP_ACCEPT, 0, ETHERTYPE_IPV6);
+        }
+        filter_add(&prog, BPF_RET | BPF_K, 0, 0, 0);
+    }
+
+    if (filter_resolve(&prog, &fprog) != 0) {
+        return -1;
+    }
+
+    if (ioctl(conf->capsuling->tunnel_device.option.tunnel.fd, TUNATTACHFILTER, &fprog) < 0) {
+        me6e_logging(LOG_ERR, "fail to ioctl TUNATTACHFILTER : %s.", strerror(errno));
+        return errno;
+    }
+
+    DEBUG_LOG("attach stub filter len = %d\n", fprog.len);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フィルタ命令追加関数
+//!
+//! フィルタプログラムの末尾に命令を追加する。
+//!
+//! @param [in,out] prog    フィルタプログラム
+//! @param [in]     code    命令コード
+//! @param [in]     jt      条件成立時のジャンプ先
+//! @param [in]     jf      条件不成立時のジャンプ先
+//! @param [in]     k       オペランド
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void filter_add(me6e_filter_prog* prog,
+                uint16_t code, uint8_t jt, uint8_t jf, uint32_t k)
+{
+    struct sock_filter insn = BPF_JUMP(code, k, jt, jf);
+
+    if (prog->len < FILTER_INSN_MAX) {
+        prog->insn[prog->len] = insn;
+    }
+    prog->len++;
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信元/送信先アドレスチェック命令追加関数
+//!
+//! IPv6ヘッダの送信元/送信先アドレスが自planeのME6Eアドレスかチェックする命令を追加する。
+//! 一致した場合は受信、不一致の場合は破棄する。
+//!
+//! @param [in,out] prog    フィルタプログラム
+//! @param [in]     handler ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void filter_add_address_check(me6e_filter_prog* prog, struct me6e_handler_t* handler)
+{
+    int dst_uni_start;
+
+    // 送信元がマルチキャストアドレスの場合は破棄
+    filter_add(prog, BPF_LD  | BPF_B   | BPF_ABS, 0, 0, FILTER_IP6_SRC_OFF);
+    filter_add(prog, BPF_JMP | BPF_JEQ | BPF_K,   FILTER_JUMP_DROP, 0, 0xff);
+
+    // モードがME6E-PRモードでなければ、送信元のprefixをチェック
+    if (handler->conf->common->tunnel_mode != ME6E_TUNNEL_MODE_PR) {
+        filter_add_uni_prefix_check(prog, FILTER_IP6_SRC_OFF, &handler->unicast_prefix);
+        // 最後の比較は一致した場合に次の命令へ進む
+        prog->insn[prog->len - 1].jt = 0;
+    }
+
+    // 送信先がマルチキャストアドレスかどうかで分岐
+    filter_add(prog, BPF_LD  | BPF_B   | BPF_ABS, 0, 0, FILTER_IP6_DST_OFF);
+    dst_uni_start = prog->len + 1;
+    filter_add(prog, BPF_JMP | BPF_JEQ | BPF_K,   0, 0, 0xff);
+
+    // 送信先ユニキャストのprefixチェック
+    filter_add_uni_prefix_check(prog, FILTER_IP6_DST_OFF, &handler->unicast_prefix);
+
+    // マルチキャストの場合はユニキャストのチェックを飛ばす
+    prog->insn[dst_uni_start - 1].jt = prog->len - dst_uni_start;
+
+    // 送信先マルチキャストのprefixチェック
+    // (マルチキャストグループ対応付け時はグループ番号部分を除く)
+    filter_add_multi_prefix_check(prog, FILTER_IP6_DST_OFF, &handler->multicast_prefix,
+                handler->conf->capsuling->mcast_group_map &&
+                (handler->conf->common->tunnel_mode != ME6E_TUNNEL_MODE_PR) &&
+                !handler->conf->capsuling->l2multi_l3uni);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 全破棄フィルタ設定関数
+//!
+//! @param [in] fd  フィルタを設定するソケット
+//!
+//! @retval 0     正常終了
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+static int filter_attach_drop(int fd)
+{
+    struct sock_filter  drop[] = {
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct sock_fprog   fprog;
+
+    fprog.len    = sizeof(drop) / sizeof(drop[0]);
+    fprog.filter = drop;
+
+    return (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) < 0) ? -1 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ユニキャストプレフィックスチェック命令追加関数
+//!
+//! 指定オフセットのIPv6アドレス上位80bitがプレフィックスと一致するか
+//! チェックする命令を追加する。一致した場合は受信、不一致の場合は破棄する。
+//!
+//! @param [in,out] prog    フィルタプログラム
+//! @param [in]     offset  IPv6アドレスのオフセット
+//! @param [in]     prefix  ME6Eユニキャストプレフィックス
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void filter_add_uni_prefix_check(me6e_filter_prog* prog,
+                int offset, const struct in6_addr* prefix)
+{
+    filter_add(prog, BPF_LD  | BPF_W   | BPF_ABS, 0, 0, offset);
+    filter_add(prog, BPF_JMP | BPF_JEQ | BPF_K,   0, FILTER_JUMP_DROP, ntohl(prefix->s6_addr32[0]));
+    filter_add(prog, BPF_LD  | BPF_W   | BPF_ABS, 0, 0, offset + 4);
+    filter_add(prog, BPF_JMP | BPF_JEQ | BPF_K,   0, FILTER_JUMP_DROP, ntohl(prefix->s6_addr32[1]));
+    filter_add(prog, BPF_LD  | BPF_H   | BPF_ABS, 0, 0, offset + 8);
+    filter_add(prog, BPF_JMP | BPF_JEQ | BPF_K,   FILTER_JUMP_ACCEPT, FILTER_JUMP_DROP,
+                ntohs(prefix->s6_addr16[4]));
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief マルチキャストプレフィックスチェック命令追加関数
+//!
+//! 指定オフセットのIPv6アドレスがME6Eマルチキャストアドレスと一致するか
+//! チェックする命令を追加する。一致した場合は受信、不一致の場合は破棄する。
+//! グループ対応付け時は11-12オクテット目(グループ番号)を比較対象外とする。
+//!
+//! @param [in,out] prog        フィルタプログラム
+//! @param [in]     offset      IPv6アドレスのオフセット
+//! @param [in]     prefix      ME6Eマルチキャストアドレス
+//! @param [in]     group_map   マルチキャストグループ対応付けの有無
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void filter_add_multi_prefix_check(me6e_filter_prog* prog,
+                int offset, const struct in6_addr* prefix, bool group_map)
+{
+    for (int i = 0; i < 4; i++) {
+        uint32_t value = ntohl(prefix->s6_addr32[i]);
+
+        filter_add(prog, BPF_LD  | BPF_W   | BPF_ABS, 0, 0, offset + (i * 4));
+        if (group_map && (i == 2)) {
+            filter_add(prog, BPF_ALU | BPF_AND | BPF_K, 0, 0, 0xffff0000);
+            value &= 0xffff0000;
+        }
+        filter_add(prog, BPF_JMP | BPF_JEQ | BPF_K,
+                    (i == 3) ? FILTER_JUMP_ACCEPT : 0, FILTER_JUMP_DROP, value);
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フィルタプログラム確定関数
+//!
+//! フィルタプログラムの末尾に受信/破棄命令を追加してジャンプ先を解決し、
+//! カーネルへ設定する形式に変換する。
+//!
+//! @param [in,out] prog    フィルタプログラム
+//! @param [out]    fprog   カーネル設定用のフィルタプログラム
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int filter_resolve(me6e_filter_prog* prog, struct sock_fprog* fprog)
+{
+    int               accept;
+    int               drop;
+
+    // 受信/破棄命令の追加
+    accept = prog->len;
+    filter_add(prog, BPF_RET | BPF_K, 0, 0, 0xffffffff);
+    drop = prog->len;
+    filter_add(prog, BPF_RET | BPF_K, 0, 0, 0);
+
+    if (prog->len > FILTER_INSN_MAX) {
+        me6e_logging(LOG_ERR, "filter program too long : %d.", prog->len);
+        return -1;
+    }
+
+    // ジャンプ先の解決
+    for (int i = 0; i < prog->len; i++) {
+        struct sock_filter* insn = &prog->insn[i];
+        if (BPF_CLASS(insn->code) != BPF_JMP) {
+            continue;
+        }
+        if (insn->jt == FILTER_JUMP_DROP) {
+            insn->jt = drop - i - 1;
+        } else if (insn->jt == FILTER_JUMP_ACCEPT) {
+            insn->jt = accept - i - 1;
+        }
+        if (insn->jf == FILTER_JUMP_DROP) {
+            insn->jf = drop - i - 1;
+        } else if (insn->jf == FILTER_JUMP_ACCEPT) {
+            insn->jf = accept - i - 1;
+        }
+    }
+
+    fprog->len    = prog->len;
+    fprog->filter = prog->insn;
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_filter.h                                              */
+/* 機能概要   : カーネルパケットフィルタ設定 ヘッダファイル                   */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_FILTER_H__
+#define __ME6EAPP_FILTER_H__
+
+#include "me6eapp.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+int me6e_filter_setup_backbone(struct me6e_handler_t* handler);
+int me6e_filter_setup_fanout(struct me6e_handler_t* handler);
+int me6e_filter_setup_stub(struct me6e_handler_t* handler);
+
+#endif // __ME6EAPP_FILTER_H__
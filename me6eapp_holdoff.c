@@ -0,0 +1,126 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_holdoff.c                                             */
+/* 機能概要   : フラッディング抑止テーブル ソースファイル                     */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "me6eapp_holdoff.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static inline uint32_t holdoff_calc_hash(const struct in6_addr* target);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フラッディング抑止テーブル生成関数
+//!
+//! フラッディング抑止テーブルを生成する。
+//!
+//! @param [in] holdoff 抑止時間(秒)
+//!
+//! @return 生成したテーブルへのポインタ
+///////////////////////////////////////////////////////////////////////////////
+me6e_holdoff_t* me6e_holdoff_create(int holdoff)
+{
+    me6e_holdoff_t* table;
+
+    // 引数チェック
+    if (holdoff <= 0) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_holdoff_create).");
+        return NULL;
+    }
+
+    table = malloc(sizeof(me6e_holdoff_t));
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for holdoff table.");
+        return NULL;
+    }
+
+    memset(table, 0, sizeof(me6e_holdoff_t));
+    table->holdoff = holdoff;
+
+    return table;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フラッディング抑止テーブル解放関数
+//!
+//! フラッディング抑止テーブルを解放する。
+//!
+//! @param [in] table   フラッディング抑止テーブル
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_holdoff_destroy(me6e_holdoff_t* table)
+{
+    free(table);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フラッディング可否判定関数
+//!
+//! 指定ターゲットへの要求を転送(フラッディング)してよいか判定する。
+//! 抑止時間内に同一ターゲットへの要求を転送済みの場合は不可とし、
+//! それ以外の場合は転送時刻を記録して可とする。
+//!
+//! @param [in,out] table   フラッディング抑止テーブル
+//! @param [in]     target  要求のターゲットアドレス
+//!
+//! @retval true  転送可
+//! @retval false 転送不可(抑止時間内)
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_holdoff_check(me6e_holdoff_t* table, const struct in6_addr* target)
+{
+    struct timespec       now;
+    me6e_holdoff_entry_t* entry;
+
+    // 引数チェック
+    if ((table == NULL) || (target == NULL)) {
+        return true;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+    entry = &table->entry[holdoff_calc_hash(target) % ME6E_HOLDOFF_TABLE_SIZE];
+    if ((entry->expire > now.tv_sec) && IN6_ARE_ADDR_EQUAL(&entry->target, target)) {
+        // 抑止時間内
+        return false;
+    }
+
+    entry->target = *target;
+    entry->expire = now.tv_sec + table->holdoff;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ハッシュ値算出関数
+//!
+//! ターゲットアドレスからテーブルの格納位置を算出する。
+//!
+//! @param [in] target  ターゲットアドレス
+//!
+//! @return ハッシュ値
+///////////////////////////////////////////////////////////////////////////////
+static inline uint32_t holdoff_calc_hash(const struct in6_addr* target)
+{
+    uint32_t hash = 0;
+
+    for (int i = 0; i < 4; i++) {
+        hash ^= target->s6_addr32[i];
+        hash *= 0x9e3779b1;
+        hash ^= hash >> 16;
+    }
+
+    return hash;
+}
@@ -0,0 +1,49 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_holdoff.h                                             */
+/* 機能概要   : フラッディング抑止テーブル ヘッダファイル                     */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_HOLDOFF_H__
+#define __ME6EAPP_HOLDOFF_H__
+
+#include <stdbool.h>
+#include <time.h>
+#include <netinet/in.h>
+
+//! フラッディング抑止テーブルのエントリ数
+#define ME6E_HOLDOFF_TABLE_SIZE 1024
+
+///////////////////////////////////////////////////////////////////////////////
+//! フラッディング抑止テーブル エントリ
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_holdoff_entry_t
+{
+    struct in6_addr     target;         ///< 要求のターゲットアドレス
+    time_t              expire;         ///< 抑止の満了時刻(単調増加時刻)
+};
+typedef struct me6e_holdoff_entry_t me6e_holdoff_entry_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! フラッディング抑止テーブル
+//!
+//! ターゲットアドレスのハッシュ値で格納位置を決める固定長テーブル。
+//! 衝突した場合は上書きする(抑止が緩むだけで転送漏れは起きない)。
+//! Stub側スレッドからのみ参照するため排他制御は行わない。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_holdoff_t
+{
+    int                     holdoff;                            ///< 抑止時間(秒)
+    me6e_holdoff_entry_t    entry[ME6E_HOLDOFF_TABLE_SIZE];     ///< エントリ
+};
+typedef struct me6e_holdoff_t me6e_holdoff_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_holdoff_t* me6e_holdoff_create(int holdoff);
+void me6e_holdoff_destroy(me6e_holdoff_t* table);
+bool me6e_holdoff_check(me6e_holdoff_t* table, const struct in6_addr* target);
+
+#endif // __ME6EAPP_HOLDOFF_H__
@@ -19,6 +19,7 @@
 #include <fcntl.h>
 #include <sys/signalfd.h>
 #include <sys/prctl.h>
+#include <net/if.h>
 
 
 #include "me6eapp.h"
@@ -29,6 +30,8 @@
 #include "me6eapp_Controller.h"
 #include "me6eapp_mainloop.h"
 #include "me6eapp_pr.h"
+#include "me6eapp_affinity.h"
+#include "me6eapp_filter.h"
 
 // デバッグ用マクロ
 #ifdef DEBUG
@@ -76,11 +79,13 @@ int main(int argc, char *argv[])
     int                    ret = 0;
     char*                  conf_file = NULL;
     int                    option_index = 0;
+    int                    i;
     pthread_t              bb_tid = -1;
     pthread_t              stub_tid = -1;
 
     // 初期化処理
     memset(&handler, 0, sizeof(handler));
+    handler.link_fd = -1;
 
     // 引数チェック
     while (1) {
@@ -147,6 +152,10 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // スレッド配置/NUMA配置の初期化
+    // (以降に確保するメモリはBackbone側物理デバイスのNUMAノードを優先する)
+    me6e_affinity_init(handler.conf->capsuling);
+
     // 統計情報用の初期化
     handler.stat_info = me6e_initial_statistics();
     if (handler.stat_info == NULL) {
@@ -244,6 +253,255 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // ME6Eピア監視テーブルの生成
+    // (監視無効時もピアからの監視要求へ応答するため生成する)
+    handler.peer_handler = me6e_peer_create(
+            (handler.conf->capsuling->l2multi_l3uni && handler.conf->capsuling->peer_probe) ?
+                &handler.conf->capsuling->me6e_host_address_list : NULL,
+            handler.conf->capsuling->bb_fd,
+            &handler.me6e_own_v6addr,
+            handler.conf->capsuling->peer_probe_interval,
+            handler.conf->capsuling->peer_probe_dead_count);
+    if(handler.peer_handler == NULL){
+        me6e_logging(LOG_ERR, "fail to create peer table.");
+        // 異常終了
+        ret = -1;
+        goto app_finish;
+    }
+
+    // マルチキャストグループ管理テーブルの生成
+    // (ME6E-FPでL2MC-L3UC機能を使用しない場合のみ)
+    if(handler.conf->capsuling->mcast_group_map &&
+       (handler.conf->common->tunnel_mode != ME6E_TUNNEL_MODE_PR) &&
+       !handler.conf->capsuling->l2multi_l3uni){
+        handler.mcast_handler = me6e_mcast_create(
+                handler.conf->capsuling->bb_fd,
+                if_nametoindex(handler.conf->capsuling->backbone_physical_dev),
+                &handler.multicast_prefix,
+                handler.conf->capsuling->mcast_member_timeout);
+        if(handler.mcast_handler == NULL){
+            me6e_logging(LOG_ERR, "fail to create multicast group table.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+    }
+
+    // パケットバッファプールの生成
+    handler.bufpool = me6e_bufpool_create(
+            handler.backbone_mtu,
+            handler.conf->capsuling->buffer_pool_num,
+            handler.conf->capsuling->buffer_pool_jumbo_num,
+            handler.conf->capsuling->buffer_pool_hugepage);
+    if(handler.bufpool == NULL){
+        me6e_logging(LOG_ERR, "fail to create buffer pool.");
+        // 異常終了
+        ret = -1;
+        goto app_finish;
+    }
+
+    // Stub側パケットリングの生成(パケットリング/AF_XDPで送受信する場合のみ)
+    if(handler.conf->capsuling->stub_backend != ME6E_STUB_BACKEND_BRIDGE){
+        handler.stub_ring = me6e_stub_ring_create(
+                handler.conf->capsuling->stub_physical_dev,
+                handler.conf->capsuling->tunnel_device.option.tunnel.fd,
+                handler.conf->capsuling->tunnel_device.option.tunnel.vnet_hdr,
+                handler.conf->capsuling->bridge_hwaddr,
+                (handler.conf->capsuling->stub_backend == ME6E_STUB_BACKEND_XDP),
+                handler.stat_info);
+        if(handler.stub_ring == NULL){
+            me6e_logging(LOG_ERR, "fail to create stub ring.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+    }
+
+    // Path MTU管理テーブルの生成
+    if(handler.conf->capsuling->pmtu_discovery){
+        handler.pmtu_handler = me6e_pmtu_create(
+                handler.conf->capsuling->bb_fd,
+                handler.conf->capsuling->tunnel_device.option.tunnel.fd,
+                handler.conf->capsuling->tunnel_device.option.tunnel.vnet_hdr,
+                handler.stub_ring,
+                handler.backbone_mtu,
+                handler.conf->capsuling->pmtu_expire,
+                (handler.conf->capsuling->transport == ME6E_TRANSPORT_UDP));
+        if(handler.pmtu_handler == NULL){
+            me6e_logging(LOG_ERR, "fail to create path mtu table.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+    }
+
+    // Backbone側分散受信の生成(分散数の指定時のみ)
+    if(handler.conf->capsuling->backbone_fanout > 0){
+        handler.bb_fanout = me6e_fanout_create(
+                handler.conf->capsuling->backbone_physical_dev,
+                handler.conf->capsuling->backbone_fanout);
+        if(handler.bb_fanout == NULL){
+            me6e_logging(LOG_ERR, "fail to create backbone fanout.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+
+        // パケットソケットのフィルタ設定とIPv6 RAWソケットの受信停止
+        if(me6e_filter_setup_backbone(&handler) != 0){
+            me6e_logging(LOG_ERR, "fail to setup backbone fanout filter.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+    }
+
+    // Backbone側L2直接送信の生成(L2直接送信の動作時のみ)
+    if(handler.conf->capsuling->backbone_l2_fastpath){
+        handler.bb_neigh = me6e_neigh_create(
+                handler.conf->capsuling->backbone_physical_dev,
+                handler.conf->capsuling->bb_fd,
+                handler.conf->capsuling->hop_limit,
+                &handler.backbone_mtu);
+        if(handler.bb_neigh == NULL){
+            me6e_logging(LOG_ERR, "fail to create backbone neighbor table.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+    }
+
+    // EtherIP over UDP送受信の生成(UDPで転送する場合のみ)
+    if(handler.conf->capsuling->transport == ME6E_TRANSPORT_UDP){
+        handler.bb_udp = me6e_udp_create(
+                handler.conf->capsuling->backbone_physical_dev,
+                handler.conf->capsuling->udp_port,
+                handler.conf->capsuling->udp_workers,
+                handler.stat_info,
+                handler.pmtu_handler);
+        if(handler.bb_udp == NULL){
+            me6e_logging(LOG_ERR, "fail to create udp transport.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+    }
+
+    // 受信スレッド/処理スレッド間パイプラインの生成(処理スレッド数の指定時のみ)
+    // (io_uring、パケットリング、分散受信は受信スレッド自身で処理するため併用しない)
+    if(handler.conf->capsuling->pipeline_workers > 0){
+        if((handler.conf->capsuling->io_engine != ME6E_IO_ENGINE_EPOLL) ||
+           (handler.stub_ring != NULL) || (handler.bb_fanout != NULL)){
+            me6e_logging(LOG_WARNING, "pipeline requires epoll, bridge and no fanout. continue without pipeline.");
+        }
+        else{
+            handler.pipeline = me6e_pipeline_create(
+                    handler.bufpool,
+                    handler.conf->capsuling->pipeline_workers,
+                    handler.conf->capsuling->pipeline_ring_size);
+            if(handler.pipeline == NULL){
+                me6e_logging(LOG_ERR, "fail to create pipeline.");
+                // 異常終了
+                ret = -1;
+                goto app_finish;
+            }
+        }
+    }
+
+    // Stub側送信のセグメント結合管理の生成(仮想NICヘッダ有効時のみ)
+    // (パケットリング使用時はフレーム毎に送信先を振り分けるため結合しない)
+    // (分散受信時、UDP転送時、パイプライン使用時は複数スレッドから送信するため結合しない)
+    if(handler.conf->capsuling->tunnel_gro &&
+       handler.conf->capsuling->tunnel_device.option.tunnel.vnet_hdr &&
+       (handler.stub_ring == NULL) && (handler.bb_fanout == NULL) &&
+       (handler.bb_udp == NULL) && (handler.pipeline == NULL)){
+        handler.gro_handler = me6e_vnet_gro_create(
+                handler.conf->capsuling->tunnel_device.option.tunnel.fd);
+        if(handler.gro_handler == NULL){
+            me6e_logging(LOG_ERR, "fail to create gro.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+    }
+
+    // トンネル送受信用io_uringの生成(io_uringで送受信する場合のみ)
+    // (生成できない場合はepollで動作するため処理継続)
+    if(handler.conf->capsuling->io_engine == ME6E_IO_ENGINE_URING){
+        if(me6e_create_tunnel_uring(&handler) != 0){
+            me6e_logging(LOG_WARNING, "fail to create io_uring. continue with epoll.");
+        }
+    }
+
+    // 受信待ちのビジーポーリング生成(ビジーポーリング有効時のみ)
+    // (io_uring、分散受信は受信待ちの方式が異なるため対象外)
+    if(handler.conf->capsuling->busy_poll){
+        if(handler.conf->capsuling->busy_poll_usec > 0){
+            // ソケットのビジーポーリング設定(設定できない場合もポーリングは行うため処理継続)
+            me6e_busypoll_setsockopt(handler.conf->capsuling->bb_fd,
+                                     handler.conf->capsuling->busy_poll_usec);
+            for(i = 0; (handler.bb_udp != NULL) && (i < handler.bb_udp->recv_num); i++){
+                me6e_busypoll_setsockopt(handler.bb_udp->recv_fd[i],
+                                         handler.conf->capsuling->busy_poll_usec);
+            }
+        }
+        if((handler.bb_uring == NULL) && (handler.bb_fanout == NULL)){
+            handler.bb_busypoll = me6e_busypoll_create("backbone",
+                                        handler.conf->capsuling->busy_poll_budget);
+            if(handler.bb_busypoll == NULL){
+                me6e_logging(LOG_ERR, "fail to create backbone busy poll.");
+                // 異常終了
+                ret = -1;
+                goto app_finish;
+            }
+        }
+        if(handler.stub_uring == NULL){
+            handler.stub_busypoll = me6e_busypoll_create("stub",
+                                        handler.conf->capsuling->busy_poll_budget);
+            if(handler.stub_busypoll == NULL){
+                me6e_logging(LOG_ERR, "fail to create stub busy poll.");
+                // 異常終了
+                ret = -1;
+                goto app_finish;
+            }
+        }
+    }
+
+    // 送信キューの生成(送信キューの上限フレーム数の指定時のみ)
+    // (Stub側はパケットリング、セグメント結合が独自に送信するため対象外)
+    if(handler.conf->capsuling->tx_queue_len > 0){
+        handler.bb_txq = me6e_txq_create("backbone", ME6E_TXQ_TYPE_SOCKET,
+                handler.conf->capsuling->bb_fd, false, handler.bufpool,
+                handler.conf->capsuling->tx_queue_len,
+                handler.conf->capsuling->tx_queue_policy);
+        if(handler.bb_txq == NULL){
+            me6e_logging(LOG_ERR, "fail to create backbone tx queue.");
+            // 異常終了
+            ret = -1;
+            goto app_finish;
+        }
+        if((handler.stub_ring == NULL) && (handler.gro_handler == NULL)){
+            handler.stub_txq = me6e_txq_create("stub", ME6E_TXQ_TYPE_TAP,
+                    handler.conf->capsuling->tunnel_device.option.tunnel.fd,
+                    handler.conf->capsuling->tunnel_device.option.tunnel.vnet_hdr,
+                    handler.bufpool,
+                    handler.conf->capsuling->tx_queue_len,
+                    handler.conf->capsuling->tx_queue_policy);
+            if(handler.stub_txq == NULL){
+                me6e_logging(LOG_ERR, "fail to create stub tx queue.");
+                // 異常終了
+                ret = -1;
+                goto app_finish;
+            }
+        }
+    }
+
+    // Backbone側物理デバイスのMTU変更監視
+    // (監視できない場合もMTUの追従以外は動作するため処理継続)
+    if(me6e_open_backbone_link_monitor(&handler) != 0){
+        me6e_logging(LOG_WARNING, "fail to open backbone link monitor. continue without mtu update.");
+    }
+
     // 各機能クラスのインスタンスを生成
     if(me6e_construct_instances(&handler) != 0){
         me6e_logging(LOG_ERR, "fail to construct instances.");
@@ -282,6 +540,10 @@ int main(int argc, char *argv[])
         goto app_finish;
     }
 
+    // 制御スレッド(メインループ)のCPU割り当て
+    // (トンネルスレッドへ引き継がないよう、トンネルスレッド起動後に行う)
+    me6e_affinity_apply(ME6E_THREAD_CONTROL);
+
     // mainloop
     ret = me6e_mainloop(&handler);
 
@@ -299,6 +561,27 @@ app_finish:
 
     me6e_release_instances(&handler);
     me6e_destroy_instances(&handler);
+    me6e_peer_destroy(handler.peer_handler);
+    me6e_mcast_destroy(handler.mcast_handler);
+    me6e_pmtu_destroy(handler.pmtu_handler);
+    me6e_vnet_gro_destroy(handler.gro_handler);
+    me6e_destroy_tunnel_uring(&handler);
+    me6e_stub_ring_destroy(handler.stub_ring);
+    if(handler.bb_fanout != NULL){
+        // IPv6 RAWソケットのフィルタを戻す
+        me6e_fanout_destroy(handler.bb_fanout);
+        handler.bb_fanout = NULL;
+        me6e_filter_setup_backbone(&handler);
+    }
+    me6e_neigh_destroy(handler.bb_neigh);
+    me6e_udp_destroy(handler.bb_udp);
+    me6e_pipeline_destroy(handler.pipeline);
+    me6e_busypoll_destroy(handler.bb_busypoll);
+    me6e_busypoll_destroy(handler.stub_busypoll);
+    me6e_txq_destroy(handler.bb_txq);
+    me6e_txq_destroy(handler.stub_txq);
+    me6e_bufpool_destroy(handler.bufpool);
+    me6e_close_backbone_link_monitor(&handler);
     me6e_close_backbone_network(&handler);
     me6e_detach_bridge(&handler);
     me6e_delete_bridge_device(&handler);
@@ -307,6 +590,7 @@ app_finish:
         me6e_pr_destruct_pr_table(handler.pr_handler);
     }
     me6e_finish_statistics(handler.stat_info);
+    me6e_affinity_release();
     me6e_logging(LOG_INFO, "ME6E application finish!!");
     me6e_config_destruct(handler.conf);
 
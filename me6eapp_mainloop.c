@@ -36,6 +36,9 @@
 #include "me6eapp_util.h"
 #include "me6eapp_ProxyArp.h"
 #include "me6eapp_ProxyNdp.h"
+#include "me6eapp_peer.h"
+#include "me6eapp_mcast.h"
+#include "me6eapp_setup.h"
 
 #include "me6eapp_pr.h"
 
@@ -128,6 +131,72 @@ int me6e_mainloop(struct me6e_handler_t* handler)
         return -1;
     }
 
+    // ME6Eピア監視タイマをepollへ登録
+    if (handler->peer_handler->timer_fd >= 0) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = handler->peer_handler->timer_fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, handler->peer_handler->timer_fd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll peer timer : %s.", strerror(errno));
+            return -1;
+        }
+    }
+
+    // マルチキャストグループ エージングタイマをepollへ登録
+    if (handler->mcast_handler != NULL) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = handler->mcast_handler->timer_fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, handler->mcast_handler->timer_fd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll multicast timer : %s.", strerror(errno));
+            return -1;
+        }
+    }
+
+    // Backbone側リンク変更通知をepollへ登録
+    if (handler->link_fd >= 0) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = handler->link_fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, handler->link_fd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll link monitor : %s.", strerror(errno));
+            return -1;
+        }
+    }
+
+    // Backbone側経路/近隣変更通知をepollへ登録
+    if (handler->bb_neigh != NULL) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = handler->bb_neigh->nl_fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, handler->bb_neigh->nl_fd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll neighbor monitor : %s.", strerror(errno));
+            return -1;
+        }
+    }
+
+    // Path MTU エージングタイマをepollへ登録
+    if (handler->pmtu_handler != NULL) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = handler->pmtu_handler->timer_fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, handler->pmtu_handler->timer_fd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll path mtu timer : %s.", strerror(errno));
+            return -1;
+        }
+    }
+
+    // EtherIP over UDP送信ソケットのエラー通知をepollへ登録
+    if (handler->bb_udp != NULL) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = handler->bb_udp->err_epfd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, handler->bb_udp->err_epfd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll udp error : %s.", strerror(errno));
+            return -1;
+        }
+    }
+
     DEBUG_LOG("mainloop start");
     while(1){
         // 受信待ち
@@ -158,6 +227,26 @@ int me6e_mainloop(struct me6e_handler_t* handler)
                     // ハンドラの戻り値がfalseの場合はループを抜ける
                     goto FINISH;    // 多重ループを抜けるためgotoを使用
                 }
+            } else if(ev_ret[loop].data.fd == handler->peer_handler->timer_fd) {
+                DEBUG_LOG("peer probe timer expire\n");
+                me6e_peer_timeout(handler->peer_handler);
+            } else if((handler->mcast_handler != NULL) &&
+                      (ev_ret[loop].data.fd == handler->mcast_handler->timer_fd)) {
+                DEBUG_LOG("multicast aging timer expire\n");
+                me6e_mcast_timeout(handler->mcast_handler);
+            } else if((handler->link_fd >= 0) && (ev_ret[loop].data.fd == handler->link_fd)) {
+                DEBUG_LOG("backbone link change receive\n");
+                me6e_backbone_link_changed(handler);
+            } else if((handler->bb_neigh != NULL) && (ev_ret[loop].data.fd == handler->bb_neigh->nl_fd)) {
+                DEBUG_LOG("backbone neighbor change receive\n");
+                me6e_neigh_changed(handler->bb_neigh);
+            } else if((handler->pmtu_handler != NULL) &&
+                      (ev_ret[loop].data.fd == handler->pmtu_handler->timer_fd)) {
+                DEBUG_LOG("path mtu aging timer expire\n");
+                me6e_pmtu_timeout(handler->pmtu_handler);
+            } else if((handler->bb_udp != NULL) && (ev_ret[loop].data.fd == handler->bb_udp->err_epfd)) {
+                DEBUG_LOG("udp send error receive\n");
+                me6e_udp_recv_error(handler->bb_udp);
             } else {
                 me6e_logging(LOG_ERR, "unknown fd = %d.", ev_ret[loop].data.fd);
                 me6e_logging(LOG_ERR, "command_fd = %d.", command_fd);
@@ -232,6 +321,12 @@ static inline bool command_handler(int fd, struct me6e_handler_t* handler)
         }
         if(command.res.result == 0){
             me6e_printf_statistics_info(handler->stat_info, sock);
+            me6e_bufpool_print(handler->bufpool, sock);
+            me6e_pipeline_print(handler->pipeline, sock);
+            me6e_busypoll_print(handler->bb_busypoll, sock);
+            me6e_busypoll_print(handler->stub_busypoll, sock);
+            me6e_txq_print(handler->bb_txq, sock);
+            me6e_txq_print(handler->stub_txq, sock);
         }
         break;
 
@@ -291,6 +386,26 @@ static inline bool command_handler(int fd, struct me6e_handler_t* handler)
         }
         break;
 
+    case ME6E_SHOW_PEER:
+        if(ret > 0){
+            command.res.result = 0;
+        }
+        else{
+            command.res.result = -ret;
+        }
+        ret = me6e_socket_send(sock, command.code, &command.res, sizeof(command.res), -1);
+        if(ret < 0){
+            me6e_logging(LOG_WARNING, "fail to send response to external command : %s.", strerror(-ret));
+        }
+        if(command.res.result == 0){
+            if (handler->peer_handler->timer_fd >= 0) {
+                me6e_peer_print_table(handler->peer_handler, sock);
+            } else {
+                dprintf(sock, "Peer probe disable...\n");
+            }
+        }
+        break;
+
     case ME6E_SHUTDOWN:
         if(ret > 0){
             command.res.result = 0;
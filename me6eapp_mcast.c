@@ -0,0 +1,633 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_mcast.c                                               */
+/* 機能概要   : マルチキャストグループ管理 ソースファイル                     */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <arpa/inet.h>
+#include <netinet/ip.h>
+#include <netinet/ip6.h>
+#include <netinet/icmp6.h>
+#include <linux/if_ether.h>
+
+#include "me6eapp_mcast.h"
+#include "me6eapp_log.h"
+
+//! IGMPメッセージタイプ
+#define IGMP_V1_MEMBERSHIP_REPORT   0x12
+#define IGMP_V2_MEMBERSHIP_REPORT   0x16
+#define IGMP_V2_LEAVE_GROUP         0x17
+#define IGMP_V3_MEMBERSHIP_REPORT   0x22
+
+//! MLDv2 Reportのメッセージタイプ
+#define MLD_V2_LISTENER_REPORT      143
+
+//! IGMPv3/MLDv2 グループレコードタイプ
+#define MCAST_MODE_IS_INCLUDE       1
+#define MCAST_MODE_IS_EXCLUDE       2
+#define MCAST_CHANGE_TO_INCLUDE     3
+#define MCAST_CHANGE_TO_EXCLUDE     4
+#define MCAST_ALLOW_NEW_SOURCES     5
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static void mcast_snoop_igmp(me6e_mcast_table_t* table, uint8_t* buf, ssize_t len);
+static void mcast_snoop_mld(me6e_mcast_table_t* table, uint8_t* buf, ssize_t len);
+static void mcast_record(me6e_mcast_table_t* table, const uint8_t* mac, int record_type, int nsrcs);
+static void mcast_join(me6e_mcast_table_t* table, const uint8_t* mac);
+static void mcast_leave(me6e_mcast_table_t* table, const uint8_t* mac);
+static void mcast_group_change(me6e_mcast_table_t* table, uint16_t group, bool join);
+static inline time_t mcast_now(void);
+static inline bool mcast_is_mapped_mac(const uint8_t* mac);
+static inline uint16_t mcast_calc_group(const uint8_t* mac);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief マルチキャストグループ管理テーブル生成関数
+//!
+//! マルチキャストグループ管理テーブルを生成し、エージング周期タイマを起動する。
+//!
+//! @param [in] bb_fd           Backbone側ソケット
+//! @param [in] bb_ifindex      Backbone側物理デバイスのインデックス
+//! @param [in] multi_prefix    ME6Eマルチキャストアドレス(基本グループ)
+//! @param [in] member_timeout  メンバーシップの保持時間(秒)
+//!
+//! @return 生成したテーブルへのポインタ
+///////////////////////////////////////////////////////////////////////////////
+me6e_mcast_table_t* me6e_mcast_create(int bb_fd, unsigned int bb_ifindex,
+        const struct in6_addr* multi_prefix, int member_timeout)
+{
+    me6e_mcast_table_t* table;
+    struct itimerspec   ispec = {
+        .it_value    = { .tv_sec = 1, .tv_nsec = 0 },
+        .it_interval = { .tv_sec = 1, .tv_nsec = 0 },
+    };
+
+    // 引数チェック
+    if ((multi_prefix == NULL) || (bb_fd < 0) || (member_timeout <= 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_mcast_create).");
+        return NULL;
+    }
+
+    table = malloc(sizeof(me6e_mcast_table_t));
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for multicast group table.");
+        return NULL;
+    }
+
+    memset(table, 0, sizeof(me6e_mcast_table_t));
+    pthread_mutex_init(&table->mutex, NULL);
+    table->bb_fd          = bb_fd;
+    table->bb_ifindex     = bb_ifindex;
+    table->multi_prefix   = *multi_prefix;
+    table->member_timeout = member_timeout;
+
+    // エージング周期タイマの起動
+    table->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (table->timer_fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create multicast aging timer : %s.", strerror(errno));
+        pthread_mutex_destroy(&table->mutex);
+        free(table);
+        return NULL;
+    }
+    if (timerfd_settime(table->timer_fd, 0, &ispec, NULL) < 0) {
+        me6e_logging(LOG_ERR, "fail to start multicast aging timer : %s.", strerror(errno));
+        close(table->timer_fd);
+        pthread_mutex_destroy(&table->mutex);
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief マルチキャストグループ管理テーブル解放関数
+//!
+//! Join中の外側グループからLeaveし、テーブルを解放する。
+//!
+//! @param [in] table   マルチキャストグループ管理テーブル
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_mcast_destroy(me6e_mcast_table_t* table)
+{
+    if (table == NULL) {
+        return;
+    }
+
+    for (int i = 1; i < ME6E_MCAST_GROUP_NUM; i++) {
+        if (table->refcnt[i] > 0) {
+            mcast_group_change(table, i, false);
+        }
+    }
+
+    close(table->timer_fd);
+    pthread_mutex_destroy(&table->mutex);
+    free(table);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 外側マルチキャストアドレス生成関数
+//!
+//! 内側の宛先マルチキャストMACアドレスに対応する外側グループアドレスを生成する。
+//! 外側グループはME6Eマルチキャストアドレスの11-12オクテット目に
+//! グループ番号を格納したアドレスとする。
+//! 対応付け対象外(ブロードキャストやリンクローカルの制御用グループ等)は
+//! 基本グループとする。
+//!
+//! @param [in]  table  マルチキャストグループ管理テーブル
+//! @param [in]  mac    内側の宛先MACアドレス
+//! @param [out] addr   外側マルチキャストアドレス
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_mcast_group_addr(me6e_mcast_table_t* table, const uint8_t* mac, struct in6_addr* addr)
+{
+    *addr = table->multi_prefix;
+
+    if (mcast_is_mapped_mac(mac)) {
+        addr->s6_addr16[5] = htons(mcast_calc_group(mac));
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief IGMP/MLD Snooping関数
+//!
+//! StubNWから受信したパケットがIGMP/MLDのReport/Leaveの場合、
+//! 内側グループのメンバーシップを更新する。
+//!
+//! @param [in,out] table       マルチキャストグループ管理テーブル
+//! @param [in]     recv_buffer 受信データ
+//! @param [in]     recv_len    受信データのサイズ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_mcast_snoop(me6e_mcast_table_t* table, char* recv_buffer, ssize_t recv_len)
+{
+    struct ethhdr*  eth = (struct ethhdr*)recv_buffer;
+    uint8_t*        buf = (uint8_t*)recv_buffer + ETH_HLEN;
+    ssize_t         len = recv_len - ETH_HLEN;
+
+    // 引数チェック
+    if ((table == NULL) || (recv_buffer == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_mcast_snoop).");
+        return;
+    }
+
+    if (recv_len < ETH_HLEN) {
+        return;
+    }
+
+    switch (ntohs(eth->h_proto)) {
+    case ETH_P_IP:
+        mcast_snoop_igmp(table, buf, len);
+        break;
+
+    case ETH_P_IPV6:
+        mcast_snoop_mld(table, buf, len);
+        break;
+
+    default:
+        break;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief メンバーシップ エージング関数
+//!
+//! 保持時間を過ぎた内側グループのメンバーシップを削除し、
+//! 参照が無くなった外側グループからLeaveする。
+//!
+//! @param [in,out] table   マルチキャストグループ管理テーブル
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_mcast_timeout(me6e_mcast_table_t* table)
+{
+    uint64_t    expire;
+    time_t      now;
+
+    // 引数チェック
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_mcast_timeout).");
+        return;
+    }
+
+    // タイマ満了回数の読み捨て
+    if (read(table->timer_fd, &expire, sizeof(expire)) < 0) {
+        if (errno != EAGAIN) {
+            me6e_logging(LOG_ERR, "fail to read multicast aging timer : %s.", strerror(errno));
+        }
+        return;
+    }
+
+    now = mcast_now();
+
+    pthread_mutex_lock(&table->mutex);
+    for (int i = 0; i < ME6E_MCAST_MEMBER_MAX; i++) {
+        me6e_mcast_member_t* member = &table->member[i];
+        if (member->used && (member->expire <= now)) {
+            member->used = false;
+            if (--table->refcnt[member->group] == 0) {
+                mcast_group_change(table, member->group, false);
+            }
+        }
+    }
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief IGMP Snooping関数
+//!
+//! @param [in,out] table   マルチキャストグループ管理テーブル
+//! @param [in]     buf     IPv4ヘッダの先頭
+//! @param [in]     len     IPv4ヘッダ以降のサイズ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void mcast_snoop_igmp(me6e_mcast_table_t* table, uint8_t* buf, ssize_t len)
+{
+    struct iphdr*   ip = (struct iphdr*)buf;
+    uint8_t*        igmp;
+    uint8_t         mac[ETH_ALEN] = {0x01, 0x00, 0x5e, 0x00, 0x00, 0x00};
+    ssize_t         hlen;
+
+    if ((len < (ssize_t)sizeof(struct iphdr)) || (ip->protocol != IPPROTO_IGMP)) {
+        return;
+    }
+
+    hlen = ip->ihl * 4;
+    if (len < hlen + 8) {
+        return;
+    }
+    igmp = buf + hlen;
+    len -= hlen;
+
+    switch (igmp[0]) {
+    case IGMP_V1_MEMBERSHIP_REPORT:
+    case IGMP_V2_MEMBERSHIP_REPORT:
+    case IGMP_V2_LEAVE_GROUP:
+        // グループアドレスの下位23bitをMACアドレスへ変換
+        mac[3] = igmp[5] & 0x7f;
+        mac[4] = igmp[6];
+        mac[5] = igmp[7];
+        if (igmp[0] == IGMP_V2_LEAVE_GROUP) {
+            mcast_leave(table, mac);
+        } else {
+            mcast_join(table, mac);
+        }
+        break;
+
+    case IGMP_V3_MEMBERSHIP_REPORT:
+    {
+        int      num = (igmp[6] << 8) | igmp[7];
+        ssize_t  off = 8;
+
+        for (int i = 0; i < num; i++) {
+            if (len < off + 8) {
+                break;
+            }
+            int type   = igmp[off];
+            int auxlen = igmp[off + 1];
+            int nsrcs  = (igmp[off + 2] << 8) | igmp[off + 3];
+
+            mac[3] = igmp[off + 5] & 0x7f;
+            mac[4] = igmp[off + 6];
+            mac[5] = igmp[off + 7];
+            mcast_record(table, mac, type, nsrcs);
+
+            off += 8 + (nsrcs * 4) + (auxlen * 4);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief MLD Snooping関数
+//!
+//! @param [in,out] table   マルチキャストグループ管理テーブル
+//! @param [in]     buf     IPv6ヘッダの先頭
+//! @param [in]     len     IPv6ヘッダ以降のサイズ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void mcast_snoop_mld(me6e_mcast_table_t* table, uint8_t* buf, ssize_t len)
+{
+    struct ip6_hdr* ip6 = (struct ip6_hdr*)buf;
+    uint8_t*        mld;
+    uint8_t         mac[ETH_ALEN] = {0x33, 0x33, 0x00, 0x00, 0x00, 0x00};
+    uint8_t         nxt;
+    ssize_t         off;
+
+    if (len < (ssize_t)sizeof(struct ip6_hdr)) {
+        return;
+    }
+
+    // MLDはHop-by-Hopオプション(Router Alert)の後ろに付く
+    nxt = ip6->ip6_nxt;
+    off = sizeof(struct ip6_hdr);
+    if (nxt == IPPROTO_HOPOPTS) {
+        if (len < off + 8) {
+            return;
+        }
+        nxt  = buf[off];
+        off += (buf[off + 1] + 1) * 8;
+    }
+    if ((nxt != IPPROTO_ICMPV6) || (len < off + 24)) {
+        return;
+    }
+    mld = buf + off;
+    len -= off;
+
+    switch (mld[0]) {
+    case MLD_LISTENER_REPORT:
+    case MLD_LISTENER_REDUCTION:
+        // グループアドレスの下位32bitをMACアドレスへ変換
+        memcpy(&mac[2], &mld[20], 4);
+        if (mld[0] == MLD_LISTENER_REDUCTION) {
+            mcast_leave(table, mac);
+        } else {
+            mcast_join(table, mac);
+        }
+        break;
+
+    case MLD_V2_LISTENER_REPORT:
+    {
+        int      num = (mld[6] << 8) | mld[7];
+        ssize_t  roff = 8;
+
+        for (int i = 0; i < num; i++) {
+            if (len < roff + 20) {
+                break;
+            }
+            int type   = mld[roff];
+            int auxlen = mld[roff + 1];
+            int nsrcs  = (mld[roff + 2] << 8) | mld[roff + 3];
+
+            memcpy(&mac[2], &mld[roff + 16], 4);
+            mcast_record(table, mac, type, nsrcs);
+
+            roff += 20 + (nsrcs * 16) + (auxlen * 4);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief IGMPv3/MLDv2 グループレコード処理関数
+//!
+//! 送信元指定の無いINCLUDEはLeave、それ以外はJoinとして扱う。
+//! BLOCK_OLD_SOURCESなど上記以外のレコードは無視する。
+//!
+//! @param [in,out] table       マルチキャストグループ管理テーブル
+//! @param [in]     mac         内側マルチキャストMACアドレス
+//! @param [in]     record_type グループレコードタイプ
+//! @param [in]     nsrcs       送信元アドレス数
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void mcast_record(me6e_mcast_table_t* table, const uint8_t* mac, int record_type, int nsrcs)
+{
+    switch (record_type) {
+    case MCAST_MODE_IS_EXCLUDE:
+    case MCAST_CHANGE_TO_EXCLUDE:
+    case MCAST_ALLOW_NEW_SOURCES:
+        mcast_join(table, mac);
+        break;
+
+    case MCAST_MODE_IS_INCLUDE:
+    case MCAST_CHANGE_TO_INCLUDE:
+        if (nsrcs > 0) {
+            mcast_join(table, mac);
+        } else {
+            mcast_leave(table, mac);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief メンバーシップ追加/更新関数
+//!
+//! 内側グループのメンバーシップを追加または保持時間を更新する。
+//! 外側グループの参照が新たに発生した場合はJoinする。
+//!
+//! @param [in,out] table   マルチキャストグループ管理テーブル
+//! @param [in]     mac     内側マルチキャストMACアドレス
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void mcast_join(me6e_mcast_table_t* table, const uint8_t* mac)
+{
+    me6e_mcast_member_t* free_entry = NULL;
+    time_t               expire;
+
+    if (!mcast_is_mapped_mac(mac)) {
+        return;
+    }
+
+    expire = mcast_now() + table->member_timeout;
+
+    pthread_mutex_lock(&table->mutex);
+    for (int i = 0; i < ME6E_MCAST_MEMBER_MAX; i++) {
+        me6e_mcast_member_t* member = &table->member[i];
+        if (!member->used) {
+            if (free_entry == NULL) {
+                free_entry = member;
+            }
+            continue;
+        }
+        if (memcmp(member->mac, mac, ETH_ALEN) == 0) {
+            member->expire = expire;
+            pthread_mutex_unlock(&table->mutex);
+            return;
+        }
+    }
+
+    if (free_entry == NULL) {
+        pthread_mutex_unlock(&table->mutex);
+        me6e_logging(LOG_WARNING, "multicast group table is full.");
+        return;
+    }
+
+    free_entry->used   = true;
+    memcpy(free_entry->mac, mac, ETH_ALEN);
+    free_entry->group  = mcast_calc_group(mac);
+    free_entry->expire = expire;
+    if (table->refcnt[free_entry->group]++ == 0) {
+        mcast_group_change(table, free_entry->group, true);
+    }
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief メンバーシップ削除予約関数
+//!
+//! Leave受信時、他の受信者がQueryに応答する猶予を残して
+//! 内側グループのメンバーシップの保持時間を短縮する。
+//!
+//! @param [in,out] table   マルチキャストグループ管理テーブル
+//! @param [in]     mac     内側マルチキャストMACアドレス
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void mcast_leave(me6e_mcast_table_t* table, const uint8_t* mac)
+{
+    time_t expire;
+
+    if (!mcast_is_mapped_mac(mac)) {
+        return;
+    }
+
+    expire = mcast_now() + ME6E_MCAST_LEAVE_HOLD;
+
+    pthread_mutex_lock(&table->mutex);
+    for (int i = 0; i < ME6E_MCAST_MEMBER_MAX; i++) {
+        me6e_mcast_member_t* member = &table->member[i];
+        if (member->used && (memcmp(member->mac, mac, ETH_ALEN) == 0)) {
+            if (member->expire > expire) {
+                member->expire = expire;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 外側グループJoin/Leave関数
+//!
+//! @param [in] table   マルチキャストグループ管理テーブル
+//! @param [in] group   外側グループ番号
+//! @param [in] join    true:Join false:Leave
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void mcast_group_change(me6e_mcast_table_t* table, uint16_t group, bool join)
+{
+    struct ipv6_mreq    mreq;
+    char                address[INET6_ADDRSTRLEN] = { 0 };
+
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.ipv6mr_multiaddr = table->multi_prefix;
+    mreq.ipv6mr_multiaddr.s6_addr16[5] = htons(group);
+    mreq.ipv6mr_interface = table->bb_ifindex;
+
+    if (setsockopt(table->bb_fd, IPPROTO_IPV6, join ? IPV6_JOIN_GROUP : IPV6_LEAVE_GROUP,
+                &mreq, sizeof(mreq))) {
+        me6e_logging(LOG_ERR, "fail to %s multicast group %s : %s.",
+                join ? "join" : "leave",
+                inet_ntop(AF_INET6, &mreq.ipv6mr_multiaddr, address, sizeof(address)),
+                strerror(errno));
+        return;
+    }
+
+    DEBUG_LOG("%s multicast group %s.\n", join ? "join" : "leave",
+            inet_ntop(AF_INET6, &mreq.ipv6mr_multiaddr, address, sizeof(address)));
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 現在時刻取得関数(単調増加時刻)
+//!
+//! @return 現在時刻(秒)
+///////////////////////////////////////////////////////////////////////////////
+static inline time_t mcast_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+    return now.tv_sec;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 外側グループ対応付け対象判定関数
+//!
+//! IPv4/IPv6マルチキャストMACアドレスのうち、Snoopingで受信者を学習できる
+//! グループのみ対応付け対象とする。以下は全ME6E宛ての基本グループを使用する。
+//!   - IPv4 Local Network Control Block(224.0.0.0/24)
+//!   - IPv6 33:33:00:00:xx:xx(全ノード/全ルータ等の予約グループ)
+//!   - IPv6 Solicited-Nodeマルチキャスト(33:33:ff:xx:xx:xx)
+//!   - 上記以外(ブロードキャスト等)
+//!
+//! @param [in] mac 内側の宛先MACアドレス
+//!
+//! @retval true  対応付け対象
+//! @retval false 対応付け対象外
+///////////////////////////////////////////////////////////////////////////////
+static inline bool mcast_is_mapped_mac(const uint8_t* mac)
+{
+    if ((mac[0] == 0x01) && (mac[1] == 0x00) && (mac[2] == 0x5e)) {
+        return !((mac[3] == 0x00) && (mac[4] == 0x00));
+    }
+
+    if ((mac[0] == 0x33) && (mac[1] == 0x33)) {
+        if (mac[2] == 0xff) {
+            return false;
+        }
+        return !((mac[2] == 0x00) && (mac[3] == 0x00));
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 外側グループ番号算出関数
+//!
+//! 全ME6Eノードで同じ値となるよう、MACアドレスのみから算出する。
+//!
+//! @param [in] mac 内側の宛先MACアドレス
+//!
+//! @return 外側グループ番号(1～ME6E_MCAST_GROUP_NUM-1)
+///////////////////////////////////////////////////////////////////////////////
+static inline uint16_t mcast_calc_group(const uint8_t* mac)
+{
+    uint32_t hash = 2166136261u;
+
+    for (int i = 0; i < ETH_ALEN; i++) {
+        hash = (hash ^ mac[i]) * 16777619u;
+    }
+
+    return (hash % (ME6E_MCAST_GROUP_NUM - 1)) + 1;
+}
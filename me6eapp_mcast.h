@@ -0,0 +1,72 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_mcast.h                                               */
+/* 機能概要   : マルチキャストグループ管理 ヘッダファイル                     */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_MCAST_H__
+#define __ME6EAPP_MCAST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <net/ethernet.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 外側マルチキャストグループ数(グループ番号0は全ME6E宛ての基本グループ)
+#define ME6E_MCAST_GROUP_NUM    4096
+//! 管理できる内側マルチキャストグループの最大数
+#define ME6E_MCAST_MEMBER_MAX   1024
+//! Leave受信後にメンバーシップを保持する時間(秒)
+#define ME6E_MCAST_LEAVE_HOLD   2
+
+///////////////////////////////////////////////////////////////////////////////
+//! 内側マルチキャストグループ メンバーシップ情報
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_mcast_member_t
+{
+    bool                used;               ///< 使用中かどうか
+    uint8_t             mac[ETH_ALEN];      ///< 内側マルチキャストMACアドレス
+    uint16_t            group;              ///< 対応する外側グループ番号
+    time_t              expire;             ///< メンバーシップの満了時刻(単調増加時刻)
+};
+typedef struct me6e_mcast_member_t me6e_mcast_member_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! マルチキャストグループ管理テーブル
+//!
+//! Stub側で受信したIGMP/MLDのReportから内側グループのメンバーシップを学習し、
+//! 対応する外側グループへのJoin/Leaveを行う。
+//! 複数の内側グループが同じ外側グループに対応するため、
+//! 外側グループ毎に参照数を管理する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_mcast_table_t
+{
+    pthread_mutex_t     mutex;                          ///< 排他用mutex
+    int                 bb_fd;                          ///< Backbone側ソケット
+    unsigned int        bb_ifindex;                     ///< Backbone側物理デバイスのインデックス
+    int                 timer_fd;                       ///< エージング周期タイマ
+    struct in6_addr     multi_prefix;                   ///< ME6Eマルチキャストアドレス(基本グループ)
+    int                 member_timeout;                 ///< メンバーシップの保持時間(秒)
+    uint16_t            refcnt[ME6E_MCAST_GROUP_NUM];   ///< 外側グループ毎の参照数
+    me6e_mcast_member_t member[ME6E_MCAST_MEMBER_MAX];  ///< 内側グループ メンバーシップ
+};
+typedef struct me6e_mcast_table_t me6e_mcast_table_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_mcast_table_t* me6e_mcast_create(int bb_fd, unsigned int bb_ifindex,
+        const struct in6_addr* multi_prefix, int member_timeout);
+void me6e_mcast_destroy(me6e_mcast_table_t* table);
+void me6e_mcast_snoop(me6e_mcast_table_t* table, char* recv_buffer, ssize_t recv_len);
+void me6e_mcast_timeout(me6e_mcast_table_t* table);
+void me6e_mcast_group_addr(me6e_mcast_table_t* table, const uint8_t* mac, struct in6_addr* addr);
+
+#endif // __ME6EAPP_MCAST_H__
@@ -0,0 +1,726 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_neigh.c                                               */
+/* 機能概要   : Backbone側L2直接送信(経路/近隣キャッシュ) ソースファイル      */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/ip6.h>
+#include <netpacket/packet.h>
+#include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
+
+#include "me6eapp.h"
+#include "me6eapp_neigh.h"
+#include "me6eapp_log.h"
+#include "me6eapp_netlink.h"
+#include "me6eapp_network.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 送信データのScatter/Gather配列の最大数(Ethernet/IPv6ヘッダを除く)
+#define NEIGH_IOV_MAX           4
+
+//! L2直接送信に使用する近隣の状態
+#define NEIGH_USABLE_STATE      (NUD_REACHABLE | NUD_PERMANENT)
+
+///////////////////////////////////////////////////////////////////////////////
+//! 直接送信フレームのヘッダ(Ethernetヘッダ + IPv6ヘッダ)
+///////////////////////////////////////////////////////////////////////////////
+struct neigh_frame_hdr
+{
+    struct ether_header eth;            ///< Ethernetヘッダ
+    struct ip6_hdr      ip6;            ///< IPv6ヘッダ
+} __attribute__((packed));
+
+///////////////////////////////////////////////////////////////////////////////
+//! 経路/近隣の一覧取得要求
+///////////////////////////////////////////////////////////////////////////////
+struct neigh_dump_req
+{
+    struct nlmsghdr     nlh;            ///< Netlinkヘッダ
+    union {
+        struct rtmsg    rtm;            ///< 経路の一覧取得
+        struct ndmsg    ndm;            ///< 近隣の一覧取得
+    };
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int neigh_sync(me6e_neigh_table_t* table);
+static int neigh_dump(me6e_neigh_table_t* table, uint16_t type);
+static int neigh_parse(struct nlmsghdr* nlh, int* errcd, void* data);
+static void neigh_route_update(me6e_neigh_table_t* table, struct nlmsghdr* nlh);
+static void neigh_entry_update(me6e_neigh_table_t* table, struct nlmsghdr* nlh);
+static bool neigh_resolve(me6e_neigh_table_t* table, const struct in6_addr* dst, struct ether_addr* hwaddr);
+static inline bool neigh_prefix_match(const struct in6_addr* addr, const struct in6_addr* prefix, int plen);
+static inline uint32_t neigh_cache_index(const struct in6_addr* addr);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief L2直接送信生成関数
+//!
+//! Backbone側物理デバイスに送信専用のパケットソケットを生成し、
+//! 経路/近隣の変更通知を受信するNetlinkソケットを生成した後、
+//! カーネルの経路表と近隣キャッシュを一覧取得して写しを作成する。
+//!
+//! @param [in] ifname          Backbone側物理デバイス名
+//! @param [in] bb_fd           Backbone側IPv6ソケット(ホップリミット取得用)
+//! @param [in] multicast_hops  マルチキャスト送信時のホップリミット
+//! @param [in] mtu             Backbone側物理デバイスのMTU
+//!
+//! @return 生成したL2直接送信(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_neigh_table_t* me6e_neigh_create(const char* ifname, int bb_fd, int multicast_hops, volatile int* mtu)
+{
+    // ローカル変数宣言
+    me6e_neigh_table_t* table;
+    struct sockaddr_ll  sll;
+    struct sockaddr_nl  local;
+    uint32_t            seq;
+    int                 errcd = 0;
+    socklen_t           len;
+
+    // 引数チェック
+    if ((ifname == NULL) || (bb_fd < 0) || (mtu == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_neigh_create).");
+        return NULL;
+    }
+
+    table = malloc(sizeof(me6e_neigh_table_t));
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "fail to allocate neighbor table.");
+        return NULL;
+    }
+    memset(table, 0, sizeof(me6e_neigh_table_t));
+    pthread_mutex_init(&table->mutex, NULL);
+    table->fd             = -1;
+    table->nl_fd          = -1;
+    table->multicast_hops = multicast_hops;
+    table->mtu            = mtu;
+    // 送信先キャッシュを無効状態にするため世代番号は1から開始
+    table->generation     = 1;
+
+    table->ifindex = if_nametoindex(ifname);
+    if (table->ifindex == 0) {
+        me6e_logging(LOG_ERR, "fail to get index of %s : %s.", ifname, strerror(errno));
+        goto error;
+    }
+
+    if (me6e_network_get_hwaddr_by_name(ifname, &table->hwaddr) != 0) {
+        goto error;
+    }
+
+    // ユニキャストのホップリミットはIPv6ソケットの実効値に合わせる
+    len = sizeof(table->unicast_hops);
+    if (getsockopt(bb_fd, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &table->unicast_hops, &len) < 0) {
+        me6e_logging(LOG_ERR, "fail to get sockopt IPV6_UNICAST_HOPS : %s.", strerror(errno));
+        goto error;
+    }
+
+    // 送信専用のパケットソケット(プロトコル0で受信しない)
+    table->fd = socket(AF_PACKET, SOCK_RAW, 0);
+    if (table->fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create neighbor send socket : %s.", strerror(errno));
+        goto error;
+    }
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family   = AF_PACKET;
+    sll.sll_protocol = 0;
+    sll.sll_ifindex  = table->ifindex;
+    if (bind(table->fd, (struct sockaddr*)&sll, sizeof(sll)) < 0) {
+        me6e_logging(LOG_ERR, "fail to bind neighbor send socket %s : %s.", ifname, strerror(errno));
+        goto error;
+    }
+
+    // 一覧取得中の変更を取りこぼさないよう、変更通知の受信を先に開始する
+    if (me6e_netlink_open(RTMGRP_NEIGH | RTMGRP_IPV6_ROUTE, &table->nl_fd, &local, &seq, &errcd) != RESULT_OK) {
+        me6e_logging(LOG_ERR, "fail to open neighbor monitor : %s.", strerror(errcd));
+        table->nl_fd = -1;
+        goto error;
+    }
+
+    if (neigh_sync(table) != 0) {
+        goto error;
+    }
+
+    me6e_logging(LOG_INFO, "backbone l2 fastpath %s : %d routes, %d neighbors.",
+            ifname, table->route_num, table->entry_num);
+
+    return table;
+
+error:
+    me6e_neigh_destroy(table);
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief L2直接送信解放関数
+//!
+//! @param [in] table   L2直接送信
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_neigh_destroy(me6e_neigh_table_t* table)
+{
+    if (table == NULL) {
+        return;
+    }
+
+    if (table->nl_fd >= 0) {
+        me6e_netlink_close(table->nl_fd);
+    }
+    if (table->fd >= 0) {
+        close(table->fd);
+    }
+    pthread_mutex_destroy(&table->mutex);
+    free(table);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 経路/近隣変更通知受信関数
+//!
+//! 経路/近隣の変更通知を全て読み出し、写しに反映する。
+//! 受信バッファ溢れで通知を取りこぼした場合は、一覧を取得し直す。
+//!
+//! @param [in,out] table   L2直接送信
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_neigh_changed(me6e_neigh_table_t* table)
+{
+    // ローカル変数宣言
+    char                buf[NETLINK_RCVBUF];
+    struct nlmsghdr*    nlh;
+    ssize_t             len;
+    int                 errcd;
+
+    // 引数チェック
+    if ((table == NULL) || (table->nl_fd < 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_neigh_changed).");
+        return;
+    }
+
+    while ((len = recv(table->nl_fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        for (nlh = (struct nlmsghdr*)buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+            neigh_parse(nlh, &errcd, table);
+        }
+    }
+
+    if ((len < 0) && (errno == ENOBUFS)) {
+        me6e_logging(LOG_WARNING, "neighbor monitor overrun. resynchronize.");
+        neigh_sync(table);
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief L2直接送信関数
+//!
+//! 送信先のMACアドレスを解決し、Ethernet/IPv6ヘッダを付加して
+//! Backbone側物理デバイスへ直接送信する。
+//! 送信先を解決できない場合、デバイスのMTUを超える場合は送信しない。
+//!
+//! @param [in] table       L2直接送信
+//! @param [in] src         送信元IPv6アドレス
+//! @param [in] dst         送信先IPv6アドレス
+//! @param [in] flowinfo    フローラベル(ネットワークバイトオーダ)
+//! @param [in] iov         送信データ(IPv6ペイロード)
+//! @param [in] iovcnt      送信データの配列数
+//!
+//! @retval 0   送信した
+//! @retval -1  送信しなかった(呼び出し元でIPv6ソケットから送信すること)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_neigh_send(me6e_neigh_table_t* table, const struct in6_addr* src, const struct in6_addr* dst,
+        uint32_t flowinfo, const struct iovec* iov, int iovcnt)
+{
+    // ローカル変数宣言
+    struct neigh_frame_hdr  hdr;
+    struct iovec            frame_iov[NEIGH_IOV_MAX + 1];
+    struct msghdr           msg;
+    size_t                  plen = 0;
+    int                     i;
+
+    // 引数チェック
+    if ((table == NULL) || (src == NULL) || (dst == NULL) || (iov == NULL) ||
+        (iovcnt <= 0) || (iovcnt > NEIGH_IOV_MAX)) {
+        return -1;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        plen += iov[i].iov_len;
+        frame_iov[i + 1] = iov[i];
+    }
+
+    // フラグメントが必要なパケットはカーネルに任せる
+    if ((sizeof(struct ip6_hdr) + plen) > (size_t)*table->mtu) {
+        return -1;
+    }
+
+    // Ethernetヘッダの設定
+    if (IN6_IS_ADDR_MULTICAST(dst)) {
+        // マルチキャストMACアドレス(33:33 + 送信先アドレスの下位32bit)
+        hdr.eth.ether_dhost[0] = 0x33;
+        hdr.eth.ether_dhost[1] = 0x33;
+        memcpy(&hdr.eth.ether_dhost[2], &dst->s6_addr[12], 4);
+        hdr.ip6.ip6_hlim = table->multicast_hops;
+    }
+    else {
+        if (!neigh_resolve(table, dst, (struct ether_addr*)hdr.eth.ether_dhost)) {
+            return -1;
+        }
+        hdr.ip6.ip6_hlim = table->unicast_hops;
+    }
+    memcpy(hdr.eth.ether_shost, &table->hwaddr, ETH_ALEN);
+    hdr.eth.ether_type = htons(ETHERTYPE_IPV6);
+
+    // IPv6ヘッダの設定
+    hdr.ip6.ip6_flow = htonl(6 << 28) | (flowinfo & htonl(0x000FFFFF));
+    hdr.ip6.ip6_plen = htons(plen);
+    hdr.ip6.ip6_nxt  = ME6E_IPPROTO_ETHERIP;
+    hdr.ip6.ip6_src  = *src;
+    hdr.ip6.ip6_dst  = *dst;
+
+    frame_iov[0].iov_base = &hdr;
+    frame_iov[0].iov_len  = sizeof(hdr);
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = frame_iov;
+    msg.msg_iovlen = iovcnt + 1;
+
+    if (sendmsg(table->fd, &msg, 0) < 0) {
+        DEBUG_LOG("fail to send l2 frame : %s.\n", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 経路/近隣同期関数
+//!
+//! 写しを破棄し、カーネルの経路表と近隣キャッシュを一覧取得し直す。
+//!
+//! @param [in,out] table   L2直接送信
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int neigh_sync(me6e_neigh_table_t* table)
+{
+    pthread_mutex_lock(&table->mutex);
+    table->route_num = 0;
+    table->entry_num = 0;
+    table->generation++;
+    pthread_mutex_unlock(&table->mutex);
+
+    if (neigh_dump(table, RTM_GETROUTE) != 0) {
+        return -1;
+    }
+    if (neigh_dump(table, RTM_GETNEIGH) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 経路/近隣一覧取得関数
+//!
+//! 一覧取得用のNetlinkソケットでIPv6の経路/近隣を一覧取得し、写しに反映する。
+//!
+//! @param [in,out] table   L2直接送信
+//! @param [in]     type    RTM_GETROUTE/RTM_GETNEIGH
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int neigh_dump(me6e_neigh_table_t* table, uint16_t type)
+{
+    // ローカル変数宣言
+    struct neigh_dump_req   req;
+    struct sockaddr_nl      local;
+    uint32_t                seq;
+    int                     sock;
+    int                     errcd = 0;
+    int                     ret;
+
+    if (me6e_netlink_open(0, &sock, &local, &seq, &errcd) != RESULT_OK) {
+        me6e_logging(LOG_ERR, "fail to open netlink for dump : %s.", strerror(errcd));
+        return -1;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.nlh.nlmsg_type  = type;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    if (type == RTM_GETROUTE) {
+        req.nlh.nlmsg_len   = NLMSG_LENGTH(sizeof(struct rtmsg));
+        req.rtm.rtm_family  = AF_INET6;
+    }
+    else {
+        req.nlh.nlmsg_len   = NLMSG_LENGTH(sizeof(struct ndmsg));
+        req.ndm.ndm_family  = AF_INET6;
+    }
+
+    ret = me6e_netlink_send(sock, seq, &req.nlh, &errcd);
+    if (ret == RESULT_OK) {
+        ret = me6e_netlink_recv(sock, &local, seq, &errcd, neigh_parse, table);
+    }
+    me6e_netlink_close(sock);
+
+    if (ret != RESULT_OK) {
+        me6e_logging(LOG_ERR, "fail to dump %s : %s.",
+                (type == RTM_GETROUTE) ? "route" : "neighbor", strerror(errcd));
+        return -1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 経路/近隣メッセージ解析関数
+//!
+//! 一覧取得の応答、変更通知のどちらも本関数で写しに反映する。
+//!
+//! @param [in]     nlh     Netlinkメッセージ
+//! @param [out]    errcd   エラーコード
+//! @param [in,out] data    L2直接送信
+//!
+//! @retval RESULT_OK          一覧取得の終了
+//! @retval RESULT_SYSCALL_NG  エラー応答
+//! @retval RESULT_SKIP_NLMSG  次のメッセージを解析する
+///////////////////////////////////////////////////////////////////////////////
+static int neigh_parse(struct nlmsghdr* nlh, int* errcd, void* data)
+{
+    // ローカル変数宣言
+    me6e_neigh_table_t* table = (me6e_neigh_table_t*)data;
+    struct nlmsgerr*    nl_err;
+
+    switch (nlh->nlmsg_type) {
+    case NLMSG_DONE:
+        return RESULT_OK;
+
+    case NLMSG_ERROR:
+        nl_err = (struct nlmsgerr*)NLMSG_DATA(nlh);
+        *errcd = -nl_err->error;
+        return RESULT_SYSCALL_NG;
+
+    case RTM_NEWROUTE:
+    case RTM_DELROUTE:
+        neigh_route_update(table, nlh);
+        break;
+
+    case RTM_NEWNEIGH:
+    case RTM_DELNEIGH:
+        neigh_entry_update(table, nlh);
+        break;
+
+    default:
+        break;
+    }
+
+    return RESULT_SKIP_NLMSG;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 経路更新関数
+//!
+//! メインテーブルのIPv6経路を写しに追加/削除する。
+//! 同じ宛先/メトリックの経路は出力デバイスとゲートウェイで区別し、
+//! 検索時に複数該当した場合(マルチパス)は直接送信に使用しない。
+//!
+//! @param [in,out] table   L2直接送信
+//! @param [in]     nlh     RTM_NEWROUTE/RTM_DELROUTEメッセージ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void neigh_route_update(me6e_neigh_table_t* table, struct nlmsghdr* nlh)
+{
+    // ローカル変数宣言
+    struct rtmsg*       rtm = NLMSG_DATA(nlh);
+    struct rtattr*      rta;
+    int                 rta_len;
+    me6e_neigh_route_t  route;
+    uint32_t            rt_table;
+    bool                multipath = false;
+    int                 i;
+
+    if ((nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*rtm))) || (rtm->rtm_family != AF_INET6)) {
+        return;
+    }
+
+    memset(&route, 0, sizeof(route));
+    route.plen = rtm->rtm_dst_len;
+    rt_table   = rtm->rtm_table;
+
+    rta_len = RTM_PAYLOAD(nlh);
+    for (rta = RTM_RTA(rtm); RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+        switch (rta->rta_type) {
+        case RTA_DST:
+            memcpy(&route.dst, RTA_DATA(rta), sizeof(route.dst));
+            break;
+        case RTA_GATEWAY:
+            memcpy(&route.gateway, RTA_DATA(rta), sizeof(route.gateway));
+            break;
+        case RTA_OIF:
+            route.oif = *(int*)RTA_DATA(rta);
+            break;
+        case RTA_PRIORITY:
+            route.metric = *(uint32_t*)RTA_DATA(rta);
+            break;
+        case RTA_TABLE:
+            rt_table = *(uint32_t*)RTA_DATA(rta);
+            break;
+        case RTA_MULTIPATH:
+            multipath = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // ポリシールーティングは対象外(メインテーブルのみ写す)
+    if (rt_table != RT_TABLE_MAIN) {
+        return;
+    }
+
+    route.usable = (rtm->rtm_type == RTN_UNICAST) && !multipath && (route.oif == table->ifindex);
+
+    pthread_mutex_lock(&table->mutex);
+
+    for (i = 0; i < table->route_num; i++) {
+        me6e_neigh_route_t* cur = &table->route[i];
+        if ((cur->plen != route.plen) || (cur->metric != route.metric) ||
+            !IN6_ARE_ADDR_EQUAL(&cur->dst, &route.dst)) {
+            continue;
+        }
+        // 置き換え時は同じ宛先/メトリックの経路を全て置き換える
+        if (((nlh->nlmsg_type == RTM_NEWROUTE) && (nlh->nlmsg_flags & NLM_F_REPLACE)) ||
+            ((cur->oif == route.oif) && IN6_ARE_ADDR_EQUAL(&cur->gateway, &route.gateway))) {
+            table->route[i] = table->route[--table->route_num];
+            i--;
+        }
+    }
+
+    if (nlh->nlmsg_type == RTM_NEWROUTE) {
+        if (table->route_num < ME6E_NEIGH_ROUTE_MAX) {
+            table->route[table->route_num++] = route;
+        }
+        else {
+            me6e_logging(LOG_WARNING, "neighbor route table is full.");
+        }
+    }
+
+    table->generation++;
+
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 近隣更新関数
+//!
+//! Backbone側物理デバイスのIPv6近隣を写しに追加/削除する。
+//! 到達性が確認済み(REACHABLE)または静的(PERMANENT)のエントリのみ直接送信に使用し、
+//! それ以外の状態ではカーネルに送信させて到達性の確認を促す。
+//!
+//! @param [in,out] table   L2直接送信
+//! @param [in]     nlh     RTM_NEWNEIGH/RTM_DELNEIGHメッセージ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void neigh_entry_update(me6e_neigh_table_t* table, struct nlmsghdr* nlh)
+{
+    // ローカル変数宣言
+    struct ndmsg*       ndm = NLMSG_DATA(nlh);
+    struct rtattr*      rta;
+    int                 rta_len;
+    me6e_neigh_entry_t  entry;
+    bool                has_dst = false;
+    bool                has_lladdr = false;
+    int                 i;
+
+    if ((nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*ndm))) || (ndm->ndm_family != AF_INET6) ||
+        (ndm->ndm_ifindex != table->ifindex)) {
+        return;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+
+    rta_len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ndm));
+    for (rta = (struct rtattr*)((char*)ndm + NLMSG_ALIGN(sizeof(*ndm)));
+         RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+        if ((rta->rta_type == NDA_DST) && (RTA_PAYLOAD(rta) >= sizeof(entry.addr))) {
+            memcpy(&entry.addr, RTA_DATA(rta), sizeof(entry.addr));
+            has_dst = true;
+        }
+        else if ((rta->rta_type == NDA_LLADDR) && (RTA_PAYLOAD(rta) == ETH_ALEN)) {
+            memcpy(&entry.hwaddr, RTA_DATA(rta), ETH_ALEN);
+            has_lladdr = true;
+        }
+    }
+
+    if (!has_dst) {
+        return;
+    }
+
+    entry.usable = (nlh->nlmsg_type == RTM_NEWNEIGH) && has_lladdr &&
+                   (ndm->ndm_state & NEIGH_USABLE_STATE);
+
+    pthread_mutex_lock(&table->mutex);
+
+    for (i = 0; i < table->entry_num; i++) {
+        if (IN6_ARE_ADDR_EQUAL(&table->entry[i].addr, &entry.addr)) {
+            break;
+        }
+    }
+
+    if (entry.usable) {
+        if (i < table->entry_num) {
+            table->entry[i] = entry;
+        }
+        else if (table->entry_num < ME6E_NEIGH_ENTRY_MAX) {
+            table->entry[table->entry_num++] = entry;
+        }
+        else {
+            me6e_logging(LOG_WARNING, "neighbor table is full.");
+        }
+    }
+    else if (i < table->entry_num) {
+        // 使用できない状態になったエントリは削除
+        table->entry[i] = table->entry[--table->entry_num];
+    }
+
+    table->generation++;
+
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信先MACアドレス解決関数
+//!
+//! 送信先キャッシュを検索し、無い場合は経路の最長一致で次ホップを決定して
+//! 近隣情報からMACアドレスを解決する(解決結果は送信先キャッシュに登録する)。
+//!
+//! @param [in]  table      L2直接送信
+//! @param [in]  dst        送信先IPv6アドレス
+//! @param [out] hwaddr     送信先MACアドレス
+//!
+//! @retval true  解決できた
+//! @retval false 解決できなかった
+///////////////////////////////////////////////////////////////////////////////
+static bool neigh_resolve(me6e_neigh_table_t* table, const struct in6_addr* dst, struct ether_addr* hwaddr)
+{
+    // ローカル変数宣言
+    me6e_neigh_cache_t*         cache;
+    const me6e_neigh_route_t*   best = NULL;
+    const struct in6_addr*      nexthop;
+    bool                        multipath = false;
+    bool                        result = false;
+    int                         i;
+
+    pthread_mutex_lock(&table->mutex);
+
+    cache = &table->cache[neigh_cache_index(dst)];
+    if ((cache->generation == table->generation) && IN6_ARE_ADDR_EQUAL(&cache->dst, dst)) {
+        *hwaddr = cache->hwaddr;
+        pthread_mutex_unlock(&table->mutex);
+        return true;
+    }
+
+    // 経路の最長一致(同じ長さの場合はメトリック優先)
+    for (i = 0; i < table->route_num; i++) {
+        const me6e_neigh_route_t* route = &table->route[i];
+        if (!neigh_prefix_match(dst, &route->dst, route->plen)) {
+            continue;
+        }
+        if ((best == NULL) || (route->plen > best->plen) ||
+            ((route->plen == best->plen) && (route->metric < best->metric))) {
+            best = route;
+            multipath = false;
+        }
+        else if ((route->plen == best->plen) && (route->metric == best->metric)) {
+            multipath = true;
+        }
+    }
+
+    if ((best != NULL) && best->usable && !multipath) {
+        nexthop = IN6_IS_ADDR_UNSPECIFIED(&best->gateway) ? dst : &best->gateway;
+        for (i = 0; i < table->entry_num; i++) {
+            if (IN6_ARE_ADDR_EQUAL(&table->entry[i].addr, nexthop)) {
+                *hwaddr           = table->entry[i].hwaddr;
+                cache->generation = table->generation;
+                cache->dst        = *dst;
+                cache->hwaddr     = *hwaddr;
+                result            = true;
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&table->mutex);
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief プレフィックス一致判定関数
+//!
+//! @param [in] addr    判定するアドレス
+//! @param [in] prefix  プレフィックス
+//! @param [in] plen    プレフィックス長
+//!
+//! @retval true  一致
+//! @retval false 不一致
+///////////////////////////////////////////////////////////////////////////////
+static inline bool neigh_prefix_match(const struct in6_addr* addr, const struct in6_addr* prefix, int plen)
+{
+    // ローカル変数宣言
+    int bytes = plen / 8;
+    int bits  = plen % 8;
+
+    if (memcmp(addr->s6_addr, prefix->s6_addr, bytes) != 0) {
+        return false;
+    }
+    if ((bits != 0) &&
+        ((addr->s6_addr[bytes] ^ prefix->s6_addr[bytes]) & (0xFF << (8 - bits)))) {
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信先キャッシュ番号算出関数
+//!
+//! @param [in] addr    送信先IPv6アドレス
+//!
+//! @return 送信先キャッシュの番号
+///////////////////////////////////////////////////////////////////////////////
+static inline uint32_t neigh_cache_index(const struct in6_addr* addr)
+{
+    // ローカル変数宣言
+    uint32_t hash;
+
+    hash = addr->s6_addr32[0] ^ addr->s6_addr32[1] ^ addr->s6_addr32[2] ^ addr->s6_addr32[3];
+    hash ^= (hash >> 16);
+    hash ^= (hash >> 8);
+
+    return hash & (ME6E_NEIGH_CACHE_NUM - 1);
+}
@@ -0,0 +1,103 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_neigh.h                                               */
+/* 機能概要   : Backbone側L2直接送信(経路/近隣キャッシュ) ヘッダファイル      */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_NEIGH_H__
+#define __ME6EAPP_NEIGH_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <net/ethernet.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 保持できる経路の最大数
+#define ME6E_NEIGH_ROUTE_MAX    256
+//! 保持できる近隣エントリの最大数
+#define ME6E_NEIGH_ENTRY_MAX    1024
+//! 送信先キャッシュのエントリ数(2のべき乗)
+#define ME6E_NEIGH_CACHE_NUM    256
+
+///////////////////////////////////////////////////////////////////////////////
+//! 経路情報(メインテーブルのIPv6経路)
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_neigh_route_t
+{
+    struct in6_addr     dst;            ///< 宛先プレフィックス
+    int                 plen;           ///< 宛先プレフィックス長
+    struct in6_addr     gateway;        ///< ゲートウェイ(直接接続時は未指定アドレス)
+    int                 oif;            ///< 出力デバイスのインデックス
+    uint32_t            metric;         ///< メトリック
+    bool                usable;         ///< L2直接送信に使用できる経路かどうか
+};
+typedef struct me6e_neigh_route_t me6e_neigh_route_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 近隣情報(Backbone側物理デバイスの近隣キャッシュ)
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_neigh_entry_t
+{
+    struct in6_addr     addr;           ///< 近隣のIPv6アドレス
+    struct ether_addr   hwaddr;         ///< 近隣のMACアドレス
+    bool                usable;         ///< L2直接送信に使用できる状態かどうか
+};
+typedef struct me6e_neigh_entry_t me6e_neigh_entry_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 送信先キャッシュ(送信先ME6Eアドレス毎の解決結果)
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_neigh_cache_t
+{
+    uint32_t            generation;     ///< 解決時の経路/近隣情報の世代番号
+    struct in6_addr     dst;            ///< 送信先アドレス
+    struct ether_addr   hwaddr;         ///< 送信先MACアドレス
+};
+typedef struct me6e_neigh_cache_t me6e_neigh_cache_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! Backbone側L2直接送信
+//!
+//! カーネルの経路表/近隣キャッシュの写しをrtnetlinkの変更通知で同期し、
+//! 送信先のMACアドレスを解決できた場合は、Ethernet/IPv6ヘッダを付加した
+//! フレームをパケットソケットから直接送信する。
+//! 解決できない場合は送信せず、呼び出し元がIPv6 RAWソケットで送信する
+//! (カーネルが近隣探索を行い、その結果が変更通知で写しに反映される)。
+//! 経路/近隣情報が変更された場合は世代番号を更新し、送信先キャッシュを無効にする。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_neigh_table_t
+{
+    pthread_mutex_t     mutex;          ///< 排他用mutex
+    int                 fd;             ///< 送信用パケットソケット
+    int                 nl_fd;          ///< 経路/近隣変更通知受信用Netlinkソケット
+    int                 ifindex;        ///< Backbone側物理デバイスのインデックス
+    struct ether_addr   hwaddr;         ///< Backbone側物理デバイスのMACアドレス
+    int                 unicast_hops;   ///< ユニキャスト送信時のホップリミット
+    int                 multicast_hops; ///< マルチキャスト送信時のホップリミット
+    volatile int*       mtu;            ///< Backbone側物理デバイスのMTU(変更時に更新)
+    uint32_t            generation;     ///< 経路/近隣情報の世代番号
+    int                 route_num;      ///< 保持している経路数
+    me6e_neigh_route_t  route[ME6E_NEIGH_ROUTE_MAX];  ///< 経路情報
+    int                 entry_num;      ///< 保持している近隣エントリ数
+    me6e_neigh_entry_t  entry[ME6E_NEIGH_ENTRY_MAX];  ///< 近隣情報
+    me6e_neigh_cache_t  cache[ME6E_NEIGH_CACHE_NUM];  ///< 送信先キャッシュ
+};
+typedef struct me6e_neigh_table_t me6e_neigh_table_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_neigh_table_t* me6e_neigh_create(const char* ifname, int bb_fd, int multicast_hops, volatile int* mtu);
+void me6e_neigh_destroy(me6e_neigh_table_t* table);
+void me6e_neigh_changed(me6e_neigh_table_t* table);
+int me6e_neigh_send(me6e_neigh_table_t* table, const struct in6_addr* src, const struct in6_addr* dst,
+        uint32_t flowinfo, const struct iovec* iov, int iovcnt);
+
+#endif // __ME6EAPP_NEIGH_H__
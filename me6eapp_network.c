@@ -94,7 +94,11 @@ int me6e_network_create_tap(const char* name, struct me6e_device_t* tunnel_dev)
     // Flag: IFF_TUN   - TUN device ( no ether header )
     //       IFF_TAP   - TAP device
     //       IFF_NO_PI - no packet information
+    //       IFF_VNET_HDR - virtio net header (GSO/checksum offload)
     ifr.ifr_flags = tunnel_dev->option.tunnel.mode | IFF_NO_PI;
+    if(tunnel_dev->option.tunnel.vnet_hdr){
+        ifr.ifr_flags |= IFF_VNET_HDR;
+    }
     // 仮想デバイス生成
     result = ioctl(tunnel_dev->option.tunnel.fd, TUNSETIFF, &ifr);
     if(result < 0){
@@ -102,6 +106,15 @@ int me6e_network_create_tap(const char* name, struct me6e_device_t* tunnel_dev)
         return result;
     }
 
+    // オフロード設定(TCPのGSOフレームとチェックサム未計算のフレームを受け付ける)
+    // 設定できない場合は、カーネルでセグメント分割されたフレームを受信する
+    if(tunnel_dev->option.tunnel.vnet_hdr){
+        if(ioctl(tunnel_dev->option.tunnel.fd, TUNSETOFFLOAD,
+                TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6 | TUN_F_TSO_ECN) < 0){
+            me6e_logging(LOG_WARNING, "ioctl(TUNSETOFFLOAD) error : %s.", strerror(errno));
+        }
+    }
+
     // デバイス名が変わっているかもしれないので、設定後のデバイス名を再取得
     //strcpy(tunnel_dev->name, ifr.ifr_name);
 
@@ -0,0 +1,471 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_peer.c                                                */
+/* 機能概要   : ME6Eピア監視 ソースファイル                                   */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <arpa/inet.h>
+#include <net/ethernet.h>
+
+#include "me6eapp.h"
+#include "me6eapp_peer.h"
+#include "me6eapp_log.h"
+#include "me6eapp_EtherIP.h"
+
+//! 監視パケットの宛先MACアドレス(Bridgeが中継しないIEEE 802.1予約アドレス)
+static const uint8_t peer_probe_dst_mac[ETH_ALEN] = {0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e};
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int peer_probe_send(int fd, const struct in6_addr* src,
+        const struct in6_addr* dst, const me6e_peer_probe_t* probe);
+static void peer_recv_reply(me6e_peer_table_t* table,
+        const struct in6_addr* src, const me6e_peer_probe_t* probe);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ME6Eピア監視テーブル生成関数
+//!
+//! ME6Eピア監視テーブルを生成する。
+//! 監視対象が指定された場合は監視周期タイマを起動する。
+//! 各ピアの初期状態はupとする。
+//!
+//! @param [in] host_list   監視対象のME6Eホストアドレスリスト(監視しない場合はNULL)
+//! @param [in] bb_fd       Backbone側ソケット
+//! @param [in] own_addr    自身のME6Eアドレス
+//! @param [in] interval    監視周期(秒)
+//! @param [in] dead_count  down判定する連続無応答回数
+//!
+//! @return 生成したテーブルへのポインタ
+///////////////////////////////////////////////////////////////////////////////
+me6e_peer_table_t* me6e_peer_create(me6e_list* host_list, int bb_fd,
+        const struct in6_addr* own_addr, int interval, int dead_count)
+{
+    me6e_peer_table_t*  table;
+    me6e_list*          iter;
+    int                 num = 0;
+
+    // 引数チェック
+    if ((own_addr == NULL) || (bb_fd < 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_peer_create).");
+        return NULL;
+    }
+
+    table = malloc(sizeof(me6e_peer_table_t));
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for peer table.");
+        return NULL;
+    }
+
+    memset(table, 0, sizeof(me6e_peer_table_t));
+    pthread_mutex_init(&table->mutex, NULL);
+    table->bb_fd      = bb_fd;
+    table->timer_fd   = -1;
+    table->own_addr   = *own_addr;
+    table->interval   = interval;
+    table->dead_count = dead_count;
+
+    if (host_list == NULL) {
+        // 応答のみ
+        return table;
+    }
+
+    // ピア情報の生成
+    me6e_list_for_each(iter, host_list) {
+        if (iter->data != NULL) {
+            num++;
+        }
+    }
+    if (num == 0) {
+        return table;
+    }
+
+    table->peer = calloc(num, sizeof(me6e_peer_t));
+    if (table->peer == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for peer entry.");
+        me6e_peer_destroy(table);
+        return NULL;
+    }
+
+    me6e_list_for_each(iter, host_list) {
+        struct in6_addr* host = iter->data;
+        if (host != NULL) {
+            table->peer[table->num].addr  = *host;
+            table->peer[table->num].alive = true;
+            table->num++;
+        }
+    }
+
+    // 監視周期タイマの起動
+    struct itimerspec ispec = {
+        .it_value    = { .tv_sec = interval, .tv_nsec = 0 },
+        .it_interval = { .tv_sec = interval, .tv_nsec = 0 },
+    };
+
+    table->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (table->timer_fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create peer probe timer : %s.", strerror(errno));
+        me6e_peer_destroy(table);
+        return NULL;
+    }
+    if (timerfd_settime(table->timer_fd, 0, &ispec, NULL) < 0) {
+        me6e_logging(LOG_ERR, "fail to start peer probe timer : %s.", strerror(errno));
+        me6e_peer_destroy(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ME6Eピア監視テーブル解放関数
+//!
+//! ME6Eピア監視テーブルを解放する。
+//!
+//! @param [in] table   ME6Eピア監視テーブル
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_peer_destroy(me6e_peer_table_t* table)
+{
+    if (table == NULL) {
+        return;
+    }
+
+    if (table->timer_fd >= 0) {
+        close(table->timer_fd);
+    }
+    pthread_mutex_destroy(&table->mutex);
+    free(table->peer);
+    free(table);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 監視周期タイムアウト処理関数
+//!
+//! 前周期の要求に応答が無かったピアを無応答として計上し、
+//! 連続無応答回数がdown判定回数に達したピアをdownとする。
+//! その後、全ピアへ監視要求を送信する。
+//!
+//! @param [in,out] table   ME6Eピア監視テーブル
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_peer_timeout(me6e_peer_table_t* table)
+{
+    uint64_t            expire;
+    struct timespec     now;
+    me6e_peer_probe_t   probe;
+    char                address[INET6_ADDRSTRLEN] = { 0 };
+    int                 i;
+
+    // 引数チェック
+    if ((table == NULL) || (table->timer_fd < 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_peer_timeout).");
+        return;
+    }
+
+    // タイマ満了回数の読み捨て
+    if (read(table->timer_fd, &expire, sizeof(expire)) < 0) {
+        if (errno != EAGAIN) {
+            me6e_logging(LOG_ERR, "fail to read peer probe timer : %s.", strerror(errno));
+        }
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    probe.magic    = htonl(ME6E_PEER_MAGIC);
+    probe.type     = ME6E_PEER_PROBE_REQUEST;
+    probe.reserved = 0;
+    probe.tv_sec   = htonl((uint32_t)now.tv_sec);
+    probe.tv_nsec  = htonl((uint32_t)now.tv_nsec);
+
+    pthread_mutex_lock(&table->mutex);
+
+    for (i = 0; i < table->num; i++) {
+        me6e_peer_t* peer = &table->peer[i];
+
+        // 前周期の要求が無応答
+        if (peer->waiting) {
+            peer->lost_count++;
+            peer->miss++;
+            if (peer->alive && (peer->miss >= table->dead_count)) {
+                peer->alive = false;
+                table->generation++;
+                me6e_logging(LOG_WARNING, "peer %s is down.",
+                        inet_ntop(AF_INET6, &peer->addr, address, sizeof(address)));
+            }
+        }
+
+        // 監視要求送信
+        peer->seq     = table->seq++;
+        peer->waiting = true;
+        peer->send_count++;
+        probe.seq = htons(peer->seq);
+        if (peer_probe_send(table->bb_fd, &table->own_addr, &peer->addr, &probe) != 0) {
+            DEBUG_LOG("fail to send peer probe : %s.\n", strerror(errno));
+        }
+    }
+
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 監視パケット受信処理関数
+//!
+//! BackboneNWから受信したパケットが監視パケットかどうか判定し、
+//! 監視パケットの場合は要求への応答、または応答の計上をおこなう。
+//!
+//! @param [in,out] table       ME6Eピア監視テーブル
+//! @param [in]     src         受信パケットの送信元アドレス
+//! @param [in]     dst         受信パケットの送信先アドレス
+//! @param [in]     recv_buffer 受信データ(ETHER_IPヘッダ除去済み)
+//! @param [in]     recv_len    受信データのサイズ
+//!
+//! @retval true  監視パケット(処理済み)
+//! @retval false 監視パケット以外
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_peer_recv(me6e_peer_table_t* table, const struct in6_addr* src,
+        const struct in6_addr* dst, char* recv_buffer, ssize_t recv_len)
+{
+    struct ether_header*    eth;
+    me6e_peer_probe_t*      probe;
+
+    // 引数チェック
+    if ((table == NULL) || (src == NULL) || (dst == NULL) || (recv_buffer == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_peer_recv).");
+        return false;
+    }
+
+    // 監視パケットかどうかのチェック
+    if (recv_len < (ssize_t)(sizeof(struct ether_header) + sizeof(me6e_peer_probe_t))) {
+        return false;
+    }
+    eth = (struct ether_header*)recv_buffer;
+    if (ntohs(eth->ether_type) != ME6E_PEER_ETHERTYPE) {
+        return false;
+    }
+    probe = (me6e_peer_probe_t*)(recv_buffer + sizeof(struct ether_header));
+    if (ntohl(probe->magic) != ME6E_PEER_MAGIC) {
+        return false;
+    }
+
+    switch (probe->type) {
+    case ME6E_PEER_PROBE_REQUEST:
+        // 自身のME6Eアドレス(ユニキャスト)宛て以外の要求には応答せず破棄する
+        // (マルチキャスト宛てや他装置宛ての要求に、そのアドレスを送信元として応答しない)
+        if (IN6_IS_ADDR_MULTICAST(dst) || IN6_IS_ADDR_UNSPECIFIED(&table->own_addr) ||
+            !IN6_ARE_ADDR_EQUAL(dst, &table->own_addr)) {
+            DEBUG_LOG("drop peer probe request to other address.\n");
+            break;
+        }
+        // 受信した宛先アドレスを送信元として、時刻をそのまま折り返す
+        probe->type = ME6E_PEER_PROBE_REPLY;
+        if (peer_probe_send(table->bb_fd, dst, src, probe) != 0) {
+            DEBUG_LOG("fail to send peer probe reply : %s.\n", strerror(errno));
+        }
+        break;
+
+    case ME6E_PEER_PROBE_REPLY:
+        peer_recv_reply(table, src, probe);
+        break;
+
+    default:
+        DEBUG_LOG("unknown peer probe type %d.\n", probe->type);
+        break;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ME6Eピア監視テーブル表示関数
+//!
+//! ピア毎の生存状態とRTT、無応答数を表示する。
+//!
+//! @param [in] table   ME6Eピア監視テーブル
+//! @param [in] fd      出力先のディスクリプタ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_peer_print_table(me6e_peer_table_t* table, int fd)
+{
+    char    address[INET6_ADDRSTRLEN] = { 0 };
+    int     i;
+
+    // 引数チェック
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_peer_print_table).");
+        return;
+    }
+
+    dprintf(fd, "\n");
+    dprintf(fd, "          ME6E Host Address             | State |  RTT(us) | SRTT(us) |   Send   |   Recv   |   Lost   \n");
+    dprintf(fd, " ---------------------------------------+-------+----------+----------+----------+----------+----------\n");
+
+    pthread_mutex_lock(&table->mutex);
+    for (i = 0; i < table->num; i++) {
+        me6e_peer_t* peer = &table->peer[i];
+        dprintf(fd, " %-39s| %-6s|%9u |%9u |%9u |%9u |%9u \n",
+                inet_ntop(AF_INET6, &peer->addr, address, sizeof(address)),
+                peer->alive ? "up" : "down",
+                peer->rtt, peer->srtt,
+                peer->send_count, peer->recv_count, peer->lost_count);
+    }
+    pthread_mutex_unlock(&table->mutex);
+
+    dprintf(fd, "\n");
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 監視パケット送信関数
+//!
+//! 監視パケットをEtherIPでカプセル化してBackboneNWへ送信する。
+//!
+//! @param [in] fd      Backbone側ソケット
+//! @param [in] src     送信元アドレス
+//! @param [in] dst     送信先アドレス
+//! @param [in] probe   監視パケット ペイロード
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int peer_probe_send(int fd, const struct in6_addr* src,
+        const struct in6_addr* dst, const me6e_peer_probe_t* probe)
+{
+    struct sockaddr_in6 daddr = {0};
+    struct in6_pktinfo* info;
+    struct msghdr       msg = {0};
+    struct cmsghdr*     cmsg;
+    char                cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))] = {0};
+    struct iovec        iov[3];
+    struct etheriphdr   ether_ip_hdr;
+    struct ether_header eth;
+
+    // EtherIPヘッダの設定
+    ether_ip_hdr.version = ETHERIP_VERSION;
+    ether_ip_hdr.reserved = 0;
+    ether_ip_hdr.reserved2 = 0;
+
+    // Ethernetヘッダの設定
+    memcpy(eth.ether_dhost, peer_probe_dst_mac, ETH_ALEN);
+    memset(eth.ether_shost, 0, ETH_ALEN);
+    eth.ether_type = htons(ME6E_PEER_ETHERTYPE);
+
+    // IPv6ヘッダの設定
+    daddr.sin6_family = AF_INET6;
+    daddr.sin6_port = htons(ME6E_IPPROTO_ETHERIP);
+    daddr.sin6_addr = *dst;
+
+    iov[0].iov_base = &ether_ip_hdr;
+    iov[0].iov_len  = sizeof(ether_ip_hdr);
+    iov[1].iov_base = &eth;
+    iov[1].iov_len  = sizeof(eth);
+    iov[2].iov_base = (void*)probe;
+    iov[2].iov_len  = sizeof(me6e_peer_probe_t);
+
+    msg.msg_name = &daddr;
+    msg.msg_namelen = sizeof(daddr);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 3;
+    msg.msg_control = cmsgbuf;
+    msg.msg_controllen = sizeof(cmsgbuf);
+
+    // 送信元情報(in6_pktinfo)をcmsgへ設定
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IPV6;
+    cmsg->cmsg_type = IPV6_PKTINFO;
+    info = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+    info->ipi6_addr = *src;
+    info->ipi6_ifindex = 0;
+
+    if (sendmsg(fd, &msg, 0) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 監視応答受信処理関数
+//!
+//! 応答待ちのシーケンス番号と一致する応答の場合、
+//! RTTを算出してピアをupとする。
+//!
+//! @param [in,out] table   ME6Eピア監視テーブル
+//! @param [in]     src     応答の送信元アドレス
+//! @param [in]     probe   監視パケット ペイロード
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void peer_recv_reply(me6e_peer_table_t* table,
+        const struct in6_addr* src, const me6e_peer_probe_t* probe)
+{
+    struct timespec now;
+    int64_t         rtt;
+    char            address[INET6_ADDRSTRLEN] = { 0 };
+    int             i;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&table->mutex);
+
+    for (i = 0; i < table->num; i++) {
+        me6e_peer_t* peer = &table->peer[i];
+
+        if (!IN6_ARE_ADDR_EQUAL(&peer->addr, src)) {
+            continue;
+        }
+
+        // 応答待ちの要求に対する応答以外は破棄(遅延応答など)
+        if (!peer->waiting || (ntohs(probe->seq) != peer->seq)) {
+            break;
+        }
+
+        rtt = ((int64_t)(uint32_t)now.tv_sec - (int64_t)ntohl(probe->tv_sec)) * 1000000
+            + ((int64_t)now.tv_nsec - (int64_t)ntohl(probe->tv_nsec)) / 1000;
+        if (rtt < 0) {
+            rtt = 0;
+        }
+
+        peer->rtt = (uint32_t)rtt;
+        if (peer->srtt == 0) {
+            peer->srtt = peer->rtt;
+        } else {
+            peer->srtt = (peer->srtt * 7 + peer->rtt) / 8;
+        }
+        peer->waiting = false;
+        peer->miss    = 0;
+        peer->recv_count++;
+
+        if (!peer->alive) {
+            peer->alive = true;
+            table->generation++;
+            me6e_logging(LOG_INFO, "peer %s is up.",
+                    inet_ntop(AF_INET6, &peer->addr, address, sizeof(address)));
+        }
+        break;
+    }
+
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
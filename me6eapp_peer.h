@@ -0,0 +1,111 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_peer.h                                                */
+/* 機能概要   : ME6Eピア監視 ヘッダファイル                                   */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_PEER_H__
+#define __ME6EAPP_PEER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+
+#include "me6eapp_list.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 監視パケットのイーサタイプ(IEEE 802 Local Experimental Ethertype 1)
+#define ME6E_PEER_ETHERTYPE     0x88B5
+//! 監視パケットの識別子("ME6P")
+#define ME6E_PEER_MAGIC         0x4D453650
+//! 監視パケット種別 要求
+#define ME6E_PEER_PROBE_REQUEST 1
+//! 監視パケット種別 応答
+#define ME6E_PEER_PROBE_REPLY   2
+
+///////////////////////////////////////////////////////////////////////////////
+//! 監視パケット ペイロード(Ethernetヘッダ以降)
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_peer_probe_t
+{
+    uint32_t    magic;          ///< 識別子
+    uint8_t     type;           ///< 種別(要求/応答)
+    uint8_t     reserved;       ///< 予約
+    uint16_t    seq;            ///< シーケンス番号
+    uint32_t    tv_sec;         ///< 要求送信時刻(秒) 応答時はそのまま折り返す
+    uint32_t    tv_nsec;        ///< 要求送信時刻(ナノ秒) 応答時はそのまま折り返す
+} __attribute__((packed));
+typedef struct me6e_peer_probe_t me6e_peer_probe_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! ME6Eピア情報
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_peer_t
+{
+    struct in6_addr     addr;           ///< ピアのME6Eアドレス
+    volatile bool       alive;          ///< 生存状態(true:up false:down)
+    bool                waiting;        ///< 応答待ち中かどうか
+    uint16_t            seq;            ///< 応答待ちのシーケンス番号
+    int                 miss;           ///< 連続無応答回数
+    uint32_t            send_count;     ///< 要求送信数
+    uint32_t            recv_count;     ///< 応答受信数
+    uint32_t            lost_count;     ///< 無応答数
+    uint32_t            rtt;            ///< 直近のRTT(マイクロ秒)
+    uint32_t            srtt;           ///< 平滑化RTT(マイクロ秒)
+};
+typedef struct me6e_peer_t me6e_peer_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! ME6Eピア監視テーブル
+//!
+//! ピア情報はme6e_host_addressの設定順に格納する。
+//! 監視無効時もピアからの要求への応答に使用するため常に生成する。
+//! 生存状態の変化時にgenerationを更新し、
+//! 参照側は値の変化で送信先リストの再構築要否を判断する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_peer_table_t
+{
+    pthread_mutex_t     mutex;          ///< ピア情報の排他用mutex
+    int                 bb_fd;          ///< Backbone側ソケット
+    int                 timer_fd;       ///< 監視周期タイマ
+    struct in6_addr     own_addr;       ///< 自身のME6Eアドレス
+    int                 interval;       ///< 監視周期(秒)
+    int                 dead_count;     ///< down判定する連続無応答回数
+    uint16_t            seq;            ///< 次に送信するシーケンス番号
+    volatile uint32_t   generation;     ///< 生存状態の世代番号
+    int                 num;            ///< ピア数
+    me6e_peer_t*        peer;           ///< ピア情報
+};
+typedef struct me6e_peer_table_t me6e_peer_table_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_peer_table_t* me6e_peer_create(me6e_list* host_list, int bb_fd,
+        const struct in6_addr* own_addr, int interval, int dead_count);
+void me6e_peer_destroy(me6e_peer_table_t* table);
+void me6e_peer_timeout(me6e_peer_table_t* table);
+bool me6e_peer_recv(me6e_peer_table_t* table, const struct in6_addr* src,
+        const struct in6_addr* dst, char* recv_buffer, ssize_t recv_len);
+void me6e_peer_print_table(me6e_peer_table_t* table, int fd);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ピア生存状態取得関数
+//!
+//! @param [in] table   ME6Eピア監視テーブル
+//! @param [in] index   ピア番号(me6e_host_addressの設定順)
+//!
+//! @retval true  up
+//! @retval false down
+///////////////////////////////////////////////////////////////////////////////
+static inline bool me6e_peer_is_alive(me6e_peer_table_t* table, int index)
+{
+    return table->peer[index].alive;
+}
+
+#endif // __ME6EAPP_PEER_H__
@@ -0,0 +1,474 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_pipeline.c                                            */
+/* 機能概要   : 受信スレッド/処理スレッド間パイプライン ソースファイル        */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+
+#include "me6eapp_pipeline.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 受け渡しリングの確認を繰り返す間のCPU休止
+#if defined(__x86_64__) || defined(__i386__)
+#define PIPELINE_CPU_RELAX()    __builtin_ia32_pause()
+#else
+#define PIPELINE_CPU_RELAX()    __asm__ __volatile__("" ::: "memory")
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int pipeline_worker_init(me6e_pipeline_worker_t* worker, int ring_size);
+static void pipeline_worker_release(me6e_pipeline_worker_t* worker);
+static void pipeline_worker_print(me6e_pipeline_worker_t* worker, const char* name, int index, int buckets, int fd);
+static void pipeline_rebalance(me6e_pipeline_t* pipeline);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パイプライン生成関数
+//!
+//! デカプセル化処理スレッド分とカプセル化処理スレッドの受け渡しリングを生成する。
+//! (処理スレッドの起動は呼び出し元で行う)
+//!
+//! @param [in] pool        パケットバッファプール
+//! @param [in] decap_num   デカプセル化処理スレッド数
+//! @param [in] ring_size   受け渡しリングのスロット数(2のべき乗に切り上げる)
+//!
+//! @return 生成したパイプライン(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_pipeline_t* me6e_pipeline_create(me6e_bufpool_t* pool, int decap_num, int ring_size)
+{
+    // ローカル変数宣言
+    me6e_pipeline_t*    pipeline;
+    int                 size;
+    int                 i;
+
+    // 引数チェック
+    if ((pool == NULL) || (decap_num <= 0) || (decap_num > ME6E_PIPELINE_WORKER_MAX) || (ring_size <= 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_pipeline_create).");
+        return NULL;
+    }
+
+    pipeline = malloc(sizeof(me6e_pipeline_t));
+    if (pipeline == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for pipeline.");
+        return NULL;
+    }
+    memset(pipeline, 0, sizeof(me6e_pipeline_t));
+    pipeline->pool      = pool;
+    pipeline->decap_num = decap_num;
+    for (i = 0; i < ME6E_PIPELINE_WORKER_MAX; i++) {
+        pipeline->decap[i].efd = -1;
+    }
+    pipeline->encap.efd = -1;
+
+    for (size = 1; size < ring_size; size <<= 1) {
+        ;
+    }
+
+    // バケットは処理スレッドへ順に割り当てる
+    for (i = 0; i < ME6E_PIPELINE_BUCKET_NUM; i++) {
+        pipeline->bucket[i] = i % decap_num;
+    }
+
+    for (i = 0; i < decap_num; i++) {
+        if (pipeline_worker_init(&pipeline->decap[i], size) != 0) {
+            me6e_pipeline_destroy(pipeline);
+            return NULL;
+        }
+    }
+    if (pipeline_worker_init(&pipeline->encap, size) != 0) {
+        me6e_pipeline_destroy(pipeline);
+        return NULL;
+    }
+
+    me6e_logging(LOG_INFO, "pipeline : %d decapsulation workers, 1 capsulation worker, ring size %d.",
+            decap_num, size);
+
+    return pipeline;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パイプライン解放関数
+//!
+//! 受け渡しリングに残っているパケットバッファはプールへ返却する。
+//! 受信スレッド/処理スレッドが全て終了した後に呼び出すこと。
+//!
+//! @param [in] pipeline    パイプライン(NULLの場合は何もしない)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pipeline_destroy(me6e_pipeline_t* pipeline)
+{
+    // ローカル変数宣言
+    int i;
+
+    if (pipeline == NULL) {
+        return;
+    }
+
+    for (i = 0; i < ME6E_PIPELINE_WORKER_MAX; i++) {
+        pipeline_worker_release(&pipeline->decap[i]);
+    }
+    pipeline_worker_release(&pipeline->encap);
+    free(pipeline);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 処理スレッド受け渡し関数
+//!
+//! パケットバッファを処理スレッドの受け渡しリングへ格納する。
+//! 満杯の場合は処理スレッドを起床させ、空きができるまで待ち合わせる。
+//! 格納後の起床通知はme6e_pipeline_kickでまとめて行う。
+//!
+//! @param [in] worker  処理スレッド
+//! @param [in] buf     パケットバッファ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pipeline_enqueue(me6e_pipeline_worker_t* worker, me6e_buf_t* buf)
+{
+    if (me6e_spsc_push(worker->ring, buf)) {
+        return;
+    }
+
+    // 満杯の場合は処理スレッドの取り出しを待つ(受信を止めて背圧をかける)
+    worker->ring->full_count++;
+    do {
+        me6e_pipeline_kick(worker);
+        sched_yield();
+    } while (!me6e_spsc_push(worker->ring, buf));
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief デカプセル化処理スレッド振り分け関数
+//!
+//! パケットバッファのフローのハッシュ値(buf->hash)からバケットを求め、
+//! バケットを担当するデカプセル化処理スレッドへ受け渡す。
+//! 一定間隔毎にバケットの担当を見直す。受信スレッドからのみ呼び出すこと。
+//!
+//! @param [in] pipeline    パイプライン
+//! @param [in] buf         パケットバッファ
+//!
+//! @return 受け渡したデカプセル化処理スレッドの番号
+///////////////////////////////////////////////////////////////////////////////
+int me6e_pipeline_dispatch(me6e_pipeline_t* pipeline, me6e_buf_t* buf)
+{
+    // ローカル変数宣言
+    me6e_pipeline_worker_t* worker;
+    uint32_t                index;
+    int                     id;
+
+    index  = (buf->hash ^ (buf->hash >> 16)) & (ME6E_PIPELINE_BUCKET_NUM - 1);
+    id     = pipeline->bucket[index];
+    worker = &pipeline->decap[id];
+
+    me6e_pipeline_enqueue(worker, buf);
+
+    // バケットの最後の受け渡し位置(処理スレッドの処理完了数と比較する)
+    pipeline->bucket_seq[index] = worker->ring->head;
+    pipeline->bucket_load[index]++;
+
+    if (++pipeline->dispatch_num >= ME6E_PIPELINE_REBALANCE_NUM) {
+        pipeline_rebalance(pipeline);
+    }
+
+    return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 処理スレッド起床関数
+//!
+//! 処理スレッドが休止中の場合は起床させる。
+//!
+//! @param [in] worker  処理スレッド
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pipeline_kick(me6e_pipeline_worker_t* worker)
+{
+    // 格納位置の更新と休止状態の確認の順序を保証する(me6e_pipeline_waitと対)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (worker->sleeping && __atomic_exchange_n(&worker->sleeping, 0, __ATOMIC_SEQ_CST)) {
+        if (eventfd_write(worker->efd, 1) != 0) {
+            me6e_logging(LOG_ERR, "fail to wakeup pipeline worker : %s.", strerror(errno));
+        }
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 処理スレッド待ち合わせ関数
+//!
+//! 受け渡しリングにパケットバッファが格納されるまで待ち合わせる。
+//! 一定回数はリングを確認し続け、格納されない場合は起床通知まで休止する。
+//! (休止中はスレッドのキャンセルポイントとなる)
+//!
+//! @param [in] worker  処理スレッド
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pipeline_wait(me6e_pipeline_worker_t* worker)
+{
+    // ローカル変数宣言
+    me6e_spsc_t*    ring = worker->ring;
+    eventfd_t       value;
+    int             spin;
+
+    for (spin = 0; spin < ME6E_PIPELINE_SPIN_NUM; spin++) {
+        if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != ring->tail) {
+            return;
+        }
+        PIPELINE_CPU_RELAX();
+    }
+
+    // 休止を宣言してから再確認する(宣言前に格納された場合の起床漏れを防ぐ)
+    __atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != ring->tail) {
+        __atomic_store_n(&worker->sleeping, 0, __ATOMIC_SEQ_CST);
+        return;
+    }
+
+    worker->sleep_count++;
+    if ((eventfd_read(worker->efd, &value) != 0) && (errno != EINTR)) {
+        me6e_logging(LOG_ERR, "fail to wait pipeline worker : %s.", strerror(errno));
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パイプライン表示関数
+//!
+//! 受け渡しリング毎の受け渡し数/取り出し数、現在/最大の滞留数、
+//! 満杯で待ち合わせた回数、処理スレッドの休止回数、担当バケット数と、
+//! デカプセル化処理スレッド間の負荷の偏り、バケットの移動回数を出力する。
+//!
+//! @param [in] pipeline    パイプライン(NULLの場合は何もしない)
+//! @param [in] fd          出力先のファイルディスクリプタ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pipeline_print(me6e_pipeline_t* pipeline, int fd)
+{
+    // ローカル変数宣言
+    int         buckets[ME6E_PIPELINE_WORKER_MAX];
+    uint64_t    total, max;
+    int         i;
+
+    if (pipeline == NULL) {
+        return;
+    }
+
+    // 処理スレッド毎の担当バケット数と、受け渡し数の偏り(最大/平均)
+    memset(buckets, 0, sizeof(buckets));
+    for (i = 0; i < ME6E_PIPELINE_BUCKET_NUM; i++) {
+        buckets[pipeline->bucket[i]]++;
+    }
+    total = 0;
+    max   = 0;
+    for (i = 0; i < pipeline->decap_num; i++) {
+        total += pipeline->decap[i].ring->enqueue_count;
+        if (pipeline->decap[i].ring->enqueue_count > max) {
+            max = pipeline->decap[i].ring->enqueue_count;
+        }
+    }
+
+    dprintf(fd, "【Pipeline】\n");
+    dprintf(fd, "   %-10s %12s %12s %6s %6s %10s %10s %7s\n",
+            "ring", "enqueue", "dequeue", "depth", "max", "full", "sleep", "buckets");
+    for (i = 0; i < pipeline->decap_num; i++) {
+        pipeline_worker_print(&pipeline->decap[i], "decap", i, buckets[i], fd);
+    }
+    pipeline_worker_print(&pipeline->encap, "encap", 0, -1, fd);
+    dprintf(fd, "   decap skew(max/avg) : %.2f\n",
+            (total > 0) ? ((double)max * pipeline->decap_num / total) : 0.0);
+    dprintf(fd, "   bucket moves        : %llu\n", (unsigned long long)pipeline->move_count);
+    dprintf(fd, "\n");
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 処理スレッド初期化関数
+//!
+//! @param [out] worker     処理スレッド
+//! @param [in]  ring_size  受け渡しリングのスロット数(2のべき乗)
+//!
+//! @retval 0   正常終了
+//! @retval -1  異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int pipeline_worker_init(me6e_pipeline_worker_t* worker, int ring_size)
+{
+    // ローカル変数宣言
+    me6e_spsc_t*    ring;
+    size_t          len;
+
+    len = sizeof(me6e_spsc_t) + sizeof(void*) * ring_size;
+    if (posix_memalign((void**)&ring, 64, len) != 0) {
+        me6e_logging(LOG_ERR, "fail to allocate pipeline ring.");
+        return -1;
+    }
+    memset(ring, 0, len);
+    ring->size = ring_size;
+    ring->mask = ring_size - 1;
+
+    worker->ring = ring;
+    worker->efd  = eventfd(0, EFD_CLOEXEC);
+    if (worker->efd < 0) {
+        me6e_logging(LOG_ERR, "fail to create pipeline eventfd : %s.", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 処理スレッド解放関数
+//!
+//! @param [in] worker  処理スレッド
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void pipeline_worker_release(me6e_pipeline_worker_t* worker)
+{
+    // ローカル変数宣言
+    me6e_buf_t* buf;
+
+    if (worker->ring != NULL) {
+        while ((buf = me6e_spsc_pop(worker->ring)) != NULL) {
+            me6e_buf_free(buf);
+        }
+        free(worker->ring);
+        worker->ring = NULL;
+    }
+    if (worker->efd >= 0) {
+        close(worker->efd);
+        worker->efd = -1;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 処理スレッド表示関数
+//!
+//! @param [in] worker  処理スレッド
+//! @param [in] name    処理スレッドの種別
+//! @param [in] index   処理スレッドの番号
+//! @param [in] buckets 担当バケット数(バケットを担当しない場合は負数)
+//! @param [in] fd      出力先のファイルディスクリプタ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void pipeline_worker_print(me6e_pipeline_worker_t* worker, const char* name, int index, int buckets, int fd)
+{
+    // ローカル変数宣言
+    me6e_spsc_t*    ring = worker->ring;
+    char            label[16];
+    char            bucket_str[16];
+
+    snprintf(label, sizeof(label), "%s[%d]", name, index);
+    if (buckets < 0) {
+        snprintf(bucket_str, sizeof(bucket_str), "-");
+    }
+    else {
+        snprintf(bucket_str, sizeof(bucket_str), "%d", buckets);
+    }
+    dprintf(fd, "   %-10s %12llu %12llu %6u %6u %10llu %10llu %7s\n",
+            label,
+            (unsigned long long)ring->enqueue_count,
+            (unsigned long long)ring->dequeue_count,
+            ring->head - ring->tail,
+            ring->max_depth,
+            (unsigned long long)ring->full_count,
+            (unsigned long long)worker->sleep_count,
+            bucket_str);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief バケット担当見直し関数
+//!
+//! 集計間隔内の受け渡し数から処理スレッド毎の負荷を求め、最大負荷が
+//! 最小負荷に対して偏っている場合は、最大負荷の処理スレッドのバケットを
+//! 1つ最小負荷の処理スレッドへ移動する。移動するバケットは、負荷差の半分を
+//! 超えない範囲で最も負荷が高く、受け渡し済みのパケットを全て処理し終えたもの
+//! (処理スレッドの処理完了数がバケットの最後の受け渡し位置に達したもの)とする。
+//!
+//! @param [in] pipeline    パイプライン
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void pipeline_rebalance(me6e_pipeline_t* pipeline)
+{
+    // ローカル変数宣言
+    uint32_t    load[ME6E_PIPELINE_WORKER_MAX];
+    uint32_t    done;
+    uint32_t    gap;
+    int         hot, cold, best;
+    int         i;
+
+    memset(load, 0, sizeof(load));
+    for (i = 0; i < ME6E_PIPELINE_BUCKET_NUM; i++) {
+        load[pipeline->bucket[i]] += pipeline->bucket_load[i];
+    }
+
+    hot  = 0;
+    cold = 0;
+    for (i = 1; i < pipeline->decap_num; i++) {
+        if (load[i] > load[hot]) {
+            hot = i;
+        }
+        if (load[i] < load[cold]) {
+            cold = i;
+        }
+    }
+
+    if ((hot != cold) &&
+        ((uint64_t)load[hot] * 100 > (uint64_t)load[cold] * ME6E_PIPELINE_REBALANCE_PCT)) {
+        gap  = (load[hot] - load[cold]) / 2;
+        done = __atomic_load_n(&pipeline->decap[hot].done, __ATOMIC_ACQUIRE);
+        best = -1;
+        for (i = 0; i < ME6E_PIPELINE_BUCKET_NUM; i++) {
+            if ((pipeline->bucket[i] != hot) ||
+                (pipeline->bucket_load[i] == 0) || (pipeline->bucket_load[i] > gap)) {
+                continue;
+            }
+            // 処理中のパケットが残っているバケットは移動しない
+            if ((int32_t)(done - pipeline->bucket_seq[i]) < 0) {
+                continue;
+            }
+            if ((best < 0) || (pipeline->bucket_load[i] > pipeline->bucket_load[best])) {
+                best = i;
+            }
+        }
+        if (best >= 0) {
+            pipeline->bucket[best] = cold;
+            pipeline->bucket_seq[best] = pipeline->decap[cold].ring->head;
+            pipeline->move_count++;
+        }
+    }
+
+    memset(pipeline->bucket_load, 0, sizeof(pipeline->bucket_load));
+    pipeline->dispatch_num = 0;
+
+    return;
+}
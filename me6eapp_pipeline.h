@@ -0,0 +1,208 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_pipeline.h                                            */
+/* 機能概要   : 受信スレッド/処理スレッド間パイプライン ヘッダファイル        */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_PIPELINE_H__
+#define __ME6EAPP_PIPELINE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "me6eapp_bufpool.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! デカプセル化処理スレッドの最大数
+#define ME6E_PIPELINE_WORKER_MAX    16
+//! 処理スレッドが休止する前に受け渡しリングを確認する回数
+#define ME6E_PIPELINE_SPIN_NUM      128
+//! 受信スレッドが処理スレッドを起床させるまでにまとめて受け渡す最大数
+#define ME6E_PIPELINE_BURST_NUM     32
+//! 滞留数を計測する受け渡し間隔(2のべき乗)
+#define ME6E_PIPELINE_DEPTH_SAMPLE  64
+//! フローのハッシュ値を振り分けるバケット数(2のべき乗)
+#define ME6E_PIPELINE_BUCKET_NUM    256
+//! バケットの担当を見直す受け渡し間隔
+#define ME6E_PIPELINE_REBALANCE_NUM 8192
+//! バケットを移動する負荷の偏り(最大負荷が最小負荷の何%を超えた場合か)
+#define ME6E_PIPELINE_REBALANCE_PCT 125
+
+///////////////////////////////////////////////////////////////////////////////
+//! 受け渡しリング(Single Producer/Single Consumer)
+//!
+//! 受信スレッド(生産者)と処理スレッド(消費者)の間でパケットバッファを
+//! ロックなしで受け渡す。生産者と消費者が更新する位置を別のキャッシュラインに置き、
+//! 相手側の位置はキャッシュした値を使用して、満杯/空の時のみ読み直す。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_spsc_t
+{
+    uint32_t            size;           ///< スロット数(2のべき乗)
+    uint32_t            mask;           ///< スロット番号のマスク
+    // 生産者側
+    volatile uint32_t   head __attribute__((aligned(64)));  ///< 次に格納する位置
+    uint32_t            tail_cache;     ///< 消費者の取り出し位置のキャッシュ
+    uint32_t            max_depth;      ///< 最大滞留数
+    uint64_t            enqueue_count;  ///< 受け渡し数
+    uint64_t            full_count;     ///< 満杯で受け渡しを待ち合わせた回数
+    // 消費者側
+    volatile uint32_t   tail __attribute__((aligned(64)));  ///< 次に取り出す位置
+    uint32_t            head_cache;     ///< 生産者の格納位置のキャッシュ
+    uint64_t            dequeue_count;  ///< 取り出し数
+    void*               slot[] __attribute__((aligned(64))); ///< スロット
+};
+typedef struct me6e_spsc_t me6e_spsc_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 処理スレッド
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_pipeline_worker_t
+{
+    me6e_spsc_t*        ring;           ///< 受け渡しリング
+    int                 efd;            ///< 起床通知用eventfd
+    volatile int        sleeping;       ///< 休止中かどうか(起床通知が必要かどうか)
+    uint64_t            sleep_count;    ///< 休止した回数
+    volatile uint32_t   done __attribute__((aligned(64)));  ///< 処理を完了した数(消費者が更新)
+};
+typedef struct me6e_pipeline_worker_t me6e_pipeline_worker_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 受信スレッド/処理スレッド間パイプライン
+//!
+//! Backbone側/Stub側の受信スレッドは受信とパケットバッファへの格納のみ行い、
+//! 処理スレッドへ受け渡しリングで受け渡す。
+//! デカプセル化はdecap_num個の処理スレッドで分担し、
+//! カプセル化は1つの処理スレッドで行う(送信先毎の送信情報を持つため)。
+//! 受け渡しリングが満杯の場合、受信スレッドは空きができるまで受信を止める
+//! (受信できないパケットはソケットの受信バッファに留まる)。
+//!
+//! デカプセル化処理スレッドへはフローのハッシュ値のバケット単位で振り分け、
+//! フロー内の順序を保つ。一定間隔毎に負荷の高い処理スレッドのバケットを
+//! 負荷の低い処理スレッドへ移動する。移動するのは受け渡し済みのパケットを
+//! 全て処理し終えたバケットのみとする(移動前後でフロー内の順序が変わらない)。
+//! バケットの担当表は受信スレッドのみが参照/更新する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_pipeline_t
+{
+    me6e_bufpool_t*         pool;       ///< パケットバッファプール
+    int                     decap_num;  ///< デカプセル化処理スレッド数
+    me6e_pipeline_worker_t  decap[ME6E_PIPELINE_WORKER_MAX];    ///< デカプセル化処理スレッド
+    me6e_pipeline_worker_t  encap;      ///< カプセル化処理スレッド
+    uint8_t                 bucket[ME6E_PIPELINE_BUCKET_NUM];       ///< バケット毎の担当処理スレッド
+    uint32_t                bucket_seq[ME6E_PIPELINE_BUCKET_NUM];   ///< バケット毎の最後に受け渡した位置
+    uint32_t                bucket_load[ME6E_PIPELINE_BUCKET_NUM];  ///< 集計間隔内のバケット毎の受け渡し数
+    uint32_t                dispatch_num;   ///< 集計間隔内の受け渡し数
+    uint64_t                move_count;     ///< バケットを移動した回数
+};
+typedef struct me6e_pipeline_t me6e_pipeline_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_pipeline_t* me6e_pipeline_create(me6e_bufpool_t* pool, int decap_num, int ring_size);
+void me6e_pipeline_destroy(me6e_pipeline_t* pipeline);
+void me6e_pipeline_enqueue(me6e_pipeline_worker_t* worker, me6e_buf_t* buf);
+int me6e_pipeline_dispatch(me6e_pipeline_t* pipeline, me6e_buf_t* buf);
+void me6e_pipeline_kick(me6e_pipeline_worker_t* worker);
+void me6e_pipeline_wait(me6e_pipeline_worker_t* worker);
+void me6e_pipeline_print(me6e_pipeline_t* pipeline, int fd);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受け渡しリング格納関数
+//!
+//! 生産者スレッドからのみ呼び出すこと。
+//!
+//! @param [in] ring    受け渡しリング
+//! @param [in] data    格納するデータ
+//!
+//! @retval true  格納した
+//! @retval false 満杯のため格納できなかった
+///////////////////////////////////////////////////////////////////////////////
+static inline bool me6e_spsc_push(me6e_spsc_t* ring, void* data)
+{
+    uint32_t head = ring->head;
+
+    if ((head - ring->tail_cache) >= ring->size) {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if ((head - ring->tail_cache) >= ring->size) {
+            return false;
+        }
+    }
+
+    ring->slot[head & ring->mask] = data;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    ring->enqueue_count++;
+
+    // 一定間隔で消費者の位置を読み直して滞留数を計測
+    if ((head & (ME6E_PIPELINE_DEPTH_SAMPLE - 1)) == 0) {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if ((head + 1 - ring->tail_cache) > ring->max_depth) {
+            ring->max_depth = head + 1 - ring->tail_cache;
+        }
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受け渡しリング取り出し関数
+//!
+//! 消費者スレッドからのみ呼び出すこと。
+//!
+//! @param [in] ring    受け渡しリング
+//!
+//! @return 取り出したデータ(空の場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static inline void* me6e_spsc_pop(me6e_spsc_t* ring)
+{
+    uint32_t tail = ring->tail;
+    void*    data;
+
+    if (tail == ring->head_cache) {
+        ring->head_cache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (tail == ring->head_cache) {
+            return NULL;
+        }
+    }
+
+    data = ring->slot[tail & ring->mask];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    ring->dequeue_count++;
+
+    return data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 処理スレッド受け取り関数
+//!
+//! 受け渡されたパケットバッファを1つ取り出す。待ち合わせは行わない。
+//!
+//! @param [in] worker  処理スレッド
+//!
+//! @return 取り出したパケットバッファ(空の場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static inline me6e_buf_t* me6e_pipeline_dequeue(me6e_pipeline_worker_t* worker)
+{
+    return (me6e_buf_t*)me6e_spsc_pop(worker->ring);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 処理スレッド処理完了関数
+//!
+//! 取り出したパケットバッファの処理を終えたことを通知する。
+//! (受信スレッドはバケットを移動してよいかの判定に使用する)
+//!
+//! @param [in] worker  処理スレッド
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void me6e_pipeline_done(me6e_pipeline_worker_t* worker)
+{
+    __atomic_store_n(&worker->done, worker->done + 1, __ATOMIC_RELEASE);
+}
+
+#endif // __ME6EAPP_PIPELINE_H__
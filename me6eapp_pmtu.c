@@ -0,0 +1,710 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_pmtu.c                                                */
+/* 機能概要   : Path MTU管理 ソースファイル                                   */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/timerfd.h>
+#include <arpa/inet.h>
+#include <net/ethernet.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/icmp6.h>
+#include <linux/errqueue.h>
+
+#include "me6eapp.h"
+#include "me6eapp_pmtu.h"
+#include "me6eapp_log.h"
+#include "me6eapp_util.h"
+#include "me6eapp_vnet.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! ICMPv4エラーに格納する元パケットを含めた最大長(RFC1812)
+#define PMTU_ICMP4_ERROR_MAX    576
+//! ICMPv4 Fragmentation Neededで通知できるMTUの最小値
+#define PMTU_IPV4_MIN_MTU       68
+//! 生成するICMPのhop limit(TTL)
+#define PMTU_ICMP_HOP_LIMIT     64
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static void pmtu_update_min(me6e_pmtu_table_t* table, time_t now);
+static bool pmtu_send_frag_needed(me6e_pmtu_table_t* table, char* frame, ssize_t len, int mtu);
+static bool pmtu_send_packet_too_big(me6e_pmtu_table_t* table, char* frame, ssize_t len, int mtu);
+static ssize_t pmtu_stub_write(me6e_pmtu_table_t* table, const struct iovec* iov, int iovcnt);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Path MTU管理テーブル生成関数
+//!
+//! Path MTU管理テーブルを生成し、
+//! Backbone側ソケットでPacket Too Bigをエラーキューで受信するよう設定する。
+//! 保持時間を過ぎたエントリを削除するエージング周期タイマ(1秒)を起動する。
+//!
+//! @param [in] bb_fd       Backbone側ソケット
+//! @param [in] tunnel_fd   Stub側トンネルデバイス
+//! @param [in] vnet_hdr    Stub側トンネルデバイスの仮想NICヘッダの有効/無効
+//! @param [in] stub_ring   Stub側パケットリング(未使用時はNULL)
+//! @param [in] dev_mtu     Backbone側物理デバイスのMTU
+//! @param [in] expire      学習したPath MTUの保持時間(秒)
+//! @param [in] udp         UDPで転送するかどうか
+//!
+//! @return 生成したテーブルへのポインタ
+///////////////////////////////////////////////////////////////////////////////
+me6e_pmtu_table_t* me6e_pmtu_create(int bb_fd, int tunnel_fd, bool vnet_hdr,
+        me6e_stub_ring_t* stub_ring, int dev_mtu, int expire, bool udp)
+{
+    me6e_pmtu_table_t*  table;
+    int                 on = 1;
+    struct itimerspec   ispec = {
+        .it_value    = { .tv_sec = 1, .tv_nsec = 0 },
+        .it_interval = { .tv_sec = 1, .tv_nsec = 0 },
+    };
+
+    // 引数チェック
+    if ((bb_fd < 0) || (tunnel_fd < 0) || (dev_mtu < IPV6_MIN_MTU) || (expire <= 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_pmtu_create).");
+        return NULL;
+    }
+
+    table = malloc(sizeof(me6e_pmtu_table_t));
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for pmtu table.");
+        return NULL;
+    }
+
+    memset(table, 0, sizeof(me6e_pmtu_table_t));
+    pthread_mutex_init(&table->mutex, NULL);
+    table->bb_fd     = bb_fd;
+    table->tunnel_fd = tunnel_fd;
+    table->vnet_hdr  = vnet_hdr;
+    table->udp       = udp;
+    table->stub_ring = stub_ring;
+    table->dev_mtu   = dev_mtu;
+    table->expire    = expire;
+    table->min_mtu   = dev_mtu;
+    table->timer_fd  = -1;
+
+    // Packet Too Bigをエラーキューで受信
+    if (setsockopt(bb_fd, IPPROTO_IPV6, IPV6_RECVERR, &on, sizeof(on))) {
+        me6e_logging(LOG_ERR, "fail to set sockopt IPV6_RECVERR : %s.", strerror(errno));
+        me6e_pmtu_destroy(table);
+        return NULL;
+    }
+
+    // エージング周期タイマの起動
+    table->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (table->timer_fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create path mtu aging timer : %s.", strerror(errno));
+        me6e_pmtu_destroy(table);
+        return NULL;
+    }
+    if (timerfd_settime(table->timer_fd, 0, &ispec, NULL) < 0) {
+        me6e_logging(LOG_ERR, "fail to start path mtu aging timer : %s.", strerror(errno));
+        me6e_pmtu_destroy(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Path MTU管理テーブル解放関数
+//!
+//! Path MTU管理テーブルを解放する。
+//!
+//! @param [in] table   Path MTU管理テーブル
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pmtu_destroy(me6e_pmtu_table_t* table)
+{
+    if (table == NULL) {
+        return;
+    }
+
+    if (table->timer_fd >= 0) {
+        close(table->timer_fd);
+    }
+    pthread_mutex_destroy(&table->mutex);
+    free(table);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief エラーキュー受信関数
+//!
+//! Backbone側ソケットのエラーキューを全て読み出し、
+//! Packet Too Bigで通知されたMTUを送信先のPath MTUとして学習する。
+//! それ以外のエラーは読み捨てる。
+//!
+//! @param [in,out] table   Path MTU管理テーブル
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pmtu_recv_error(me6e_pmtu_table_t* table)
+{
+    struct msghdr               msg;
+    struct iovec                iov;
+    struct cmsghdr*             cmsg;
+    struct sock_extended_err*   serr;
+    struct sockaddr_in6         offender;
+    char                        data[sizeof(struct ip6_hdr)];
+    char                        cmsgbuf[CMSG_SPACE(sizeof(struct sock_extended_err) +
+                                                   sizeof(struct sockaddr_in6))];
+
+    // 引数チェック
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_pmtu_recv_error).");
+        return;
+    }
+
+    while (1) {
+        memset(&msg, 0, sizeof(msg));
+        iov.iov_base       = data;
+        iov.iov_len        = sizeof(data);
+        msg.msg_name       = &offender;
+        msg.msg_namelen    = sizeof(offender);
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = cmsgbuf;
+        msg.msg_controllen = sizeof(cmsgbuf);
+
+        if (recvmsg(table->bb_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                me6e_logging(LOG_ERR, "fail to recv error queue : %s.", strerror(errno));
+            }
+            break;
+        }
+
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if ((cmsg->cmsg_level != IPPROTO_IPV6) || (cmsg->cmsg_type != IPV6_RECVERR)) {
+                continue;
+            }
+
+            serr = (struct sock_extended_err*)CMSG_DATA(cmsg);
+            if ((serr->ee_errno != EMSGSIZE) ||
+                ((serr->ee_origin != SO_EE_ORIGIN_ICMP6) && (serr->ee_origin != SO_EE_ORIGIN_LOCAL))) {
+                DEBUG_LOG("ignore backbone error : %s.\n", strerror(serr->ee_errno));
+                continue;
+            }
+
+            // msg_nameには元パケットの送信先アドレスが格納される
+            me6e_pmtu_update(table, &offender.sin6_addr, serr->ee_info);
+        }
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief エージングタイマ満了関数
+//!
+//! 保持時間を過ぎたエントリを削除し、全送信先で最小のPath MTUを再計算する。
+//! (使用されなくなった送信先の小さなPath MTUがmin_mtuに残らないようにする)
+//!
+//! @param [in,out] table   Path MTU管理テーブル
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pmtu_timeout(me6e_pmtu_table_t* table)
+{
+    struct timespec now;
+    uint64_t        expire;
+
+    // 引数チェック
+    if (table == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_pmtu_timeout).");
+        return;
+    }
+
+    // タイマ満了回数の読み捨て
+    if (read(table->timer_fd, &expire, sizeof(expire)) < 0) {
+        if (errno != EAGAIN) {
+            me6e_logging(LOG_ERR, "fail to read path mtu aging timer : %s.", strerror(errno));
+        }
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&table->mutex);
+    pmtu_update_min(table, now.tv_sec);
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Path MTU取得関数
+//!
+//! 送信先のPath MTUを取得する。
+//! 未学習または保持時間を過ぎた送信先はBackbone側物理デバイスのMTUとする。
+//!
+//! @param [in,out] table   Path MTU管理テーブル
+//! @param [in]     dst     送信先ME6Eアドレス
+//!
+//! @return Path MTU
+///////////////////////////////////////////////////////////////////////////////
+int me6e_pmtu_get(me6e_pmtu_table_t* table, const struct in6_addr* dst)
+{
+    struct timespec now;
+    int             mtu;
+    int             i;
+
+    // 引数チェック
+    if ((table == NULL) || (dst == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_pmtu_get).");
+        return IPV6_MIN_MTU;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&table->mutex);
+
+    mtu = table->dev_mtu;
+    for (i = 0; i < ME6E_PMTU_ENTRY_MAX; i++) {
+        me6e_pmtu_entry_t* entry = &table->entry[i];
+        if (!entry->used || !IN6_ARE_ADDR_EQUAL(&entry->addr, dst)) {
+            continue;
+        }
+
+        if (entry->expire <= now.tv_sec) {
+            // 保持時間を過ぎたエントリは削除(他の満了したエントリも合わせて削除)
+            pmtu_update_min(table, now.tv_sec);
+        }
+        else {
+            mtu = entry->mtu;
+        }
+        break;
+    }
+
+    pthread_mutex_unlock(&table->mutex);
+
+    return mtu;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone MTU更新関数
+//!
+//! Backbone側物理デバイスのMTU変更に合わせて、未学習の送信先のPath MTUを更新する。
+//! 学習済みのPath MTUが新しいMTUを超える場合は新しいMTUに合わせる。
+//!
+//! @param [in,out] table   Path MTU管理テーブル
+//! @param [in]     dev_mtu 変更後のMTU
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pmtu_set_dev_mtu(me6e_pmtu_table_t* table, int dev_mtu)
+{
+    struct timespec now;
+    int             i;
+
+    // 引数チェック
+    if ((table == NULL) || (dev_mtu < IPV6_MIN_MTU)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_pmtu_set_dev_mtu).");
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&table->mutex);
+
+    table->dev_mtu = dev_mtu;
+    for (i = 0; i < ME6E_PMTU_ENTRY_MAX; i++) {
+        if (table->entry[i].used && (table->entry[i].mtu > dev_mtu)) {
+            table->entry[i].mtu = dev_mtu;
+        }
+    }
+    pmtu_update_min(table, now.tv_sec);
+
+    pthread_mutex_unlock(&table->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ICMP Too Big返送関数
+//!
+//! Path MTUを超えるフレームの送信元ホストへ、
+//! IPv4(DFあり)の場合はICMP Fragmentation Neededを、
+//! IPv6の場合はICMPv6 Packet Too Bigをトンネルデバイスから返送する。
+//! 返送するICMPの送信元は元フレームの送信先(MAC/IPアドレス)とする。
+//! 通知するMTUが各プロトコルの最小MTUを下回る場合などは返送しない。
+//!
+//! @param [in] table   Path MTU管理テーブル
+//! @param [in] frame   Stub側から受信したフレーム
+//! @param [in] len     フレーム長
+//! @param [in] mtu     送信先のPath MTU
+//!
+//! @retval true  ICMPを返送した(フレームは破棄する)
+//! @retval false ICMPを返送しない
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_pmtu_send_too_big(me6e_pmtu_table_t* table, char* frame, ssize_t len, int mtu)
+{
+    struct ether_header* eth = (struct ether_header*)frame;
+
+    // 引数チェック
+    if ((table == NULL) || (frame == NULL) || (len < (ssize_t)sizeof(struct ether_header))) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_pmtu_send_too_big).");
+        return false;
+    }
+
+    // 内側フレームで使用できるMTU
+    mtu -= me6e_pmtu_overhead(table->udp) + sizeof(struct ether_header);
+
+    switch (ntohs(eth->ether_type)) {
+    case ETHERTYPE_IP:
+        return pmtu_send_frag_needed(table, frame, len, mtu);
+
+    case ETHERTYPE_IPV6:
+        return pmtu_send_packet_too_big(table, frame, len, mtu);
+
+    default:
+        // VLANタグ付き、IP以外のフレームは対象外
+        return false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Path MTU学習関数
+//!
+//! 送信先のPath MTUを登録する。
+//! 登録済みの場合は値と満了時刻を更新する。
+//! テーブルに空きが無い場合は満了時刻が最も近いエントリを置き換える。
+//! (EtherIP over UDPの送信ソケットで通知されたMTUの登録にも使用する)
+//!
+//! @param [in,out] table   Path MTU管理テーブル
+//! @param [in]     dst     送信先ME6Eアドレス
+//! @param [in]     mtu     通知されたMTU
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_pmtu_update(me6e_pmtu_table_t* table, const struct in6_addr* dst, int mtu)
+{
+    struct timespec     now;
+    me6e_pmtu_entry_t*  target = NULL;
+    char                address[INET6_ADDRSTRLEN] = { 0 };
+    int                 i;
+
+    // 引数チェック
+    if ((table == NULL) || (dst == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_pmtu_update).");
+        return;
+    }
+
+    // IPv6の最小MTU未満の通知はIPv6の最小MTUとして扱う
+    if (mtu < IPV6_MIN_MTU) {
+        mtu = IPV6_MIN_MTU;
+    }
+    if (mtu > table->dev_mtu) {
+        mtu = table->dev_mtu;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&table->mutex);
+
+    // 登録済みのエントリを検索
+    for (i = 0; i < ME6E_PMTU_ENTRY_MAX; i++) {
+        me6e_pmtu_entry_t* entry = &table->entry[i];
+        if (entry->used && IN6_ARE_ADDR_EQUAL(&entry->addr, dst)) {
+            target = entry;
+            break;
+        }
+    }
+
+    // 未登録の場合は空きエントリ、空きが無ければ満了時刻が最も近いエントリを使用
+    if (target == NULL) {
+        for (i = 0; i < ME6E_PMTU_ENTRY_MAX; i++) {
+            me6e_pmtu_entry_t* entry = &table->entry[i];
+            if (!entry->used) {
+                target = entry;
+                break;
+            }
+            if ((target == NULL) || (entry->expire < target->expire)) {
+                target = entry;
+            }
+        }
+    }
+
+    target->used   = true;
+    target->addr   = *dst;
+    target->mtu    = mtu;
+    target->expire = now.tv_sec + table->expire;
+    pmtu_update_min(table, now.tv_sec);
+
+    pthread_mutex_unlock(&table->mutex);
+
+    me6e_logging(LOG_INFO, "learn path mtu %d to %s.", mtu,
+            inet_ntop(AF_INET6, dst, address, sizeof(address)));
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 最小Path MTU更新関数
+//!
+//! 保持時間を過ぎたエントリを削除し、
+//! 登録されている全送信先で最小のPath MTUを再計算する。
+//! (mutexを取得した状態で呼び出すこと)
+//!
+//! @param [in,out] table   Path MTU管理テーブル
+//! @param [in]     now     現在時刻(単調増加時刻)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void pmtu_update_min(me6e_pmtu_table_t* table, time_t now)
+{
+    int min_mtu = table->dev_mtu;
+    int i;
+
+    for (i = 0; i < ME6E_PMTU_ENTRY_MAX; i++) {
+        me6e_pmtu_entry_t* entry = &table->entry[i];
+        if (!entry->used) {
+            continue;
+        }
+        if (entry->expire <= now) {
+            entry->used = false;
+            continue;
+        }
+        if (entry->mtu < min_mtu) {
+            min_mtu = entry->mtu;
+        }
+    }
+    table->min_mtu = min_mtu;
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ICMP Fragmentation Needed返送関数
+//!
+//! DFビットが設定されたIPv4パケットの送信元ホストへ
+//! ICMP Fragmentation Neededを返送する。
+//! 先頭以外のフラグメントと、ICMPの問い合わせ要求以外のメッセージには
+//! 返送しない(RFC792/RFC1812)。
+//!
+//! @param [in] table   Path MTU管理テーブル
+//! @param [in] frame   Stub側から受信したフレーム
+//! @param [in] len     フレーム長
+//! @param [in] mtu     内側フレームで使用できるMTU
+//!
+//! @retval true  ICMPを返送した
+//! @retval false ICMPを返送しない
+///////////////////////////////////////////////////////////////////////////////
+static bool pmtu_send_frag_needed(me6e_pmtu_table_t* table, char* frame, ssize_t len, int mtu)
+{
+    struct ether_header*    orig_eth = (struct ether_header*)frame;
+    struct ip*              orig_ip  = (struct ip*)(frame + sizeof(struct ether_header));
+    ssize_t                 orig_len = len - sizeof(struct ether_header);
+    struct ether_header     eth;
+    struct ip               ip;
+    struct icmp             icmp;
+    struct iovec            iov[4];
+    ssize_t                 data_len;
+
+    if ((orig_len < (ssize_t)sizeof(struct ip)) || (mtu < PMTU_IPV4_MIN_MTU)) {
+        return false;
+    }
+
+    // DFビットが無いパケット、先頭以外のフラグメント、
+    // ブロードキャスト/マルチキャスト送信元は対象外
+    if (((ntohs(orig_ip->ip_off) & IP_DF) == 0) ||
+        ((ntohs(orig_ip->ip_off) & IP_OFFMASK) != 0) ||
+        IN_MULTICAST(ntohl(orig_ip->ip_src.s_addr)) ||
+        (orig_ip->ip_src.s_addr == INADDR_ANY) ||
+        (orig_ip->ip_src.s_addr == INADDR_BROADCAST)) {
+        return false;
+    }
+
+    // ICMPはエコー/タイムスタンプ/情報要求以外は対象外
+    if (orig_ip->ip_p == IPPROTO_ICMP) {
+        uint8_t type;
+        if (orig_len < (ssize_t)(orig_ip->ip_hl * 4 + 1)) {
+            return false;
+        }
+        type = ((uint8_t*)orig_ip)[orig_ip->ip_hl * 4];
+        if ((type != ICMP_ECHO) && (type != ICMP_TSTAMP) && (type != ICMP_IREQ)) {
+            return false;
+        }
+    }
+
+    // ICMPエラーには元パケットを最大長まで格納
+    data_len = PMTU_ICMP4_ERROR_MAX - sizeof(struct ip) - ICMP_MINLEN;
+    if (data_len > orig_len) {
+        data_len = orig_len;
+    }
+
+    // Ethernetヘッダ
+    memcpy(eth.ether_dhost, orig_eth->ether_shost, ETH_ALEN);
+    memcpy(eth.ether_shost, orig_eth->ether_dhost, ETH_ALEN);
+    eth.ether_type = htons(ETHERTYPE_IP);
+
+    // ICMPヘッダ
+    memset(&icmp, 0, ICMP_MINLEN);
+    icmp.icmp_type       = ICMP_UNREACH;
+    icmp.icmp_code       = ICMP_UNREACH_NEEDFRAG;
+    icmp.icmp_nextmtu    = htons(mtu);
+    iov[2].iov_base = &icmp;
+    iov[2].iov_len  = ICMP_MINLEN;
+    iov[3].iov_base = orig_ip;
+    iov[3].iov_len  = data_len;
+    icmp.icmp_cksum = me6e_util_checksumv(&iov[2], 2);
+
+    // IPv4ヘッダ
+    memset(&ip, 0, sizeof(ip));
+    ip.ip_v   = IPVERSION;
+    ip.ip_hl  = sizeof(struct ip) >> 2;
+    ip.ip_len = htons(sizeof(struct ip) + ICMP_MINLEN + data_len);
+    ip.ip_ttl = PMTU_ICMP_HOP_LIMIT;
+    ip.ip_p   = IPPROTO_ICMP;
+    ip.ip_src = orig_ip->ip_dst;
+    ip.ip_dst = orig_ip->ip_src;
+    ip.ip_sum = me6e_util_checksum((unsigned short*)&ip, sizeof(ip));
+
+    iov[0].iov_base = &eth;
+    iov[0].iov_len  = sizeof(eth);
+    iov[1].iov_base = &ip;
+    iov[1].iov_len  = sizeof(ip);
+
+    if (pmtu_stub_write(table, iov, 4) < 0) {
+        me6e_logging(LOG_ERR, "fail to send icmp fragmentation needed : %s.", strerror(errno));
+        return false;
+    }
+
+    DEBUG_LOG("send icmp fragmentation needed (mtu %d).\n", mtu);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ICMPv6 Packet Too Big返送関数
+//!
+//! IPv6パケットの送信元ホストへICMPv6 Packet Too Bigを返送する。
+//! 内側で使用できるMTUがIPv6の最小MTU(1280)未満の場合は1280を通知し、
+//! 1280以下のパケットは返送せずに外側(カプセル化後)でフラグメントする。
+//!
+//! @param [in] table   Path MTU管理テーブル
+//! @param [in] frame   Stub側から受信したフレーム
+//! @param [in] len     フレーム長
+//! @param [in] mtu     内側フレームで使用できるMTU
+//!
+//! @retval true  ICMPを返送した
+//! @retval false ICMPを返送しない
+///////////////////////////////////////////////////////////////////////////////
+static bool pmtu_send_packet_too_big(me6e_pmtu_table_t* table, char* frame, ssize_t len, int mtu)
+{
+    struct ether_header*    orig_eth = (struct ether_header*)frame;
+    struct ip6_hdr*         orig_ip6 = (struct ip6_hdr*)(frame + sizeof(struct ether_header));
+    ssize_t                 orig_len = len - sizeof(struct ether_header);
+    struct ether_header     eth;
+    struct ip6_hdr          ip6;
+    struct icmp6_hdr        icmp6;
+    struct iovec            iov[4];
+    ssize_t                 data_len;
+
+    if (orig_len < (ssize_t)sizeof(struct ip6_hdr)) {
+        return false;
+    }
+
+    // IPv6の最小MTU未満は通知できないため1280を通知する
+    // (1280以下のパケットは送信側でカーネルがフラグメントして送信する)
+    if (mtu < IPV6_MIN_MTU) {
+        if (orig_len <= IPV6_MIN_MTU) {
+            return false;
+        }
+        mtu = IPV6_MIN_MTU;
+    }
+
+    // マルチキャスト/未指定送信元、ICMPv6エラーメッセージは対象外(RFC4443)
+    if (IN6_IS_ADDR_MULTICAST(&orig_ip6->ip6_src) ||
+        IN6_IS_ADDR_UNSPECIFIED(&orig_ip6->ip6_src)) {
+        return false;
+    }
+    if ((orig_ip6->ip6_nxt == IPPROTO_ICMPV6) &&
+        (orig_len >= (ssize_t)(sizeof(struct ip6_hdr) + 1)) &&
+        ((((uint8_t*)(orig_ip6 + 1))[0] & ICMP6_INFOMSG_MASK) == 0)) {
+        return false;
+    }
+
+    // ICMPv6エラーには元パケットをIPv6の最小MTUまで格納
+    data_len = IPV6_MIN_MTU - sizeof(struct ip6_hdr) - sizeof(struct icmp6_hdr);
+    if (data_len > orig_len) {
+        data_len = orig_len;
+    }
+
+    // Ethernetヘッダ
+    memcpy(eth.ether_dhost, orig_eth->ether_shost, ETH_ALEN);
+    memcpy(eth.ether_shost, orig_eth->ether_dhost, ETH_ALEN);
+    eth.ether_type = htons(ETHERTYPE_IPV6);
+
+    // IPv6ヘッダ
+    memset(&ip6, 0, sizeof(ip6));
+    ip6.ip6_vfc  = 6 << 4;
+    ip6.ip6_plen = htons(sizeof(struct icmp6_hdr) + data_len);
+    ip6.ip6_nxt  = IPPROTO_ICMPV6;
+    ip6.ip6_hlim = PMTU_ICMP_HOP_LIMIT;
+    ip6.ip6_src  = orig_ip6->ip6_dst;
+    ip6.ip6_dst  = orig_ip6->ip6_src;
+
+    // ICMPv6ヘッダ
+    memset(&icmp6, 0, sizeof(icmp6));
+    icmp6.icmp6_type = ICMP6_PACKET_TOO_BIG;
+    icmp6.icmp6_code = 0;
+    icmp6.icmp6_mtu  = htonl(mtu);
+
+    iov[0].iov_base = &eth;
+    iov[0].iov_len  = sizeof(eth);
+    iov[1].iov_base = &ip6;
+    iov[1].iov_len  = sizeof(ip6);
+    iov[2].iov_base = &icmp6;
+    iov[2].iov_len  = sizeof(icmp6);
+    iov[3].iov_base = orig_ip6;
+    iov[3].iov_len  = data_len;
+    icmp6.icmp6_cksum = me6e_util_pseudo_checksumv(AF_INET6, &iov[1], 3);
+
+    if (pmtu_stub_write(table, iov, 4) < 0) {
+        me6e_logging(LOG_ERR, "fail to send icmpv6 packet too big : %s.", strerror(errno));
+        return false;
+    }
+
+    DEBUG_LOG("send icmpv6 packet too big (mtu %d).\n", mtu);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stub側ICMP送信関数
+//!
+//! Stub側パケットリング使用時はパケットリングへ、
+//! それ以外はトンネルデバイスへICMPを送信する。
+//!
+//! @param [in] table   Path MTU管理テーブル
+//! @param [in] iov     送信データ
+//! @param [in] iovcnt  送信データの要素数
+//!
+//! @retval 0以上 送信したフレーム長
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+static ssize_t pmtu_stub_write(me6e_pmtu_table_t* table, const struct iovec* iov, int iovcnt)
+{
+    if (table->stub_ring != NULL) {
+        return me6e_stub_ring_output(table->stub_ring, iov, iovcnt);
+    }
+
+    return me6e_vnet_writev(table->tunnel_fd, table->vnet_hdr, iov, iovcnt);
+}
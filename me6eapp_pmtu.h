@@ -0,0 +1,111 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_pmtu.h                                                */
+/* 機能概要   : Path MTU管理 ヘッダファイル                                   */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_PMTU_H__
+#define __ME6EAPP_PMTU_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <netinet/ip6.h>
+
+#include "me6eapp_EtherIP.h"
+#include "me6eapp_stub_ring.h"
+#include "me6eapp_udp.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! カプセル化によるオーバーヘッド(IPv6ヘッダ + EtherIPヘッダ)
+#define ME6E_PMTU_OVERHEAD      (sizeof(struct ip6_hdr) + sizeof(struct etheriphdr))
+//! 管理できる送信先の最大数
+#define ME6E_PMTU_ENTRY_MAX     256
+
+///////////////////////////////////////////////////////////////////////////////
+//! 送信先毎のPath MTU情報
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_pmtu_entry_t
+{
+    bool                used;           ///< 使用中かどうか
+    struct in6_addr     addr;           ///< 送信先ME6Eアドレス
+    int                 mtu;            ///< Path MTU
+    time_t              expire;         ///< 満了時刻(単調増加時刻)
+};
+typedef struct me6e_pmtu_entry_t me6e_pmtu_entry_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! Path MTU管理テーブル
+//!
+//! Backbone側ソケットのエラーキューで通知されるPacket Too Bigから
+//! 送信先毎のPath MTUを学習する。
+//! 学習したPath MTUのうち最小の値をmin_mtuに保持し、
+//! min_mtu以下のパケットはテーブルを検索せずに送信する。
+//! 保持時間を過ぎたエントリはエージング周期タイマで削除し、min_mtuを再計算する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_pmtu_table_t
+{
+    pthread_mutex_t     mutex;          ///< 排他用mutex
+    int                 bb_fd;          ///< Backbone側ソケット
+    int                 tunnel_fd;      ///< Stub側トンネルデバイス(ICMP返送用)
+    bool                vnet_hdr;       ///< Stub側トンネルデバイスの仮想NICヘッダの有効/無効
+    bool                udp;            ///< UDPで転送するかどうか(オーバーヘッド算出用)
+    me6e_stub_ring_t*   stub_ring;      ///< Stub側パケットリング(ICMP返送用、未使用時はNULL)
+    int                 dev_mtu;        ///< Backbone側物理デバイスのMTU
+    int                 expire;         ///< 学習したPath MTUの保持時間(秒)
+    int                 timer_fd;       ///< エージング周期タイマ
+    volatile int        min_mtu;        ///< 全送信先で最小のPath MTU
+    me6e_pmtu_entry_t   entry[ME6E_PMTU_ENTRY_MAX]; ///< 送信先毎のPath MTU
+};
+typedef struct me6e_pmtu_table_t me6e_pmtu_table_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_pmtu_table_t* me6e_pmtu_create(int bb_fd, int tunnel_fd, bool vnet_hdr,
+        me6e_stub_ring_t* stub_ring, int dev_mtu, int expire, bool udp);
+void me6e_pmtu_destroy(me6e_pmtu_table_t* table);
+void me6e_pmtu_recv_error(me6e_pmtu_table_t* table);
+void me6e_pmtu_timeout(me6e_pmtu_table_t* table);
+int me6e_pmtu_get(me6e_pmtu_table_t* table, const struct in6_addr* dst);
+void me6e_pmtu_update(me6e_pmtu_table_t* table, const struct in6_addr* dst, int mtu);
+void me6e_pmtu_set_dev_mtu(me6e_pmtu_table_t* table, int dev_mtu);
+bool me6e_pmtu_send_too_big(me6e_pmtu_table_t* table, char* frame, ssize_t len, int mtu);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief カプセル化オーバーヘッド取得関数
+//!
+//! カプセル化で付加するヘッダ長を返す。UDPで転送する場合はUDPヘッダを含む。
+//!
+//! @param [in] udp     UDPで転送するかどうか
+//!
+//! @return カプセル化によるオーバーヘッド(IPv6ヘッダ + [UDPヘッダ] + EtherIPヘッダ)
+///////////////////////////////////////////////////////////////////////////////
+static inline int me6e_pmtu_overhead(bool udp)
+{
+    return (int)ME6E_PMTU_OVERHEAD + (udp ? ME6E_UDP_OVERHEAD : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Path MTU簡易判定関数
+//!
+//! カプセル化後のサイズが全送信先で最小のPath MTU以下かどうかを判定する。
+//!
+//! @param [in] table   Path MTU管理テーブル
+//! @param [in] len     カプセル化前のフレーム長
+//!
+//! @retval true  送信先に関わらずPath MTU以下
+//! @retval false 送信先のPath MTUを確認する必要あり
+///////////////////////////////////////////////////////////////////////////////
+static inline bool me6e_pmtu_fit(me6e_pmtu_table_t* table, ssize_t len)
+{
+    return (len + me6e_pmtu_overhead(table->udp)) <= table->min_mtu;
+}
+
+#endif // __ME6EAPP_PMTU_H__
@@ -17,15 +17,32 @@
 #include <netinet/ether.h>
 #include <net/if.h>
 #include <arpa/inet.h>
+#include <linux/rtnetlink.h>
 
 #include "me6eapp.h"
 #include "me6eapp_setup.h"
 #include "me6eapp_log.h"
 #include "me6eapp_network.h"
 #include "me6eapp_util.h"
+#include "me6eapp_filter.h"
+#include "me6eapp_netlink.h"
 
 #define BB_SND_BUF_SIZE    262142
 #define BB_RCV_BUF_SIZE    262142
+//! 送受信バッファに格納できるようにするパケット数(MTUサイズ換算)
+#define BB_BUF_PACKET_NUM  128
+
+// glibcのnetinet/in.hで未定義のため定義(linux/in6.h)
+#ifndef IPV6_FLOWINFO_SEND
+#define IPV6_FLOWINFO_SEND 33
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int calc_tunnel_mtu(struct me6e_handler_t* handler, int bb_mtu);
+static int setup_backbone_buffer(int sock, int mtu);
+static void update_backbone_mtu(struct me6e_handler_t* handler, int mtu);
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -164,6 +181,23 @@ int me6e_create_tunnel_device(struct me6e_handler_t* handler)
     }
 
     conf = handler->conf;
+
+    // MTU自動設定の場合は、Backbone側物理デバイスのMTUから算出
+    if (conf->capsuling->tunnel_mtu_auto) {
+        int bb_mtu;
+        int result = me6e_network_get_mtu_by_name(conf->capsuling->backbone_physical_dev, &bb_mtu);
+        if (result == 0) {
+            conf->capsuling->tunnel_device.mtu = calc_tunnel_mtu(handler, bb_mtu);
+        }
+        else {
+            me6e_logging(LOG_WARNING, "%s get mtu error : %s.",
+                    conf->capsuling->backbone_physical_dev, strerror(result));
+        }
+    }
+
+    // オフロード有効時は仮想NICヘッダ付きでトンネルデバイスを生成
+    conf->capsuling->tunnel_device.option.tunnel.vnet_hdr = conf->capsuling->tunnel_offload;
+
     // トンネルデバイス生成
     if(me6e_network_create_tap(conf->capsuling->tunnel_device.name,
                             &conf->capsuling->tunnel_device) != 0){
@@ -318,8 +352,10 @@ int me6e_attach_bridge(struct me6e_handler_t* handler)
 #endif
 
     // 物理デバイスをBridgeへアタッチ
-    if(me6e_network_bridge_add_interface(conf->capsuling->bridge_name,
-            (conf->capsuling->stub_physical_dev)) != 0){
+    // (パケットリングで送受信する場合は物理デバイスをBridgeへ接続しない)
+    if((conf->capsuling->stub_backend == ME6E_STUB_BACKEND_BRIDGE) &&
+       (me6e_network_bridge_add_interface(conf->capsuling->bridge_name,
+            (conf->capsuling->stub_physical_dev)) != 0)){
         me6e_logging(LOG_ERR, "physical device fail to attach bridge device.");
         return -1;
     }
@@ -350,12 +386,19 @@ int me6e_detach_bridge(struct me6e_handler_t* handler)
 
     conf = handler->conf;
 
+    // パケットリングで送受信する場合は物理デバイスがBridgeに接続されていないため
+    // トンネルデバイスのみデタッチする
+    bool physical = (conf->capsuling->stub_backend == ME6E_STUB_BACKEND_BRIDGE);
+    int ret;
+
     // 物理デバイスの非活性化
-    int ret = me6e_network_set_flags_by_name(conf->capsuling->stub_physical_dev, -(IFF_UP | IFF_RUNNING));
-    if(ret != 0) {
-        me6e_logging(LOG_ERR, "fail to down %s device : %s.",
-                conf->capsuling->stub_physical_dev, strerror(ret));
-        return -1;
+    if(physical){
+        ret = me6e_network_set_flags_by_name(conf->capsuling->stub_physical_dev, -(IFF_UP | IFF_RUNNING));
+        if(ret != 0) {
+            me6e_logging(LOG_ERR, "fail to down %s device : %s.",
+                    conf->capsuling->stub_physical_dev, strerror(ret));
+            return -1;
+        }
     }
 
     // トンネルデバイスの非活性化
@@ -366,20 +409,22 @@ int me6e_detach_bridge(struct me6e_handler_t* handler)
         return -1;
     }
 
-    // 物理デバイスをBridgeからデダッチ
-    if(me6e_network_bridge_del_interface(conf->capsuling->bridge_name,
-            (conf->capsuling->stub_physical_dev)) != 0){
-        me6e_logging(LOG_ERR, "%s device fail to dettach bridge device.",
-                conf->capsuling->stub_physical_dev);
-        return -1;
-    }
+    if(physical){
+        // 物理デバイスをBridgeからデダッチ
+        if(me6e_network_bridge_del_interface(conf->capsuling->bridge_name,
+                (conf->capsuling->stub_physical_dev)) != 0){
+            me6e_logging(LOG_ERR, "%s device fail to dettach bridge device.",
+                    conf->capsuling->stub_physical_dev);
+            return -1;
+        }
 
-    // 物理デバイスの活性化
-    ret = me6e_network_set_flags_by_name(conf->capsuling->stub_physical_dev, (IFF_UP | IFF_RUNNING));
-    if(ret != 0) {
-        me6e_logging(LOG_ERR, "fail to up %s device : %s.",
-                conf->capsuling->stub_physical_dev, strerror(ret));
-        return -1;
+        // 物理デバイスの活性化
+        ret = me6e_network_set_flags_by_name(conf->capsuling->stub_physical_dev, (IFF_UP | IFF_RUNNING));
+        if(ret != 0) {
+            me6e_logging(LOG_ERR, "fail to up %s device : %s.",
+                    conf->capsuling->stub_physical_dev, strerror(ret));
+            return -1;
+        }
     }
 
     // トンネルデバイスをBridgeからデダッチ
@@ -397,6 +442,7 @@ int me6e_detach_bridge(struct me6e_handler_t* handler)
 //!
 //! Stubネットワークの起動をおこなう。具体的には
 //!
+//!   - トンネルデバイスの受信フィルタ設定
 //!   - BridgeデバイスのUP
 //!   - IPv4トンネルデバイスのUP
 //!   - multicast snoopingをOFF
@@ -421,6 +467,12 @@ int me6e_start_stub_network(struct me6e_handler_t* handler)
 
     conf = handler->conf;
 
+    // 転送しないフレームをカーネル内で破棄するフィルタを設定
+    // (設定に失敗した場合も各機能でチェックするため処理継続)
+    if (me6e_filter_setup_stub(handler) != 0) {
+        me6e_logging(LOG_WARNING, "fail to setup stub filter. continue without filter.");
+    }
+
     // トンネルデバイスの活性化
     ret = me6e_network_set_flags_by_index(conf->capsuling->tunnel_device.ifindex, (IFF_UP | IFF_RUNNING));
     if(ret != 0) {
@@ -498,6 +550,7 @@ int me6e_start_stub_network(struct me6e_handler_t* handler)
 //!   - マルチキャスト HOP LIMITの設定
 //!   - マルチキャスト ループをOFF
 //!   - マルチキャストGroupへJoin
+//!   - 受信フィルタの設定
 //!
 //!   をおこなう。
 //!
@@ -551,36 +604,23 @@ int me6e_setup_backbone_network(struct me6e_handler_t* handler)
         return errno;
     }
 
-    // 送信バッファサイズの設定
-    int send_buf_size = BB_SND_BUF_SIZE;
-    if( setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &send_buf_size, sizeof(send_buf_size)) < 0) {
-        me6e_logging(LOG_ERR, "fail to set sockopt SO_SNDBUF : %s.", strerror(errno));
-        return errno;
-    }
-
-    // 送信バッファサイズの設定確認
-    socklen_t len = sizeof(socklen_t);
-    send_buf_size = 0;
-    if( getsockopt(sock, SOL_SOCKET, SO_SNDBUF, &send_buf_size, &len) < 0) {
-        me6e_logging(LOG_ERR, "fail to get sockopt SO_SNDBUF : %s.", strerror(errno));
-        return errno;
-    }
-    me6e_logging(LOG_INFO, "set send buffer size : %d.", send_buf_size);
-
-    // 受信バッファサイズの設定
-    int rcv_buf_size = BB_RCV_BUF_SIZE;
-    if( setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcv_buf_size, sizeof(rcv_buf_size)) < 0) {
-        me6e_logging(LOG_ERR, "fail to set sockopt SO_SNDBUF : %s.", strerror(errno));
-        return errno;
+    // Backbone側物理デバイスのMTUを取得
+    int bb_mtu = 0;
+    int result = me6e_network_get_mtu_by_name(handler->conf->capsuling->backbone_physical_dev, &bb_mtu);
+    if (result != 0) {
+        me6e_logging(LOG_ERR, "%s get mtu error : %s.",
+                handler->conf->capsuling->backbone_physical_dev, strerror(result));
+        close(sock);
+        return result;
     }
+    handler->backbone_mtu = bb_mtu;
 
-    // 受信バッファサイズの設定確認
-    rcv_buf_size = 0;
-    if( getsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcv_buf_size, &len) < 0) {
-        me6e_logging(LOG_ERR, "fail to get sockopt SO_SNDBUF : %s.", strerror(errno));
-        return errno;
+    // 送受信バッファサイズの設定(MTUに合わせて拡張)
+    result = setup_backbone_buffer(sock, handler->backbone_mtu);
+    if (result != 0) {
+        close(sock);
+        return result;
     }
-    me6e_logging(LOG_INFO, "set recieve buffer size : %d.", rcv_buf_size);
 
     // 送信元情報としてin6_packetinfoを使用
     int on = 1;
@@ -590,6 +630,14 @@ int me6e_setup_backbone_network(struct me6e_handler_t* handler)
         return errno;
     }
 
+    // 送信先アドレスのsin6_flowinfoをフローラベルとして使用
+    // (設定に失敗した場合はフローラベル0で送信されるため処理継続)
+    if (handler->conf->capsuling->flow_label) {
+        if (setsockopt(sock, IPPROTO_IPV6, IPV6_FLOWINFO_SEND, &on, sizeof(on))) {
+            me6e_logging(LOG_WARNING, "fail to set sockopt IPV6_FLOWINFO_SEND : %s.", strerror(errno));
+        }
+    }
+
     // マルチキャストパケットのhop limit数を設定
     int hops = handler->conf->capsuling->hop_limit;
     if (setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &hops, sizeof(hops))) {
@@ -619,6 +667,12 @@ int me6e_setup_backbone_network(struct me6e_handler_t* handler)
     // ソケットの格納
     handler->conf->capsuling->bb_fd = sock;
 
+    // 自plane宛て以外のパケットをカーネル内で破棄するフィルタを設定
+    // (設定に失敗した場合もデカプセル化処理でチェックするため処理継続)
+    if (me6e_filter_setup_backbone(handler) != 0) {
+        me6e_logging(LOG_WARNING, "fail to setup backbone filter. continue without filter.");
+    }
+
     return 0;
 }
 
@@ -756,3 +810,254 @@ int me6e_set_signal(struct me6e_handler_t* handler)
     return 0;
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone側リンク監視開始関数
+//!
+//! Backbone側物理デバイスのMTU変更を検知するため、
+//! リンク情報の変更通知を受信するNetlinkソケットを生成する。
+//!
+//! @param [in,out] handler      ME6Eハンドラ
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_open_backbone_link_monitor(struct me6e_handler_t* handler)
+{
+    struct sockaddr_nl  local;
+    uint32_t            seq;
+    int                 errcd = 0;
+
+    // 引数チェック
+    if (handler == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_open_backbone_link_monitor).");
+        return -1;
+    }
+
+    if (me6e_netlink_open(RTMGRP_LINK, &handler->link_fd, &local, &seq, &errcd) != RESULT_OK) {
+        me6e_logging(LOG_ERR, "fail to open link monitor : %s.", strerror(errcd));
+        handler->link_fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone側リンク監視終了関数
+//!
+//! リンク情報の変更通知を受信するNetlinkソケットを閉じる。
+//!
+//! @param [in,out] handler      ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_close_backbone_link_monitor(struct me6e_handler_t* handler)
+{
+    // 引数チェック
+    if (handler == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_close_backbone_link_monitor).");
+        return;
+    }
+
+    if (handler->link_fd >= 0) {
+        me6e_netlink_close(handler->link_fd);
+        handler->link_fd = -1;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone側リンク変更通知受信関数
+//!
+//! リンク情報の変更通知を全て読み出し、
+//! Backbone側物理デバイスのMTUが変更されていれば、
+//! ソケットバッファサイズ、トンネルデバイスのMTU(自動設定時)、
+//! Path MTU管理テーブルを新しいMTUに合わせて更新する。
+//!
+//! @param [in,out] handler      ME6Eハンドラ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_backbone_link_changed(struct me6e_handler_t* handler)
+{
+    char                buf[8192];
+    struct nlmsghdr*    nlh;
+    struct ifinfomsg*   ifi;
+    struct rtattr*      rta;
+    unsigned int        bb_ifindex;
+    ssize_t             len;
+    int                 rta_len;
+    int                 mtu = -1;
+
+    // 引数チェック
+    if ((handler == NULL) || (handler->link_fd < 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_backbone_link_changed).");
+        return;
+    }
+
+    bb_ifindex = if_nametoindex(handler->conf->capsuling->backbone_physical_dev);
+
+    while ((len = recv(handler->link_fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        for (nlh = (struct nlmsghdr*)buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type != RTM_NEWLINK) {
+                continue;
+            }
+
+            ifi = NLMSG_DATA(nlh);
+            if (ifi->ifi_index != (int)bb_ifindex) {
+                continue;
+            }
+
+            rta_len = IFLA_PAYLOAD(nlh);
+            for (rta = IFLA_RTA(ifi); RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+                if ((rta->rta_type == IFLA_MTU) && (RTA_PAYLOAD(rta) >= sizeof(uint32_t))) {
+                    mtu = *(uint32_t*)RTA_DATA(rta);
+                }
+            }
+        }
+    }
+
+    if ((mtu > 0) && (mtu != handler->backbone_mtu)) {
+        update_backbone_mtu(handler, mtu);
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief トンネルデバイスMTU計算関数
+//!
+//! Backbone側物理デバイスのMTUからカプセル化のオーバーヘッド
+//! (IPv6ヘッダ + EtherIPヘッダ + 内側Ethernetヘッダ)を差し引いた値を
+//! トンネルデバイスのMTUとする(EtherIP over UDP時はUDPヘッダも差し引く)。
+//! Path MTU学習時は、超過フレームをICMP返送/フラグメントで処理するため
+//! Stub側物理デバイスのMTUを下限とする(Bridgeでの破棄を防ぐ)。
+//!
+//! @param [in]     handler      ME6Eハンドラ
+//! @param [in]     bb_mtu       Backbone側物理デバイスのMTU
+//!
+//! @return トンネルデバイスのMTU
+///////////////////////////////////////////////////////////////////////////////
+static int calc_tunnel_mtu(struct me6e_handler_t* handler, int bb_mtu)
+{
+    bool udp = (handler->conf->capsuling->transport == ME6E_TRANSPORT_UDP);
+    int mtu = bb_mtu - me6e_pmtu_overhead(udp) - ETH_HLEN;
+    int stub_mtu;
+
+    if (handler->conf->capsuling->pmtu_discovery &&
+        (handler->conf->capsuling->stub_physical_dev != NULL) &&
+        (me6e_network_get_mtu_by_name(handler->conf->capsuling->stub_physical_dev, &stub_mtu) == 0) &&
+        (stub_mtu > mtu)) {
+        mtu = stub_mtu;
+    }
+
+    if (mtu < IPV6_MIN_MTU) {
+        mtu = IPV6_MIN_MTU;
+    }
+
+    return mtu;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backboneソケットバッファ設定関数
+//!
+//! 送受信バッファサイズを、既定値とMTU×パケット数の大きい方に設定する。
+//!
+//! @param [in]     sock         Backbone側ソケット
+//! @param [in]     mtu          Backbone側物理デバイスのMTU
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int setup_backbone_buffer(int sock, int mtu)
+{
+    socklen_t len = sizeof(int);
+
+    // 送信バッファサイズの設定
+    int send_buf_size = BB_SND_BUF_SIZE;
+    if (mtu * BB_BUF_PACKET_NUM > send_buf_size) {
+        send_buf_size = mtu * BB_BUF_PACKET_NUM;
+    }
+    if( setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &send_buf_size, sizeof(send_buf_size)) < 0) {
+        me6e_logging(LOG_ERR, "fail to set sockopt SO_SNDBUF : %s.", strerror(errno));
+        return errno;
+    }
+
+    // 送信バッファサイズの設定確認
+    send_buf_size = 0;
+    if( getsockopt(sock, SOL_SOCKET, SO_SNDBUF, &send_buf_size, &len) < 0) {
+        me6e_logging(LOG_ERR, "fail to get sockopt SO_SNDBUF : %s.", strerror(errno));
+        return errno;
+    }
+    me6e_logging(LOG_INFO, "set send buffer size : %d.", send_buf_size);
+
+    // 受信バッファサイズの設定
+    int rcv_buf_size = BB_RCV_BUF_SIZE;
+    if (mtu * BB_BUF_PACKET_NUM > rcv_buf_size) {
+        rcv_buf_size = mtu * BB_BUF_PACKET_NUM;
+    }
+    if( setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcv_buf_size, sizeof(rcv_buf_size)) < 0) {
+        me6e_logging(LOG_ERR, "fail to set sockopt SO_RCVBUF : %s.", strerror(errno));
+        return errno;
+    }
+
+    // 受信バッファサイズの設定確認
+    rcv_buf_size = 0;
+    if( getsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcv_buf_size, &len) < 0) {
+        me6e_logging(LOG_ERR, "fail to get sockopt SO_RCVBUF : %s.", strerror(errno));
+        return errno;
+    }
+    me6e_logging(LOG_INFO, "set recieve buffer size : %d.", rcv_buf_size);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Backbone MTU更新関数
+//!
+//! Backbone側物理デバイスのMTU変更に合わせて、
+//! ソケットバッファサイズ、トンネルデバイスのMTU(自動設定時)、
+//! Path MTU管理テーブルを更新する。
+//!
+//! @param [in,out] handler      ME6Eハンドラ
+//! @param [in]     mtu          変更後のMTU
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void update_backbone_mtu(struct me6e_handler_t* handler, int mtu)
+{
+    me6e_device_t*  tunnel_dev = &handler->conf->capsuling->tunnel_device;
+    int             result;
+
+    me6e_logging(LOG_INFO, "%s mtu changed %d to %d.",
+            handler->conf->capsuling->backbone_physical_dev, handler->backbone_mtu, mtu);
+
+    handler->backbone_mtu = mtu;
+
+    // ソケットバッファサイズの更新
+    setup_backbone_buffer(handler->conf->capsuling->bb_fd, mtu);
+
+    // トンネルデバイスのMTUの更新
+    if (handler->conf->capsuling->tunnel_mtu_auto) {
+        int tunnel_mtu = calc_tunnel_mtu(handler, mtu);
+        if (tunnel_mtu != tunnel_dev->mtu) {
+            result = me6e_network_set_mtu_by_name(tunnel_dev->name, tunnel_mtu);
+            if (result != 0) {
+                me6e_logging(LOG_WARNING, "%s configure mtu error : %s.", tunnel_dev->name, strerror(result));
+            }
+            else {
+                me6e_logging(LOG_INFO, "%s mtu changed %d to %d.", tunnel_dev->name, tunnel_dev->mtu, tunnel_mtu);
+                tunnel_dev->mtu = tunnel_mtu;
+            }
+        }
+    }
+
+    // Path MTU管理テーブルの更新
+    if (handler->pmtu_handler != NULL) {
+        me6e_pmtu_set_dev_mtu(handler->pmtu_handler, mtu);
+    }
+
+    return;
+}
@@ -27,6 +27,9 @@ int me6e_start_stub_network(struct me6e_handler_t* handler);
 int me6e_setup_backbone_network(struct me6e_handler_t* handler);
 int me6e_close_backbone_network(struct me6e_handler_t* handler);
 int run_startup_script(struct me6e_handler_t* handler);
+int me6e_open_backbone_link_monitor(struct me6e_handler_t* handler);
+void me6e_close_backbone_link_monitor(struct me6e_handler_t* handler);
+void me6e_backbone_link_changed(struct me6e_handler_t* handler);
 
 #endif // __ME6EAPP_SETUP_H__
 
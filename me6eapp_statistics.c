@@ -93,11 +93,15 @@ void me6e_printf_statistics_info(me6e_statistics_t* statistics_info, int fd)
     dprintf(fd, "【Capsuling】\n");
     dprintf(fd, "   Success count                     : %d \n", statistics_info->capsuling_success_count);
     dprintf(fd, "   Failure count                     : %d \n", statistics_info->capsuling_failure_count);
+    dprintf(fd, "   Send ICMP Too Big count           : %d \n", statistics_info->capsuling_too_big_count);
+    dprintf(fd, "   Inner fragment count              : %d \n", statistics_info->capsuling_fragment_count);
+    dprintf(fd, "   GSO segmentation count            : %d \n", statistics_info->capsuling_gso_count);
     dprintf(fd, "\n");
     dprintf(fd, "【DeCapsuling】\n");
     dprintf(fd, "   Success count                     : %d \n", statistics_info->decapsuling_success_count);
     dprintf(fd, "   Failure count(Unmatch EtherIP )   : %d \n", statistics_info->decapsuling_unmatch_header_count);
     dprintf(fd, "   Failure count(Send error)         : %d \n", statistics_info->decapsuling_failure_count);
+    dprintf(fd, "   Drop count(Stub ring full)        : %d \n", statistics_info->decapsuling_ring_drop_count);
     dprintf(fd, "\n");
     dprintf(fd, "【Proxy ARP】\n");
     dprintf(fd, "   Recieve ARP Request count         : %d \n", statistics_info->arp_request_recv_count);
@@ -105,11 +109,13 @@ void me6e_printf_statistics_info(me6e_statistics_t* statistics_info, int fd)
     dprintf(fd, "   Recieve ARP Request\n");
     dprintf(fd, "      Type is not Ethernet or not IP : %d \n", statistics_info->disease_not_arp_request_recv_count);
     dprintf(fd, "   ARP Reply send error count        : %d \n", statistics_info->arp_reply_send_err_count);
+    dprintf(fd, "   Suppress ARP Request count        : %d \n", statistics_info->arp_request_suppress_count);
     dprintf(fd, "\n");
     dprintf(fd, "【Proxy NDP】\n");
     dprintf(fd, "   Recieve NS count                  : %d \n", statistics_info->ns_recv_count);
     dprintf(fd, "   Send NA count                     : %d \n", statistics_info->na_send_count);
     dprintf(fd, "   NA send error count               : %d \n", statistics_info->na_send_err_count);
+    dprintf(fd, "   Suppress NS count                 : %d \n", statistics_info->ns_suppress_count);
     dprintf(fd, "\n");
 
     return;
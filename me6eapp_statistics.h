@@ -23,6 +23,12 @@ typedef struct _me6e_statistics_t
     uint32_t capsuling_success_count;
     //! カプセル化に成功したパケット
     uint32_t capsuling_failure_count;
+    //! Path MTU超過でICMP Too Bigを返送したパケット
+    uint32_t capsuling_too_big_count;
+    //! Path MTU超過で内側フラグメントしたパケット
+    uint32_t capsuling_fragment_count;
+    //! Stub側から受信しセグメント分割したGSOフレーム
+    uint32_t capsuling_gso_count;
 
     ////////////////////////////////////////////////////////////////////////////
     // デカプセル化
@@ -33,6 +39,8 @@ typedef struct _me6e_statistics_t
     uint32_t decapsuling_unmatch_header_count;
     //! カプセル化に成功したパケット(送信エラー)
     uint32_t decapsuling_failure_count;
+    //! Stub側パケットリングの送信リング満杯で破棄したフレーム
+    uint32_t decapsuling_ring_drop_count;
 
     ////////////////////////////////////////////////////////////////////////////
     // 代理ARP
@@ -45,6 +53,8 @@ typedef struct _me6e_statistics_t
     uint32_t disease_not_arp_request_recv_count;
     //! ARP Reply送信エラー数
     uint32_t arp_reply_send_err_count;
+    //! フラッディング抑止したARP Request数
+    uint32_t arp_request_suppress_count;
 
     ////////////////////////////////////////////////////////////////////////////
     // 代理NDP
@@ -55,6 +65,8 @@ typedef struct _me6e_statistics_t
     uint32_t na_send_count;
     //! NAパケット送信エラー数
     uint32_t na_send_err_count;
+    //! フラッディング抑止したNSパケット数
+    uint32_t ns_suppress_count;
 
 } me6e_statistics_t;
 
@@ -70,64 +82,107 @@ void me6e_printf_statistics_info(me6e_statistics_t* statistics, int fd);
 ///////////////////////////////////////////////////////////////////////////////
 // カウントアップ用の関数はinlineで定義する
 ///////////////////////////////////////////////////////////////////////////////
+//! 統計情報の加算(複数の転送スレッドから同時に更新されるため不可分に加算する)
+#define ME6E_STAT_ADD(counter, count) __atomic_fetch_add(&(counter), (count), __ATOMIC_RELAXED)
+
 inline void me6e_inc_capsuling_success_count(me6e_statistics_t* statistics)
 {
-    statistics->capsuling_success_count++;
+    ME6E_STAT_ADD(statistics->capsuling_success_count, 1);
 };
 
 inline void me6e_inc_capsuling_failure_count(me6e_statistics_t* statistics)
 {
-    statistics->capsuling_failure_count++;
+    ME6E_STAT_ADD(statistics->capsuling_failure_count, 1);
+};
+
+inline void me6e_add_capsuling_success_count(me6e_statistics_t* statistics, uint32_t count)
+{
+    ME6E_STAT_ADD(statistics->capsuling_success_count, count);
+};
+
+inline void me6e_add_capsuling_failure_count(me6e_statistics_t* statistics, uint32_t count)
+{
+    ME6E_STAT_ADD(statistics->capsuling_failure_count, count);
+};
+
+inline void me6e_inc_capsuling_too_big_count(me6e_statistics_t* statistics)
+{
+    ME6E_STAT_ADD(statistics->capsuling_too_big_count, 1);
+};
+
+inline void me6e_inc_capsuling_fragment_count(me6e_statistics_t* statistics)
+{
+    ME6E_STAT_ADD(statistics->capsuling_fragment_count, 1);
+};
+
+inline void me6e_inc_capsuling_gso_count(me6e_statistics_t* statistics)
+{
+    ME6E_STAT_ADD(statistics->capsuling_gso_count, 1);
 };
 
 inline void me6e_inc_decapsuling_success_count(me6e_statistics_t* statistics)
 {
-    statistics->decapsuling_success_count++;
+    ME6E_STAT_ADD(statistics->decapsuling_success_count, 1);
 };
 
 inline void me6e_inc_decapsuling_unmatch_header_count(me6e_statistics_t* statistics)
 {
-    statistics->decapsuling_unmatch_header_count++;
+    ME6E_STAT_ADD(statistics->decapsuling_unmatch_header_count, 1);
 };
 
 inline void me6e_inc_decapsuling_failure_count(me6e_statistics_t* statistics)
 {
-    statistics->decapsuling_failure_count++;
+    ME6E_STAT_ADD(statistics->decapsuling_failure_count, 1);
+};
+
+inline void me6e_inc_decapsuling_ring_drop_count(me6e_statistics_t* statistics)
+{
+    ME6E_STAT_ADD(statistics->decapsuling_ring_drop_count, 1);
 };
 
 inline void me6e_inc_arp_request_recv_count(me6e_statistics_t* statistics)
 {
-    statistics->arp_request_recv_count++;
+    ME6E_STAT_ADD(statistics->arp_request_recv_count, 1);
 };
 
 inline void me6e_inc_arp_reply_send_count(me6e_statistics_t* statistics)
 {
-    statistics->arp_reply_send_count++;
+    ME6E_STAT_ADD(statistics->arp_reply_send_count, 1);
 };
 
 inline void me6e_inc_disease_not_arp_request_recv_count(me6e_statistics_t* statistics)
 {
-    statistics->disease_not_arp_request_recv_count++;
+    ME6E_STAT_ADD(statistics->disease_not_arp_request_recv_count, 1);
 };
 
 inline void me6e_inc_arp_reply_send_err_count(me6e_statistics_t* statistics)
 {
-    statistics->arp_reply_send_err_count++;
+    ME6E_STAT_ADD(statistics->arp_reply_send_err_count, 1);
+};
+
+inline void me6e_inc_arp_request_suppress_count(me6e_statistics_t* statistics)
+{
+    ME6E_STAT_ADD(statistics->arp_request_suppress_count, 1);
 };
 
 inline void me6e_inc_ns_recv_count(me6e_statistics_t* statistics)
 {
-    statistics->ns_recv_count++;
+    ME6E_STAT_ADD(statistics->ns_recv_count, 1);
 };
 
 inline void me6e_inc_na_send_count(me6e_statistics_t* statistics)
 {
-    statistics->na_send_count++;
+    ME6E_STAT_ADD(statistics->na_send_count, 1);
 };
 
 inline void me6e_inc_na_send_err_count(me6e_statistics_t* statistics)
 {
-    statistics->na_send_err_count++;
+    ME6E_STAT_ADD(statistics->na_send_err_count, 1);
+};
+
+inline void me6e_inc_ns_suppress_count(me6e_statistics_t* statistics)
+{
+    ME6E_STAT_ADD(statistics->ns_suppress_count, 1);
 };
 
 
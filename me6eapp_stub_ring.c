@@ -0,0 +1,924 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_stub_ring.c                                           */
+/* 機能概要   : Stub側パケットリング(TPACKET_V3/AF_XDP) ソースファイル        */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+#include "me6eapp.h"
+#include "me6eapp_stub_ring.h"
+#include "me6eapp_vnet.h"
+#include "me6eapp_log.h"
+#include "me6eapp_network.h"
+#include "me6eapp_xsk.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+#ifndef PACKET_IGNORE_OUTGOING
+//! 自ソケットからの送信フレームを受信しない(Linux 4.20以降)
+#define PACKET_IGNORE_OUTGOING  23
+#endif
+
+//! 受信リングのフレームサイズ(TPACKET_V3では可変長のため設定上の値)
+#define STUB_RING_RX_FRAME_SIZE 2048
+//! 送信リングのフレームサイズ最小値
+#define STUB_RING_TX_FRAME_MIN  2048
+//! 送信リングのブロックサイズ
+#define STUB_RING_TX_BLOCK_SIZE (1 << 16)
+//! VLANタグ長
+#define STUB_RING_VLAN_TAG_LEN  4
+
+///////////////////////////////////////////////////////////////////////////////
+//! AF_XDP受信時の処理コンテキスト
+///////////////////////////////////////////////////////////////////////////////
+struct stub_ring_xsk_arg
+{
+    me6e_stub_ring_t*           ring;       ///< Stub側パケットリング
+    me6e_stub_ring_recv_func    forward;    ///< カプセル化対象フレームの処理関数
+    void*                       arg;        ///< forwardに渡す引数
+    int                         count;      ///< 処理したフレーム数
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int stub_ring_open_packet(me6e_stub_ring_t* ring, const char* ifname);
+static int stub_ring_open_xdp(me6e_stub_ring_t* ring, const char* ifname);
+static void stub_ring_close_xdp(me6e_stub_ring_t* ring);
+static inline bool stub_ring_input(me6e_stub_ring_t* ring, char* frame, ssize_t len,
+        me6e_stub_ring_recv_func forward, void* arg);
+static void stub_ring_xsk_input(void* arg, char* frame, ssize_t len);
+static inline unsigned int stub_ring_mac_hash(const uint8_t* addr);
+static inline int stub_ring_mac_lookup(me6e_stub_ring_t* ring, const uint8_t* addr);
+static inline void stub_ring_mac_learn(me6e_stub_ring_t* ring, const uint8_t* addr, uint8_t port);
+static inline bool stub_ring_is_local(const me6e_stub_ring_t* ring, const uint8_t* addr);
+static inline ssize_t stub_ring_tap_write(me6e_stub_ring_t* ring, const struct iovec* iov, int iovcnt);
+static inline void stub_ring_kick(me6e_stub_ring_t* ring);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stub側パケットリング生成関数
+//!
+//! Stub側物理デバイスにTPACKET_V3のパケットソケット、
+//! またはAF_XDPソケット(受信キュー毎)を生成する。
+//! AF_XDPソケットを生成できない場合はTPACKET_V3で動作する。
+//! 物理デバイスはプロミスキャスモードに設定する。
+//!
+//! @param [in] ifname          Stub側物理デバイス名
+//! @param [in] tap_fd          トンネルデバイスファイルディスクリプタ
+//! @param [in] tap_vnet_hdr    トンネルデバイスの仮想NICヘッダの有効/無効
+//! @param [in] local_hwaddr    ホスト自身(Bridgeデバイス)のMACアドレス
+//! @param [in] xdp             AF_XDPソケットを使用するかどうか
+//! @param [in] stat_info       統計情報
+//!
+//! @return 生成したStub側パケットリング(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_stub_ring_t* me6e_stub_ring_create(const char* ifname, int tap_fd, bool tap_vnet_hdr,
+        const struct ether_addr* local_hwaddr, bool xdp, me6e_statistics_t* stat_info)
+{
+    // ローカル変数宣言
+    me6e_stub_ring_t*   ring;
+
+    // 引数チェック
+    if ((ifname == NULL) || (local_hwaddr == NULL) || (stat_info == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_stub_ring_create).");
+        return NULL;
+    }
+
+    ring = malloc(sizeof(me6e_stub_ring_t));
+    if (ring == NULL) {
+        me6e_logging(LOG_ERR, "fail to allocate stub ring.");
+        return NULL;
+    }
+    memset(ring, 0, sizeof(me6e_stub_ring_t));
+
+    ring->fd           = -1;
+    ring->poll_fd      = -1;
+    ring->map          = MAP_FAILED;
+    ring->xsk_prog.map_fd  = -1;
+    ring->xsk_prog.prog_fd = -1;
+    ring->xsk_prog.link_fd = -1;
+    ring->tap_fd       = tap_fd;
+    ring->tap_vnet_hdr = tap_vnet_hdr;
+    ring->local_hwaddr = *local_hwaddr;
+    ring->stat_info    = stat_info;
+    pthread_mutex_init(&ring->tx_mutex, NULL);
+    pthread_mutex_init(&ring->mac_mutex, NULL);
+
+    ring->ifindex = if_nametoindex(ifname);
+    if (ring->ifindex == 0) {
+        me6e_logging(LOG_ERR, "fail to get index of %s : %s.", ifname, strerror(errno));
+        goto error;
+    }
+
+    if (me6e_network_get_mtu_by_name(ifname, &ring->mtu) != 0) {
+        me6e_logging(LOG_ERR, "fail to get mtu of %s.", ifname);
+        goto error;
+    }
+
+    // AF_XDPソケットの生成(生成できない場合はTPACKET_V3で動作する)
+    if (xdp && (stub_ring_open_xdp(ring, ifname) != 0)) {
+        me6e_logging(LOG_WARNING, "fail to open AF_XDP socket on %s. fall back to packet ring.", ifname);
+        stub_ring_close_xdp(ring);
+    }
+
+    if (ring->xsk_num == 0) {
+        if (stub_ring_open_packet(ring, ifname) != 0) {
+            goto error;
+        }
+        ring->poll_fd = ring->fd;
+    }
+
+    ring->now = time(NULL);
+
+    return ring;
+
+error:
+    me6e_stub_ring_destroy(ring);
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stub側パケットリング解放関数
+//!
+//! 送信リングに残ったフレームを送信し、リングのマッピングと
+//! パケットソケット(またはAF_XDPソケット)を解放する。
+//!
+//! @param [in] ring    Stub側パケットリング
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_stub_ring_destroy(me6e_stub_ring_t* ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+
+    stub_ring_close_xdp(ring);
+
+    if (ring->map != MAP_FAILED) {
+        if (ring->tx_pending > 0) {
+            send(ring->fd, NULL, 0, MSG_DONTWAIT);
+        }
+        munmap(ring->map, ring->map_size);
+    }
+
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+
+    pthread_mutex_destroy(&ring->tx_mutex);
+    pthread_mutex_destroy(&ring->mac_mutex);
+    free(ring);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受信リング処理関数
+//!
+//! 受信リングのユーザ側に渡されたブロックを順に処理し、カーネルへ返却する。
+//! 送信元MACアドレスを物理デバイス側として学習し、宛先MACアドレスで
+//!
+//!   - ホスト自身宛て            : トンネルデバイスへ送信
+//!   - マルチキャスト/ブロードキャスト : トンネルデバイスへ送信し、forwardを呼ぶ
+//!   - 物理デバイス側で学習済み  : 同一セグメント内の通信のため破棄
+//!   - 上記以外                  : forwardを呼ぶ(カプセル化)
+//!
+//! に振り分ける。VLANタグはカーネルで取り除かれているため、
+//! scratchへ再挿入してから処理する。
+//! AF_XDPの場合は各受信キューのRXリングを処理する(VLANタグは付いたまま受信する)。
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] scratch フレーム加工用バッファ(ME6E_STUB_RING_SCRATCH_SIZE以上)
+//! @param [in] forward カプセル化対象フレームの処理関数
+//! @param [in] arg     forwardに渡す引数
+//!
+//! @return 処理したフレーム数
+///////////////////////////////////////////////////////////////////////////////
+int me6e_stub_ring_recv(me6e_stub_ring_t* ring, char* scratch,
+        me6e_stub_ring_recv_func forward, void* arg)
+{
+    // ローカル変数宣言
+    struct tpacket_block_desc*  bd;
+    struct tpacket3_hdr*        ph;
+    struct stub_ring_xsk_arg    xsk_arg;
+    char*                       frame;
+    ssize_t                     len;
+    unsigned int                i;
+    unsigned int                block;
+    int                         count = 0;
+
+    // 引数チェック
+    if ((ring == NULL) || (scratch == NULL) || (forward == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_stub_ring_recv).");
+        return 0;
+    }
+
+    ring->now = time(NULL);
+
+    if (ring->xsk_num > 0) {
+        // AF_XDP(フレームはUMEM上のまま処理する)
+        xsk_arg.ring    = ring;
+        xsk_arg.forward = forward;
+        xsk_arg.arg     = arg;
+        xsk_arg.count   = 0;
+        for (i = 0; i < (unsigned int)ring->xsk_num; i++) {
+            me6e_xsk_recv(ring->xsk[i], stub_ring_xsk_input, &xsk_arg);
+        }
+        return xsk_arg.count;
+    }
+
+    for (block = 0; block < ring->rx_block_num; block++) {
+        bd = (struct tpacket_block_desc*)(ring->map + (size_t)ring->rx_block * ring->rx_block_size);
+        if (!(__atomic_load_n(&bd->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+            break;
+        }
+
+        ph = (struct tpacket3_hdr*)((uint8_t*)bd + bd->hdr.bh1.offset_to_first_pkt);
+        for (i = 0; i < bd->hdr.bh1.num_pkts; i++) {
+            frame = (char*)ph + ph->tp_mac;
+            len   = ph->tp_snaplen;
+
+            if ((ph->tp_status & TP_STATUS_VLAN_VALID) &&
+                ((len + STUB_RING_VLAN_TAG_LEN) <= ME6E_STUB_RING_SCRATCH_SIZE) &&
+                (len >= ETH_ALEN * 2)) {
+                uint16_t tpid = (ph->tp_status & TP_STATUS_VLAN_TPID_VALID) ?
+                        ph->hv1.tp_vlan_tpid : ETH_P_8021Q;
+                uint16_t tag[2] = { htons(tpid), htons(ph->hv1.tp_vlan_tci) };
+
+                memcpy(scratch, frame, ETH_ALEN * 2);
+                memcpy(scratch + ETH_ALEN * 2, tag, sizeof(tag));
+                memcpy(scratch + ETH_ALEN * 2 + sizeof(tag), frame + ETH_ALEN * 2, len - ETH_ALEN * 2);
+                frame = scratch;
+                len  += STUB_RING_VLAN_TAG_LEN;
+            }
+
+            if (stub_ring_input(ring, frame, len, forward, arg)) {
+                count++;
+            }
+
+            ph = (struct tpacket3_hdr*)((uint8_t*)ph + ph->tp_next_offset);
+        }
+
+        // ブロックをカーネルへ返却
+        __atomic_store_n(&bd->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        ring->rx_block = (ring->rx_block + 1) % ring->rx_block_num;
+    }
+
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ホスト送信フレーム振り分け関数
+//!
+//! トンネルデバイスから受信したフレーム(ホスト自身が送信したフレーム)のうち、
+//! 物理デバイス側へ送信すべきものを送信リングへ送信する。
+//!
+//!   - 物理デバイス側で学習済み  : 送信リングへ送信(カプセル化不要)
+//!   - トンネル側で学習済み      : 何もしない(カプセル化)
+//!   - マルチキャスト/未学習     : 送信リングへ送信し、カプセル化も行う
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] frame   Ethernetフレーム
+//! @param [in] len     Ethernetフレーム長
+//!
+//! @retval true  処理済み(カプセル化不要)
+//! @retval false カプセル化が必要
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_stub_ring_from_host(me6e_stub_ring_t* ring, char* frame, ssize_t len)
+{
+    // ローカル変数宣言
+    struct ether_header*    eth;
+    struct iovec            iov;
+    int                     port = ME6E_STUB_RING_PORT_NONE;
+
+    // 引数チェック
+    if ((ring == NULL) || (frame == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_stub_ring_from_host).");
+        return false;
+    }
+
+    if (len < (ssize_t)sizeof(struct ether_header)) {
+        return false;
+    }
+
+    eth = (struct ether_header*)frame;
+    if (!(eth->ether_dhost[0] & 0x01)) {
+        port = stub_ring_mac_lookup(ring, eth->ether_dhost);
+    }
+
+    if (port == ME6E_STUB_RING_PORT_TUNNEL) {
+        return false;
+    }
+
+    iov.iov_base = frame;
+    iov.iov_len  = len;
+    me6e_stub_ring_send(ring, &iov, 1);
+
+    return (port == ME6E_STUB_RING_PORT_PHYSICAL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief Stub側送信関数
+//!
+//! Stub側へ送信するフレーム(デカプセル化したフレーム、代理応答等)を
+//! 宛先MACアドレスで振り分けて送信する。
+//! 送信元MACアドレスはトンネル側として学習する。
+//!
+//!   - ホスト自身宛て            : トンネルデバイスへ送信
+//!   - 物理デバイス側で学習済み  : 送信リングへ送信
+//!   - マルチキャスト/未学習     : 両方へ送信
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] iov     送信データ(先頭要素にEthernetヘッダを含むこと)
+//! @param [in] iovcnt  送信データの要素数
+//!
+//! @retval 0以上 送信したフレーム長
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_stub_ring_output(me6e_stub_ring_t* ring, const struct iovec* iov, int iovcnt)
+{
+    // ローカル変数宣言
+    struct ether_header*    eth;
+    ssize_t                 ret;
+
+    // 引数チェック
+    if ((ring == NULL) || (iov == NULL) || (iovcnt < 1) ||
+        (iov[0].iov_len < sizeof(struct ether_header))) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_stub_ring_output).");
+        errno = EINVAL;
+        return -1;
+    }
+
+    eth = (struct ether_header*)iov[0].iov_base;
+
+    if (!(eth->ether_shost[0] & 0x01) && !stub_ring_is_local(ring, eth->ether_shost)) {
+        stub_ring_mac_learn(ring, eth->ether_shost, ME6E_STUB_RING_PORT_TUNNEL);
+    }
+
+    if (eth->ether_dhost[0] & 0x01) {
+        ret = stub_ring_tap_write(ring, iov, iovcnt);
+        me6e_stub_ring_send(ring, iov, iovcnt);
+    }
+    else if (stub_ring_is_local(ring, eth->ether_dhost)) {
+        ret = stub_ring_tap_write(ring, iov, iovcnt);
+    }
+    else if (stub_ring_mac_lookup(ring, eth->ether_dhost) == ME6E_STUB_RING_PORT_PHYSICAL) {
+        ret = me6e_stub_ring_send(ring, iov, iovcnt);
+    }
+    else {
+        ret = me6e_stub_ring_send(ring, iov, iovcnt);
+        stub_ring_tap_write(ring, iov, iovcnt);
+    }
+
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信リング送信関数
+//!
+//! 送信リングの空きフレームにフレームを複製して送信要求を設定する。
+//! 送信要求がME6E_STUB_RING_TX_BATCHに達した場合はカーネルへ通知する。
+//! 空きフレームが無い場合は破棄する。
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] iov     送信データ
+//! @param [in] iovcnt  送信データの要素数
+//!
+//! @retval 0以上 送信要求したフレーム長
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_stub_ring_send(me6e_stub_ring_t* ring, const struct iovec* iov, int iovcnt)
+{
+    // ローカル変数宣言
+    struct tpacket3_hdr*    ph;
+    uint8_t*                data;
+    size_t                  len = 0;
+    size_t                  max_len;
+    int                     i;
+
+    // 引数チェック
+    if ((ring == NULL) || (iov == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_stub_ring_send).");
+        errno = EINVAL;
+        return -1;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+
+    if (ring->xsk_num > 0) {
+        // AF_XDP(送信はキュー0のソケットに集約する)
+        ssize_t ret = me6e_xsk_send(ring->xsk[0], iov, iovcnt);
+        if ((ret < 0) && (errno == ENOBUFS)) {
+            me6e_inc_decapsuling_ring_drop_count(ring->stat_info);
+        }
+        return ret;
+    }
+
+    max_len = ring->tx_frame_size - (TPACKET3_HDRLEN - sizeof(struct sockaddr_ll));
+    if (len > max_len) {
+        DEBUG_LOG("stub ring frame too long(%zu).\n", len);
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    pthread_mutex_lock(&ring->tx_mutex);
+
+    ph = (struct tpacket3_hdr*)(ring->tx_map + (size_t)ring->tx_frame * ring->tx_frame_size);
+    if (__atomic_load_n(&ph->tp_status, __ATOMIC_ACQUIRE) & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING)) {
+        // 送信リング満杯
+        stub_ring_kick(ring);
+        pthread_mutex_unlock(&ring->tx_mutex);
+        me6e_inc_decapsuling_ring_drop_count(ring->stat_info);
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    data = (uint8_t*)ph + TPACKET3_HDRLEN - sizeof(struct sockaddr_ll);
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(data, iov[i].iov_base, iov[i].iov_len);
+        data += iov[i].iov_len;
+    }
+    ph->tp_len          = len;
+    ph->tp_snaplen      = len;
+    ph->tp_next_offset  = 0;
+    __atomic_store_n(&ph->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+    ring->tx_frame = (ring->tx_frame + 1) % ring->tx_frame_num;
+    if (++ring->tx_pending >= ME6E_STUB_RING_TX_BATCH) {
+        stub_ring_kick(ring);
+    }
+
+    pthread_mutex_unlock(&ring->tx_mutex);
+
+    return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信リング通知関数
+//!
+//! 未通知の送信要求があればカーネルへ送信を通知する。
+//! バースト処理の終了時に呼び出すこと。
+//!
+//! @param [in] ring    Stub側パケットリング
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_stub_ring_flush(me6e_stub_ring_t* ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+
+    if (ring->xsk_num > 0) {
+        me6e_xsk_flush(ring->xsk[0]);
+        return;
+    }
+
+    pthread_mutex_lock(&ring->tx_mutex);
+    if (ring->tx_pending > 0) {
+        stub_ring_kick(ring);
+    }
+    pthread_mutex_unlock(&ring->tx_mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受信フレーム振り分け関数
+//!
+//! 物理デバイスから受信したフレームの送信元MACアドレスを学習し、
+//! 宛先MACアドレスでトンネルデバイス/カプセル化対象に振り分ける。
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] frame   Ethernetフレーム
+//! @param [in] len     Ethernetフレーム長
+//! @param [in] forward カプセル化対象フレームの処理関数
+//! @param [in] arg     forwardに渡す引数
+//!
+//! @retval true  処理した
+//! @retval false フレーム長不正
+///////////////////////////////////////////////////////////////////////////////
+static inline bool stub_ring_input(me6e_stub_ring_t* ring, char* frame, ssize_t len,
+        me6e_stub_ring_recv_func forward, void* arg)
+{
+    // ローカル変数宣言
+    struct ether_header*    eth;
+    struct iovec            iov;
+
+    if (len < (ssize_t)sizeof(struct ether_header)) {
+        return false;
+    }
+
+    eth = (struct ether_header*)frame;
+
+    if (!(eth->ether_shost[0] & 0x01)) {
+        stub_ring_mac_learn(ring, eth->ether_shost, ME6E_STUB_RING_PORT_PHYSICAL);
+    }
+
+    iov.iov_base = frame;
+    iov.iov_len  = len;
+
+    if (eth->ether_dhost[0] & 0x01) {
+        // ホスト自身へ渡してからカプセル化する(forwardでフレームが書き換わるため)
+        stub_ring_tap_write(ring, &iov, 1);
+        forward(arg, frame, len);
+    }
+    else if (stub_ring_is_local(ring, eth->ether_dhost)) {
+        stub_ring_tap_write(ring, &iov, 1);
+    }
+    else if (stub_ring_mac_lookup(ring, eth->ether_dhost) == ME6E_STUB_RING_PORT_PHYSICAL) {
+        // 同一セグメント内の通信は破棄
+    }
+    else {
+        forward(arg, frame, len);
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDP受信フレーム処理関数
+//!
+//! me6e_xsk_recvから受信フレーム毎に呼ばれる。
+//!
+//! @param [in] arg     処理コンテキスト(struct stub_ring_xsk_arg)
+//! @param [in] frame   Ethernetフレーム(UMEM上)
+//! @param [in] len     Ethernetフレーム長
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void stub_ring_xsk_input(void* arg, char* frame, ssize_t len)
+{
+    struct stub_ring_xsk_arg* xsk_arg = (struct stub_ring_xsk_arg*)arg;
+
+    if (stub_ring_input(xsk_arg->ring, frame, len, xsk_arg->forward, xsk_arg->arg)) {
+        xsk_arg->count++;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief パケットソケット生成関数
+//!
+//! TPACKET_V3のパケットソケットを生成し、受信リング/送信リングをマッピングする。
+//!
+//! @param [in,out] ring    Stub側パケットリング
+//! @param [in]     ifname  Stub側物理デバイス名
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int stub_ring_open_packet(me6e_stub_ring_t* ring, const char* ifname)
+{
+    // ローカル変数宣言
+    int                 version = TPACKET_V3;
+    int                 ignore  = 1;
+    unsigned int        frame_size;
+    unsigned int        block_size;
+    size_t              rx_size;
+    struct tpacket_req3 req;
+    struct sockaddr_ll  sll;
+    struct packet_mreq  mreq;
+
+    ring->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (ring->fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create packet socket : %s.", strerror(errno));
+        return -1;
+    }
+
+    if (setsockopt(ring->fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        me6e_logging(LOG_ERR, "fail to set TPACKET_V3 : %s.", strerror(errno));
+        return -1;
+    }
+
+    // 自ソケットから送信したフレームを受信リングに折り返さない
+    // (未対応のカーネルではMAC学習で破棄されるため処理継続)
+    if (setsockopt(ring->fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignore, sizeof(ignore)) < 0) {
+        me6e_logging(LOG_WARNING, "fail to set PACKET_IGNORE_OUTGOING : %s.", strerror(errno));
+    }
+
+    // 受信リング(ブロック単位でまとめて受信)
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size       = ME6E_STUB_RING_BLOCK_SIZE;
+    req.tp_block_nr         = ME6E_STUB_RING_BLOCK_NUM;
+    req.tp_frame_size       = STUB_RING_RX_FRAME_SIZE;
+    req.tp_frame_nr         = (ME6E_STUB_RING_BLOCK_SIZE / STUB_RING_RX_FRAME_SIZE) * ME6E_STUB_RING_BLOCK_NUM;
+    req.tp_retire_blk_tov   = ME6E_STUB_RING_BLOCK_TOV;
+    req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+    if (setsockopt(ring->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+        me6e_logging(LOG_ERR, "fail to set PACKET_RX_RING : %s.", strerror(errno));
+        return -1;
+    }
+    ring->rx_block_size = req.tp_block_size;
+    ring->rx_block_num  = req.tp_block_nr;
+    rx_size = (size_t)req.tp_block_size * req.tp_block_nr;
+
+    // 送信リング(MTU + L2ヘッダが収まる2のべき乗のフレームサイズ)
+    // (TPACKET_V3の送信リングではブロック満了時間等は指定できない)
+    frame_size = STUB_RING_TX_FRAME_MIN;
+    while (frame_size < TPACKET3_HDRLEN + ring->mtu + ETH_HLEN + STUB_RING_VLAN_TAG_LEN) {
+        frame_size <<= 1;
+    }
+    block_size = (frame_size > STUB_RING_TX_BLOCK_SIZE) ? frame_size : STUB_RING_TX_BLOCK_SIZE;
+
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = block_size;
+    req.tp_frame_size = frame_size;
+    req.tp_block_nr   = (ME6E_STUB_RING_TX_FRAME_NUM + (block_size / frame_size) - 1) / (block_size / frame_size);
+    req.tp_frame_nr   = req.tp_block_nr * (block_size / frame_size);
+    if (setsockopt(ring->fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0) {
+        me6e_logging(LOG_ERR, "fail to set PACKET_TX_RING : %s.", strerror(errno));
+        return -1;
+    }
+    ring->tx_frame_size = req.tp_frame_size;
+    ring->tx_frame_num  = req.tp_frame_nr;
+
+    ring->map_size = rx_size + (size_t)req.tp_block_size * req.tp_block_nr;
+    ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, ring->fd, 0);
+    if (ring->map == MAP_FAILED) {
+        // ロックできない場合(RLIMIT_MEMLOCK超過)はロック無しで再試行
+        ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+    }
+    if (ring->map == MAP_FAILED) {
+        me6e_logging(LOG_ERR, "fail to mmap packet ring : %s.", strerror(errno));
+        return -1;
+    }
+    ring->tx_map = ring->map + rx_size;
+
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family   = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    sll.sll_ifindex  = ring->ifindex;
+    if (bind(ring->fd, (struct sockaddr*)&sll, sizeof(sll)) < 0) {
+        me6e_logging(LOG_ERR, "fail to bind packet socket to %s : %s.", ifname, strerror(errno));
+        return -1;
+    }
+
+    // Bridgeに接続しないため、他ホスト宛てのフレームを受信できるよう
+    // プロミスキャスモードに設定する(ソケットのクローズで解除される)
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.mr_ifindex = ring->ifindex;
+    mreq.mr_type    = PACKET_MR_PROMISC;
+    if (setsockopt(ring->fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        me6e_logging(LOG_ERR, "fail to set promiscuous mode %s : %s.", ifname, strerror(errno));
+        return -1;
+    }
+
+    DEBUG_LOG("stub ring %s : rx %u x %u, tx %u x %u\n", ifname,
+            ring->rx_block_num, ring->rx_block_size, ring->tx_frame_num, ring->tx_frame_size);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDPソケット生成関数
+//!
+//! 受信フレームをAF_XDPソケットへリダイレクトするXDPプログラムをアタッチし、
+//! 受信キュー毎にAF_XDPソケットを生成する。
+//! 複数のAF_XDPソケットをまとめて待ち受けるため、epollを生成して登録する。
+//! XDPのリダイレクトはパケットソケットのプロミスキャス設定が使えないため、
+//! デバイスのフラグでプロミスキャスモードに設定する。
+//!
+//! @param [in,out] ring    Stub側パケットリング
+//! @param [in]     ifname  Stub側物理デバイス名
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int stub_ring_open_xdp(me6e_stub_ring_t* ring, const char* ifname)
+{
+    // ローカル変数宣言
+    struct epoll_event  ev;
+    int                 queue_num;
+    int                 i;
+    int                 ret;
+
+    queue_num = me6e_xsk_queue_num(ifname);
+
+    if (me6e_xsk_prog_attach(ring->ifindex, queue_num, &ring->xsk_prog) != 0) {
+        return -1;
+    }
+
+    ring->poll_fd = epoll_create(queue_num);
+    if (ring->poll_fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create epoll xsk : %s.", strerror(errno));
+        return -1;
+    }
+
+    for (i = 0; i < queue_num; i++) {
+        ring->xsk[i] = me6e_xsk_create(ring->ifindex, i, ring->xsk_prog.skb_mode);
+        if (ring->xsk[i] == NULL) {
+            return -1;
+        }
+        ring->xsk_num++;
+
+        if (me6e_xsk_prog_register(&ring->xsk_prog, ring->xsk[i]) != 0) {
+            return -1;
+        }
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events   = EPOLLIN;
+        ev.data.ptr = ring->xsk[i];
+        if (epoll_ctl(ring->poll_fd, EPOLL_CTL_ADD, ring->xsk[i]->fd, &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control epoll xsk : %s.", strerror(errno));
+            return -1;
+        }
+    }
+
+    ret = me6e_network_set_flags_by_index(ring->ifindex, IFF_PROMISC);
+    if (ret != 0) {
+        me6e_logging(LOG_ERR, "fail to set promiscuous mode %s : %s.", ifname, strerror(ret));
+        return -1;
+    }
+    ring->promisc = true;
+
+    me6e_logging(LOG_INFO, "stub ring %s : AF_XDP %d queues (%s mode, %s).", ifname, queue_num,
+            ring->xsk_prog.skb_mode ? "generic" : "native",
+            ring->xsk[0]->zerocopy ? "zerocopy" : "copy");
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDPソケット解放関数
+//!
+//! AF_XDPソケットとXDPプログラムを解放し、プロミスキャスモードを解除する。
+//!
+//! @param [in,out] ring    Stub側パケットリング
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void stub_ring_close_xdp(me6e_stub_ring_t* ring)
+{
+    int i;
+
+    // XSKMAPからの参照を先に外す
+    me6e_xsk_prog_detach(&ring->xsk_prog);
+
+    for (i = 0; i < ring->xsk_num; i++) {
+        me6e_xsk_flush(ring->xsk[i]);
+        me6e_xsk_destroy(ring->xsk[i]);
+        ring->xsk[i] = NULL;
+    }
+    ring->xsk_num = 0;
+
+    if ((ring->poll_fd >= 0) && (ring->poll_fd != ring->fd)) {
+        close(ring->poll_fd);
+        ring->poll_fd = -1;
+    }
+
+    if (ring->promisc) {
+        me6e_network_set_flags_by_index(ring->ifindex, -IFF_PROMISC);
+        ring->promisc = false;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief MAC学習テーブルハッシュ関数
+//!
+//! @param [in] addr    MACアドレス
+//!
+//! @return MAC学習テーブルのインデックス
+///////////////////////////////////////////////////////////////////////////////
+static inline unsigned int stub_ring_mac_hash(const uint8_t* addr)
+{
+    unsigned int hash;
+
+    // OUIは偏りが大きいため下位3バイトを主に使用する
+    hash = ((unsigned int)addr[3] << 16) | ((unsigned int)addr[4] << 8) | addr[5];
+    hash ^= (hash >> 12) ^ ((unsigned int)addr[2] << 4);
+
+    return hash & (ME6E_STUB_RING_MAC_NUM - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief MAC学習テーブル検索関数
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] addr    MACアドレス
+//!
+//! @return 学習先(未学習または満了時はME6E_STUB_RING_PORT_NONE)
+///////////////////////////////////////////////////////////////////////////////
+static inline int stub_ring_mac_lookup(me6e_stub_ring_t* ring, const uint8_t* addr)
+{
+    me6e_stub_ring_mac_t* entry = &ring->mac[stub_ring_mac_hash(addr)];
+
+    if ((entry->expire < ring->now) || (memcmp(entry->addr, addr, ETH_ALEN) != 0)) {
+        return ME6E_STUB_RING_PORT_NONE;
+    }
+
+    return entry->port;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief MAC学習関数
+//!
+//! 送信元MACアドレスを学習する。同じ学習先で満了まで十分な時間がある場合は
+//! 更新しない(受信毎の書き込みと排他を避けるため)。
+//! ハッシュが衝突した場合は後から学習したアドレスで上書きする。
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] addr    MACアドレス
+//! @param [in] port    学習先
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void stub_ring_mac_learn(me6e_stub_ring_t* ring, const uint8_t* addr, uint8_t port)
+{
+    me6e_stub_ring_mac_t* entry = &ring->mac[stub_ring_mac_hash(addr)];
+    time_t now = ring->now;
+
+    if ((entry->port == port) &&
+        (entry->expire >= now + ME6E_STUB_RING_MAC_AGEING / 2) &&
+        (memcmp(entry->addr, addr, ETH_ALEN) == 0)) {
+        return;
+    }
+
+    pthread_mutex_lock(&ring->mac_mutex);
+    // 更新中の参照で別アドレスと誤認しないよう、先に満了させてから書き換える
+    entry->expire = 0;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(entry->addr, addr, ETH_ALEN);
+    entry->port   = port;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    entry->expire = now + ME6E_STUB_RING_MAC_AGEING;
+    pthread_mutex_unlock(&ring->mac_mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief ホスト自身宛て判定関数
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] addr    MACアドレス
+//!
+//! @retval true  ホスト自身(Bridgeデバイス)のMACアドレス
+//! @retval false 上記以外
+///////////////////////////////////////////////////////////////////////////////
+static inline bool stub_ring_is_local(const me6e_stub_ring_t* ring, const uint8_t* addr)
+{
+    return (memcmp(addr, ring->local_hwaddr.ether_addr_octet, ETH_ALEN) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief トンネルデバイス送信関数
+//!
+//! ホスト自身へ渡すフレームをトンネルデバイスへ送信する。
+//!
+//! @param [in] ring    Stub側パケットリング
+//! @param [in] iov     送信データ
+//! @param [in] iovcnt  送信データの要素数
+//!
+//! @retval 0以上 送信したフレーム長
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+static inline ssize_t stub_ring_tap_write(me6e_stub_ring_t* ring, const struct iovec* iov, int iovcnt)
+{
+    ssize_t ret = me6e_vnet_writev(ring->tap_fd, ring->tap_vnet_hdr, iov, iovcnt);
+
+    if (ret < 0) {
+        DEBUG_LOG("fail to write tunnel device : %s\n", strerror(errno));
+    }
+
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信通知関数
+//!
+//! 送信リングの送信要求をカーネルへ通知する。tx_mutexを獲得して呼び出すこと。
+//!
+//! @param [in] ring    Stub側パケットリング
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void stub_ring_kick(me6e_stub_ring_t* ring)
+{
+    if ((send(ring->fd, NULL, 0, MSG_DONTWAIT) < 0) && (errno != EAGAIN) && (errno != ENOBUFS)) {
+        DEBUG_LOG("fail to kick stub ring : %s\n", strerror(errno));
+    }
+    ring->tx_pending = 0;
+
+    return;
+}
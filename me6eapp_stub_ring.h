@@ -0,0 +1,123 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_stub_ring.h                                           */
+/* 機能概要   : Stub側パケットリング(TPACKET_V3/AF_XDP) ヘッダファイル        */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_STUB_RING_H__
+#define __ME6EAPP_STUB_RING_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <net/ethernet.h>
+
+#include "me6eapp_statistics.h"
+#include "me6eapp_xsk.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 受信リングのブロックサイズ
+#define ME6E_STUB_RING_BLOCK_SIZE   (1 << 20)
+//! 受信リングのブロック数
+#define ME6E_STUB_RING_BLOCK_NUM    32
+//! 受信ブロックの満了時間(ミリ秒)
+#define ME6E_STUB_RING_BLOCK_TOV    1
+//! 送信リングのフレーム数
+#define ME6E_STUB_RING_TX_FRAME_NUM 1024
+//! 送信要求をまとめてカーネルへ通知するフレーム数
+#define ME6E_STUB_RING_TX_BATCH     64
+//! MAC学習テーブルのエントリ数(2のべき乗)
+#define ME6E_STUB_RING_MAC_NUM      4096
+//! 学習したMACアドレスの保持時間(秒)
+#define ME6E_STUB_RING_MAC_AGEING   300
+//! 受信フレーム加工用バッファのサイズ(VLANタグ再挿入用)
+#define ME6E_STUB_RING_SCRATCH_SIZE (65535 + 256)
+
+//! MACアドレスの学習先(未学習)
+#define ME6E_STUB_RING_PORT_NONE        0
+//! MACアドレスの学習先(Stub側物理デバイス)
+#define ME6E_STUB_RING_PORT_PHYSICAL    1
+//! MACアドレスの学習先(トンネル側)
+#define ME6E_STUB_RING_PORT_TUNNEL      2
+
+///////////////////////////////////////////////////////////////////////////////
+//! 物理デバイス側で学習したMACアドレス
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_stub_ring_mac_t
+{
+    uint8_t             addr[ETH_ALEN]; ///< MACアドレス
+    uint8_t             port;           ///< 学習先
+    time_t              expire;         ///< 満了時刻
+};
+typedef struct me6e_stub_ring_mac_t me6e_stub_ring_mac_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! Stub側パケットリング
+//!
+//! Stub側物理デバイスをブリッジに接続せず、TPACKET_V3の受信/送信リングで
+//! 直接送受信する。ブリッジの代わりに物理デバイス側とトンネル側の
+//! MACアドレスを学習し、Stub側への送信フレームを物理デバイス(送信リング)と
+//! トンネルデバイス(ブリッジ経由でホスト自身)に振り分ける。
+//! AF_XDPを使用する場合は受信キュー毎のAF_XDPソケットで送受信し、
+//! poll_fdには各ソケットを登録したepollを設定する。
+//! MAC学習テーブルの更新は内容が変わる場合のみmutexで排他し、
+//! 参照は排他しない(競合時は未学習として扱われ、両方へ送信される)。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_stub_ring_t
+{
+    int                 fd;             ///< パケットソケット
+    int                 poll_fd;        ///< 受信待ち受け用ファイルディスクリプタ
+    int                 ifindex;        ///< Stub側物理デバイスのインデックス
+    int                 mtu;            ///< Stub側物理デバイスのMTU
+    int                 tap_fd;         ///< トンネルデバイス
+    bool                tap_vnet_hdr;   ///< トンネルデバイスの仮想NICヘッダの有効/無効
+    struct ether_addr   local_hwaddr;   ///< ホスト自身(Bridgeデバイス)のMACアドレス
+    uint8_t*            map;            ///< リングのマッピング先頭(受信→送信の順)
+    size_t              map_size;       ///< リングのマッピングサイズ
+    unsigned int        rx_block_size;  ///< 受信リングのブロックサイズ
+    unsigned int        rx_block_num;   ///< 受信リングのブロック数
+    unsigned int        rx_block;       ///< 次に処理する受信ブロック
+    unsigned int        tx_frame_size;  ///< 送信リングのフレームサイズ
+    unsigned int        tx_frame_num;   ///< 送信リングのフレーム数
+    uint8_t*            tx_map;         ///< 送信リング先頭
+    unsigned int        tx_frame;       ///< 次に使用する送信フレーム
+    int                 tx_pending;     ///< 送信要求済みで未通知のフレーム数
+    pthread_mutex_t     tx_mutex;       ///< 送信リング排他用mutex
+    me6e_xsk_t*         xsk[ME6E_XSK_QUEUE_MAX]; ///< AF_XDPソケット(受信キュー毎)
+    int                 xsk_num;        ///< AF_XDPソケット数(0の場合はTPACKET_V3)
+    me6e_xsk_prog_t     xsk_prog;       ///< AF_XDPへリダイレクトするXDPプログラム
+    bool                promisc;        ///< デバイスフラグでプロミスキャスモードにしたかどうか
+    pthread_mutex_t     mac_mutex;      ///< MAC学習テーブル更新排他用mutex
+    volatile time_t     now;            ///< MAC学習用の現在時刻(受信/送信処理毎に更新)
+    me6e_statistics_t*  stat_info;      ///< 統計情報
+    me6e_stub_ring_mac_t mac[ME6E_STUB_RING_MAC_NUM]; ///< MAC学習テーブル
+};
+typedef struct me6e_stub_ring_t me6e_stub_ring_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 受信フレーム処理関数
+//!
+//! 受信リング上のフレーム(物理デバイスからの受信)毎に呼ばれる。
+///////////////////////////////////////////////////////////////////////////////
+typedef void (*me6e_stub_ring_recv_func)(void* arg, char* frame, ssize_t len);
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_stub_ring_t* me6e_stub_ring_create(const char* ifname, int tap_fd, bool tap_vnet_hdr,
+        const struct ether_addr* local_hwaddr, bool xdp, me6e_statistics_t* stat_info);
+void me6e_stub_ring_destroy(me6e_stub_ring_t* ring);
+int me6e_stub_ring_recv(me6e_stub_ring_t* ring, char* scratch,
+        me6e_stub_ring_recv_func forward, void* arg);
+bool me6e_stub_ring_from_host(me6e_stub_ring_t* ring, char* frame, ssize_t len);
+ssize_t me6e_stub_ring_output(me6e_stub_ring_t* ring, const struct iovec* iov, int iovcnt);
+ssize_t me6e_stub_ring_send(me6e_stub_ring_t* ring, const struct iovec* iov, int iovcnt);
+void me6e_stub_ring_flush(me6e_stub_ring_t* ring);
+
+#endif // __ME6EAPP_STUB_RING_H__
@@ -18,6 +18,7 @@
 #include "me6eapp_list.h"
 #include "me6eapp_timer.h"
 #include "me6eapp_log.h"
+#include "me6eapp_affinity.h"
 
 // デバッグ用マクロ
 #ifdef DEBUG
@@ -181,6 +182,7 @@ int me6e_timer_register(
     evp.sigev_signo  = SIGRTMIN + 1;              // リアルタイムタイマーを指定
     evp.sigev_notify_function = timer_timeout_cb; // 関数ポインタ
     evp.sigev_value.sival_ptr = cb_data;          // 関数呼び出し時の引数
+    evp.sigev_notify_attributes = me6e_affinity_control_attr(); // コールバックスレッドの属性(制御スレッドのCPU)
 
     if(timer_create(CLOCK_MONOTONIC, &evp, &cb_data->timerid) < 0) {
         // エラー処理
@@ -0,0 +1,585 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_txq.c                                                 */
+/* 機能概要   : 送信キュー ソースファイル                                     */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip6.h>
+#include <net/ethernet.h>
+#include <linux/if_ether.h>
+
+#include "me6eapp_txq.h"
+#include "me6eapp_vnet.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 送信制御情報(cmsg)の最大長
+#define TXQ_CONTROL_MAX         CMSG_SPACE(sizeof(struct in6_pktinfo))
+
+//! 高優先とするDSCPの下限(EF以上。CS6/CS7のネットワーク制御を含む)
+#define TXQ_HIGH_DSCP           46
+
+//! 高優先とするVLANの優先度(PCP)の下限
+#define TXQ_HIGH_PCP            6
+
+//! キューに積んで再送する送信エラーかどうか
+#define TXQ_RETRY_ERRNO(err)    (((err) == EAGAIN) || ((err) == EWOULDBLOCK) || ((err) == ENOBUFS))
+
+///////////////////////////////////////////////////////////////////////////////
+//! キューに積んだフレームの送信情報
+//!
+//! パケットバッファのデータ先頭に格納し、続けてフレームを格納する。
+///////////////////////////////////////////////////////////////////////////////
+struct txq_hdr
+{
+    struct sockaddr_in6 name;           ///< 送信先アドレス
+    socklen_t           namelen;        ///< 送信先アドレス長(0は指定なし)
+    size_t              controllen;     ///< 送信制御情報長(0は指定なし)
+    char                control[TXQ_CONTROL_MAX] __attribute__((aligned(8))); ///< 送信制御情報
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static inline ssize_t txq_xmit(me6e_txq_t* txq, const struct msghdr* msg);
+static ssize_t txq_enqueue(me6e_txq_t* txq, const struct msghdr* msg, bool high);
+static me6e_buf_t* txq_evict(me6e_txq_t* txq);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信キュー生成関数
+//!
+//! @param [in] name        表示名
+//! @param [in] type        送信先の種別
+//! @param [in] fd          送信先のディスクリプタ
+//! @param [in] vnet_hdr    仮想NICヘッダの有効/無効(トンネルデバイスのみ)
+//! @param [in] pool        フレーム保持用のパケットバッファプール
+//! @param [in] capacity    保持できるフレーム数の上限
+//! @param [in] policy      満杯時の破棄ポリシー
+//!
+//! @return 生成した送信キュー(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_txq_t* me6e_txq_create(const char* name, me6e_txq_type type, int fd, bool vnet_hdr,
+                me6e_bufpool_t* pool, int capacity, me6e_txq_policy policy)
+{
+    // ローカル変数宣言
+    me6e_txq_t*         txq;
+    struct epoll_event  ev;
+
+    // 引数チェック
+    if ((name == NULL) || (fd < 0) || (pool == NULL) || (capacity <= 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_txq_create).");
+        return NULL;
+    }
+
+    txq = malloc(sizeof(me6e_txq_t));
+    if (txq == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for tx queue.");
+        return NULL;
+    }
+    memset(txq, 0, sizeof(me6e_txq_t));
+    pthread_mutex_init(&txq->mutex, NULL);
+    txq->name     = name;
+    txq->type     = type;
+    txq->fd       = fd;
+    txq->vnet_hdr = vnet_hdr;
+    txq->pool     = pool;
+    txq->capacity = capacity;
+    txq->policy   = policy;
+    txq->efd      = -1;
+    txq->epfd     = -1;
+
+    txq->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (txq->efd < 0) {
+        me6e_logging(LOG_ERR, "fail to create tx queue eventfd : %s.", strerror(errno));
+        me6e_txq_destroy(txq);
+        return NULL;
+    }
+
+    txq->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (txq->epfd < 0) {
+        me6e_logging(LOG_ERR, "fail to create tx queue epoll : %s.", strerror(errno));
+        me6e_txq_destroy(txq);
+        return NULL;
+    }
+
+    ev.events  = EPOLLIN;
+    ev.data.fd = txq->efd;
+    if (epoll_ctl(txq->epfd, EPOLL_CTL_ADD, txq->efd, &ev) != 0) {
+        me6e_logging(LOG_ERR, "fail to control tx queue epoll : %s.", strerror(errno));
+        me6e_txq_destroy(txq);
+        return NULL;
+    }
+
+    // 送信先はキューに積んだ時のみEPOLLOUTを待ち合わせる
+    ev.events  = 0;
+    ev.data.fd = fd;
+    if (epoll_ctl(txq->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        me6e_logging(LOG_ERR, "fail to control tx queue epoll : %s.", strerror(errno));
+        me6e_txq_destroy(txq);
+        return NULL;
+    }
+
+    me6e_logging(LOG_INFO, "%s tx queue : %d frames, %s drop.", name, capacity,
+                 (policy == ME6E_TXQ_POLICY_PRIORITY) ? "priority" : "tail");
+
+    return txq;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信キュー解放関数
+//!
+//! 保持中のフレームは送信せずに破棄する。
+//!
+//! @param [in] txq     送信キュー(NULLの場合は何もしない)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_txq_destroy(me6e_txq_t* txq)
+{
+    // ローカル変数宣言
+    me6e_buf_t* buf;
+    int         band;
+
+    if (txq == NULL) {
+        return;
+    }
+
+    for (band = 0; band < ME6E_TXQ_BAND_NUM; band++) {
+        while ((buf = txq->head[band]) != NULL) {
+            txq->head[band] = buf->next;
+            me6e_buf_free(buf);
+        }
+    }
+    if (txq->epfd >= 0) {
+        close(txq->epfd);
+    }
+    if (txq->efd >= 0) {
+        close(txq->efd);
+    }
+    pthread_mutex_destroy(&txq->mutex);
+    free(txq);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信キュー送信関数
+//!
+//! キューが空の場合は直接送信し、送信先が一時的に送信できない場合のみ
+//! キューに積む。キューが空でない場合、または送信キュー処理スレッドが
+//! 送信中の場合は順序を保つためキューに積む。
+//!
+//! @param [in] txq     送信キュー
+//! @param [in] msg     送信メッセージ(トンネルデバイスの場合はmsg_iovのみ使用)
+//! @param [in] high    高優先のフレームかどうか
+//!
+//! @return 送信した(キューに積んだ)データ長(異常時は-1。満杯で破棄した場合のerrnoはENOBUFS)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_txq_send(me6e_txq_t* txq, const struct msghdr* msg, bool high)
+{
+    // ローカル変数宣言
+    ssize_t ret;
+    bool    empty;
+
+    // 送信キュー処理スレッドの送信完了(depth/inflightの更新)はmutex配下で判定する
+    pthread_mutex_lock(&txq->mutex);
+    empty = ((txq->depth == 0) && (txq->inflight == NULL));
+    pthread_mutex_unlock(&txq->mutex);
+
+    if (empty) {
+        ret = txq_xmit(txq, msg);
+        if ((ret >= 0) || !TXQ_RETRY_ERRNO(errno)) {
+            return ret;
+        }
+    }
+
+    return txq_enqueue(txq, msg, high);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信キュー再送関数
+//!
+//! キューに積んだフレームを高優先から順に、送信先が送信できなくなるまで送信する。
+//! 送信キュー処理スレッドからのみ呼び出すこと。
+//!
+//! @param [in] txq     送信キュー
+//!
+//! @return 送信できずに残ったフレーム数
+///////////////////////////////////////////////////////////////////////////////
+int me6e_txq_drain(me6e_txq_t* txq)
+{
+    // ローカル変数宣言
+    me6e_buf_t*     buf;
+    struct txq_hdr* hdr;
+    struct msghdr   msg;
+    struct iovec    iov;
+    ssize_t         ret;
+    int             band;
+    int             depth;
+
+    while (1) {
+        pthread_mutex_lock(&txq->mutex);
+        band = (txq->head[ME6E_TXQ_BAND_HIGH] != NULL) ? ME6E_TXQ_BAND_HIGH : ME6E_TXQ_BAND_NORMAL;
+        buf  = txq->head[band];
+        if (buf == NULL) {
+            pthread_mutex_unlock(&txq->mutex);
+            return 0;
+        }
+        // 送信中のフレームは優先破棄の対象外とする
+        txq->inflight = buf;
+        pthread_mutex_unlock(&txq->mutex);
+
+        hdr = (struct txq_hdr*)me6e_buf_data(buf);
+        iov.iov_base = (char*)(hdr + 1);
+        iov.iov_len  = buf->len - sizeof(struct txq_hdr);
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name       = (hdr->namelen > 0) ? &hdr->name : NULL;
+        msg.msg_namelen    = hdr->namelen;
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = (hdr->controllen > 0) ? hdr->control : NULL;
+        msg.msg_controllen = hdr->controllen;
+
+        ret = txq_xmit(txq, &msg);
+        if ((ret < 0) && TXQ_RETRY_ERRNO(errno)) {
+            pthread_mutex_lock(&txq->mutex);
+            txq->inflight = NULL;
+            depth = txq->depth;
+            pthread_mutex_unlock(&txq->mutex);
+            return depth;
+        }
+
+        pthread_mutex_lock(&txq->mutex);
+        txq->head[band] = buf->next;
+        if (txq->head[band] == NULL) {
+            txq->tail[band] = NULL;
+        }
+        txq->inflight = NULL;
+        txq->depth--;
+        if (ret < 0) {
+            txq->error_count++;
+        }
+        else {
+            txq->drain_count++;
+        }
+        pthread_mutex_unlock(&txq->mutex);
+
+        if (ret < 0) {
+            DEBUG_LOG("%s tx queue send error : %s.\n", txq->name, strerror(errno));
+        }
+        me6e_buf_free(buf);
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信キュー待ち合わせ関数
+//!
+//! キューが空の場合はフレームが積まれるまで、空でない場合は送信先の
+//! EPOLLOUTまたは再送間隔の経過まで待ち合わせる。
+//! 送信キュー処理スレッドからのみ呼び出すこと。
+//! (休止中はスレッドのキャンセルポイントとなる)
+//!
+//! @param [in] txq     送信キュー
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_txq_wait(me6e_txq_t* txq)
+{
+    // ローカル変数宣言
+    struct epoll_event  ev[2];
+    eventfd_t           value;
+    int                 timeout;
+    int                 num;
+    int                 i;
+
+    timeout = -1;
+    if (txq->depth > 0) {
+        timeout = ME6E_TXQ_RETRY_MSEC;
+        if (!txq->armed) {
+            ev[0].events  = EPOLLOUT | EPOLLONESHOT;
+            ev[0].data.fd = txq->fd;
+            if (epoll_ctl(txq->epfd, EPOLL_CTL_MOD, txq->fd, &ev[0]) == 0) {
+                txq->armed = true;
+            }
+        }
+    }
+
+    num = epoll_wait(txq->epfd, ev, 2, timeout);
+    for (i = 0; i < num; i++) {
+        if (ev[i].data.fd == txq->efd) {
+            eventfd_read(txq->efd, &value);
+        }
+        else {
+            txq->armed = false;
+        }
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 高優先フレーム判定関数
+//!
+//! ARP、ICMPv6(近隣探索等)、VLANの優先度(PCP)が6以上、
+//! DSCPがEF以上のフレームを高優先とする。
+//!
+//! @param [in] frame   Ethernetフレーム
+//! @param [in] len     フレーム長
+//!
+//! @retval true  高優先
+//! @retval false 通常
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_txq_classify(const char* frame, size_t len)
+{
+    // ローカル変数宣言
+    const struct ether_header*  eth = (const struct ether_header*)frame;
+    const uint8_t*              l3;
+    uint16_t                    type;
+    size_t                      offset;
+
+    if (len < sizeof(struct ether_header)) {
+        return false;
+    }
+
+    type   = ntohs(eth->ether_type);
+    offset = sizeof(struct ether_header);
+    if ((type == ETH_P_8021Q) && (len >= offset + 4)) {
+        l3 = (const uint8_t*)frame + offset;
+        if ((l3[0] >> 5) >= TXQ_HIGH_PCP) {
+            return true;
+        }
+        type    = (l3[2] << 8) | l3[3];
+        offset += 4;
+    }
+
+    l3 = (const uint8_t*)frame + offset;
+    switch (type) {
+    case ETH_P_ARP:
+        return true;
+
+    case ETH_P_IP:
+        if (len >= offset + sizeof(struct ip)) {
+            return ((l3[1] >> 2) >= TXQ_HIGH_DSCP);
+        }
+        break;
+
+    case ETH_P_IPV6:
+        if (len >= offset + sizeof(struct ip6_hdr)) {
+            if (((const struct ip6_hdr*)l3)->ip6_nxt == IPPROTO_ICMPV6) {
+                return true;
+            }
+            return (((((l3[0] & 0x0f) << 4) | (l3[1] >> 4)) >> 2) >= TXQ_HIGH_DSCP);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信キュー表示関数
+//!
+//! @param [in] txq     送信キュー(NULLの場合は何もしない)
+//! @param [in] fd      出力先のファイルディスクリプタ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_txq_print(me6e_txq_t* txq, int fd)
+{
+    if (txq == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&txq->mutex);
+    dprintf(fd, "【TX Queue(%s)】\n", txq->name);
+    dprintf(fd, "   depth(current/max)   : %d / %d (capacity %d, %s drop)\n",
+            txq->depth, txq->depth_max, txq->capacity,
+            (txq->policy == ME6E_TXQ_POLICY_PRIORITY) ? "priority" : "tail");
+    dprintf(fd, "   queued/drained       : %llu / %llu\n",
+            (unsigned long long)txq->queue_count, (unsigned long long)txq->drain_count);
+    dprintf(fd, "   drop(tail/priority)  : %llu / %llu\n",
+            (unsigned long long)txq->tail_drop, (unsigned long long)txq->prio_drop);
+    dprintf(fd, "   error                : %llu\n", (unsigned long long)txq->error_count);
+    dprintf(fd, "\n");
+    pthread_mutex_unlock(&txq->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フレーム送信関数
+//!
+//! @param [in] txq     送信キュー
+//! @param [in] msg     送信メッセージ
+//!
+//! @return 送信したデータ長(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+static inline ssize_t txq_xmit(me6e_txq_t* txq, const struct msghdr* msg)
+{
+    if (txq->type == ME6E_TXQ_TYPE_TAP) {
+        return me6e_vnet_writev(txq->fd, txq->vnet_hdr, msg->msg_iov, msg->msg_iovlen);
+    }
+
+    return sendmsg(txq->fd, msg, MSG_DONTWAIT);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フレーム保持関数
+//!
+//! 送信メッセージをパケットバッファに複製してキューの末尾に積む。
+//! 満杯の場合は破棄ポリシーに従って破棄する。
+//!
+//! @param [in] txq     送信キュー
+//! @param [in] msg     送信メッセージ
+//! @param [in] high    高優先のフレームかどうか
+//!
+//! @return キューに積んだデータ長(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+static ssize_t txq_enqueue(me6e_txq_t* txq, const struct msghdr* msg, bool high)
+{
+    // ローカル変数宣言
+    me6e_buf_t*     buf;
+    me6e_buf_t*     victim = NULL;
+    struct txq_hdr* hdr;
+    char*           data;
+    size_t          len;
+    size_t          i;
+    int             band;
+    bool            kick;
+
+    len = 0;
+    for (i = 0; i < msg->msg_iovlen; i++) {
+        len += msg->msg_iov[i].iov_len;
+    }
+
+    // 送信情報と併せて複製する
+    buf = NULL;
+    if ((msg->msg_namelen <= sizeof(struct sockaddr_in6)) && (msg->msg_controllen <= TXQ_CONTROL_MAX)) {
+        buf = me6e_buf_alloc(txq->pool, sizeof(struct txq_hdr) + len);
+    }
+    if (buf == NULL) {
+        pthread_mutex_lock(&txq->mutex);
+        txq->error_count++;
+        pthread_mutex_unlock(&txq->mutex);
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    hdr = (struct txq_hdr*)me6e_buf_data(buf);
+    hdr->namelen    = (msg->msg_name != NULL) ? msg->msg_namelen : 0;
+    hdr->controllen = (msg->msg_control != NULL) ? msg->msg_controllen : 0;
+    if (hdr->namelen > 0) {
+        memcpy(&hdr->name, msg->msg_name, hdr->namelen);
+    }
+    if (hdr->controllen > 0) {
+        memcpy(hdr->control, msg->msg_control, hdr->controllen);
+    }
+    data = (char*)(hdr + 1);
+    for (i = 0; i < msg->msg_iovlen; i++) {
+        memcpy(data, msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+        data += msg->msg_iov[i].iov_len;
+    }
+    buf->len  = sizeof(struct txq_hdr) + len;
+    buf->next = NULL;
+    band      = high ? ME6E_TXQ_BAND_HIGH : ME6E_TXQ_BAND_NORMAL;
+
+    pthread_mutex_lock(&txq->mutex);
+    if (txq->depth >= txq->capacity) {
+        // 優先破棄の場合は高優先のフレームのために通常のフレームを破棄する
+        if ((txq->policy == ME6E_TXQ_POLICY_PRIORITY) && high) {
+            victim = txq_evict(txq);
+        }
+        if (victim == NULL) {
+            txq->tail_drop++;
+            pthread_mutex_unlock(&txq->mutex);
+            me6e_buf_free(buf);
+            errno = ENOBUFS;
+            return -1;
+        }
+        txq->prio_drop++;
+        txq->depth--;
+    }
+
+    if (txq->tail[band] != NULL) {
+        txq->tail[band]->next = buf;
+    }
+    else {
+        txq->head[band] = buf;
+    }
+    txq->tail[band] = buf;
+    txq->depth++;
+    txq->queue_count++;
+    if (txq->depth > txq->depth_max) {
+        txq->depth_max = txq->depth;
+    }
+    kick = (txq->depth == 1);
+    pthread_mutex_unlock(&txq->mutex);
+
+    if (victim != NULL) {
+        me6e_buf_free(victim);
+    }
+
+    // 空から積んだ場合は送信キュー処理スレッドを起床する
+    if (kick && (eventfd_write(txq->efd, 1) != 0)) {
+        me6e_logging(LOG_ERR, "fail to wakeup %s tx queue : %s.", txq->name, strerror(errno));
+    }
+
+    return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 優先破棄対象取り出し関数
+//!
+//! 通常のキューの最も古いフレーム(送信中の場合はその次)を取り出す。
+//! 送信キューのmutexを獲得した状態で呼び出すこと。
+//!
+//! @param [in] txq     送信キュー
+//!
+//! @return 取り出したフレーム(通常のフレームがない場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static me6e_buf_t* txq_evict(me6e_txq_t* txq)
+{
+    // ローカル変数宣言
+    me6e_buf_t* prev = NULL;
+    me6e_buf_t* victim;
+
+    victim = txq->head[ME6E_TXQ_BAND_NORMAL];
+    if ((victim != NULL) && (victim == txq->inflight)) {
+        prev   = victim;
+        victim = victim->next;
+    }
+    if (victim == NULL) {
+        return NULL;
+    }
+
+    if (prev != NULL) {
+        prev->next = victim->next;
+    }
+    else {
+        txq->head[ME6E_TXQ_BAND_NORMAL] = victim->next;
+    }
+    if (txq->tail[ME6E_TXQ_BAND_NORMAL] == victim) {
+        txq->tail[ME6E_TXQ_BAND_NORMAL] = prev;
+    }
+
+    return victim;
+}
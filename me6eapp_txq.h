@@ -0,0 +1,98 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_txq.h                                                 */
+/* 機能概要   : 送信キュー ヘッダファイル                                     */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_TXQ_H__
+#define __ME6EAPP_TXQ_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "me6eapp_config.h"
+#include "me6eapp_bufpool.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 送信できない間に再送を試みる間隔(ミリ秒)
+//! (ENOBUFSは送信可能になっても通知されないため、EPOLLOUTと併用する)
+#define ME6E_TXQ_RETRY_MSEC     1
+
+///////////////////////////////////////////////////////////////////////////////
+//! 送信先の種別
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_txq_type
+{
+    ME6E_TXQ_TYPE_SOCKET = 0,   ///< ソケット(sendmsgで送信)
+    ME6E_TXQ_TYPE_TAP    = 1,   ///< トンネルデバイス(仮想NICヘッダを付けてwritevで送信)
+};
+typedef enum me6e_txq_type me6e_txq_type;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 送信キューの優先度
+///////////////////////////////////////////////////////////////////////////////
+enum me6e_txq_band
+{
+    ME6E_TXQ_BAND_HIGH   = 0,   ///< 高優先(制御系/優先マーキングされたフレーム)
+    ME6E_TXQ_BAND_NORMAL = 1,   ///< 通常
+    ME6E_TXQ_BAND_NUM
+};
+typedef enum me6e_txq_band me6e_txq_band;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 送信キュー
+//!
+//! 送信先が一時的に送信できない(EAGAIN/ENOBUFS)場合に、フレームを
+//! パケットバッファに複製して上限数まで保持し、送信キュー処理スレッドが
+//! EPOLLOUT(ENOBUFSの場合は一定間隔)で再送する。キューが空でない間は
+//! 順序を保つため、新しいフレームも直接送信せずにキューに積む。
+//! 満杯時は、末尾破棄ポリシーでは新しいフレームを破棄し、優先破棄ポリシーでは
+//! 高優先のフレームのために保持中の通常のフレームを破棄する。
+//! 複数のスレッドから送信してよい。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_txq_t
+{
+    pthread_mutex_t     mutex;          ///< 排他用mutex(キュー)
+    const char*         name;           ///< 表示名
+    me6e_txq_type       type;           ///< 送信先の種別
+    int                 fd;             ///< 送信先のディスクリプタ
+    bool                vnet_hdr;       ///< 仮想NICヘッダの有効/無効(トンネルデバイスのみ)
+    me6e_bufpool_t*     pool;           ///< フレーム保持用のパケットバッファプール
+    me6e_txq_policy     policy;         ///< 満杯時の破棄ポリシー
+    int                 capacity;       ///< 保持できるフレーム数の上限
+    me6e_buf_t*         head[ME6E_TXQ_BAND_NUM];    ///< 優先度毎のキューの先頭
+    me6e_buf_t*         tail[ME6E_TXQ_BAND_NUM];    ///< 優先度毎のキューの末尾
+    me6e_buf_t*         inflight;       ///< 送信キュー処理スレッドが送信中のフレーム
+    volatile int        depth;          ///< 保持中のフレーム数(送信中を含む)
+    int                 depth_max;      ///< 保持中のフレーム数の最大値
+    int                 efd;            ///< 送信キュー処理スレッドの起床通知用eventfd
+    int                 epfd;           ///< 送信キュー処理スレッドの待ち合わせ用epoll
+    bool                armed;          ///< EPOLLOUTの待ち合わせ中かどうか
+    uint64_t            queue_count;    ///< キューに積んだフレーム数
+    uint64_t            drain_count;    ///< キューから送信したフレーム数
+    uint64_t            tail_drop;      ///< 満杯で破棄した新しいフレーム数
+    uint64_t            prio_drop;      ///< 高優先のフレームのために破棄したフレーム数
+    uint64_t            error_count;    ///< 送信エラー/複製失敗で破棄したフレーム数
+};
+typedef struct me6e_txq_t me6e_txq_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_txq_t* me6e_txq_create(const char* name, me6e_txq_type type, int fd, bool vnet_hdr,
+                me6e_bufpool_t* pool, int capacity, me6e_txq_policy policy);
+void me6e_txq_destroy(me6e_txq_t* txq);
+ssize_t me6e_txq_send(me6e_txq_t* txq, const struct msghdr* msg, bool high);
+int me6e_txq_drain(me6e_txq_t* txq);
+void me6e_txq_wait(me6e_txq_t* txq);
+bool me6e_txq_classify(const char* frame, size_t len);
+void me6e_txq_print(me6e_txq_t* txq, int fd);
+
+#endif // __ME6EAPP_TXQ_H__
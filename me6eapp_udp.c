@@ -0,0 +1,745 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_udp.c                                                 */
+/* 機能概要   : EtherIP over UDP送受信 ソースファイル                         */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/udp.h>
+#include <sys/epoll.h>
+#include <netinet/icmp6.h>
+#include <linux/errqueue.h>
+
+#include "me6eapp.h"
+#include "me6eapp_udp.h"
+#include "me6eapp_pmtu.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+#ifndef SOL_UDP
+#define SOL_UDP                 17
+#endif
+#ifndef UDP_SEGMENT
+//! 送信時のセグメント分割サイズ(Linux 4.18以降)
+#define UDP_SEGMENT             103
+#endif
+#ifndef UDP_GRO
+//! 受信時のセグメント結合(Linux 5.0以降)
+#define UDP_GRO                 104
+#endif
+#ifndef IPV6_FLOWINFO_SEND
+//! 送信先アドレスのフローラベルを送信パケットに設定(linux/in6.h)
+#define IPV6_FLOWINFO_SEND      33
+#endif
+
+//! 送信時の補助データ領域のサイズ
+#define UDP_SEND_CMSG_SIZE      (CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(uint16_t)))
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static int udp_open_send(void);
+static int udp_open_recv(const char* ifname, int port);
+static bool udp_peer_is_raw(me6e_udp_t* udp, const struct in6_addr* dst);
+static void udp_peer_set_raw(me6e_udp_t* udp, const struct in6_addr* dst);
+static void udp_peer_clear(me6e_udp_t* udp, const struct in6_addr* src);
+static void udp_recv_error(me6e_udp_t* udp, int fd);
+static int udp_sendmsg(me6e_udp_t* udp, int fd, const struct in6_addr* src, const struct in6_addr* dst,
+        uint32_t flowinfo, const struct iovec* iov, int iovcnt, uint16_t gso_size);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief EtherIP over UDP生成関数
+//!
+//! 送信ソケット(送信元ポートは自動割り当て)と、
+//! SO_REUSEPORTのグループに登録した受信ソケットを生成する。
+//! 送信ソケットはエラー監視用epollに登録する。
+//!
+//! @param [in] ifname      Backbone側物理デバイス名(受信ソケットのバインド先)
+//! @param [in] port        送信先/受信ポート番号
+//! @param [in] recv_num    受信ソケット数(1～ME6E_UDP_RECV_MAX)
+//! @param [in] stat_info   統計情報
+//! @param [in] pmtu        Path MTU管理テーブル(未使用時はNULL)
+//!
+//! @return 生成したEtherIP over UDP(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_udp_t* me6e_udp_create(const char* ifname, int port, int recv_num,
+        me6e_statistics_t* stat_info, struct me6e_pmtu_table_t* pmtu)
+{
+    // ローカル変数宣言
+    me6e_udp_t*         udp;
+    struct epoll_event  ev;
+    int                 size = 0;
+    int                 i;
+
+    // 引数チェック
+    if ((ifname == NULL) || (port <= 0) || (port > 65535) ||
+        (recv_num <= 0) || (recv_num > ME6E_UDP_RECV_MAX) || (stat_info == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_udp_create).");
+        return NULL;
+    }
+
+    udp = malloc(sizeof(me6e_udp_t));
+    if (udp == NULL) {
+        me6e_logging(LOG_ERR, "fail to allocate udp transport.");
+        return NULL;
+    }
+    memset(udp, 0, sizeof(me6e_udp_t));
+    pthread_mutex_init(&udp->mutex, NULL);
+    udp->port      = port;
+    udp->stat_info = stat_info;
+    udp->pmtu      = pmtu;
+    udp->err_epfd  = -1;
+    for (i = 0; i < ME6E_UDP_SEND_NUM; i++) {
+        udp->send_fd[i] = -1;
+    }
+    for (i = 0; i < ME6E_UDP_RECV_MAX; i++) {
+        udp->recv_fd[i] = -1;
+    }
+
+    udp->batch = malloc(ME6E_UDP_GSO_SIZE);
+    if (udp->batch == NULL) {
+        me6e_logging(LOG_ERR, "fail to allocate udp send buffer.");
+        goto error;
+    }
+
+    udp->err_epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (udp->err_epfd < 0) {
+        me6e_logging(LOG_ERR, "fail to create udp error epoll : %s.", strerror(errno));
+        goto error;
+    }
+
+    for (i = 0; i < ME6E_UDP_SEND_NUM; i++) {
+        udp->send_fd[i] = udp_open_send();
+        if (udp->send_fd[i] < 0) {
+            goto error;
+        }
+
+        // EPOLLERRは常に通知されるため、待ち合わせるイベントは指定しない
+        memset(&ev, 0, sizeof(ev));
+        ev.events  = 0;
+        ev.data.fd = udp->send_fd[i];
+        if (epoll_ctl(udp->err_epfd, EPOLL_CTL_ADD, udp->send_fd[i], &ev) != 0) {
+            me6e_logging(LOG_ERR, "fail to control udp error epoll : %s.", strerror(errno));
+            goto error;
+        }
+    }
+
+    // UDP_SEGMENTに対応していない場合はセグメント毎に送信する
+    udp->gso = (setsockopt(udp->send_fd[0], SOL_UDP, UDP_SEGMENT, &size, sizeof(size)) == 0);
+    if (!udp->gso) {
+        me6e_logging(LOG_WARNING, "UDP_SEGMENT is not supported. send udp without segmentation offload.");
+    }
+
+    for (i = 0; i < recv_num; i++) {
+        udp->recv_fd[i] = udp_open_recv(ifname, port);
+        if (udp->recv_fd[i] < 0) {
+            goto error;
+        }
+        udp->recv_num++;
+    }
+
+    me6e_logging(LOG_INFO, "udp transport port %d : %d receive sockets.", port, recv_num);
+
+    return udp;
+
+error:
+    me6e_udp_destroy(udp);
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief EtherIP over UDP解放関数
+//!
+//! @param [in] udp     EtherIP over UDP
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_udp_destroy(me6e_udp_t* udp)
+{
+    // ローカル変数宣言
+    int i;
+
+    if (udp == NULL) {
+        return;
+    }
+
+    for (i = 0; i < ME6E_UDP_SEND_NUM; i++) {
+        if (udp->send_fd[i] >= 0) {
+            close(udp->send_fd[i]);
+        }
+    }
+    for (i = 0; i < udp->recv_num; i++) {
+        close(udp->recv_fd[i]);
+    }
+    if (udp->err_epfd >= 0) {
+        close(udp->err_epfd);
+    }
+    pthread_mutex_destroy(&udp->mutex);
+    free(udp->batch);
+    free(udp);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief EtherIP over UDP送信エラー受信関数
+//!
+//! エラー監視用epollでエラーが通知されている送信ソケットの
+//! エラーキューを全て読み出す。(メインループから呼び出す)
+//!
+//! @param [in] udp     EtherIP over UDP
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_udp_recv_error(me6e_udp_t* udp)
+{
+    // ローカル変数宣言
+    struct epoll_event  ev[ME6E_UDP_SEND_NUM];
+    int                 num;
+    int                 i;
+
+    // 引数チェック
+    if (udp == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_udp_recv_error).");
+        return;
+    }
+
+    num = epoll_wait(udp->err_epfd, ev, ME6E_UDP_SEND_NUM, 0);
+    for (i = 0; i < num; i++) {
+        udp_recv_error(udp, ev[i].data.fd);
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief EtherIP over UDP送信関数
+//!
+//! EtherIPヘッダ以降のデータを送信待ちのセグメントに追加する。
+//! 送信先/送信元/送信ソケット/フローラベルが同じで、長さが揃っているセグメントは
+//! まとめて送信するため、条件が変わった時点でそれまでのセグメントを送信する。
+//! 送信先がUDP非対応の場合は送信しない。
+//!
+//! @param [in] udp         EtherIP over UDP
+//! @param [in] src         送信元IPv6アドレス
+//! @param [in] dst         送信先IPv6アドレス
+//! @param [in] flowinfo    フローラベル(ネットワークバイトオーダ)
+//! @param [in] hash        内側フローのハッシュ値(送信元ポートの選択に使用)
+//! @param [in] iov         送信データ(EtherIPヘッダ以降)
+//! @param [in] iovcnt      送信データの配列数
+//!
+//! @retval 0   送信した(または送信待ちに追加した)
+//! @retval -1  送信しなかった(呼び出し元でRAWソケットから送信すること)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_udp_send(me6e_udp_t* udp, const struct in6_addr* src, const struct in6_addr* dst,
+        uint32_t flowinfo, uint32_t hash, const struct iovec* iov, int iovcnt)
+{
+    // ローカル変数宣言
+    size_t  len = 0;
+    int     fd;
+    int     i;
+
+    // 引数チェック
+    if ((udp == NULL) || (src == NULL) || (dst == NULL) || (iov == NULL)) {
+        return -1;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+    fd = udp->send_fd[hash % ME6E_UDP_SEND_NUM];
+
+    // 送信待ちのセグメントに続けられない場合は先に送信する
+    if ((udp->batch_num > 0) &&
+        (udp->batch_closed || (udp->batch_fd != fd) || (len > udp->batch_seg) ||
+         (udp->batch_num >= ME6E_UDP_GSO_SEGS) || ((udp->batch_len + len) > ME6E_UDP_GSO_SIZE) ||
+         (udp->batch_flow != flowinfo) ||
+         !IN6_ARE_ADDR_EQUAL(&udp->batch_dst, dst) || !IN6_ARE_ADDR_EQUAL(&udp->batch_src, src))) {
+        me6e_udp_flush(udp);
+    }
+
+    if (udp->batch_num == 0) {
+        // UDP非対応の送信先(ポート到達不能を通知された送信先)
+        if ((udp->peer_num > 0) && udp_peer_is_raw(udp, dst)) {
+            return -1;
+        }
+
+        // まとめて送信できない場合はそのまま送信
+        if (!udp->gso || (len > ME6E_UDP_GSO_SIZE)) {
+            if (udp_sendmsg(udp, fd, src, dst, flowinfo, iov, iovcnt, 0) == 0) {
+                me6e_inc_capsuling_success_count(udp->stat_info);
+            }
+            else {
+                me6e_inc_capsuling_failure_count(udp->stat_info);
+            }
+            return 0;
+        }
+
+        udp->batch_fd     = fd;
+        udp->batch_src    = *src;
+        udp->batch_dst    = *dst;
+        udp->batch_flow   = flowinfo;
+        udp->batch_seg    = len;
+        udp->batch_closed = false;
+    }
+
+    // セグメントを追加(最後のセグメントのみ短くできる)
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(udp->batch + udp->batch_len, iov[i].iov_base, iov[i].iov_len);
+        udp->batch_len += iov[i].iov_len;
+    }
+    udp->batch_num++;
+    if (len < udp->batch_seg) {
+        udp->batch_closed = true;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief EtherIP over UDP送信待ちセグメント送信関数
+//!
+//! 送信待ちのセグメントをUDP_SEGMENTでまとめて送信する。
+//! まとめて送信できなかった場合はセグメント毎に送信し直す。
+//!
+//! @param [in] udp     EtherIP over UDP(NULLの場合は何もしない)
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_udp_flush(me6e_udp_t* udp)
+{
+    // ローカル変数宣言
+    struct iovec    iov;
+    size_t          offset;
+    int             i;
+
+    if ((udp == NULL) || (udp->batch_num == 0)) {
+        return;
+    }
+
+    iov.iov_base = udp->batch;
+    iov.iov_len  = udp->batch_len;
+
+    if (udp_sendmsg(udp, udp->batch_fd, &udp->batch_src, &udp->batch_dst, udp->batch_flow,
+                &iov, 1, (udp->batch_num > 1) ? udp->batch_seg : 0) == 0) {
+        for (i = 0; i < udp->batch_num; i++) {
+            me6e_inc_capsuling_success_count(udp->stat_info);
+        }
+    }
+    else if (udp->batch_num > 1) {
+        // セグメント毎に送信(Path MTU超過時はカーネルがフラグメントする)
+        DEBUG_LOG("fail to send udp gso(%d segments) : %s.\n", udp->batch_num, strerror(errno));
+        for (offset = 0; offset < udp->batch_len; offset += udp->batch_seg) {
+            iov.iov_base = udp->batch + offset;
+            iov.iov_len  = ((udp->batch_len - offset) < udp->batch_seg) ?
+                                (udp->batch_len - offset) : udp->batch_seg;
+            if (udp_sendmsg(udp, udp->batch_fd, &udp->batch_src, &udp->batch_dst, udp->batch_flow,
+                        &iov, 1, 0) == 0) {
+                me6e_inc_capsuling_success_count(udp->stat_info);
+            }
+            else {
+                me6e_inc_capsuling_failure_count(udp->stat_info);
+            }
+        }
+    }
+    else {
+        me6e_inc_capsuling_failure_count(udp->stat_info);
+    }
+
+    udp->batch_num = 0;
+    udp->batch_len = 0;
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief EtherIP over UDP受信関数
+//!
+//! 受信ソケットからUDP_GROで結合されたデータを受信し、
+//! 結合されたセグメント長を取得する。
+//! 受信した送信元はUDP対応として扱う(RAW送信を解除する)。
+//!
+//! @param [in]     udp         EtherIP over UDP
+//! @param [in]     fd          受信ソケット
+//! @param [in,out] msg         受信メッセージ(送信元アドレスとIPV6_PKTINFOを受信すること)
+//! @param [out]    seg_size    セグメント長(結合されていない場合は受信長)
+//!
+//! @return 受信長(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_udp_recv(me6e_udp_t* udp, int fd, struct msghdr* msg, int* seg_size)
+{
+    // ローカル変数宣言
+    struct cmsghdr*         cmsg;
+    struct sockaddr_in6*    src;
+    ssize_t                 len;
+
+    len = recvmsg(fd, msg, 0);
+    if (len < 0) {
+        return -1;
+    }
+
+    *seg_size = len;
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if ((cmsg->cmsg_level == SOL_UDP) && (cmsg->cmsg_type == UDP_GRO)) {
+            *seg_size = *(int*)CMSG_DATA(cmsg);
+            break;
+        }
+    }
+
+    if (udp->peer_num > 0) {
+        src = (struct sockaddr_in6*)msg->msg_name;
+        udp_peer_clear(udp, &src->sin6_addr);
+    }
+
+    return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信ソケット生成関数
+//!
+//! 送信元ポートを自動割り当てしたUDPソケットを生成する。
+//! ポート到達不能等のICMPエラーはエラーキューで受信する。
+//!
+//! @return 生成した送信ソケット(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+static int udp_open_send(void)
+{
+    // ローカル変数宣言
+    int                 fd;
+    int                 on = 1;
+    struct sockaddr_in6 addr;
+
+    fd = socket(AF_INET6, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create udp send socket : %s.", strerror(errno));
+        return -1;
+    }
+
+    if ((setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on)) < 0) ||
+        (setsockopt(fd, IPPROTO_IPV6, IPV6_RECVERR, &on, sizeof(on)) < 0) ||
+        (setsockopt(fd, IPPROTO_IPV6, IPV6_FLOWINFO_SEND, &on, sizeof(on)) < 0)) {
+        me6e_logging(LOG_ERR, "fail to set udp send socket option : %s.", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr   = in6addr_any;
+    addr.sin6_port   = 0;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        me6e_logging(LOG_ERR, "fail to bind udp send socket : %s.", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受信ソケット生成関数
+//!
+//! SO_REUSEPORTを設定したUDPソケットをBackbone側物理デバイスと
+//! 受信ポートにバインドし、送信先情報(IPV6_PKTINFO)とUDP_GROを有効にする。
+//!
+//! @param [in] ifname  Backbone側物理デバイス名
+//! @param [in] port    受信ポート番号
+//!
+//! @return 生成した受信ソケット(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+static int udp_open_recv(const char* ifname, int port)
+{
+    // ローカル変数宣言
+    int                 fd;
+    int                 on = 1;
+    struct sockaddr_in6 addr;
+
+    fd = socket(AF_INET6, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create udp receive socket : %s.", strerror(errno));
+        return -1;
+    }
+
+    if ((setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) ||
+        (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on)) < 0) ||
+        (setsockopt(fd, IPPROTO_IPV6, IPV6_RECVPKTINFO, &on, sizeof(on)) < 0)) {
+        me6e_logging(LOG_ERR, "fail to set udp receive socket option : %s.", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    if (setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, ifname, strlen(ifname) + 1) < 0) {
+        me6e_logging(LOG_ERR, "fail to bind udp receive socket to %s : %s.", ifname, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // 未対応のカーネルではセグメント毎に受信するため処理継続
+    if (setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) < 0) {
+        DEBUG_LOG("fail to set UDP_GRO : %s.\n", strerror(errno));
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr   = in6addr_any;
+    addr.sin6_port   = htons(port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        me6e_logging(LOG_ERR, "fail to bind udp receive socket port %d : %s.", port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief UDP送信関数
+//!
+//! 送信に失敗した場合はエラーキューのICMPエラーを処理し、1回だけ再送する。
+//! (エラーキューにエラーがある間はソケットのエラーで送信が失敗するため)
+//!
+//! @param [in] udp         EtherIP over UDP
+//! @param [in] fd          送信ソケット
+//! @param [in] src         送信元IPv6アドレス
+//! @param [in] dst         送信先IPv6アドレス
+//! @param [in] flowinfo    フローラベル(ネットワークバイトオーダ)
+//! @param [in] iov         送信データ
+//! @param [in] iovcnt      送信データの配列数
+//! @param [in] gso_size    セグメント長(0はまとめて送信しない)
+//!
+//! @retval 0   正常終了
+//! @retval -1  異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int udp_sendmsg(me6e_udp_t* udp, int fd, const struct in6_addr* src, const struct in6_addr* dst,
+        uint32_t flowinfo, const struct iovec* iov, int iovcnt, uint16_t gso_size)
+{
+    // ローカル変数宣言
+    struct sockaddr_in6 daddr;
+    struct msghdr       msg;
+    struct cmsghdr*     cmsg;
+    struct in6_pktinfo* info;
+    char                cmsgbuf[UDP_SEND_CMSG_SIZE];
+    int                 retry;
+
+    memset(&daddr, 0, sizeof(daddr));
+    daddr.sin6_family   = AF_INET6;
+    daddr.sin6_port     = htons(udp->port);
+    daddr.sin6_addr     = *dst;
+    daddr.sin6_flowinfo = flowinfo;
+
+    memset(cmsgbuf, 0, sizeof(cmsgbuf));
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name       = &daddr;
+    msg.msg_namelen    = sizeof(daddr);
+    msg.msg_iov        = (struct iovec*)iov;
+    msg.msg_iovlen     = iovcnt;
+    msg.msg_control    = cmsgbuf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(struct in6_pktinfo));
+
+    // 送信元情報(in6_pktinfo)
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(struct in6_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IPV6;
+    cmsg->cmsg_type  = IPV6_PKTINFO;
+    info = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+    info->ipi6_addr    = *src;
+    info->ipi6_ifindex = 0;
+
+    // セグメント長
+    if (gso_size > 0) {
+        msg.msg_controllen = UDP_SEND_CMSG_SIZE;
+        cmsg = CMSG_NXTHDR(&msg, cmsg);
+        cmsg->cmsg_len   = CMSG_LEN(sizeof(uint16_t));
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type  = UDP_SEGMENT;
+        *(uint16_t*)CMSG_DATA(cmsg) = gso_size;
+    }
+
+    for (retry = 0; retry < 2; retry++) {
+        if (sendmsg(fd, &msg, 0) >= 0) {
+            return 0;
+        }
+        if ((errno != ECONNREFUSED) && (errno != EHOSTUNREACH) && (errno != ENETUNREACH) &&
+            (errno != EMSGSIZE)) {
+            break;
+        }
+        // 通知されたICMPエラーで送信が失敗した場合
+        udp_recv_error(udp, fd);
+    }
+
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief UDP送信エラー受信関数
+//!
+//! 送信ソケットのエラーキューを全て読み出し、
+//! ポート到達不能が通知された送信先をUDP非対応として登録する。
+//! Packet Too Big(またはローカルのMTU超過)が通知された送信先は
+//! 通知されたMTUをPath MTU管理テーブルへ登録する。
+//!
+//! @param [in] udp     EtherIP over UDP
+//! @param [in] fd      送信ソケット
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void udp_recv_error(me6e_udp_t* udp, int fd)
+{
+    // ローカル変数宣言
+    struct msghdr               msg;
+    struct sockaddr_in6         addr;
+    char                        cmsgbuf[512];
+    char                        data[64];
+    struct iovec                iov;
+    struct cmsghdr*             cmsg;
+    struct sock_extended_err*   ee;
+
+    while (1) {
+        memset(&msg, 0, sizeof(msg));
+        iov.iov_base       = data;
+        iov.iov_len        = sizeof(data);
+        msg.msg_name       = &addr;
+        msg.msg_namelen    = sizeof(addr);
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = cmsgbuf;
+        msg.msg_controllen = sizeof(cmsgbuf);
+
+        if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            break;
+        }
+
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if ((cmsg->cmsg_level != IPPROTO_IPV6) || (cmsg->cmsg_type != IPV6_RECVERR)) {
+                continue;
+            }
+            ee = (struct sock_extended_err*)CMSG_DATA(cmsg);
+            if ((ee->ee_origin == SO_EE_ORIGIN_ICMP6) &&
+                (ee->ee_type == ICMP6_DST_UNREACH) && (ee->ee_code == ICMP6_DST_UNREACH_NOPORT)) {
+                // エラーキューの送信先アドレスは元パケットの送信先
+                udp_peer_set_raw(udp, &addr.sin6_addr);
+            }
+            else if ((ee->ee_errno == EMSGSIZE) && (udp->pmtu != NULL) &&
+                     ((ee->ee_origin == SO_EE_ORIGIN_ICMP6) || (ee->ee_origin == SO_EE_ORIGIN_LOCAL))) {
+                me6e_pmtu_update(udp->pmtu, &addr.sin6_addr, ee->ee_info);
+            }
+            else {
+                DEBUG_LOG("ignore udp send error : %s.\n", strerror(ee->ee_errno));
+            }
+        }
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief UDP非対応送信先判定関数
+//!
+//! @param [in] udp     EtherIP over UDP
+//! @param [in] dst     送信先IPv6アドレス
+//!
+//! @retval true  UDP非対応(RAWで送信する)
+//! @retval false UDPで送信する
+///////////////////////////////////////////////////////////////////////////////
+static bool udp_peer_is_raw(me6e_udp_t* udp, const struct in6_addr* dst)
+{
+    // ローカル変数宣言
+    struct timespec now;
+    bool            result = false;
+    int             i;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&udp->mutex);
+    for (i = 0; i < udp->peer_num; i++) {
+        if (!IN6_ARE_ADDR_EQUAL(&udp->peer[i].addr, dst)) {
+            continue;
+        }
+        if (udp->peer[i].expire > now.tv_sec) {
+            result = true;
+        }
+        else {
+            // 保持時間が経過した送信先はUDPで再試行する
+            udp->peer[i] = udp->peer[--udp->peer_num];
+        }
+        break;
+    }
+    pthread_mutex_unlock(&udp->mutex);
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief UDP非対応送信先登録関数
+//!
+//! @param [in] udp     EtherIP over UDP
+//! @param [in] dst     送信先IPv6アドレス
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void udp_peer_set_raw(me6e_udp_t* udp, const struct in6_addr* dst)
+{
+    // ローカル変数宣言
+    struct timespec now;
+    char            addr[INET6_ADDRSTRLEN];
+    int             i;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&udp->mutex);
+    for (i = 0; i < udp->peer_num; i++) {
+        if (IN6_ARE_ADDR_EQUAL(&udp->peer[i].addr, dst)) {
+            break;
+        }
+    }
+    if (i == udp->peer_num) {
+        if (udp->peer_num >= ME6E_UDP_PEER_MAX) {
+            pthread_mutex_unlock(&udp->mutex);
+            me6e_logging(LOG_WARNING, "udp peer table is full.");
+            return;
+        }
+        udp->peer[i].addr = *dst;
+        udp->peer_num++;
+        me6e_logging(LOG_INFO, "udp port unreachable from %s. send with raw EtherIP.",
+                inet_ntop(AF_INET6, dst, addr, sizeof(addr)));
+    }
+    udp->peer[i].expire = now.tv_sec + ME6E_UDP_RAW_EXPIRE;
+    pthread_mutex_unlock(&udp->mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief UDP非対応送信先解除関数
+//!
+//! @param [in] udp     EtherIP over UDP
+//! @param [in] src     UDPで受信した送信元IPv6アドレス
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void udp_peer_clear(me6e_udp_t* udp, const struct in6_addr* src)
+{
+    // ローカル変数宣言
+    int i;
+
+    pthread_mutex_lock(&udp->mutex);
+    for (i = 0; i < udp->peer_num; i++) {
+        if (IN6_ARE_ADDR_EQUAL(&udp->peer[i].addr, src)) {
+            udp->peer[i] = udp->peer[--udp->peer_num];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&udp->mutex);
+
+    return;
+}
@@ -0,0 +1,104 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_udp.h                                                 */
+/* 機能概要   : EtherIP over UDP送受信 ヘッダファイル                         */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_UDP_H__
+#define __ME6EAPP_UDP_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+#include "me6eapp_statistics.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! UDPカプセル化によるIPv6ペイロードの追加オーバーヘッド(UDPヘッダ)
+#define ME6E_UDP_OVERHEAD       8
+//! 受信ソケット(デカプセル化スレッド)の最大数
+#define ME6E_UDP_RECV_MAX       16
+//! 送信ソケット数(内側フローのハッシュで選択し、送信元ポートを分散する)
+#define ME6E_UDP_SEND_NUM       16
+//! 1回の送信でまとめるセグメントの最大数
+#define ME6E_UDP_GSO_SEGS       64
+//! 1回の送信でまとめるデータの最大長
+#define ME6E_UDP_GSO_SIZE       65000
+//! 送信先毎の転送方式を管理できる最大数
+#define ME6E_UDP_PEER_MAX       256
+//! 受信バッファのサイズ(UDP_GROで結合された最大長)
+#define ME6E_UDP_RECV_BUF_SIZE  65536
+//! ポート到達不能を通知された送信先へRAWで送信する時間(秒)
+#define ME6E_UDP_RAW_EXPIRE     300
+
+struct me6e_pmtu_table_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! UDP非対応の送信先
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_udp_peer_t
+{
+    struct in6_addr     addr;           ///< 送信先ME6Eアドレス
+    time_t              expire;         ///< RAW送信の満了時刻(単調増加時刻、0は未使用)
+};
+typedef struct me6e_udp_peer_t me6e_udp_peer_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! EtherIP over UDP
+//!
+//! EtherIPヘッダ以降をUDP/IPv6で送受信する。
+//! 送信は内側フローのハッシュで選択した送信ソケット(送信元ポート)から行い、
+//! 同じ送信先への同じ長さのセグメントはUDP_SEGMENTでまとめて送信する。
+//! (まとめたセグメントはme6e_udp_flushで送信する。送信は1つのスレッドからのみ行うこと)
+//! 受信はSO_REUSEPORTのグループに登録した受信ソケット毎のスレッドで行い、
+//! UDP_GROで結合されたセグメントをまとめて受信する。
+//! ポート到達不能が通知された送信先は、保持時間の間RAW(EtherIP)で送信する。
+//! 送信ソケットのエラーキューはerr_epfdで監視し、メインループで読み出す。
+//! Packet Too Bigで通知されたMTUはPath MTU管理テーブルへ登録する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_udp_t
+{
+    pthread_mutex_t     mutex;          ///< 排他用mutex(送信先毎の転送方式)
+    uint16_t            port;           ///< 送信先/受信ポート番号
+    bool                gso;            ///< UDP_SEGMENTの使用可否
+    int                 send_fd[ME6E_UDP_SEND_NUM];     ///< 送信ソケット
+    int                 recv_num;       ///< 受信ソケット数
+    int                 recv_fd[ME6E_UDP_RECV_MAX];     ///< 受信ソケット
+    int                 err_epfd;       ///< 送信ソケットのエラー監視用epoll
+    struct me6e_pmtu_table_t* pmtu;     ///< Path MTU管理テーブル(未使用時はNULL)
+    me6e_udp_peer_t     peer[ME6E_UDP_PEER_MAX];        ///< UDP非対応の送信先
+    volatile int        peer_num;       ///< UDP非対応の送信先数
+    uint8_t*            batch;          ///< まとめて送信するセグメントの格納領域
+    size_t              batch_len;      ///< まとめたデータ長
+    size_t              batch_seg;      ///< セグメント長(最後のセグメントのみ短くできる)
+    int                 batch_num;      ///< まとめたセグメント数
+    bool                batch_closed;   ///< 短いセグメントを追加済み(以降は追加不可)
+    int                 batch_fd;       ///< まとめたセグメントの送信ソケット
+    struct in6_addr     batch_src;      ///< まとめたセグメントの送信元アドレス
+    struct in6_addr     batch_dst;      ///< まとめたセグメントの送信先アドレス
+    uint32_t            batch_flow;     ///< まとめたセグメントのフローラベル
+    me6e_statistics_t*  stat_info;      ///< 統計情報
+};
+typedef struct me6e_udp_t me6e_udp_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_udp_t* me6e_udp_create(const char* ifname, int port, int recv_num,
+        me6e_statistics_t* stat_info, struct me6e_pmtu_table_t* pmtu);
+void me6e_udp_destroy(me6e_udp_t* udp);
+void me6e_udp_recv_error(me6e_udp_t* udp);
+int me6e_udp_send(me6e_udp_t* udp, const struct in6_addr* src, const struct in6_addr* dst,
+        uint32_t flowinfo, uint32_t hash, const struct iovec* iov, int iovcnt);
+void me6e_udp_flush(me6e_udp_t* udp);
+ssize_t me6e_udp_recv(me6e_udp_t* udp, int fd, struct msghdr* msg, int* seg_size);
+
+#endif // __ME6EAPP_UDP_H__
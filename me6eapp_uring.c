@@ -0,0 +1,839 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_uring.c                                               */
+/* 機能概要   : io_uring送受信 ソースファイル                                 */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "me6eapp_uring.h"
+#include "me6eapp_log.h"
+
+#if ME6E_URING_CQE_F_MORE != IORING_CQE_F_MORE
+#error "ME6E_URING_CQE_F_MORE mismatch"
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! マルチショット受信の提供バッファグループ番号
+#define URING_RECV_BGID     0
+//! 完了キューのエントリ数(投入キューに対する倍数)
+#define URING_CQ_FACTOR     4
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static inline int uring_setup(unsigned int entries, struct io_uring_params* params);
+static inline int uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags);
+static inline int uring_register(int fd, unsigned int opcode, void* arg, unsigned int nr_args);
+static inline struct io_uring_sqe* uring_get_sqe(me6e_uring_t* uring);
+static inline void uring_commit_sqe(me6e_uring_t* uring);
+static inline void uring_send_complete(me6e_uring_t* uring, uint64_t user_data, int res);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief io_uring生成関数
+//!
+//! io_uringを生成して投入キュー/完了キューをマッピングし、
+//! 送受信に使用するファイルを固定ファイルとして登録する。
+//! (fdsに-1を指定した番号は未使用となる)
+//!
+//! @param [in] fds         登録するファイルディスクリプタ
+//! @param [in] fd_num      登録するファイルディスクリプタ数
+//! @param [in] stat_info   統計情報
+//!
+//! @return 生成したio_uring(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_uring_t* me6e_uring_create(const int* fds, int fd_num, me6e_statistics_t* stat_info)
+{
+    // ローカル変数宣言
+    me6e_uring_t*           uring;
+    struct io_uring_params  params;
+    unsigned int            i;
+
+    // 引数チェック
+    if ((fds == NULL) || (fd_num <= 0) || (stat_info == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_uring_create).");
+        return NULL;
+    }
+
+    uring = malloc(sizeof(me6e_uring_t));
+    if (uring == NULL) {
+        me6e_logging(LOG_ERR, "fail to allocate io_uring.");
+        return NULL;
+    }
+    memset(uring, 0, sizeof(me6e_uring_t));
+    uring->sq_map    = MAP_FAILED;
+    uring->cq_map    = MAP_FAILED;
+    uring->sqes      = MAP_FAILED;
+    uring->read_buf  = MAP_FAILED;
+    uring->recv_ring = MAP_FAILED;
+    uring->recv_buf  = MAP_FAILED;
+    uring->send_buf  = MAP_FAILED;
+    uring->stat_info = stat_info;
+
+    // 生成(タスク実行の協調モードに対応していないカーネルでは指定しない)
+    memset(&params, 0, sizeof(params));
+    params.flags      = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = ME6E_URING_ENTRIES * URING_CQ_FACTOR;
+    uring->fd = uring_setup(ME6E_URING_ENTRIES, &params);
+    if ((uring->fd < 0) && (errno == EINVAL)) {
+        memset(&params, 0, sizeof(params));
+        params.flags      = IORING_SETUP_CQSIZE;
+        params.cq_entries = ME6E_URING_ENTRIES * URING_CQ_FACTOR;
+        uring->fd = uring_setup(ME6E_URING_ENTRIES, &params);
+    }
+    if (uring->fd < 0) {
+        me6e_logging(LOG_ERR, "fail to setup io_uring : %s.", strerror(errno));
+        goto error;
+    }
+
+    // 投入キュー/完了キューのマッピング
+    uring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    uring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (uring->cq_map_size > uring->sq_map_size) {
+            uring->sq_map_size = uring->cq_map_size;
+        }
+    }
+
+    uring->sq_map = mmap(NULL, uring->sq_map_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+    if (uring->sq_map == MAP_FAILED) {
+        me6e_logging(LOG_ERR, "fail to map io_uring sq : %s.", strerror(errno));
+        goto error;
+    }
+
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        uring->cq_map = mmap(NULL, uring->cq_map_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_CQ_RING);
+        if (uring->cq_map == MAP_FAILED) {
+            me6e_logging(LOG_ERR, "fail to map io_uring cq : %s.", strerror(errno));
+            goto error;
+        }
+    }
+
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED) {
+        me6e_logging(LOG_ERR, "fail to map io_uring sqes : %s.", strerror(errno));
+        goto error;
+    }
+
+    uring->sq_entries = params.sq_entries;
+    uring->sq_head    = (uint32_t*)((uint8_t*)uring->sq_map + params.sq_off.head);
+    uring->sq_tail    = (uint32_t*)((uint8_t*)uring->sq_map + params.sq_off.tail);
+    uring->sq_mask    = *(uint32_t*)((uint8_t*)uring->sq_map + params.sq_off.ring_mask);
+    uring->sq_array   = (uint32_t*)((uint8_t*)uring->sq_map + params.sq_off.array);
+    uring->sq_local_tail = *uring->sq_tail;
+
+    {
+        uint8_t* cq = (uring->cq_map != MAP_FAILED) ? uring->cq_map : uring->sq_map;
+        uring->cq_head = (uint32_t*)(cq + params.cq_off.head);
+        uring->cq_tail = (uint32_t*)(cq + params.cq_off.tail);
+        uring->cq_mask = *(uint32_t*)(cq + params.cq_off.ring_mask);
+        uring->cqes    = cq + params.cq_off.cqes;
+    }
+
+    // 投入エントリは投入キューと同じ順に使用する
+    for (i = 0; i < uring->sq_entries; i++) {
+        uring->sq_array[i] = i;
+    }
+
+    // 固定ファイルの登録
+    if (uring_register(uring->fd, IORING_REGISTER_FILES, (void*)fds, fd_num) < 0) {
+        me6e_logging(LOG_ERR, "fail to register io_uring files : %s.", strerror(errno));
+        goto error;
+    }
+
+    return uring;
+
+error:
+    me6e_uring_destroy(uring);
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief io_uring解放関数
+//!
+//! io_uringをクローズし(発行中の要求は取り消される)、
+//! 各バッファとマッピングを解放する。
+//!
+//! @param [in] uring   io_uring
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_uring_destroy(me6e_uring_t* uring)
+{
+    if (uring == NULL) {
+        return;
+    }
+
+    if (uring->fd >= 0) {
+        close(uring->fd);
+    }
+
+    if (uring->sqes != MAP_FAILED) {
+        munmap(uring->sqes, uring->sqes_size);
+    }
+    if (uring->cq_map != MAP_FAILED) {
+        munmap(uring->cq_map, uring->cq_map_size);
+    }
+    if (uring->sq_map != MAP_FAILED) {
+        munmap(uring->sq_map, uring->sq_map_size);
+    }
+    if (uring->read_buf != MAP_FAILED) {
+        munmap(uring->read_buf, (size_t)uring->read_num * uring->read_size);
+    }
+    if (uring->recv_ring != MAP_FAILED) {
+        munmap(uring->recv_ring, (size_t)uring->recv_num * sizeof(struct io_uring_buf));
+    }
+    if (uring->recv_buf != MAP_FAILED) {
+        munmap(uring->recv_buf, (size_t)uring->recv_num * uring->recv_size);
+    }
+    if (uring->send_buf != MAP_FAILED) {
+        munmap(uring->send_buf, (size_t)uring->send_num * uring->send_size);
+    }
+    free(uring->send);
+    free(uring->send_free);
+    free(uring);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 読み込み用バッファ登録関数
+//!
+//! 読み込み用バッファを確保し、固定バッファとして登録する。
+//!
+//! @param [in] uring   io_uring
+//! @param [in] num     バッファ数
+//! @param [in] size    バッファサイズ
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_uring_setup_read(me6e_uring_t* uring, int num, size_t size)
+{
+    // ローカル変数宣言
+    struct iovec    iov[num > 0 ? num : 1];
+    int             i;
+
+    // 引数チェック
+    if ((uring == NULL) || (num <= 0) || (size == 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_uring_setup_read).");
+        return -1;
+    }
+
+    uring->read_buf = mmap(NULL, (size_t)num * size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (uring->read_buf == MAP_FAILED) {
+        me6e_logging(LOG_ERR, "fail to allocate io_uring read buffer : %s.", strerror(errno));
+        return -1;
+    }
+    uring->read_num  = num;
+    uring->read_size = size;
+
+    for (i = 0; i < num; i++) {
+        iov[i].iov_base = uring->read_buf + (size_t)i * size;
+        iov[i].iov_len  = size;
+    }
+
+    if (uring_register(uring->fd, IORING_REGISTER_BUFFERS, iov, num) < 0) {
+        me6e_logging(LOG_ERR, "fail to register io_uring buffers : %s.", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief マルチショット受信用バッファ登録関数
+//!
+//! マルチショット受信用のバッファを確保し、提供バッファリングとして登録する。
+//! 受信毎にカーネルがバッファを選択し、処理後にme6e_uring_recv_recycleで返却する。
+//!
+//! @param [in] uring   io_uring
+//! @param [in] num     バッファ数(2のべき乗)
+//! @param [in] size    バッファサイズ
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_uring_setup_recv(me6e_uring_t* uring, int num, size_t size)
+{
+    // ローカル変数宣言
+    struct io_uring_buf_reg     reg;
+    struct io_uring_buf_ring*   br;
+    int                         i;
+
+    // 引数チェック
+    if ((uring == NULL) || (num <= 0) || ((num & (num - 1)) != 0) || (size == 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_uring_setup_recv).");
+        return -1;
+    }
+
+    uring->recv_ring = mmap(NULL, (size_t)num * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    uring->recv_buf  = mmap(NULL, (size_t)num * size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    uring->recv_num  = num;
+    uring->recv_size = size;
+    if ((uring->recv_ring == MAP_FAILED) || (uring->recv_buf == MAP_FAILED)) {
+        me6e_logging(LOG_ERR, "fail to allocate io_uring recv buffer : %s.", strerror(errno));
+        return -1;
+    }
+
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = (uint64_t)(unsigned long)uring->recv_ring;
+    reg.ring_entries = num;
+    reg.bgid         = URING_RECV_BGID;
+    if (uring_register(uring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        me6e_logging(LOG_ERR, "fail to register io_uring buffer ring : %s.", strerror(errno));
+        return -1;
+    }
+
+    br = (struct io_uring_buf_ring*)uring->recv_ring;
+    for (i = 0; i < num; i++) {
+        br->bufs[i].addr = (uint64_t)(unsigned long)(uring->recv_buf + (size_t)i * size);
+        br->bufs[i].len  = size;
+        br->bufs[i].bid  = i;
+    }
+    uring->recv_tail = num;
+    __atomic_store_n(&br->tail, uring->recv_tail, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信用バッファ確保関数
+//!
+//! 送信要求と送信データ格納領域を確保する。
+//!
+//! @param [in] uring   io_uring
+//! @param [in] num     送信要求数
+//! @param [in] size    送信データ格納領域のサイズ(1要求毎)
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_uring_setup_send(me6e_uring_t* uring, int num, size_t size)
+{
+    // ローカル変数宣言
+    int i;
+
+    // 引数チェック
+    if ((uring == NULL) || (num <= 0) || (size == 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_uring_setup_send).");
+        return -1;
+    }
+
+    uring->send      = calloc(num, sizeof(me6e_uring_send_t));
+    uring->send_free = calloc(num, sizeof(int));
+    uring->send_buf  = mmap(NULL, (size_t)num * size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    uring->send_num  = num;
+    uring->send_size = size;
+    if ((uring->send == NULL) || (uring->send_free == NULL) || (uring->send_buf == MAP_FAILED)) {
+        me6e_logging(LOG_ERR, "fail to allocate io_uring send buffer.");
+        return -1;
+    }
+
+    for (i = 0; i < num; i++) {
+        uring->send[i].data = uring->send_buf + (size_t)i * size;
+        uring->send_free[i] = num - 1 - i;
+    }
+    uring->send_free_num = num;
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 読み込み用バッファ取得関数
+//!
+//! @param [in] uring   io_uring
+//! @param [in] index   バッファ番号
+//!
+//! @return 読み込み用バッファ
+///////////////////////////////////////////////////////////////////////////////
+char* me6e_uring_read_buffer(me6e_uring_t* uring, int index)
+{
+    return (char*)uring->read_buf + (size_t)index * uring->read_size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 読み込み要求関数
+//!
+//! 固定ファイルから固定バッファへの読み込みを要求する(投入はme6e_uring_submit)。
+//!
+//! @param [in] uring       io_uring
+//! @param [in] file        固定ファイル番号
+//! @param [in] index       バッファ番号
+//! @param [in] user_data   完了通知の識別子
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了(投入キュー満杯)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_uring_read(me6e_uring_t* uring, int file, int index, uint64_t user_data)
+{
+    struct io_uring_sqe* sqe = uring_get_sqe(uring);
+
+    if (sqe == NULL) {
+        return -1;
+    }
+
+    sqe->opcode    = IORING_OP_READ_FIXED;
+    sqe->flags     = IOSQE_FIXED_FILE;
+    sqe->fd        = file;
+    sqe->off       = (uint64_t)-1;
+    sqe->addr      = (uint64_t)(unsigned long)me6e_uring_read_buffer(uring, index);
+    sqe->len       = uring->read_size;
+    sqe->buf_index = index;
+    sqe->user_data = user_data;
+    uring_commit_sqe(uring);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief マルチショット受信要求関数
+//!
+//! 固定ファイルからのマルチショット受信(recvmsg)を要求する。
+//! msgにはmsg_namelen/msg_controllenのみ設定し、受信中は保持すること。
+//! 完了通知にIORING_CQE_F_MOREが無い場合は受信が終了しているため再度要求すること。
+//!
+//! @param [in] uring       io_uring
+//! @param [in] file        固定ファイル番号
+//! @param [in] msg         受信メッセージのひな型
+//! @param [in] user_data   完了通知の識別子
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了(投入キュー満杯)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_uring_recvmsg(me6e_uring_t* uring, int file, struct msghdr* msg, uint64_t user_data)
+{
+    struct io_uring_sqe* sqe = uring_get_sqe(uring);
+
+    if (sqe == NULL) {
+        return -1;
+    }
+
+    sqe->opcode    = IORING_OP_RECVMSG;
+    sqe->flags     = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->fd        = file;
+    sqe->addr      = (uint64_t)(unsigned long)msg;
+    sqe->len       = 1;
+    sqe->buf_group = URING_RECV_BGID;
+    sqe->user_data = user_data;
+    uring_commit_sqe(uring);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief マルチショット監視要求関数
+//!
+//! 固定ファイルのイベント監視(マルチショット)を要求する。
+//!
+//! @param [in] uring       io_uring
+//! @param [in] file        固定ファイル番号
+//! @param [in] events      監視するイベント(POLLIN等)
+//! @param [in] user_data   完了通知の識別子
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了(投入キュー満杯)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_uring_poll(me6e_uring_t* uring, int file, uint32_t events, uint64_t user_data)
+{
+    struct io_uring_sqe* sqe = uring_get_sqe(uring);
+
+    if (sqe == NULL) {
+        return -1;
+    }
+
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->flags         = IOSQE_FIXED_FILE;
+    sqe->fd            = file;
+    sqe->len           = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = events;
+    sqe->user_data     = user_data;
+    uring_commit_sqe(uring);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief マルチショット受信結果取得関数
+//!
+//! マルチショット受信の完了通知から、受信したバッファ上の
+//! 送信元アドレス/補助データ/受信データを取得する。
+//!
+//! @param [in]     uring   io_uring
+//! @param [in]     flags   完了通知のフラグ
+//! @param [in]     res     完了通知の結果
+//! @param [in,out] msg     受信メッセージ(入力はme6e_uring_recvmsgに渡したひな型と同じ長さ)
+//! @param [out]    len     受信データ長
+//!
+//! @return 受信データの先頭(バッファ無し、または切り詰められた場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+char* me6e_uring_recvmsg_out(me6e_uring_t* uring, uint32_t flags, int res, struct msghdr* msg, ssize_t* len)
+{
+    // ローカル変数宣言
+    struct io_uring_recvmsg_out*    out;
+    uint8_t*                        buf;
+    size_t                          hdr_len;
+
+    if (!(flags & IORING_CQE_F_BUFFER) || (res < 0)) {
+        return NULL;
+    }
+
+    buf = uring->recv_buf + (size_t)(flags >> IORING_CQE_BUFFER_SHIFT) * uring->recv_size;
+    out = (struct io_uring_recvmsg_out*)buf;
+
+    hdr_len = sizeof(*out) + msg->msg_namelen + msg->msg_controllen;
+    if (((size_t)res < hdr_len) || (out->flags & MSG_TRUNC)) {
+        return NULL;
+    }
+
+    msg->msg_name       = buf + sizeof(*out);
+    msg->msg_control    = buf + sizeof(*out) + msg->msg_namelen;
+    if (out->namelen < msg->msg_namelen) {
+        msg->msg_namelen = out->namelen;
+    }
+    if (out->controllen < msg->msg_controllen) {
+        msg->msg_controllen = out->controllen;
+    }
+    msg->msg_flags      = out->flags;
+
+    *len = res - hdr_len;
+
+    return (char*)buf + hdr_len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief マルチショット受信バッファ返却関数
+//!
+//! 完了通知で使用されたバッファを提供バッファリングへ返却する。
+//!
+//! @param [in] uring   io_uring
+//! @param [in] flags   完了通知のフラグ
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_uring_recv_recycle(me6e_uring_t* uring, uint32_t flags)
+{
+    // ローカル変数宣言
+    struct io_uring_buf_ring*   br;
+    struct io_uring_buf*        buf;
+    uint16_t                    bid;
+
+    if (!(flags & IORING_CQE_F_BUFFER)) {
+        return;
+    }
+
+    bid = flags >> IORING_CQE_BUFFER_SHIFT;
+    br  = (struct io_uring_buf_ring*)uring->recv_ring;
+    buf = &br->bufs[uring->recv_tail & (uring->recv_num - 1)];
+    buf->addr = (uint64_t)(unsigned long)(uring->recv_buf + (size_t)bid * uring->recv_size);
+    buf->len  = uring->recv_size;
+    buf->bid  = bid;
+    uring->recv_tail++;
+    __atomic_store_n(&br->tail, uring->recv_tail, __ATOMIC_RELEASE);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信要求関数
+//!
+//! 送信メッセージ(送信先アドレス/補助データ/送信データ)を送信用バッファへ複製し、
+//! 固定ファイルへのsendmsgを要求する(投入はme6e_uring_submit)。
+//! 送信結果の統計は完了通知の処理時に計上する。
+//! 送信用バッファが無い、または送信データが大きい場合は、
+//! 要求済みの送信を投入してから異常終了する(呼び出し元で直接送信すること)。
+//!
+//! @param [in] uring   io_uring
+//! @param [in] file    固定ファイル番号
+//! @param [in] msg     送信メッセージ
+//!
+//! @retval 0以上 送信要求したデータ長
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_uring_sendmsg(me6e_uring_t* uring, int file, const struct msghdr* msg)
+{
+    // ローカル変数宣言
+    struct io_uring_sqe*    sqe;
+    me6e_uring_send_t*      send;
+    size_t                  len = 0;
+    uint8_t*                data;
+    int                     slot;
+    size_t                  i;
+
+    // 引数チェック
+    if ((uring == NULL) || (msg == NULL) || (uring->send == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    for (i = 0; i < msg->msg_iovlen; i++) {
+        len += msg->msg_iov[i].iov_len;
+    }
+
+    if ((uring->send_free_num == 0) || (len > uring->send_size) ||
+        (msg->msg_namelen > sizeof(send->name)) || (msg->msg_controllen > sizeof(send->control)) ||
+        ((sqe = uring_get_sqe(uring)) == NULL)) {
+        // 送信順序を保つため、要求済みの送信を先に投入する
+        me6e_uring_submit(uring, false);
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    slot = uring->send_free[--uring->send_free_num];
+    send = &uring->send[slot];
+
+    data = send->data;
+    for (i = 0; i < msg->msg_iovlen; i++) {
+        memcpy(data, msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+        data += msg->msg_iov[i].iov_len;
+    }
+    send->iov.iov_base = send->data;
+    send->iov.iov_len  = len;
+
+    memset(&send->msg, 0, sizeof(send->msg));
+    send->msg.msg_iov    = &send->iov;
+    send->msg.msg_iovlen = 1;
+    if (msg->msg_namelen > 0) {
+        memcpy(&send->name, msg->msg_name, msg->msg_namelen);
+        send->msg.msg_name    = &send->name;
+        send->msg.msg_namelen = msg->msg_namelen;
+    }
+    if (msg->msg_controllen > 0) {
+        memcpy(send->control, msg->msg_control, msg->msg_controllen);
+        send->msg.msg_control    = send->control;
+        send->msg.msg_controllen = msg->msg_controllen;
+    }
+
+    sqe->opcode    = IORING_OP_SENDMSG;
+    sqe->flags     = IOSQE_FIXED_FILE;
+    sqe->fd        = file;
+    sqe->addr      = (uint64_t)(unsigned long)&send->msg;
+    sqe->len       = 1;
+    sqe->user_data = ME6E_URING_UD_SEND | (uint64_t)slot;
+    uring_commit_sqe(uring);
+
+    return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 要求投入関数
+//!
+//! 未投入の要求をまとめて投入する。
+//! waitがtrueの場合は、完了通知が1つ以上届くまで待ち合わせる。
+//!
+//! @param [in] uring   io_uring
+//! @param [in] wait    完了通知を待ち合わせるかどうか
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_uring_submit(me6e_uring_t* uring, bool wait)
+{
+    // ローカル変数宣言
+    int ret;
+
+    if (!wait && (uring->sq_pending == 0)) {
+        return 0;
+    }
+
+    ret = uring_enter(uring->fd, uring->sq_pending, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0);
+    if (ret < 0) {
+        return -1;
+    }
+
+    if ((unsigned int)ret >= uring->sq_pending) {
+        uring->sq_pending = 0;
+    }
+    else {
+        uring->sq_pending -= ret;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 完了通知処理関数
+//!
+//! 完了キューに届いた完了通知を順に処理する。
+//! 送信の完了通知は送信用バッファを解放して統計を計上し、
+//! それ以外の完了通知はfuncを呼び出す。
+//!
+//! @param [in] uring   io_uring
+//! @param [in] func    完了通知処理関数
+//! @param [in] arg     funcに渡す引数
+//!
+//! @return 処理した完了通知数
+///////////////////////////////////////////////////////////////////////////////
+int me6e_uring_reap(me6e_uring_t* uring, me6e_uring_complete_func func, void* arg)
+{
+    // ローカル変数宣言
+    struct io_uring_cqe*    cqe;
+    uint32_t                head;
+    uint64_t                user_data;
+    int                     res;
+    uint32_t                flags;
+    int                     count = 0;
+
+    head = *uring->cq_head;
+    while (head != __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+        cqe = &((struct io_uring_cqe*)uring->cqes)[head & uring->cq_mask];
+        user_data = cqe->user_data;
+        res       = cqe->res;
+        flags     = cqe->flags;
+
+        // 完了キューの空きを先に返却する(処理中に要求を追加するため)
+        head++;
+        __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+
+        if ((user_data & ME6E_URING_UD_SEND) == ME6E_URING_UD_SEND) {
+            uring_send_complete(uring, user_data, res);
+        }
+        else {
+            func(arg, user_data, res, flags);
+        }
+        count++;
+    }
+
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief io_uring_setupシステムコール呼び出し関数
+//!
+//! @param [in]     entries 投入キューのエントリ数
+//! @param [in,out] params  パラメータ
+//!
+//! @return io_uringのファイルディスクリプタ(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+static inline int uring_setup(unsigned int entries, struct io_uring_params* params)
+{
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief io_uring_enterシステムコール呼び出し関数
+//!
+//! @param [in] fd              io_uringのファイルディスクリプタ
+//! @param [in] to_submit       投入する要求数
+//! @param [in] min_complete    待ち合わせる完了通知数
+//! @param [in] flags           フラグ
+//!
+//! @return 投入した要求数(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+static inline int uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief io_uring_registerシステムコール呼び出し関数
+//!
+//! @param [in] fd          io_uringのファイルディスクリプタ
+//! @param [in] opcode      登録種別
+//! @param [in] arg         登録内容
+//! @param [in] nr_args     登録数
+//!
+//! @return 0以上 正常終了(異常時は-1)
+///////////////////////////////////////////////////////////////////////////////
+static inline int uring_register(int fd, unsigned int opcode, void* arg, unsigned int nr_args)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 投入エントリ取得関数
+//!
+//! 投入キューの空きエントリを取得する。
+//! 空きが無い場合は未投入の要求を投入してから取得する。
+//!
+//! @param [in] uring   io_uring
+//!
+//! @return 投入エントリ(空きが無い場合はNULL)
+///////////////////////////////////////////////////////////////////////////////
+static inline struct io_uring_sqe* uring_get_sqe(me6e_uring_t* uring)
+{
+    // ローカル変数宣言
+    struct io_uring_sqe* sqe;
+
+    if ((uring->sq_local_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE)) >= uring->sq_entries) {
+        me6e_uring_submit(uring, false);
+        if ((uring->sq_local_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE)) >= uring->sq_entries) {
+            DEBUG_LOG("io_uring sq full.\n");
+            return NULL;
+        }
+    }
+
+    sqe = &((struct io_uring_sqe*)uring->sqes)[uring->sq_local_tail & uring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+
+    return sqe;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 投入エントリ確定関数
+//!
+//! uring_get_sqeで取得して設定した投入エントリを投入キューへ公開する。
+//!
+//! @param [in] uring   io_uring
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void uring_commit_sqe(me6e_uring_t* uring)
+{
+    uring->sq_local_tail++;
+    uring->sq_pending++;
+    __atomic_store_n(uring->sq_tail, uring->sq_local_tail, __ATOMIC_RELEASE);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信完了処理関数
+//!
+//! 送信用バッファを解放し、送信結果を統計に計上する。
+//!
+//! @param [in] uring       io_uring
+//! @param [in] user_data   完了通知の識別子
+//! @param [in] res         送信結果
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void uring_send_complete(me6e_uring_t* uring, uint64_t user_data, int res)
+{
+    int slot = (int)(user_data & 0xFFFFFFFF);
+
+    if ((slot < 0) || (slot >= uring->send_num)) {
+        return;
+    }
+    uring->send_free[uring->send_free_num++] = slot;
+
+    if (res < 0) {
+        me6e_inc_capsuling_failure_count(uring->stat_info);
+        me6e_logging(LOG_ERR, "fail to sendmsg capsuling packet. %s\n", strerror(-res));
+    }
+    else {
+        me6e_inc_capsuling_success_count(uring->stat_info);
+    }
+
+    return;
+}
@@ -0,0 +1,125 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_uring.h                                               */
+/* 機能概要   : io_uring送受信 ヘッダファイル                                 */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_URING_H__
+#define __ME6EAPP_URING_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "me6eapp_statistics.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 投入キューのエントリ数
+#define ME6E_URING_ENTRIES      512
+//! 同時に発行するトンネルデバイスの読み込み数
+#define ME6E_URING_READ_NUM     16
+//! マルチショット受信用の提供バッファ数(2のべき乗)
+#define ME6E_URING_RECV_NUM     128
+//! 送信用バッファ数
+#define ME6E_URING_SEND_NUM     1024
+//! 読み込み/受信用バッファのサイズ
+#define ME6E_URING_BUF_SIZE     (65535 + 512)
+//! 送信用バッファの最小サイズ
+#define ME6E_URING_SEND_SIZE    2048
+
+//! 完了通知のフラグ(マルチショット要求が継続中、IORING_CQE_F_MOREと同値)
+#define ME6E_URING_CQE_F_MORE   (1U << 1)
+
+//! 完了通知の識別子から要求種別を取り出すシフト数
+#define ME6E_URING_UD_SHIFT     56
+//! 完了通知の識別子(送信、モジュール内部で処理する)
+#define ME6E_URING_UD_SEND      (0xFFULL << ME6E_URING_UD_SHIFT)
+
+///////////////////////////////////////////////////////////////////////////////
+//! 送信要求(送信完了まで送信データを保持する)
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_uring_send_t
+{
+    struct msghdr       msg;            ///< 送信メッセージ
+    struct iovec        iov;            ///< 送信データ
+    struct sockaddr_in6 name;           ///< 送信先アドレス
+    char                control[64];    ///< 補助データ
+    uint8_t*            data;           ///< 送信データ格納領域
+};
+typedef struct me6e_uring_send_t me6e_uring_send_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! io_uring
+//!
+//! 投入キュー/完了キューはカーネルとの共有メモリをマッピングして操作し、
+//! io_uring_enterは待ち合わせ時のみ呼び出す(未投入の要求はその際にまとめて投入する)。
+//! 送受信するファイルは固定ファイルとして登録し、番号で指定する。
+//! 1つのスレッドからのみ使用すること。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_uring_t
+{
+    int                 fd;             ///< io_uringのファイルディスクリプタ
+    unsigned int        sq_entries;     ///< 投入キューのエントリ数
+    volatile uint32_t*  sq_head;        ///< 投入キューの先頭(カーネルが更新)
+    volatile uint32_t*  sq_tail;        ///< 投入キューの末尾
+    uint32_t            sq_mask;        ///< 投入キューのマスク
+    uint32_t*           sq_array;       ///< 投入キューのインデックス配列
+    void*               sqes;           ///< 投入エントリ配列
+    uint32_t            sq_local_tail;  ///< 投入キューの末尾(未公開分を含む)
+    unsigned int        sq_pending;     ///< 未投入の要求数
+    volatile uint32_t*  cq_head;        ///< 完了キューの先頭
+    volatile uint32_t*  cq_tail;        ///< 完了キューの末尾(カーネルが更新)
+    uint32_t            cq_mask;        ///< 完了キューのマスク
+    void*               cqes;           ///< 完了エントリ配列
+    void*               sq_map;         ///< 投入キューのマッピング
+    size_t              sq_map_size;    ///< 投入キューのマッピングサイズ
+    void*               cq_map;         ///< 完了キューのマッピング(投入キューと共用時はMAP_FAILED)
+    size_t              cq_map_size;    ///< 完了キューのマッピングサイズ
+    size_t              sqes_size;      ///< 投入エントリ配列のマッピングサイズ
+    uint8_t*            read_buf;       ///< 登録済み読み込み用バッファ
+    int                 read_num;       ///< 登録済み読み込み用バッファ数
+    size_t              read_size;      ///< 登録済み読み込み用バッファのサイズ
+    void*               recv_ring;      ///< マルチショット受信用の提供バッファリング
+    uint8_t*            recv_buf;       ///< マルチショット受信用の提供バッファ
+    int                 recv_num;       ///< マルチショット受信用の提供バッファ数
+    size_t              recv_size;      ///< マルチショット受信用の提供バッファのサイズ
+    uint16_t            recv_tail;      ///< 提供バッファリングの末尾
+    me6e_uring_send_t*  send;           ///< 送信要求
+    uint8_t*            send_buf;       ///< 送信データ格納領域
+    size_t              send_size;      ///< 送信データ格納領域のサイズ(1要求毎)
+    int*                send_free;      ///< 未使用の送信要求
+    int                 send_free_num;  ///< 未使用の送信要求数
+    int                 send_num;       ///< 送信要求数
+    me6e_statistics_t*  stat_info;      ///< 統計情報
+};
+typedef struct me6e_uring_t me6e_uring_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 完了通知処理関数(送信以外の完了通知毎に呼ばれる)
+///////////////////////////////////////////////////////////////////////////////
+typedef void (*me6e_uring_complete_func)(void* arg, uint64_t user_data, int res, uint32_t flags);
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+me6e_uring_t* me6e_uring_create(const int* fds, int fd_num, me6e_statistics_t* stat_info);
+void me6e_uring_destroy(me6e_uring_t* uring);
+int me6e_uring_setup_read(me6e_uring_t* uring, int num, size_t size);
+int me6e_uring_setup_recv(me6e_uring_t* uring, int num, size_t size);
+int me6e_uring_setup_send(me6e_uring_t* uring, int num, size_t size);
+char* me6e_uring_read_buffer(me6e_uring_t* uring, int index);
+int me6e_uring_read(me6e_uring_t* uring, int file, int index, uint64_t user_data);
+int me6e_uring_recvmsg(me6e_uring_t* uring, int file, struct msghdr* msg, uint64_t user_data);
+int me6e_uring_poll(me6e_uring_t* uring, int file, uint32_t events, uint64_t user_data);
+char* me6e_uring_recvmsg_out(me6e_uring_t* uring, uint32_t flags, int res, struct msghdr* msg, ssize_t* len);
+void me6e_uring_recv_recycle(me6e_uring_t* uring, uint32_t flags);
+ssize_t me6e_uring_sendmsg(me6e_uring_t* uring, int file, const struct msghdr* msg);
+int me6e_uring_submit(me6e_uring_t* uring, bool wait);
+int me6e_uring_reap(me6e_uring_t* uring, me6e_uring_complete_func func, void* arg);
+
+#endif // __ME6EAPP_URING_H__
@@ -18,7 +18,9 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
+#include <netinet/ip.h>
 #include <netinet/ip6.h>
+#include <net/ethernet.h>
 
 #include "me6eapp_util.h"
 #include "me6eapp_log.h"
@@ -31,6 +33,12 @@
 #define _D_(x)
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+//! フローハッシュ計算用 FNV-1a パラメータ
+///////////////////////////////////////////////////////////////////////////////
+#define FLOW_HASH_FNV_OFFSET    2166136261U
+#define FLOW_HASH_FNV_PRIME     16777619U
+
 ///////////////////////////////////////////////////////////////////////////////
 //! IPv6疑似ヘッダ
 ///////////////////////////////////////////////////////////////////////////////
@@ -175,3 +183,119 @@ unsigned short me6e_util_pseudo_checksumv(
     return me6e_util_checksumv(cksum, vec_size);
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フローハッシュ計算(データ追加)関数
+//!
+//! FNV-1aでハッシュ値にデータを追加する。
+//!
+//! @param [in]  hash  計算途中のハッシュ値
+//! @param [in]  data  追加するデータ
+//! @param [in]  len   追加するデータ長
+//!
+//! @return 計算したハッシュ値
+///////////////////////////////////////////////////////////////////////////////
+static inline uint32_t flow_hash_add(uint32_t hash, const void* data, size_t len)
+{
+    const uint8_t* p = data;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= FLOW_HASH_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief フローハッシュ計算関数
+//!
+//! Ethernetフレームからフローを識別するハッシュ値を計算する。
+//! IPv4/IPv6の場合は送信元/送信先アドレスとプロトコル番号、
+//! TCP/UDP/SCTPの場合は更にポート番号を対象とする。
+//! (フラグメントパケットはポート番号を対象外とする)
+//! IP以外の場合は送信元/送信先MACアドレスとイーサタイプを対象とする。
+//! VLANタグは読み飛ばす。
+//!
+//! @param [in]  frame Ethernetフレームの先頭アドレス
+//! @param [in]  len   Ethernetフレーム長
+//!
+//! @return 計算したハッシュ値
+///////////////////////////////////////////////////////////////////////////////
+uint32_t me6e_util_flow_hash(const char* frame, ssize_t len)
+{
+    const struct ether_header* eth;
+    const uint8_t*  l3;
+    const uint8_t*  l4 = NULL;
+    ssize_t         l3_len;
+    uint16_t        type;
+    uint8_t         proto;
+    uint32_t        hash = FLOW_HASH_FNV_OFFSET;
+
+    // 引数チェック
+    if ((frame == NULL) || (len < (ssize_t)sizeof(struct ether_header))) {
+        return hash;
+    }
+
+    eth    = (const struct ether_header*)frame;
+    type   = ntohs(eth->ether_type);
+    l3     = (const uint8_t*)frame + sizeof(struct ether_header);
+    l3_len = len - sizeof(struct ether_header);
+
+    // VLANタグの読み飛ばし
+    while (((type == ETHERTYPE_VLAN) || (type == 0x88A8)) && (l3_len >= 4)) {
+        type    = (l3[2] << 8) | l3[3];
+        l3     += 4;
+        l3_len -= 4;
+    }
+
+    if ((type == ETHERTYPE_IP) && (l3_len >= (ssize_t)sizeof(struct ip))) {
+        const struct ip* ip = (const struct ip*)l3;
+        int hlen = ip->ip_hl * 4;
+
+        proto = ip->ip_p;
+        hash = flow_hash_add(hash, &ip->ip_src, sizeof(ip->ip_src));
+        hash = flow_hash_add(hash, &ip->ip_dst, sizeof(ip->ip_dst));
+        hash = flow_hash_add(hash, &proto, sizeof(proto));
+
+        // 先頭フラグメント以外はポート番号が無く、
+        // 先頭フラグメントもフローを揃えるためポート番号を対象外とする
+        if (((ntohs(ip->ip_off) & (IP_MF | IP_OFFMASK)) == 0) && (l3_len >= hlen + 4)) {
+            l4 = l3 + hlen;
+        }
+    }
+    else if ((type == ETHERTYPE_IPV6) && (l3_len >= (ssize_t)sizeof(struct ip6_hdr))) {
+        const struct ip6_hdr* ip6 = (const struct ip6_hdr*)l3;
+        uint32_t flow = ip6->ip6_flow & htonl(0x000FFFFF);
+
+        proto = ip6->ip6_nxt;
+        hash = flow_hash_add(hash, &ip6->ip6_src, sizeof(ip6->ip6_src));
+        hash = flow_hash_add(hash, &ip6->ip6_dst, sizeof(ip6->ip6_dst));
+        if (flow != 0) {
+            // 内側でフローラベルが設定されていれば、それを識別子として使用
+            hash = flow_hash_add(hash, &flow, sizeof(flow));
+        }
+        else {
+            hash = flow_hash_add(hash, &proto, sizeof(proto));
+            // 拡張ヘッダ付きの場合はポート番号を対象外とする
+            if (l3_len >= (ssize_t)sizeof(struct ip6_hdr) + 4) {
+                l4 = l3 + sizeof(struct ip6_hdr);
+            }
+        }
+    }
+    else {
+        hash = flow_hash_add(hash, eth->ether_dhost, ETH_ALEN);
+        hash = flow_hash_add(hash, eth->ether_shost, ETH_ALEN);
+        hash = flow_hash_add(hash, &type, sizeof(type));
+        return hash;
+    }
+
+    // L4ポート番号
+    if ((l4 != NULL) &&
+        ((proto == IPPROTO_TCP) || (proto == IPPROTO_UDP) || (proto == IPPROTO_SCTP))) {
+        hash = flow_hash_add(hash, l4, 4);
+    }
+
+    return hash;
+}
@@ -10,6 +10,8 @@
 #define __ME6EAPP_UTIL_H__
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
 #include <sys/uio.h>
 #include <netinet/in.h>
 
@@ -21,6 +23,7 @@ unsigned short me6e_util_checksum(unsigned short *buf, int size);
 unsigned short me6e_util_checksumv(struct iovec vec[], int vec_size);
 unsigned short me6e_util_pseudo_checksumv(
             const int family, const struct iovec* vec, const int vec_size);
+uint32_t me6e_util_flow_hash(const char* frame, ssize_t len);
 
 ///////////////////////////////////////////////////////////////////////////////
 //! @brief MACブロードキャストチェック関数
@@ -0,0 +1,807 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_vnet.c                                                */
+/* 機能概要   : 仮想NICヘッダ(GSO/チェックサムオフロード)処理 ソースファイル  */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip6.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <linux/if_ether.h>
+
+#include "me6eapp.h"
+#include "me6eapp_vnet.h"
+#include "me6eapp_log.h"
+#include "me6eapp_util.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! TCPヘッダ内のフラグ位置
+#define VNET_TCP_FLAGS_OFFSET   13
+//! TCP CWRフラグ
+#define VNET_TCP_FLAG_CWR       0x80
+//! TCP PSHフラグ
+#define VNET_TCP_FLAG_PSH       0x08
+//! TCP ACKフラグ
+#define VNET_TCP_FLAG_ACK       0x10
+//! TCPヘッダ内のチェックサム位置
+#define VNET_TCP_CSUM_OFFSET    16
+
+///////////////////////////////////////////////////////////////////////////////
+//! GRO対象セグメントの解析結果
+///////////////////////////////////////////////////////////////////////////////
+struct vnet_gro_info
+{
+    uint16_t    type;           ///< EtherType(ホストバイトオーダー)
+    int         l3_off;         ///< L3ヘッダのオフセット
+    int         l4_off;         ///< TCPヘッダのオフセット
+    int         hdr_len;        ///< TCPヘッダまでのヘッダ長
+    int         payload_len;    ///< TCPペイロード長
+    uint32_t    seq;            ///< シーケンス番号
+    uint8_t     flags;          ///< TCPフラグ
+    uint32_t    pseudo;         ///< 擬似ヘッダ(アドレス、プロトコル)の部分和
+};
+typedef struct vnet_gro_info vnet_gro_info;
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static inline uint32_t vnet_csum_add(uint32_t sum, const void* data, size_t len);
+static inline uint16_t vnet_csum_fold(uint32_t sum);
+static inline int vnet_l3_offset(const char* frame, ssize_t len, uint16_t* type);
+static inline bool vnet_gro_parse(const char* frame, ssize_t len, vnet_gro_info* info);
+static inline bool vnet_gro_match(const me6e_vnet_gro_t* gro, const char* frame, const vnet_gro_info* info);
+static inline ssize_t vnet_write_frame(int fd, char* frame, ssize_t len);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 部分チェックサム補完関数
+//!
+//! 仮想NICヘッダでチェックサム計算が要求されている(NEEDS_CSUM)場合、
+//! csum_startからフレーム末尾までのチェックサムを計算し、
+//! csum_start + csum_offsetの位置に格納する。
+//! 格納位置には擬似ヘッダ分の部分チェックサムがカーネルにより設定済みである。
+//!
+//! @param [in]     vnet    仮想NICヘッダ
+//! @param [in,out] frame   Ethernetフレーム
+//! @param [in]     len     Ethernetフレーム長
+//!
+//! @retval true  正常終了(補完不要の場合を含む)
+//! @retval false 異常終了
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_vnet_complete_csum(const struct virtio_net_hdr* vnet, char* frame, ssize_t len)
+{
+    // ローカル変数宣言
+    uint16_t csum;
+
+    // 引数チェック
+    if ((vnet == NULL) || (frame == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_vnet_complete_csum).");
+        return false;
+    }
+
+    if (!(vnet->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM)) {
+        return true;
+    }
+
+    if ((vnet->csum_start + vnet->csum_offset + sizeof(csum)) > (size_t)len) {
+        DEBUG_LOG("invalid csum_start(%d) csum_offset(%d).\n", vnet->csum_start, vnet->csum_offset);
+        return false;
+    }
+
+    csum = me6e_util_checksum((unsigned short*)(frame + vnet->csum_start), len - vnet->csum_start);
+    // UDPのチェックサム0は「チェックサム無し」を意味するので0xffffとする
+    if ((csum == 0) && (vnet->csum_offset == offsetof(struct udphdr, check))) {
+        csum = 0xffff;
+    }
+    memcpy(frame + vnet->csum_start + vnet->csum_offset, &csum, sizeof(csum));
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GSOフレーム分割関数
+//!
+//! TCPのGSOフレーム(最大64KB)をgso_size毎のセグメントに分割し、
+//! セグメント毎にoutputを呼び出す。
+//! 各セグメントはseg_bufferにヘッダを複製して組み立て、
+//! IPv4の場合はトータル長、ID、ヘッダチェックサムを、
+//! IPv6の場合はペイロード長を書き換え、
+//! TCPシーケンス番号とフラグ(FIN/PSHは最終セグメントのみ、CWRは先頭のみ)を調整する。
+//! TCPチェックサムは擬似ヘッダの固定部分を一度だけ計算し、
+//! セグメント毎にTCP部分のみを加算して算出する。
+//!
+//! @param [in]     vnet        仮想NICヘッダ
+//! @param [in]     frame       GSOフレーム
+//! @param [in]     len         GSOフレーム長
+//! @param [out]    seg_buffer  セグメント組み立て用バッファ
+//! @param [in]     output      セグメント出力関数
+//! @param [in]     arg         セグメント出力関数に渡す引数
+//!
+//! @retval 0以上 出力したセグメント数
+//! @retval -1    異常終了(未対応のGSO種別を含む)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_vnet_segment(const struct virtio_net_hdr* vnet, char* frame, ssize_t len,
+        char* seg_buffer, me6e_vnet_output_func output, void* arg)
+{
+    // ローカル変数宣言
+    uint8_t         gso_type;
+    uint16_t        type;
+    int             l3_off;
+    int             l4_off;
+    int             hdr_len;
+    int             mss;
+    ssize_t         payload_len;
+    ssize_t         offset;
+    uint32_t        seq;
+    uint16_t        ip_id = 0;
+    uint32_t        pseudo;
+    struct tcphdr*  tcp;
+    int             count;
+
+    // 引数チェック
+    if ((vnet == NULL) || (frame == NULL) || (seg_buffer == NULL) || (output == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_vnet_segment).");
+        return -1;
+    }
+
+    gso_type = vnet->gso_type & ~VIRTIO_NET_HDR_GSO_ECN;
+    mss      = vnet->gso_size;
+    if (((gso_type != VIRTIO_NET_HDR_GSO_TCPV4) && (gso_type != VIRTIO_NET_HDR_GSO_TCPV6)) || (mss == 0)) {
+        DEBUG_LOG("unsupported gso type(%d) size(%d).\n", vnet->gso_type, mss);
+        return -1;
+    }
+
+    l3_off = vnet_l3_offset(frame, len, &type);
+    if (l3_off < 0) {
+        return -1;
+    }
+
+    // L4ヘッダ位置の取得と擬似ヘッダ(アドレス、プロトコル)の部分チェックサム計算
+    if ((gso_type == VIRTIO_NET_HDR_GSO_TCPV4) && (type == ETH_P_IP)) {
+        struct ip* ip = (struct ip*)(frame + l3_off);
+        if ((len < l3_off + (ssize_t)sizeof(struct ip)) || (ip->ip_p != IPPROTO_TCP)) {
+            return -1;
+        }
+        l4_off = l3_off + ip->ip_hl * 4;
+        ip_id  = ntohs(ip->ip_id);
+        pseudo = vnet_csum_add(0, &ip->ip_src, sizeof(ip->ip_src) * 2);
+    }
+    else if ((gso_type == VIRTIO_NET_HDR_GSO_TCPV6) && (type == ETH_P_IPV6)) {
+        struct ip6_hdr* ip6 = (struct ip6_hdr*)(frame + l3_off);
+        if (len < l3_off + (ssize_t)sizeof(struct ip6_hdr)) {
+            return -1;
+        }
+        if (vnet->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) {
+            // 拡張ヘッダ付きの場合もcsum_startがTCPヘッダ位置を示す
+            l4_off = vnet->csum_start;
+        }
+        else if (ip6->ip6_nxt == IPPROTO_TCP) {
+            l4_off = l3_off + sizeof(struct ip6_hdr);
+        }
+        else {
+            return -1;
+        }
+        pseudo = vnet_csum_add(0, &ip6->ip6_src, sizeof(ip6->ip6_src) * 2);
+    }
+    else {
+        return -1;
+    }
+    pseudo += htons(IPPROTO_TCP);
+
+    if (len < l4_off + (ssize_t)sizeof(struct tcphdr)) {
+        return -1;
+    }
+    tcp     = (struct tcphdr*)(frame + l4_off);
+    hdr_len = l4_off + tcp->doff * 4;
+    if (hdr_len >= len) {
+        return -1;
+    }
+    seq         = ntohl(tcp->seq);
+    payload_len = len - hdr_len;
+
+    count = 0;
+    for (offset = 0; offset < payload_len; offset += mss) {
+        ssize_t         seg_payload = ((payload_len - offset) < mss) ? (payload_len - offset) : mss;
+        ssize_t         seg_len     = hdr_len + seg_payload;
+        struct tcphdr*  seg_tcp     = (struct tcphdr*)(seg_buffer + l4_off);
+        uint32_t        sum;
+
+        memcpy(seg_buffer, frame, hdr_len);
+        memcpy(seg_buffer + hdr_len, frame + hdr_len + offset, seg_payload);
+
+        // IPヘッダの書き換え
+        if (type == ETH_P_IP) {
+            struct ip* ip = (struct ip*)(seg_buffer + l3_off);
+            ip->ip_len = htons(seg_len - l3_off);
+            ip->ip_id  = htons(ip_id + count);
+            ip->ip_sum = 0;
+            ip->ip_sum = me6e_util_checksum((unsigned short*)ip, ip->ip_hl * 4);
+        }
+        else {
+            struct ip6_hdr* ip6 = (struct ip6_hdr*)(seg_buffer + l3_off);
+            ip6->ip6_plen = htons(seg_len - l3_off - sizeof(struct ip6_hdr));
+        }
+
+        // TCPヘッダの書き換え
+        seg_tcp->seq = htonl(seq + offset);
+        if (count > 0) {
+            ((uint8_t*)seg_tcp)[VNET_TCP_FLAGS_OFFSET] &= ~VNET_TCP_FLAG_CWR;
+        }
+        if (offset + seg_payload < payload_len) {
+            seg_tcp->fin = 0;
+            seg_tcp->psh = 0;
+        }
+
+        // TCPチェックサムの計算
+        seg_tcp->check = 0;
+        sum = pseudo + htons(seg_len - l4_off);
+        sum = vnet_csum_add(sum, seg_tcp, seg_len - l4_off);
+        seg_tcp->check = ~vnet_csum_fold(sum);
+
+        output(arg, seg_buffer, seg_len);
+        count++;
+    }
+
+    DEBUG_LOG("segment %d bytes gso frame to %d segments(mss %d).\n", len, count, mss);
+
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GSO情報生成関数
+//!
+//! 仮想NICヘッダを伴わずに受信したMTU超過のTCPフレーム
+//! (物理デバイスのGRO/LROで結合されたフレーム)を
+//! me6e_vnet_segmentでMTU以下に分割するための仮想NICヘッダを生成する。
+//! gso_sizeはIPヘッダとTCPヘッダ(オプションを含む)を除いた長さとする。
+//!
+//! @param [in]     frame   Ethernetフレーム
+//! @param [in]     len     Ethernetフレーム長
+//! @param [in]     mtu     分割後のIPパケット最大長
+//! @param [out]    vnet    生成した仮想NICヘッダ
+//!
+//! @retval true  生成成功(TCPフレーム)
+//! @retval false 分割対象外
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_vnet_build_gso(const char* frame, ssize_t len, int mtu, struct virtio_net_hdr* vnet)
+{
+    // ローカル変数宣言
+    uint16_t                type;
+    int                     l3_off;
+    int                     l4_off;
+    const struct tcphdr*    tcp;
+
+    // 引数チェック
+    if ((frame == NULL) || (vnet == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_vnet_build_gso).");
+        return false;
+    }
+
+    l3_off = vnet_l3_offset(frame, len, &type);
+    if (l3_off < 0) {
+        return false;
+    }
+
+    memset(vnet, 0, sizeof(*vnet));
+    if (type == ETH_P_IP) {
+        const struct ip* ip = (const struct ip*)(frame + l3_off);
+        if ((len < l3_off + (ssize_t)sizeof(struct ip)) || (ip->ip_p != IPPROTO_TCP) ||
+            (ntohs(ip->ip_off) & (IP_MF | IP_OFFMASK))) {
+            return false;
+        }
+        l4_off = l3_off + ip->ip_hl * 4;
+        vnet->gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+    }
+    else if (type == ETH_P_IPV6) {
+        const struct ip6_hdr* ip6 = (const struct ip6_hdr*)(frame + l3_off);
+        if ((len < l3_off + (ssize_t)sizeof(struct ip6_hdr)) || (ip6->ip6_nxt != IPPROTO_TCP)) {
+            return false;
+        }
+        l4_off = l3_off + sizeof(struct ip6_hdr);
+        vnet->gso_type = VIRTIO_NET_HDR_GSO_TCPV6;
+    }
+    else {
+        return false;
+    }
+
+    if (len < l4_off + (ssize_t)sizeof(struct tcphdr)) {
+        return false;
+    }
+    tcp = (const struct tcphdr*)(frame + l4_off);
+
+    vnet->hdr_len = l4_off + tcp->doff * 4;
+    if ((mtu <= (vnet->hdr_len - l3_off)) || (vnet->hdr_len >= len)) {
+        return false;
+    }
+    vnet->gso_size = mtu - (vnet->hdr_len - l3_off);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief トンネルデバイス送信関数
+//!
+//! トンネルデバイスへフレームを送信する。
+//! 仮想NICヘッダ有効時は、オフロード無しの仮想NICヘッダを先頭に付加する。
+//!
+//! @param [in] fd          トンネルデバイスファイルディスクリプタ
+//! @param [in] vnet_hdr    仮想NICヘッダの有効/無効
+//! @param [in] iov         送信データ
+//! @param [in] iovcnt      送信データの要素数
+//!
+//! @retval 0以上 送信したフレーム長(仮想NICヘッダを含まない)
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_vnet_writev(int fd, bool vnet_hdr, const struct iovec* iov, int iovcnt)
+{
+    // ローカル変数宣言
+    struct virtio_net_hdr   vnet;
+    struct iovec            vec[iovcnt + 1];
+    ssize_t                 ret;
+
+    if (!vnet_hdr) {
+        return writev(fd, iov, iovcnt);
+    }
+
+    memset(&vnet, 0, sizeof(vnet));
+    vnet.gso_type = VIRTIO_NET_HDR_GSO_NONE;
+
+    vec[0].iov_base = &vnet;
+    vec[0].iov_len  = sizeof(vnet);
+    memcpy(&vec[1], iov, sizeof(struct iovec) * iovcnt);
+
+    ret = writev(fd, vec, iovcnt + 1);
+    if (ret >= (ssize_t)sizeof(vnet)) {
+        ret -= sizeof(vnet);
+    }
+
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GRO管理生成関数
+//!
+//! @param [in] fd  トンネルデバイスファイルディスクリプタ(仮想NICヘッダ有効)
+//!
+//! @return 生成したGRO管理へのポインタ
+///////////////////////////////////////////////////////////////////////////////
+me6e_vnet_gro_t* me6e_vnet_gro_create(int fd)
+{
+    me6e_vnet_gro_t* gro;
+
+    // 引数チェック
+    if (fd < 0) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_vnet_gro_create).");
+        return NULL;
+    }
+
+    gro = malloc(sizeof(me6e_vnet_gro_t));
+    if (gro == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for gro.");
+        return NULL;
+    }
+    memset(gro, 0, sizeof(me6e_vnet_gro_t));
+
+    gro->buffer = malloc(ME6E_VNET_GRO_BUF_SIZE);
+    if (gro->buffer == NULL) {
+        me6e_logging(LOG_ERR, "fail to malloc for gro buffer.");
+        free(gro);
+        return NULL;
+    }
+    gro->fd = fd;
+
+    return gro;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GRO管理解放関数
+//!
+//! @param [in] gro GRO管理
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_vnet_gro_destroy(me6e_vnet_gro_t* gro)
+{
+    if (gro == NULL) {
+        return;
+    }
+
+    free(gro->buffer);
+    free(gro);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GRO送信関数
+//!
+//! トンネルデバイスへフレームを送信する。
+//! 保持中のフレームと同一フローで連続するTCPセグメントであれば結合し、
+//! 結合できないフレームの場合は保持中のフレームを送信した後に、
+//! 新たに結合の起点として保持するか、そのまま送信する。
+//! PSHフラグ付き、またはペイロードが先頭より短いセグメントを結合した場合は、
+//! それ以上結合できないため即時に送信する。
+//!
+//! @param [in]     gro     GRO管理
+//! @param [in]     frame   送信するEthernetフレーム
+//! @param [in]     len     送信するEthernetフレーム長
+//!
+//! @retval 0以上 受け付けたフレーム長
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_vnet_gro_write(me6e_vnet_gro_t* gro, char* frame, ssize_t len)
+{
+    vnet_gro_info info;
+
+    // 引数チェック
+    if ((gro == NULL) || (frame == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_vnet_gro_write).");
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (!vnet_gro_parse(frame, len, &info)) {
+        // 結合対象外
+        if (!me6e_vnet_gro_flush(gro)) {
+            return -1;
+        }
+        return vnet_write_frame(gro->fd, frame, len);
+    }
+
+    if (gro->len > 0) {
+        if (vnet_gro_match(gro, frame, &info)) {
+            // ペイロードを末尾に結合
+            memcpy(gro->buffer + gro->len, frame + info.hdr_len, info.payload_len);
+            gro->len      += info.payload_len;
+            gro->next_seq += info.payload_len;
+            gro->count++;
+
+            if ((info.flags & VNET_TCP_FLAG_PSH) || (info.payload_len < gro->mss)) {
+                gro->buffer[gro->l4_off + VNET_TCP_FLAGS_OFFSET] |= (info.flags & VNET_TCP_FLAG_PSH);
+                if (!me6e_vnet_gro_flush(gro)) {
+                    return -1;
+                }
+            }
+            return len;
+        }
+
+        if (!me6e_vnet_gro_flush(gro)) {
+            return -1;
+        }
+    }
+
+    if (info.flags & VNET_TCP_FLAG_PSH) {
+        // 後続の結合が無いのでそのまま送信
+        return vnet_write_frame(gro->fd, frame, len);
+    }
+
+    // 結合の起点として保持
+    memcpy(gro->buffer, frame, len);
+    gro->len      = len;
+    gro->type     = info.type;
+    gro->l3_off   = info.l3_off;
+    gro->l4_off   = info.l4_off;
+    gro->hdr_len  = info.hdr_len;
+    gro->mss      = info.payload_len;
+    gro->count    = 1;
+    gro->next_seq = info.seq + info.payload_len;
+    gro->pseudo   = info.pseudo;
+
+    return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GRO保持フレーム送信関数
+//!
+//! 保持中のフレームをトンネルデバイスへ送信する。
+//! 複数セグメントを結合している場合は、IPヘッダの長さとチェックサムを更新し、
+//! TCPチェックサムに擬似ヘッダの部分和を設定して、
+//! 仮想NICヘッダにGSO種別とチェックサム計算要求を設定して送信する。
+//!
+//! @param [in] gro GRO管理
+//!
+//! @retval true  正常終了
+//! @retval false 異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+bool me6e_vnet_gro_flush(me6e_vnet_gro_t* gro)
+{
+    struct virtio_net_hdr   vnet;
+    struct iovec            iov[2];
+    struct tcphdr*          tcp;
+    ssize_t                 len;
+
+    // 引数チェック
+    if (gro == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_vnet_gro_flush).");
+        return false;
+    }
+
+    if (gro->len == 0) {
+        return true;
+    }
+
+    len      = gro->len;
+    gro->len = 0;
+
+    if (gro->count == 1) {
+        return (vnet_write_frame(gro->fd, gro->buffer, len) >= 0);
+    }
+
+    memset(&vnet, 0, sizeof(vnet));
+    vnet.flags       = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+    vnet.hdr_len     = gro->hdr_len;
+    vnet.gso_size    = gro->mss;
+    vnet.csum_start  = gro->l4_off;
+    vnet.csum_offset = VNET_TCP_CSUM_OFFSET;
+
+    if (gro->type == ETH_P_IP) {
+        struct ip* ip = (struct ip*)(gro->buffer + gro->l3_off);
+        ip->ip_len = htons(len - gro->l3_off);
+        ip->ip_sum = 0;
+        ip->ip_sum = me6e_util_checksum((unsigned short*)ip, ip->ip_hl * 4);
+        vnet.gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+    }
+    else {
+        struct ip6_hdr* ip6 = (struct ip6_hdr*)(gro->buffer + gro->l3_off);
+        ip6->ip6_plen = htons(len - gro->l3_off - sizeof(struct ip6_hdr));
+        vnet.gso_type = VIRTIO_NET_HDR_GSO_TCPV6;
+    }
+
+    // チェックサム計算要求時は擬似ヘッダの部分和を格納する
+    tcp = (struct tcphdr*)(gro->buffer + gro->l4_off);
+    tcp->check = vnet_csum_fold(gro->pseudo + htons(len - gro->l4_off));
+
+    iov[0].iov_base = &vnet;
+    iov[0].iov_len  = sizeof(vnet);
+    iov[1].iov_base = gro->buffer;
+    iov[1].iov_len  = len;
+
+    if (writev(gro->fd, iov, 2) < 0) {
+        return false;
+    }
+
+    DEBUG_LOG("coalesce %d segments to %d bytes gso frame(mss %d).\n", gro->count, len, gro->mss);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief チェックサム加算関数
+//!
+//! 16bit単位の1の補数和にデータを加算する(桁上げは畳み込まない)。
+//!
+//! @param [in] sum     計算途中の和
+//! @param [in] data    加算するデータ
+//! @param [in] len     加算するデータ長
+//!
+//! @return 計算した和
+///////////////////////////////////////////////////////////////////////////////
+static inline uint32_t vnet_csum_add(uint32_t sum, const void* data, size_t len)
+{
+    const uint16_t* p = data;
+
+    while (len > 1) {
+        sum += *p++;
+        len -= 2;
+    }
+    if (len) {
+        sum += *(const uint8_t*)p;
+    }
+
+    return sum;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief チェックサム畳み込み関数
+//!
+//! @param [in] sum     1の補数和
+//!
+//! @return 16bitに畳み込んだ値
+///////////////////////////////////////////////////////////////////////////////
+static inline uint16_t vnet_csum_fold(uint32_t sum)
+{
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+
+    return sum;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief L3ヘッダ位置取得関数
+//!
+//! VLANタグを読み飛ばし、L3ヘッダの位置とEtherTypeを取得する。
+//!
+//! @param [in]  frame  Ethernetフレーム
+//! @param [in]  len    Ethernetフレーム長
+//! @param [out] type   EtherType(ホストバイトオーダー)
+//!
+//! @retval 0以上 L3ヘッダのオフセット
+//! @retval -1    異常終了
+///////////////////////////////////////////////////////////////////////////////
+static inline int vnet_l3_offset(const char* frame, ssize_t len, uint16_t* type)
+{
+    const uint8_t*  p = (const uint8_t*)frame;
+    int             off;
+
+    if (len < ETH_HLEN) {
+        return -1;
+    }
+
+    *type = (p[12] << 8) | p[13];
+    off   = ETH_HLEN;
+    while ((*type == ETH_P_8021Q) || (*type == ETH_P_8021AD)) {
+        if (len < off + 4) {
+            return -1;
+        }
+        *type = (p[off + 2] << 8) | p[off + 3];
+        off  += 4;
+    }
+
+    return off;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GRO対象セグメント解析関数
+//!
+//! フレームがGRO対象のTCPセグメントかどうかを判定する。
+//! 対象はオプション無しIPv4(フラグメント除く)、または拡張ヘッダ無しIPv6上の
+//! ACK(PSH可)のみのペイロード付きTCPセグメントで、
+//! TCPチェックサムが正しいものとする。
+//!
+//! @param [in]  frame  Ethernetフレーム
+//! @param [in]  len    Ethernetフレーム長
+//! @param [out] info   解析結果
+//!
+//! @retval true  GRO対象
+//! @retval false GRO対象外
+///////////////////////////////////////////////////////////////////////////////
+static inline bool vnet_gro_parse(const char* frame, ssize_t len, vnet_gro_info* info)
+{
+    const struct tcphdr* tcp;
+    uint32_t             sum;
+
+    info->l3_off = vnet_l3_offset(frame, len, &info->type);
+    if (info->l3_off < 0) {
+        return false;
+    }
+
+    if ((info->type == ETH_P_IP) && (len >= info->l3_off + (ssize_t)sizeof(struct ip))) {
+        const struct ip* ip = (const struct ip*)(frame + info->l3_off);
+        if ((ip->ip_hl != 5) || (ip->ip_p != IPPROTO_TCP) ||
+            (ntohs(ip->ip_off) & (IP_MF | IP_OFFMASK)) ||
+            (info->l3_off + ntohs(ip->ip_len) != len)) {
+            return false;
+        }
+        info->l4_off = info->l3_off + sizeof(struct ip);
+        info->pseudo = vnet_csum_add(0, &ip->ip_src, sizeof(ip->ip_src) * 2);
+    }
+    else if ((info->type == ETH_P_IPV6) && (len >= info->l3_off + (ssize_t)sizeof(struct ip6_hdr))) {
+        const struct ip6_hdr* ip6 = (const struct ip6_hdr*)(frame + info->l3_off);
+        if ((ip6->ip6_nxt != IPPROTO_TCP) ||
+            (info->l3_off + (ssize_t)sizeof(struct ip6_hdr) + ntohs(ip6->ip6_plen) != len)) {
+            return false;
+        }
+        info->l4_off = info->l3_off + sizeof(struct ip6_hdr);
+        info->pseudo = vnet_csum_add(0, &ip6->ip6_src, sizeof(ip6->ip6_src) * 2);
+    }
+    else {
+        return false;
+    }
+    info->pseudo += htons(IPPROTO_TCP);
+
+    if (len < info->l4_off + (ssize_t)sizeof(struct tcphdr)) {
+        return false;
+    }
+    tcp               = (const struct tcphdr*)(frame + info->l4_off);
+    info->hdr_len     = info->l4_off + tcp->doff * 4;
+    info->payload_len = len - info->hdr_len;
+    info->seq         = ntohl(tcp->seq);
+    info->flags       = ((const uint8_t*)tcp)[VNET_TCP_FLAGS_OFFSET];
+    if ((info->payload_len <= 0) || ((info->flags & ~VNET_TCP_FLAG_PSH) != VNET_TCP_FLAG_ACK)) {
+        return false;
+    }
+
+    // 結合後はカーネルでチェックサムを再計算するため、結合前に検証する
+    sum = info->pseudo + htons(len - info->l4_off);
+    sum = vnet_csum_add(sum, tcp, len - info->l4_off);
+    if (vnet_csum_fold(sum) != 0xffff) {
+        DEBUG_LOG("gro skip invalid tcp checksum.\n");
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief GRO結合可否判定関数
+//!
+//! 保持中のフレームの末尾に結合できるかどうかを判定する。
+//! L2ヘッダ、IPヘッダ(長さ、ID、チェックサムを除く)、
+//! TCPヘッダ(シーケンス番号、チェックサム、PSHフラグを除く)が一致し、
+//! シーケンス番号が連続している場合に結合できる。
+//!
+//! @param [in] gro     GRO管理
+//! @param [in] frame   Ethernetフレーム
+//! @param [in] info    解析結果
+//!
+//! @retval true  結合可
+//! @retval false 結合不可
+///////////////////////////////////////////////////////////////////////////////
+static inline bool vnet_gro_match(const me6e_vnet_gro_t* gro, const char* frame, const vnet_gro_info* info)
+{
+    const char* held = gro->buffer;
+    const char* l3   = frame + info->l3_off;
+    const char* hl3  = held + gro->l3_off;
+    const char* l4   = frame + info->l4_off;
+    const char* hl4  = held + gro->l4_off;
+
+    if ((info->type != gro->type) || (info->l3_off != gro->l3_off) ||
+        (info->hdr_len != gro->hdr_len) || (info->seq != gro->next_seq) ||
+        (info->payload_len > gro->mss) ||
+        (gro->len + info->payload_len - gro->l3_off > ME6E_VNET_GRO_MAX)) {
+        return false;
+    }
+
+    // L2ヘッダ
+    if (memcmp(frame, held, info->l3_off) != 0) {
+        return false;
+    }
+
+    // IPヘッダ
+    if (info->type == ETH_P_IP) {
+        // バージョン～TOS、フラグ～プロトコル、アドレス
+        if ((memcmp(l3, hl3, 2) != 0) || (memcmp(l3 + 6, hl3 + 6, 4) != 0) ||
+            (memcmp(l3 + 12, hl3 + 12, 8) != 0)) {
+            return false;
+        }
+    }
+    else {
+        // バージョン～フローラベル、次ヘッダ～アドレス
+        if ((memcmp(l3, hl3, 4) != 0) || (memcmp(l3 + 6, hl3 + 6, 34) != 0)) {
+            return false;
+        }
+    }
+
+    // TCPヘッダ(ポート、ACK番号、ヘッダ長、ウィンドウ、緊急ポインタ、オプション)
+    if ((memcmp(l4, hl4, 4) != 0) || (memcmp(l4 + 8, hl4 + 8, 5) != 0) ||
+        (memcmp(l4 + 14, hl4 + 14, 2) != 0) ||
+        (memcmp(l4 + 18, hl4 + 18, info->hdr_len - info->l4_off - 18) != 0)) {
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 単一フレーム送信関数
+//!
+//! オフロード無しの仮想NICヘッダを付加してフレームを送信する。
+//!
+//! @param [in] fd      トンネルデバイスファイルディスクリプタ
+//! @param [in] frame   Ethernetフレーム
+//! @param [in] len     Ethernetフレーム長
+//!
+//! @retval 0以上 送信したフレーム長
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+static inline ssize_t vnet_write_frame(int fd, char* frame, ssize_t len)
+{
+    struct iovec iov;
+
+    iov.iov_base = frame;
+    iov.iov_len  = len;
+
+    return me6e_vnet_writev(fd, true, &iov, 1);
+}
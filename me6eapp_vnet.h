@@ -0,0 +1,71 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_vnet.h                                                */
+/* 機能概要   : 仮想NICヘッダ(GSO/チェックサムオフロード)処理 ヘッダファイル  */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_VNET_H__
+#define __ME6EAPP_VNET_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <linux/virtio_net.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! トンネルデバイスの送受信フレームに付加される仮想NICヘッダ長
+#define ME6E_VNET_HDR_LEN   sizeof(struct virtio_net_hdr)
+//! 結合フレームのIPパケット最大長
+#define ME6E_VNET_GRO_MAX   65535
+//! 結合バッファのサイズ(IPパケット最大長 + L2ヘッダ)
+#define ME6E_VNET_GRO_BUF_SIZE  (ME6E_VNET_GRO_MAX + 64)
+
+///////////////////////////////////////////////////////////////////////////////
+//! セグメント出力関数
+//!
+//! GSOフレームを分割したセグメント毎に呼ばれる。
+///////////////////////////////////////////////////////////////////////////////
+typedef void (*me6e_vnet_output_func)(void* arg, char* frame, ssize_t len);
+
+///////////////////////////////////////////////////////////////////////////////
+//! GRO(受信セグメント結合)管理
+//!
+//! トンネルデバイスへ送信するTCPセグメントのうち、
+//! 同一フローで連続するものを1つのGSOフレームに結合して保持する。
+//! 結合できないフレームの送信時、またはバースト受信の終了時に
+//! 保持しているフレームを送信する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_vnet_gro_t
+{
+    int         fd;             ///< トンネルデバイスファイルディスクリプタ
+    char*       buffer;         ///< 結合バッファ
+    ssize_t     len;            ///< 結合中のフレーム長(0は保持なし)
+    uint16_t    type;           ///< EtherType(ホストバイトオーダー)
+    int         l3_off;         ///< L3ヘッダのオフセット
+    int         l4_off;         ///< TCPヘッダのオフセット
+    int         hdr_len;        ///< TCPヘッダまでのヘッダ長
+    int         mss;            ///< 先頭セグメントのペイロード長
+    int         count;          ///< 結合したセグメント数
+    uint32_t    next_seq;       ///< 次に結合できるシーケンス番号
+    uint32_t    pseudo;         ///< 擬似ヘッダ(アドレス、プロトコル)の部分和
+};
+typedef struct me6e_vnet_gro_t me6e_vnet_gro_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+bool me6e_vnet_complete_csum(const struct virtio_net_hdr* vnet, char* frame, ssize_t len);
+int me6e_vnet_segment(const struct virtio_net_hdr* vnet, char* frame, ssize_t len,
+        char* seg_buffer, me6e_vnet_output_func output, void* arg);
+bool me6e_vnet_build_gso(const char* frame, ssize_t len, int mtu, struct virtio_net_hdr* vnet);
+ssize_t me6e_vnet_writev(int fd, bool vnet_hdr, const struct iovec* iov, int iovcnt);
+me6e_vnet_gro_t* me6e_vnet_gro_create(int fd);
+void me6e_vnet_gro_destroy(me6e_vnet_gro_t* gro);
+ssize_t me6e_vnet_gro_write(me6e_vnet_gro_t* gro, char* frame, ssize_t len);
+bool me6e_vnet_gro_flush(me6e_vnet_gro_t* gro);
+
+#endif // __ME6EAPP_VNET_H__
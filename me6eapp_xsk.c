@@ -0,0 +1,722 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_xsk.c                                                 */
+/* 機能概要   : AF_XDPソケット ソースファイル                                 */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+
+#include "me6eapp_xsk.h"
+#include "me6eapp_log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+#ifndef AF_XDP
+//! AF_XDPのアドレスファミリ(glibc 2.27未満向け)
+#define AF_XDP  44
+#endif
+#ifndef SOL_XDP
+//! AF_XDPのソケットオプションレベル(glibc 2.27未満向け)
+#define SOL_XDP 283
+#endif
+
+//! XDPプログラムの最大命令数
+#define XSK_PROG_INSN_MAX   8
+//! 受信キュー一覧のディレクトリ
+#define XSK_QUEUE_DIR       "/sys/class/net/%s/queues"
+
+////////////////////////////////////////////////////////////////////////////////
+// 内部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+static inline long xsk_bpf(int cmd, union bpf_attr* attr);
+static inline void xsk_insn(struct bpf_insn* prog, int* cnt, uint8_t code,
+        uint8_t dst, uint8_t src, int16_t off, int32_t imm);
+static int xsk_ring_map(int fd, me6e_xsk_ring_t* ring, const struct xdp_ring_offset* off,
+        size_t desc_size, off_t pgoff);
+static void xsk_ring_unmap(me6e_xsk_ring_t* ring);
+static inline void xsk_tx_reclaim(me6e_xsk_t* xsk);
+static inline void xsk_tx_kick(me6e_xsk_t* xsk);
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 受信キュー数取得関数
+//!
+//! デバイスの受信キュー数を取得する。
+//!
+//! @param [in] ifname  デバイス名
+//!
+//! @return 受信キュー数(1～ME6E_XSK_QUEUE_MAX)
+///////////////////////////////////////////////////////////////////////////////
+int me6e_xsk_queue_num(const char* ifname)
+{
+    // ローカル変数宣言
+    char            path[128];
+    DIR*            dir;
+    struct dirent*  ent;
+    int             num = 0;
+
+    // 引数チェック
+    if (ifname == NULL) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_xsk_queue_num).");
+        return 1;
+    }
+
+    snprintf(path, sizeof(path), XSK_QUEUE_DIR, ifname);
+    dir = opendir(path);
+    if (dir == NULL) {
+        return 1;
+    }
+    while ((ent = readdir(dir)) != NULL) {
+        if (strncmp(ent->d_name, "rx-", 3) == 0) {
+            num++;
+        }
+    }
+    closedir(dir);
+
+    if (num < 1) {
+        num = 1;
+    }
+    if (num > ME6E_XSK_QUEUE_MAX) {
+        me6e_logging(LOG_WARNING, "%s has %d rx queues. use first %d queues.",
+                ifname, num, ME6E_XSK_QUEUE_MAX);
+        num = ME6E_XSK_QUEUE_MAX;
+    }
+
+    return num;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief XDPプログラムアタッチ関数
+//!
+//! 受信キュー番号をキーとするXSKMAPと、受信フレームをXSKMAPの
+//! AF_XDPソケットへリダイレクトする(ソケット未登録のキューは
+//! カーネルへ渡す)XDPプログラムを生成し、デバイスへアタッチする。
+//! ネイティブモードでアタッチできない場合は汎用(SKB)モードでアタッチする。
+//! アタッチはbpf_linkで行うため、プロセス終了時に自動的にデタッチされる。
+//!
+//! @param [in]  ifindex    デバイスのインデックス
+//! @param [in]  queue_num  受信キュー数
+//! @param [out] prog       XDPプログラム
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_xsk_prog_attach(int ifindex, int queue_num, me6e_xsk_prog_t* prog)
+{
+    // ローカル変数宣言
+    union bpf_attr  attr;
+    struct bpf_insn insn[XSK_PROG_INSN_MAX];
+    int             cnt = 0;
+
+    // 引数チェック
+    if ((ifindex <= 0) || (queue_num <= 0) || (prog == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_xsk_prog_attach).");
+        return -1;
+    }
+
+    prog->map_fd   = -1;
+    prog->prog_fd  = -1;
+    prog->link_fd  = -1;
+    prog->skb_mode = false;
+
+    // XSKMAPの生成
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type    = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size    = sizeof(uint32_t);
+    attr.value_size  = sizeof(uint32_t);
+    attr.max_entries = queue_num;
+    prog->map_fd = xsk_bpf(BPF_MAP_CREATE, &attr);
+    if (prog->map_fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create xsk map : %s.", strerror(errno));
+        goto error;
+    }
+
+    // r2 = ctx->rx_queue_index
+    xsk_insn(insn, &cnt, BPF_LDX | BPF_W | BPF_MEM, BPF_REG_2, BPF_REG_1,
+            offsetof(struct xdp_md, rx_queue_index), 0);
+    // r1 = xsk map
+    xsk_insn(insn, &cnt, BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, prog->map_fd);
+    xsk_insn(insn, &cnt, 0, 0, 0, 0, 0);
+    // r3 = XDP_PASS (ソケット未登録時の動作)
+    xsk_insn(insn, &cnt, BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS);
+    // return bpf_redirect_map(r1, r2, r3)
+    xsk_insn(insn, &cnt, BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map);
+    xsk_insn(insn, &cnt, BPF_JMP | BPF_EXIT, 0, 0, 0, 0);
+
+    memset(&attr, 0, sizeof(attr));
+    attr.prog_type            = BPF_PROG_TYPE_XDP;
+    attr.expected_attach_type = BPF_XDP;
+    attr.insns                = (uint64_t)(unsigned long)insn;
+    attr.insn_cnt             = cnt;
+    attr.license              = (uint64_t)(unsigned long)"GPL";
+    prog->prog_fd = xsk_bpf(BPF_PROG_LOAD, &attr);
+    if (prog->prog_fd < 0) {
+        me6e_logging(LOG_ERR, "fail to load xdp program : %s.", strerror(errno));
+        goto error;
+    }
+
+    // ネイティブモードでアタッチ(未対応ドライバの場合は汎用モード)
+    memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd        = prog->prog_fd;
+    attr.link_create.target_ifindex = ifindex;
+    attr.link_create.attach_type    = BPF_XDP;
+    attr.link_create.flags          = XDP_FLAGS_DRV_MODE;
+    prog->link_fd = xsk_bpf(BPF_LINK_CREATE, &attr);
+    if (prog->link_fd < 0) {
+        me6e_logging(LOG_INFO, "fail to attach xdp program in native mode : %s. retry generic mode.", strerror(errno));
+        attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+        prog->link_fd  = xsk_bpf(BPF_LINK_CREATE, &attr);
+        prog->skb_mode = true;
+    }
+    if (prog->link_fd < 0) {
+        me6e_logging(LOG_ERR, "fail to attach xdp program : %s.", strerror(errno));
+        goto error;
+    }
+
+    return 0;
+
+error:
+    me6e_xsk_prog_detach(prog);
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDPソケット登録関数
+//!
+//! AF_XDPソケットを受信キュー番号でXSKMAPへ登録する。
+//!
+//! @param [in] prog    XDPプログラム
+//! @param [in] xsk     AF_XDPソケット
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+int me6e_xsk_prog_register(me6e_xsk_prog_t* prog, me6e_xsk_t* xsk)
+{
+    // ローカル変数宣言
+    union bpf_attr  attr;
+    uint32_t        key;
+    uint32_t        value;
+
+    // 引数チェック
+    if ((prog == NULL) || (xsk == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_xsk_prog_register).");
+        return -1;
+    }
+
+    key   = xsk->queue;
+    value = xsk->fd;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = prog->map_fd;
+    attr.key    = (uint64_t)(unsigned long)&key;
+    attr.value  = (uint64_t)(unsigned long)&value;
+    attr.flags  = BPF_ANY;
+    if (xsk_bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+        me6e_logging(LOG_ERR, "fail to register xsk(queue %d) : %s.", xsk->queue, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief XDPプログラムデタッチ関数
+//!
+//! XDPプログラムをデバイスからデタッチし、XSKMAPを解放する。
+//!
+//! @param [in] prog    XDPプログラム
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_xsk_prog_detach(me6e_xsk_prog_t* prog)
+{
+    if (prog == NULL) {
+        return;
+    }
+
+    if (prog->link_fd >= 0) {
+        close(prog->link_fd);
+        prog->link_fd = -1;
+    }
+    if (prog->prog_fd >= 0) {
+        close(prog->prog_fd);
+        prog->prog_fd = -1;
+    }
+    if (prog->map_fd >= 0) {
+        close(prog->map_fd);
+        prog->map_fd = -1;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDPソケット生成関数
+//!
+//! 受信キューにAF_XDPソケットを生成し、UMEMと各リングを設定する。
+//! ゼロコピーモードでバインドできない場合はコピーモードでバインドする。
+//!
+//! @param [in] ifindex     デバイスのインデックス
+//! @param [in] queue       受信キュー番号
+//! @param [in] copy_only   コピーモードのみ使用するかどうか(汎用モード時)
+//!
+//! @return 生成したAF_XDPソケット(異常時はNULL)
+///////////////////////////////////////////////////////////////////////////////
+me6e_xsk_t* me6e_xsk_create(int ifindex, int queue, bool copy_only)
+{
+    // ローカル変数宣言
+    me6e_xsk_t*             xsk;
+    struct xdp_umem_reg     reg;
+    struct xdp_mmap_offsets off;
+    socklen_t               optlen;
+    struct sockaddr_xdp     sxdp;
+    int                     size = ME6E_XSK_RING_SIZE;
+    int                     i;
+
+    // 引数チェック
+    if ((ifindex <= 0) || (queue < 0)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_xsk_create).");
+        return NULL;
+    }
+
+    xsk = malloc(sizeof(me6e_xsk_t));
+    if (xsk == NULL) {
+        me6e_logging(LOG_ERR, "fail to allocate xsk.");
+        return NULL;
+    }
+    memset(xsk, 0, sizeof(me6e_xsk_t));
+    xsk->fd      = -1;
+    xsk->ifindex = ifindex;
+    xsk->queue   = queue;
+    xsk->umem    = MAP_FAILED;
+    pthread_mutex_init(&xsk->tx_mutex, NULL);
+
+    xsk->fd = socket(AF_XDP, SOCK_RAW, 0);
+    if (xsk->fd < 0) {
+        me6e_logging(LOG_ERR, "fail to create xdp socket : %s.", strerror(errno));
+        goto error;
+    }
+
+    // UMEMの登録
+    xsk->umem_size = (size_t)ME6E_XSK_FRAME_SIZE * ME6E_XSK_FRAME_NUM;
+    xsk->umem = mmap(NULL, xsk->umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (xsk->umem == MAP_FAILED) {
+        me6e_logging(LOG_ERR, "fail to allocate umem : %s.", strerror(errno));
+        goto error;
+    }
+
+    memset(&reg, 0, sizeof(reg));
+    reg.addr       = (uint64_t)(unsigned long)xsk->umem;
+    reg.len        = xsk->umem_size;
+    reg.chunk_size = ME6E_XSK_FRAME_SIZE;
+    reg.headroom   = 0;
+    if (setsockopt(xsk->fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0) {
+        me6e_logging(LOG_ERR, "fail to register umem : %s.", strerror(errno));
+        goto error;
+    }
+
+    // 各リングの生成
+    if ((setsockopt(xsk->fd, SOL_XDP, XDP_UMEM_FILL_RING, &size, sizeof(size)) < 0) ||
+        (setsockopt(xsk->fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &size, sizeof(size)) < 0) ||
+        (setsockopt(xsk->fd, SOL_XDP, XDP_RX_RING, &size, sizeof(size)) < 0) ||
+        (setsockopt(xsk->fd, SOL_XDP, XDP_TX_RING, &size, sizeof(size)) < 0)) {
+        me6e_logging(LOG_ERR, "fail to set xdp ring size : %s.", strerror(errno));
+        goto error;
+    }
+
+    optlen = sizeof(off);
+    if (getsockopt(xsk->fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) < 0) {
+        me6e_logging(LOG_ERR, "fail to get xdp mmap offsets : %s.", strerror(errno));
+        goto error;
+    }
+
+    if ((xsk_ring_map(xsk->fd, &xsk->fill, &off.fr, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) != 0) ||
+        (xsk_ring_map(xsk->fd, &xsk->comp, &off.cr, sizeof(uint64_t), XDP_UMEM_PGOFF_COMPLETION_RING) != 0) ||
+        (xsk_ring_map(xsk->fd, &xsk->rx, &off.rx, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) != 0) ||
+        (xsk_ring_map(xsk->fd, &xsk->tx, &off.tx, sizeof(struct xdp_desc), XDP_PGOFF_TX_RING) != 0)) {
+        me6e_logging(LOG_ERR, "fail to map xdp ring : %s.", strerror(errno));
+        goto error;
+    }
+
+    // UMEMの前半を受信用としてFillリングへ、後半を送信用として未使用リストへ
+    for (i = 0; i < ME6E_XSK_FRAME_NUM / 2; i++) {
+        ((uint64_t*)xsk->fill.desc)[i & xsk->fill.mask] = (uint64_t)i * ME6E_XSK_FRAME_SIZE;
+        xsk->tx_free[i] = (uint64_t)(i + ME6E_XSK_FRAME_NUM / 2) * ME6E_XSK_FRAME_SIZE;
+    }
+    xsk->tx_free_num = ME6E_XSK_FRAME_NUM / 2;
+    __atomic_store_n(xsk->fill.producer, ME6E_XSK_FRAME_NUM / 2, __ATOMIC_RELEASE);
+
+    // バインド(ゼロコピーモードでバインドできない場合はコピーモード)
+    memset(&sxdp, 0, sizeof(sxdp));
+    sxdp.sxdp_family   = AF_XDP;
+    sxdp.sxdp_ifindex  = ifindex;
+    sxdp.sxdp_queue_id = queue;
+    sxdp.sxdp_flags    = XDP_USE_NEED_WAKEUP | (copy_only ? XDP_COPY : XDP_ZEROCOPY);
+    xsk->zerocopy      = !copy_only;
+    if (bind(xsk->fd, (struct sockaddr*)&sxdp, sizeof(sxdp)) < 0) {
+        if (copy_only) {
+            me6e_logging(LOG_ERR, "fail to bind xsk(queue %d) : %s.", queue, strerror(errno));
+            goto error;
+        }
+        DEBUG_LOG("fail to bind xsk(queue %d) in zerocopy mode : %s.\n", queue, strerror(errno));
+        sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_COPY;
+        xsk->zerocopy   = false;
+        if (bind(xsk->fd, (struct sockaddr*)&sxdp, sizeof(sxdp)) < 0) {
+            me6e_logging(LOG_ERR, "fail to bind xsk(queue %d) : %s.", queue, strerror(errno));
+            goto error;
+        }
+    }
+
+    return xsk;
+
+error:
+    me6e_xsk_destroy(xsk);
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDPソケット解放関数
+//!
+//! @param [in] xsk     AF_XDPソケット
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_xsk_destroy(me6e_xsk_t* xsk)
+{
+    if (xsk == NULL) {
+        return;
+    }
+
+    xsk_ring_unmap(&xsk->fill);
+    xsk_ring_unmap(&xsk->comp);
+    xsk_ring_unmap(&xsk->rx);
+    xsk_ring_unmap(&xsk->tx);
+
+    if (xsk->fd >= 0) {
+        close(xsk->fd);
+    }
+    if (xsk->umem != MAP_FAILED) {
+        munmap(xsk->umem, xsk->umem_size);
+    }
+
+    pthread_mutex_destroy(&xsk->tx_mutex);
+    free(xsk);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDP受信関数
+//!
+//! RXリングのフレームを最大ME6E_XSK_RX_BATCH個まで処理し、
+//! 処理したフレームをFillリングへ戻す。
+//! フレームはUMEM上のまま処理関数へ渡す(処理関数内での書き換えは可能)。
+//!
+//! @param [in] xsk     AF_XDPソケット
+//! @param [in] func    受信フレーム処理関数
+//! @param [in] arg     受信フレーム処理関数に渡す引数
+//!
+//! @return 処理したフレーム数
+///////////////////////////////////////////////////////////////////////////////
+int me6e_xsk_recv(me6e_xsk_t* xsk, me6e_xsk_recv_func func, void* arg)
+{
+    // ローカル変数宣言
+    struct xdp_desc*    desc;
+    uint32_t            cons;
+    uint32_t            prod;
+    uint32_t            fill_prod;
+    uint32_t            num;
+    uint32_t            i;
+
+    // 引数チェック
+    if ((xsk == NULL) || (func == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_xsk_recv).");
+        return 0;
+    }
+
+    cons = *xsk->rx.consumer;
+    prod = __atomic_load_n(xsk->rx.producer, __ATOMIC_ACQUIRE);
+    num  = prod - cons;
+    if (num > ME6E_XSK_RX_BATCH) {
+        num = ME6E_XSK_RX_BATCH;
+    }
+
+    fill_prod = *xsk->fill.producer;
+    for (i = 0; i < num; i++) {
+        desc = &((struct xdp_desc*)xsk->rx.desc)[(cons + i) & xsk->rx.mask];
+
+        func(arg, (char*)xsk->umem + desc->addr, desc->len);
+
+        // 受信に使用したフレームをFillリングへ戻す
+        // (受信用フレーム数とFillリングのサイズが同じため空きは常にある)
+        ((uint64_t*)xsk->fill.desc)[(fill_prod + i) & xsk->fill.mask] =
+                desc->addr & ~((uint64_t)ME6E_XSK_FRAME_SIZE - 1);
+    }
+
+    if (num > 0) {
+        __atomic_store_n(xsk->rx.consumer, cons + num, __ATOMIC_RELEASE);
+        __atomic_store_n(xsk->fill.producer, fill_prod + num, __ATOMIC_RELEASE);
+    }
+
+    // Fillリングの補充をカーネルへ通知
+    if (*xsk->fill.flags & XDP_RING_NEED_WAKEUP) {
+        recvfrom(xsk->fd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+    }
+
+    return num;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDP送信関数
+//!
+//! 送信用フレームへ複製してTXリングへ積む。
+//! 送信要求がME6E_XSK_TX_BATCHに達した場合はカーネルへ通知する。
+//! 送信用フレームが無い場合は破棄する。
+//!
+//! @param [in] xsk     AF_XDPソケット
+//! @param [in] iov     送信データ
+//! @param [in] iovcnt  送信データの要素数
+//!
+//! @retval 0以上 送信要求したフレーム長
+//! @retval -1    異常終了(errnoを設定)
+///////////////////////////////////////////////////////////////////////////////
+ssize_t me6e_xsk_send(me6e_xsk_t* xsk, const struct iovec* iov, int iovcnt)
+{
+    // ローカル変数宣言
+    struct xdp_desc*    desc;
+    uint64_t            addr;
+    uint8_t*            data;
+    uint32_t            prod;
+    size_t              len = 0;
+    int                 i;
+
+    // 引数チェック
+    if ((xsk == NULL) || (iov == NULL)) {
+        me6e_logging(LOG_ERR, "Parameter Check NG(me6e_xsk_send).");
+        errno = EINVAL;
+        return -1;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+    if (len > ME6E_XSK_FRAME_SIZE) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    pthread_mutex_lock(&xsk->tx_mutex);
+
+    xsk_tx_reclaim(xsk);
+    if (xsk->tx_free_num == 0) {
+        // 送信用フレーム枯渇
+        xsk_tx_kick(xsk);
+        pthread_mutex_unlock(&xsk->tx_mutex);
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    addr = xsk->tx_free[--xsk->tx_free_num];
+    data = xsk->umem + addr;
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(data, iov[i].iov_base, iov[i].iov_len);
+        data += iov[i].iov_len;
+    }
+
+    // 送信用フレーム数とTXリングのサイズが同じため空きは常にある
+    prod = *xsk->tx.producer;
+    desc = &((struct xdp_desc*)xsk->tx.desc)[prod & xsk->tx.mask];
+    desc->addr    = addr;
+    desc->len     = len;
+    desc->options = 0;
+    __atomic_store_n(xsk->tx.producer, prod + 1, __ATOMIC_RELEASE);
+
+    if (++xsk->tx_pending >= ME6E_XSK_TX_BATCH) {
+        xsk_tx_kick(xsk);
+    }
+
+    pthread_mutex_unlock(&xsk->tx_mutex);
+
+    return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief AF_XDP送信通知関数
+//!
+//! 未通知の送信要求があればカーネルへ送信を通知する。
+//!
+//! @param [in] xsk     AF_XDPソケット
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+void me6e_xsk_flush(me6e_xsk_t* xsk)
+{
+    if (xsk == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&xsk->tx_mutex);
+    if (xsk->tx_pending > 0) {
+        xsk_tx_kick(xsk);
+    }
+    xsk_tx_reclaim(xsk);
+    pthread_mutex_unlock(&xsk->tx_mutex);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief bpfシステムコール発行関数
+//!
+//! @param [in]     cmd     コマンド
+//! @param [in,out] attr    属性
+//!
+//! @return システムコールの戻り値
+///////////////////////////////////////////////////////////////////////////////
+static inline long xsk_bpf(int cmd, union bpf_attr* attr)
+{
+    return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief XDPプログラム命令追加関数
+//!
+//! @param [in,out] prog    命令列
+//! @param [in,out] cnt     命令数
+//! @param [in]     code    命令コード
+//! @param [in]     dst     宛先レジスタ
+//! @param [in]     src     送信元レジスタ
+//! @param [in]     off     オフセット
+//! @param [in]     imm     即値
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void xsk_insn(struct bpf_insn* prog, int* cnt, uint8_t code,
+        uint8_t dst, uint8_t src, int16_t off, int32_t imm)
+{
+    struct bpf_insn* insn = &prog[(*cnt)++];
+
+    memset(insn, 0, sizeof(*insn));
+    insn->code    = code;
+    insn->dst_reg = dst;
+    insn->src_reg = src;
+    insn->off     = off;
+    insn->imm     = imm;
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief リングマッピング関数
+//!
+//! @param [in]  fd         AF_XDPソケット
+//! @param [out] ring       リング
+//! @param [in]  off        リングのオフセット情報
+//! @param [in]  desc_size  ディスクリプタのサイズ
+//! @param [in]  pgoff      マッピングのオフセット
+//!
+//! @retval 0     正常終了
+//! @retval 0以外 異常終了
+///////////////////////////////////////////////////////////////////////////////
+static int xsk_ring_map(int fd, me6e_xsk_ring_t* ring, const struct xdp_ring_offset* off,
+        size_t desc_size, off_t pgoff)
+{
+    uint8_t* map;
+
+    ring->map_size = off->desc + ME6E_XSK_RING_SIZE * desc_size;
+    map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, pgoff);
+    if (map == MAP_FAILED) {
+        ring->map = NULL;
+        return -1;
+    }
+
+    ring->map      = map;
+    ring->producer = (uint32_t*)(map + off->producer);
+    ring->consumer = (uint32_t*)(map + off->consumer);
+    ring->flags    = (uint32_t*)(map + off->flags);
+    ring->desc     = map + off->desc;
+    ring->mask     = ME6E_XSK_RING_SIZE - 1;
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief リングマッピング解除関数
+//!
+//! @param [in] ring    リング
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static void xsk_ring_unmap(me6e_xsk_ring_t* ring)
+{
+    if (ring->map != NULL) {
+        munmap(ring->map, ring->map_size);
+        ring->map = NULL;
+    }
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信完了フレーム回収関数
+//!
+//! Completionリングから送信完了したフレームを回収し、未使用リストへ戻す。
+//! tx_mutexを獲得して呼び出すこと。
+//!
+//! @param [in] xsk     AF_XDPソケット
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void xsk_tx_reclaim(me6e_xsk_t* xsk)
+{
+    uint32_t cons = *xsk->comp.consumer;
+    uint32_t prod = __atomic_load_n(xsk->comp.producer, __ATOMIC_ACQUIRE);
+
+    if (prod == cons) {
+        return;
+    }
+
+    for (; cons != prod; cons++) {
+        xsk->tx_free[xsk->tx_free_num++] = ((uint64_t*)xsk->comp.desc)[cons & xsk->comp.mask];
+    }
+    __atomic_store_n(xsk->comp.consumer, cons, __ATOMIC_RELEASE);
+
+    return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//! @brief 送信通知関数
+//!
+//! TXリングの送信要求をカーネルへ通知する。tx_mutexを獲得して呼び出すこと。
+//!
+//! @param [in] xsk     AF_XDPソケット
+//!
+//! @return なし
+///////////////////////////////////////////////////////////////////////////////
+static inline void xsk_tx_kick(me6e_xsk_t* xsk)
+{
+    // ゼロコピーモードでドライバが処理中の場合は通知不要
+    if (!xsk->zerocopy || (*xsk->tx.flags & XDP_RING_NEED_WAKEUP)) {
+        if ((sendto(xsk->fd, NULL, 0, MSG_DONTWAIT, NULL, 0) < 0) &&
+            (errno != EAGAIN) && (errno != EBUSY) && (errno != ENOBUFS) && (errno != ENETDOWN)) {
+            DEBUG_LOG("fail to kick xsk(queue %d) : %s\n", xsk->queue, strerror(errno));
+        }
+    }
+    xsk->tx_pending = 0;
+
+    return;
+}
@@ -0,0 +1,105 @@
+/******************************************************************************/
+/* ファイル名 : me6eapp_xsk.h                                                 */
+/* 機能概要   : AF_XDPソケット ヘッダファイル                                 */
+/* 修正履歴   : 2026.10.18 新規作成                                           */
+/*                                                                            */
+/* ALL RIGHTS RESERVED, COPYRIGHT(C) FUJITSU LIMITED 2013-2016                */
+/******************************************************************************/
+#ifndef __ME6EAPP_XSK_H__
+#define __ME6EAPP_XSK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// マクロ定義
+////////////////////////////////////////////////////////////////////////////////
+//! 1デバイスで使用する受信キューの最大数
+#define ME6E_XSK_QUEUE_MAX      16
+//! UMEMのフレームサイズ
+#define ME6E_XSK_FRAME_SIZE     4096
+//! UMEMのフレーム数(前半を受信用、後半を送信用に使用する)
+#define ME6E_XSK_FRAME_NUM      4096
+//! 各リングのエントリ数(2のべき乗)
+#define ME6E_XSK_RING_SIZE      2048
+//! 1回の受信処理でまとめて処理するフレームの最大数
+#define ME6E_XSK_RX_BATCH       64
+//! 送信要求をまとめてカーネルへ通知するフレーム数
+#define ME6E_XSK_TX_BATCH       64
+
+///////////////////////////////////////////////////////////////////////////////
+//! AF_XDPリング(生産者/消費者インデックスとディスクリプタ配列)
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_xsk_ring_t
+{
+    volatile uint32_t*  producer;       ///< 生産者インデックス
+    volatile uint32_t*  consumer;       ///< 消費者インデックス
+    volatile uint32_t*  flags;          ///< リングフラグ(XDP_RING_NEED_WAKEUP)
+    void*               desc;           ///< ディスクリプタ配列
+    uint32_t            mask;           ///< インデックスのマスク
+    void*               map;            ///< マッピング先頭
+    size_t              map_size;       ///< マッピングサイズ
+};
+typedef struct me6e_xsk_ring_t me6e_xsk_ring_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! AF_XDPソケット
+//!
+//! 受信キュー毎に生成し、キュー毎にUMEMを持つ。
+//! 受信フレームはUMEM上のまま処理関数へ渡し、処理後にFillリングへ戻す。
+//! 送信は送信用フレームへ複製してTXリングへ積み、
+//! Completionリングから回収したフレームを再利用する。
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_xsk_t
+{
+    int                 fd;             ///< AF_XDPソケット
+    int                 ifindex;        ///< デバイスのインデックス
+    int                 queue;          ///< 受信キュー番号
+    bool                zerocopy;       ///< ゼロコピーモードかどうか
+    uint8_t*            umem;           ///< UMEM領域
+    size_t              umem_size;      ///< UMEM領域のサイズ
+    me6e_xsk_ring_t     fill;           ///< Fillリング
+    me6e_xsk_ring_t     comp;           ///< Completionリング
+    me6e_xsk_ring_t     rx;             ///< RXリング
+    me6e_xsk_ring_t     tx;             ///< TXリング
+    uint64_t            tx_free[ME6E_XSK_FRAME_NUM / 2]; ///< 未使用の送信用フレーム
+    int                 tx_free_num;    ///< 未使用の送信用フレーム数
+    int                 tx_pending;     ///< 送信要求済みで未通知のフレーム数
+    pthread_mutex_t     tx_mutex;       ///< 送信排他用mutex
+};
+typedef struct me6e_xsk_t me6e_xsk_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! XDPプログラム(受信キュー番号でAF_XDPソケットへリダイレクトする)
+///////////////////////////////////////////////////////////////////////////////
+struct me6e_xsk_prog_t
+{
+    int                 map_fd;         ///< XSKMAP
+    int                 prog_fd;        ///< XDPプログラム
+    int                 link_fd;        ///< デバイスとのリンク(クローズでデタッチ)
+    bool                skb_mode;       ///< 汎用(SKB)モードでアタッチしたかどうか
+};
+typedef struct me6e_xsk_prog_t me6e_xsk_prog_t;
+
+///////////////////////////////////////////////////////////////////////////////
+//! 受信フレーム処理関数
+///////////////////////////////////////////////////////////////////////////////
+typedef void (*me6e_xsk_recv_func)(void* arg, char* frame, ssize_t len);
+
+////////////////////////////////////////////////////////////////////////////////
+// 外部関数プロトタイプ宣言
+////////////////////////////////////////////////////////////////////////////////
+int me6e_xsk_queue_num(const char* ifname);
+int me6e_xsk_prog_attach(int ifindex, int queue_num, me6e_xsk_prog_t* prog);
+int me6e_xsk_prog_register(me6e_xsk_prog_t* prog, me6e_xsk_t* xsk);
+void me6e_xsk_prog_detach(me6e_xsk_prog_t* prog);
+me6e_xsk_t* me6e_xsk_create(int ifindex, int queue, bool copy_only);
+void me6e_xsk_destroy(me6e_xsk_t* xsk);
+int me6e_xsk_recv(me6e_xsk_t* xsk, me6e_xsk_recv_func func, void* arg);
+ssize_t me6e_xsk_send(me6e_xsk_t* xsk, const struct iovec* iov, int iovcnt);
+void me6e_xsk_flush(me6e_xsk_t* xsk);
+
+#endif // __ME6EAPP_XSK_H__
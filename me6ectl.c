@@ -52,6 +52,7 @@ static const struct command_arg command_args[] = {
     {"show",     "arp",   ME6E_SHOW_ARP},
     {"show",     "ndp",   ME6E_SHOW_NDP},
     {"show",     "pr",    ME6E_SHOW_PR},
+    {"show",     "peer",  ME6E_SHOW_PEER},
     {"add",      "arp",   ME6E_ADD_ARP},
     {"add",      "ndp",   ME6E_ADD_NDP},
     {"add",      "pr",    ME6E_ADD_PR},
@@ -85,6 +86,7 @@ static void usage(void)
 "                    show arp  \n"
 "                    show ndp  \n"
 "                    show pr   \n"
+"                    show peer \n"
 "                    add arp IPv4Addr MACAddr \n"
 "                    add ndp IPv6Addr MACAddr \n"
 "                    add pr  MACAddr IPv6Addr/Prefixlen mode \n"
@@ -102,6 +104,7 @@ static void usage(void)
 "  show arp   : Show the Proxy ARP table specified plane_name.\n"
 "  show ndp   : Show the Proxy NDP table specified plane_name.\n"
 "  show pr    : Show the ME6E-PR table specified plane_name.\n"
+"  show peer  : Show the ME6E host liveness and RTT specified plane_name.\n"
 "  add arp    : Add the ARP entry to the Proxy ARP tablen specified plane_name.\n"
 "  add ndp    : Add the NDP entry to the Proxy NDP table specified plane_name.\n"
 "  add pr     : Add the PR entry to the ME6E-PR table specified plane_name.\n"
@@ -294,7 +297,7 @@ int main(int argc, char* argv[])
         }
     }
 
-    if (command.code == ME6E_SHOW_PR) {
+    if ((command.code == ME6E_SHOW_PR) || (command.code == ME6E_SHOW_PEER)) {
         if (argc != 5)  {
             usage();
             exit(EINVAL);
@@ -375,6 +378,7 @@ int main(int argc, char* argv[])
     case ME6E_ADD_PR:
     case ME6E_DEL_PR:
     case ME6E_SHOW_PR:
+    case ME6E_SHOW_PEER:
     case ME6E_ENABLE_PR:
     case ME6E_DISABLE_PR:
     case ME6E_LOAD_PR: